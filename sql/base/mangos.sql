@@ -23,7 +23,7 @@ DROP TABLE IF EXISTS `db_version`;
 CREATE TABLE `db_version` (
   `version` varchar(120) DEFAULT NULL,
   `creature_ai_version` varchar(120) DEFAULT NULL,
-  `required_s2358_01_mangos_game_event_group` bit(1) DEFAULT NULL
+  `required_s2371_01_mangos_command` bit(1) DEFAULT NULL
 ) ENGINE=MyISAM DEFAULT CHARSET=utf8 ROW_FORMAT=DYNAMIC COMMENT='Used DB version notes';
 
 --
@@ -660,6 +660,7 @@ INSERT INTO `command` VALUES
 ('send mass money',3,'Syntax: .send mass money #racemask|$racename|alliance|horde|all \"#subject\" \"#text\" #money\r\n\r\nSend mail with money to players. Subject and mail text must be in \"\".'),
 ('send message',3,'Syntax: .send message $playername $message\r\n\r\nSend screen message to player from ADMINISTRATOR.'),
 ('send money',3,'Syntax: .send money #playername \"#subject\" \"#text\" #money\r\n\r\nSend mail with money to a player. Subject and mail text must be in \"\".'),
+('server aurapool',3,'Syntax: .server aurapool\r\n\r\nShow how many spell aura objects were served from the aura pool.'),
 ('server corpses',2,'Syntax: .server corpses\r\n\r\nTriggering corpses expire check in world.'),
 ('server exit',4,'Syntax: .server exit\r\n\r\nTerminate mangosd NOW. Exit code 0.'),
 ('server idlerestart',3,'Syntax: .server idlerestart #delay\r\n\r\nRestart the server after #delay seconds if no active connections are present (no players). Use #exist_code or 2 as program exist code.'),
@@ -669,10 +670,21 @@ INSERT INTO `command` VALUES
 ('server info',0,'Syntax: .server info\r\n\r\nDisplay server version and the number of connected players.'),
 ('server log filter',4,'Syntax: .server log filter [($filtername|all) (on|off)]\r\n\r\nShow or set server log filters. If used \"all\" then all filters will be set to on/off state.'),
 ('server log level',4,'Syntax: .server log level [#level]\r\n\r\nShow or set server log level (0 - errors only, 1 - basic, 2 - detail, 3 - debug).'),
+('server loscachestats',3,'Syntax: .server loscachestats\r\n\r\nShow how many line of sight checks were answered by the per map line of sight caches, for all maps and for the map you are on.'),
+('server mapstats',3,'Syntax: .server mapstats [#count]\r\n\r\nShow the map update thread count, the duration of the last map update phase and the #count (default 10) maps with the highest average update time.'),
 ('server motd',0,'Syntax: .server motd\r\n\r\nShow server Message of the day.'),
+('server netlatency',3,'Syntax: .server netlatency [$playername]\r\n\r\nShow the distribution of the time between queueing and sending packets, for all connections or the connection of the player.'),
+('server netstats',3,'Syntax: .server netstats\r\n\r\nShow the sockets, measured load, traffic and busy time of every network thread.'),
+('server packetpool',3,'Syntax: .server packetpool\r\n\r\nShow hit rate and retained memory of the packet buffer pool, in total and per buffer size class.'),
+('server pathstats',3,'Syntax: .server pathstats\r\n\r\nShow how many paths were built, how long they took, how often the path cache and corridor repair avoided a search and how the path finder threads keep up.'),
 ('server plimit',3,'Syntax: .server plimit [#num|-1|-2|-3|reset|player|moderator|gamemaster|administrator]\r\n\r\nWithout arg show current player amount and security level limitations for login to server, with arg set player linit ($num > 0) or securiti limitation ($num < 0 or security leme name. With `reset` sets player limit to the one in the config file'),
+('server preloadstats',3,'Syntax: .server preloadstats\r\n\r\nShow how many terrain tiles the grid preloader read ahead of players, how many grid loads found their tile preloaded and how many preloaded tiles were never used.'),
+('server procbenchmark',3,'Syntax: .server procbenchmark [#events]\r\n\r\nFind the aura holders of the selected unit which can proc from #events (default 100000) typical combat events, once by walking all holders and once with the proc index, and show the time per event of both.'),
+('server procstats',3,'Syntax: .server procstats\r\n\r\nShow how many aura holders the proc checks visited and how many the proc index let them skip.'),
+('server recvqueues',3,'Syntax: .server recvqueues [#count]\r\n\r\nShow the receive queue depth of all sessions and list the #count (default 10) sessions with the highest queue peak, with their current depth and how often reading from their client was throttled.'),
 ('server restart',3,'Syntax: .server restart #delay\r\n\r\nRestart the server after #delay seconds. Use #exist_code or 2 as program exist code.'),
 ('server restart cancel',3,'Syntax: .server restart cancel\r\n\r\nCancel the restart/shutdown timer if any.'),
+('server savestats',3,'Syntax: .server savestats\r\n\r\nShow the number of character saves with their average time, statements and database round trips, and the totals of all character database transactions.'),
 ('server set motd',3,'Syntax: .server set motd $MOTD\r\n\r\nSet server Message of the day.'),
 ('server shutdown',3,'Syntax: .server shutdown #delay [#exit_code]\r\n\r\nShut the server down after #delay seconds. Use #exit_code or 0 as program exit code.'),
 ('server shutdown cancel',3,'Syntax: .server shutdown cancel\r\n\r\nCancel the restart/shutdown timer if any.'),
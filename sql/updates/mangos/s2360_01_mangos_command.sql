@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2358_01_mangos_game_event_group required_s2360_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server mapstats');
+INSERT INTO command (name, security, help) VALUES
+('server mapstats',3,'Syntax: .server mapstats [#count]\r\n\r\nShow the map update thread count, the duration of the last map update phase and the #count (default 10) maps with the highest average update time.');
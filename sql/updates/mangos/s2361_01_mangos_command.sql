@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2360_01_mangos_command required_s2361_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server netstats');
+INSERT INTO command (name, security, help) VALUES
+('server netstats',3,'Syntax: .server netstats\r\n\r\nShow the sockets, measured load, traffic and busy time of every network thread.');
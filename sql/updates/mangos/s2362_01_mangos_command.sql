@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2361_01_mangos_command required_s2362_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server netlatency');
+INSERT INTO command (name, security, help) VALUES
+('server netlatency',3,'Syntax: .server netlatency [$playername]\r\n\r\nShow the distribution of the time between queueing and sending packets, for all connections or the connection of the player.');
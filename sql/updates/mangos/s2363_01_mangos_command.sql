@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2362_01_mangos_command required_s2363_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server recvqueues');
+INSERT INTO command (name, security, help) VALUES
+('server recvqueues',3,'Syntax: .server recvqueues [#count]\r\n\r\nShow the receive queue depth of all sessions and list the #count (default 10) sessions with the highest queue peak, with their current depth and how often reading from their client was throttled.');
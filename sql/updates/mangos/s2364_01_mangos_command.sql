@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2363_01_mangos_command required_s2364_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server packetpool');
+INSERT INTO command (name, security, help) VALUES
+('server packetpool',3,'Syntax: .server packetpool\r\n\r\nShow hit rate and retained memory of the packet buffer pool, in total and per buffer size class.');
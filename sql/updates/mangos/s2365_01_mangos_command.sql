@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2364_01_mangos_command required_s2365_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server savestats');
+INSERT INTO command (name, security, help) VALUES
+('server savestats',3,'Syntax: .server savestats\r\n\r\nShow the number of character saves with their average time, statements and database round trips, and the totals of all character database transactions.');
@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2365_01_mangos_command required_s2366_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server preloadstats');
+INSERT INTO command (name, security, help) VALUES
+('server preloadstats',3,'Syntax: .server preloadstats\r\n\r\nShow how many terrain tiles the grid preloader read ahead of players, how many grid loads found their tile preloaded and how many preloaded tiles were never used.');
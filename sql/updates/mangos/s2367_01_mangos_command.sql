@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2366_01_mangos_command required_s2367_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server loscachestats');
+INSERT INTO command (name, security, help) VALUES
+('server loscachestats',3,'Syntax: .server loscachestats\r\n\r\nShow how many line of sight checks were answered by the per map line of sight caches, for all maps and for the map you are on.');
@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2367_01_mangos_command required_s2368_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server pathstats');
+INSERT INTO command (name, security, help) VALUES
+('server pathstats',3,'Syntax: .server pathstats\r\n\r\nShow how many paths were built, how long they took, how often the path cache and corridor repair avoided a search and how the path finder threads keep up.');
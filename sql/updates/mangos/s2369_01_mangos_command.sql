@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2368_01_mangos_command required_s2369_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server aurapool');
+INSERT INTO command (name, security, help) VALUES
+('server aurapool',3,'Syntax: .server aurapool\r\n\r\nShow how many spell aura objects were served from the aura pool.');
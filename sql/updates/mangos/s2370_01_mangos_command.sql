@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2369_01_mangos_command required_s2370_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server procstats');
+INSERT INTO command (name, security, help) VALUES
+('server procstats',3,'Syntax: .server procstats\r\n\r\nShow how many aura holders the proc checks visited and how many the proc index let them skip.');
@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_s2370_01_mangos_command required_s2371_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('server procbenchmark');
+INSERT INTO command (name, security, help) VALUES
+('server procbenchmark',3,'Syntax: .server procbenchmark [#events]\r\n\r\nFind the aura holders of the selected unit which can proc from #events (default 100000) typical combat events, once by walking all holders and once with the proc index, and show the time per event of both.');
@@ -0,0 +1,144 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_GRIDPOSITIONINDEX_H
+#define MANGOS_GRIDPOSITIONINDEX_H
+
+#include "Platform/Define.h"
+
+#include <vector>
+
+template<class OBJECT> class GridReference;
+
+#define GRID_POSITION_INDEX_BLOCK 64                        // positions tested at once before any object is touched
+
+/*
+  @class GridPositionIndexTraits
+  Types whose grid lists also keep a GridPositionIndex, specialized with Enabled = 1
+  before the grid containers of the type are used.
+*/
+template<class OBJECT>
+struct GridPositionIndexTraits
+{
+    enum { Enabled = 0 };
+};
+
+/*
+  @class GridPositionIndex
+  Positions of the objects of one grid list packed in flat arrays, kept in sync by GridReference
+  on link, unlink and GridReference::UpdatePosition. Range searches test the packed positions
+  first, a block at a time in a loop the compiler can vectorize, and only follow the objects
+  close enough to pass. The objects need GetPositionX, GetPositionY and GetObjectBoundingRadius.
+*/
+template<class OBJECT, bool ENABLED = GridPositionIndexTraits<OBJECT>::Enabled != 0>
+class GridPositionIndex
+{
+    public:
+        static bool IsEnabled() { return false; }
+
+        void Insert(GridReference<OBJECT>* /*ref*/) {}
+        void Remove(GridReference<OBJECT>* /*ref*/) {}
+        void Relocate(GridReference<OBJECT>* /*ref*/) {}
+
+        template<class FUNC>
+        void VisitInRange(float /*x*/, float /*y*/, float /*range*/, FUNC& /*func*/) const {}
+};
+
+template<class OBJECT>
+class GridPositionIndex<OBJECT, true>
+{
+    public:
+        static bool IsEnabled() { return true; }
+
+        void Insert(GridReference<OBJECT>* ref)
+        {
+            ref->i_indexSlot = uint32(i_refs.size());
+            i_refs.push_back(ref);
+            i_x.push_back(0.0f);
+            i_y.push_back(0.0f);
+            i_radius.push_back(0.0f);
+            Relocate(ref);
+        }
+
+        void Remove(GridReference<OBJECT>* ref)
+        {
+            // the last object takes the free slot
+            uint32 slot = ref->i_indexSlot;
+            uint32 last = uint32(i_refs.size()) - 1;
+            if (slot != last)
+            {
+                i_refs[slot] = i_refs[last];
+                i_x[slot] = i_x[last];
+                i_y[slot] = i_y[last];
+                i_radius[slot] = i_radius[last];
+                i_refs[slot]->i_indexSlot = slot;
+            }
+
+            i_refs.pop_back();
+            i_x.pop_back();
+            i_y.pop_back();
+            i_radius.pop_back();
+        }
+
+        void Relocate(GridReference<OBJECT>* ref)
+        {
+            OBJECT const* obj = ref->getSource();
+            uint32 slot = ref->i_indexSlot;
+            i_x[slot] = obj->GetPositionX();
+            i_y[slot] = obj->GetPositionY();
+            i_radius[slot] = obj->GetObjectBoundingRadius();
+        }
+
+        /** Calls func for every object whose bounding circle reaches within range of (x, y),
+            until func returns false. Objects are not visited in list order.
+         */
+        template<class FUNC>
+        void VisitInRange(float x, float y, float range, FUNC& func) const
+        {
+            uint8 inRange[GRID_POSITION_INDEX_BLOCK];
+
+            size_t size = i_refs.size();
+            for (size_t begin = 0; begin < size; begin += GRID_POSITION_INDEX_BLOCK)
+            {
+                size_t count = size - begin < GRID_POSITION_INDEX_BLOCK ? size - begin : GRID_POSITION_INDEX_BLOCK;
+
+                float const* px = &i_x[begin];
+                float const* py = &i_y[begin];
+                float const* pr = &i_radius[begin];
+                for (size_t i = 0; i < count; ++i)
+                {
+                    float dx = px[i] - x;
+                    float dy = py[i] - y;
+                    float maxDist = range + pr[i];
+                    inRange[i] = uint8(dx * dx + dy * dy <= maxDist * maxDist);
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                    if (inRange[i] && !func(i_refs[begin + i]->getSource()))
+                        return;
+            }
+        }
+
+    private:
+        std::vector<GridReference<OBJECT>*> i_refs;
+        std::vector<float> i_x;
+        std::vector<float> i_y;
+        std::vector<float> i_radius;
+};
+
+#endif
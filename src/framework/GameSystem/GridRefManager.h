@@ -20,6 +20,7 @@
 #define _GRIDREFMANAGER
 
 #include "Utilities/LinkedReference/RefManager.h"
+#include "GameSystem/GridPositionIndex.h"
 
 template<class OBJECT> class GridReference;
 
@@ -44,5 +45,12 @@ class GridRefManager : public RefManager<GridRefManager<OBJECT>, OBJECT>
         iterator end() { return iterator(nullptr); }
         iterator rbegin() { return iterator(getLast()); }
         iterator rend() { return iterator(nullptr); }
+
+        GridPositionIndex<OBJECT>& GetPositionIndex() { return i_positionIndex; }
+        GridPositionIndex<OBJECT> const& GetPositionIndex() const { return i_positionIndex; }
+
+    private:
+
+        GridPositionIndex<OBJECT> i_positionIndex;
 };
 #endif
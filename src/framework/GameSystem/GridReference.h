@@ -19,13 +19,17 @@
 #ifndef _GRIDREFERENCE_H
 #define _GRIDREFERENCE_H
 
+#include "Platform/Define.h"
 #include "Utilities/LinkedReference/Reference.h"
 
 template<class OBJECT> class GridRefManager;
+template<class OBJECT, bool ENABLED> class GridPositionIndex;
 
 template<class OBJECT>
 class GridReference : public Reference<GridRefManager<OBJECT>, OBJECT>
 {
+        template<class O, bool E> friend class GridPositionIndex;
+
     protected:
 
         void targetObjectBuildLink() override
@@ -33,25 +37,29 @@ class GridReference : public Reference<GridRefManager<OBJECT>, OBJECT>
             // called from link()
             this->getTarget()->insertFirst(this);
             this->getTarget()->incSize();
+            this->getTarget()->GetPositionIndex().Insert(this);
         }
 
         void targetObjectDestroyLink() override
         {
             // called from unlink()
             if (this->isValid())
+            {
                 this->getTarget()->decSize();
+                this->getTarget()->GetPositionIndex().Remove(this);
+            }
         }
 
         void sourceObjectDestroyLink() override
         {
-            // called from invalidate()
+            // called from invalidate(), the position index goes away with the list
             this->getTarget()->decSize();
         }
 
     public:
 
         GridReference()
-            : Reference<GridRefManager<OBJECT>, OBJECT>()
+            : Reference<GridRefManager<OBJECT>, OBJECT>(), i_indexSlot(0)
         {
         }
 
@@ -64,6 +72,17 @@ class GridReference : public Reference<GridRefManager<OBJECT>, OBJECT>
         {
             return (GridReference*)Reference<GridRefManager<OBJECT>, OBJECT>::next();
         }
+
+        // the object moved, see GridPositionIndex
+        void UpdatePosition()
+        {
+            if (this->isValid())
+                this->getTarget()->GetPositionIndex().Relocate(this);
+        }
+
+    private:
+
+        uint32 i_indexSlot;                                 // position in the GridPositionIndex of the list
 };
 
 #endif
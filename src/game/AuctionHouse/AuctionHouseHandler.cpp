@@ -621,5 +621,5 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
     data.put<uint32>(0, count);
     data << uint32(totalcount);
     data << uint32(300);                                    // 2.3.0 delay for next isFull request?
-    SendPacket(data);
+    SendPacket(std::move(data));
 }
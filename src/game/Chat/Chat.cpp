@@ -661,14 +661,26 @@ ChatCommand* ChatHandler::getCommandTable()
 
     static ChatCommand serverCommandTable[] =
     {
+        { "aurapool",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerAuraPoolCommand,      "", nullptr },
         { "corpses",        SEC_GAMEMASTER,     true,  &ChatHandler::HandleServerCorpsesCommand,       "", nullptr },
         { "exit",           SEC_CONSOLE,        true,  &ChatHandler::HandleServerExitCommand,          "", nullptr },
         { "idlerestart",    SEC_ADMINISTRATOR,  true,  nullptr,                                        "", serverIdleRestartCommandTable },
         { "idleshutdown",   SEC_ADMINISTRATOR,  true,  nullptr,                                        "", serverIdleShutdownCommandTable },
         { "info",           SEC_PLAYER,         true,  &ChatHandler::HandleServerInfoCommand,          "", nullptr },
         { "log",            SEC_CONSOLE,        true,  nullptr,                                        "", serverLogCommandTable },
+        { "loscachestats",  SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerLosCacheStatsCommand, "", nullptr },
+        { "mapstats",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerMapStatsCommand,      "", nullptr },
         { "motd",           SEC_PLAYER,         true,  &ChatHandler::HandleServerMotdCommand,          "", nullptr },
+        { "netlatency",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerNetLatencyCommand,    "", nullptr },
+        { "netstats",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerNetStatsCommand,      "", nullptr },
+        { "packetpool",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerPacketPoolCommand,    "", nullptr },
+        { "pathstats",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerPathStatsCommand,     "", nullptr },
         { "plimit",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerPLimitCommand,        "", nullptr },
+        { "preloadstats",   SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerPreloadStatsCommand,  "", nullptr },
+        { "procbenchmark",  SEC_ADMINISTRATOR,  false, &ChatHandler::HandleServerProcBenchmarkCommand, "", nullptr },
+        { "procstats",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerProcStatsCommand,     "", nullptr },
+        { "recvqueues",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerRecvQueuesCommand,    "", nullptr },
+        { "savestats",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerSaveStatsCommand,     "", nullptr },
         { "resetallraid",   SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerResetAllRaidCommand,  "", nullptr },
         { "restart",        SEC_ADMINISTRATOR,  true,  nullptr,                                        "", serverRestartCommandTable },
         { "shutdown",       SEC_ADMINISTRATOR,  true,  nullptr,                                        "", serverShutdownCommandTable },
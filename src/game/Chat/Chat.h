@@ -497,6 +497,18 @@ class ChatHandler
         bool HandleServerInfoCommand(char* args);
         bool HandleServerLogFilterCommand(char* args);
         bool HandleServerLogLevelCommand(char* args);
+        bool HandleServerMapStatsCommand(char* args);
+        bool HandleServerNetLatencyCommand(char* args);
+        bool HandleServerRecvQueuesCommand(char* args);
+        bool HandleServerPacketPoolCommand(char* args);
+        bool HandleServerAuraPoolCommand(char* args);
+        bool HandleServerSaveStatsCommand(char* args);
+        bool HandleServerPreloadStatsCommand(char* args);
+        bool HandleServerLosCacheStatsCommand(char* args);
+        bool HandleServerPathStatsCommand(char* args);
+        bool HandleServerProcBenchmarkCommand(char* args);
+        bool HandleServerProcStatsCommand(char* args);
+        bool HandleServerNetStatsCommand(char* args);
         bool HandleServerMotdCommand(char* args);
         bool HandleServerPLimitCommand(char* args);
         bool HandleServerResetAllRaidCommand(char* args);
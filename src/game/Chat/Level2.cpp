@@ -4921,6 +4921,7 @@ bool ChatHandler::HandleMmapStatsCommand(char* /*args*/)
 
     MMAP::MMapManager* manager = MMAP::MMapFactory::createOrGetMMapManager();
     PSendSysMessage(" %u maps loaded with %u tiles overall", manager->getLoadedMapsCount(), manager->getLoadedTilesCount());
+    PSendSysMessage(" %u unused tiles unloaded since startup", manager->getEvictedTilesCount());
 
     const dtNavMesh* navmesh = manager->GetNavMesh(m_session->GetPlayer()->GetMapId());
     if (!navmesh)
@@ -58,6 +58,10 @@
 #include "Loot/LootMgr.h"
 
 #include "Entities/CPlayer.h"
+#include "Network/NetworkStatistics.hpp"
+#include "Spells/AuraPool.h"
+
+#include <chrono>
 
 static uint32 ahbotQualityIds[MAX_AUCTION_QUALITY] =
 {
@@ -4632,6 +4636,7 @@ static bool HandleResetStatsOrLevelHelper(Player* player)
         player->SetShapeshiftForm(FORM_NONE);
 
     player->SetFloatValue(UNIT_FIELD_BOUNDINGRADIUS, DEFAULT_WORLD_OBJECT_SIZE);
+    player->UpdateGridPosition();
     player->SetFloatValue(UNIT_FIELD_COMBATREACH, 1.5f);
 
     player->setFactionForRace(player->getRace());
@@ -5867,6 +5872,341 @@ bool ChatHandler::HandleServerPLimitCommand(char* args)
     return true;
 }
 
+bool ChatHandler::HandleServerMapStatsCommand(char* args)
+{
+    uint32 count;
+    if (!ExtractOptUInt32(&args, count, 10))
+        return false;
+
+    MapManager::MapMapType const& maps = sMapMgr.Maps();
+    PSendSysMessage("Map update: %u maps, %u worker threads, last update took %.2f ms.",
+                    uint32(maps.size()), std::max(sMapMgr.GetMapUpdateThreadCount(), 1u), sMapMgr.GetLastMapsUpdateTime() / 1000.0f);
+
+    // slowest maps first, these are the ones setting the tick length
+    // sorted by the averages read once, the statistics may change while sorting
+    typedef std::pair<uint32 /*averageTime*/, Map const*> MapByTime;
+    std::vector<MapByTime> sortedMaps;
+    sortedMaps.reserve(maps.size());
+    for (MapManager::MapMapType::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+        sortedMaps.push_back(MapByTime(itr->second->GetUpdateStatistics().averageTime, itr->second));
+
+    std::sort(sortedMaps.begin(), sortedMaps.end(), [](MapByTime const & a, MapByTime const & b)
+    {
+        return a.first > b.first;
+    });
+
+    if (sortedMaps.size() > count)
+        sortedMaps.resize(count);
+
+    for (std::vector<MapByTime>::const_iterator itr = sortedMaps.begin(); itr != sortedMaps.end(); ++itr)
+    {
+        Map const* map = itr->second;
+        MapUpdateStatistics const& stats = map->GetUpdateStatistics();
+        const uint64 valuesBlocksShared = stats.valuesBlocksShared;
+        const uint64 valuesBlocks = stats.valuesBlocksBuilt + valuesBlocksShared;
+        PSendSysMessage("Map %u (%s) instance %u, players %u: avg %.2f ms, last %.2f ms, max %.2f ms, update blocks shared %.1f%%",
+                        map->GetId(), map->GetMapName(), map->GetInstanceId(), map->GetPlayers().getSize(),
+                        itr->first / 1000.0f, stats.lastTime / 1000.0f, stats.maxTime / 1000.0f,
+                        valuesBlocks ? valuesBlocksShared * 100.0f / valuesBlocks : 0.0f);
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleServerNetStatsCommand(char* /*args*/)
+{
+    UpdateCompressionStatistics const& compression = UpdateData::GetCompressionStatistics();
+    const uint64 bytesIn = compression.bytesIn;
+    const uint64 bytesSaved = bytesIn - std::min(bytesIn, uint64(compression.bytesOut));
+    PSendSysMessage("Update compression: " UI64FMTD " packets, " UI64FMTD " KB saved (%.1f%%), " UI64FMTD " ms cpu, " UI64FMTD " left to network threads",
+                    uint64(compression.packets), bytesSaved / 1024, bytesIn ? bytesSaved * 100.0f / bytesIn : 0.0f,
+                    compression.time / 1000, uint64(compression.offloaded));
+
+    std::vector<MaNGOS::NetworkStatistics::Snapshot> snapshots;
+    MaNGOS::NetworkStatistics::GetSnapshots(snapshots);
+
+    if (snapshots.empty())
+    {
+        SendSysMessage("No network threads running.");
+        return true;
+    }
+
+    for (std::vector<MaNGOS::NetworkStatistics::Snapshot>::const_iterator itr = snapshots.begin(); itr != snapshots.end(); ++itr)
+    {
+        PSendSysMessage("Port %i thread %u: sockets %u, load %.1f%%, in " UI64FMTD " KB / " UI64FMTD " packets, out " UI64FMTD " KB / " UI64FMTD " packets, busy " UI64FMTD " ms",
+                        itr->port, itr->index, itr->sockets, itr->load / 10000.0f, itr->bytesReceived / 1024, itr->packetsReceived,
+                        itr->bytesSent / 1024, itr->packetsSent, itr->busyTime / 1000);
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleServerNetLatencyCommand(char* args)
+{
+    MaNGOS::LatencyHistogram::Snapshot latency;
+
+    if (*args)
+    {
+        Player* target;
+        if (!ExtractPlayerTarget(&args, &target))
+            return false;
+
+        MaNGOS::LatencyHistogram const* histogram = target->GetSession()->GetSendLatency();
+        if (!histogram)
+        {
+            SendSysMessage("Player has no connection.");
+            SetSentErrorMessage(true);
+            return false;
+        }
+
+        histogram->AddTo(latency);
+        PSendSysMessage("Send latency of %s:", GetNameLink(target).c_str());
+    }
+    else
+    {
+        MaNGOS::NetworkStatistics::GetSendLatency(latency);
+        SendSysMessage("Send latency of all network threads:");
+    }
+
+    PSendSysMessage("Packets " UI64FMTD ", average " UI64FMTD " us, max " UI64FMTD " us",
+                    latency.samples, latency.GetAverageLatency(), latency.max);
+
+    if (!latency.samples)
+        return true;
+
+    for (uint32 i = 0; i < MaNGOS::LatencyHistogram::BucketCount; ++i)
+    {
+        if (i + 1 < MaNGOS::LatencyHistogram::BucketCount)
+            PSendSysMessage("  <= " UI64FMTD " us: " UI64FMTD " (%.1f%%)", MaNGOS::LatencyHistogram::GetBucketLimit(i),
+                            latency.buckets[i], latency.buckets[i] * 100.0f / latency.samples);
+        else
+            PSendSysMessage("  > " UI64FMTD " us: " UI64FMTD " (%.1f%%)", MaNGOS::LatencyHistogram::GetBucketLimit(i - 1),
+                            latency.buckets[i], latency.buckets[i] * 100.0f / latency.samples);
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleServerRecvQueuesCommand(char* args)
+{
+    uint32 count;
+    if (!ExtractOptUInt32(&args, count, 10))
+        return false;
+
+    std::vector<WorldSession*> sessions;
+    uint32 queued = 0;
+    uint32 throttled = 0;
+    for (auto& itr : sWorld.GetSessions())
+    {
+        sessions.push_back(itr.second);
+        queued += itr.second->GetRecvQueueSize();
+        throttled += itr.second->GetRecvThrottleCount();
+    }
+
+    PSendSysMessage("Sessions: " SIZEFMTD ", queued packets: %u, read throttles: %u", sessions.size(), queued, throttled);
+
+    std::sort(sessions.begin(), sessions.end(), [](WorldSession const* a, WorldSession const* b)
+    {
+        return a->GetRecvQueuePeak() > b->GetRecvQueuePeak();
+    });
+
+    if (sessions.size() > count)
+        sessions.resize(count);
+
+    for (WorldSession const* session : sessions)
+    {
+        Player const* player = session->GetPlayer();
+        PSendSysMessage("Account %u (%s): depth %u/%u, peak %u, throttles %u", session->GetAccountId(),
+                        player ? player->GetName() : "no character", session->GetRecvQueueSize(), session->GetRecvQueueCapacity(),
+                        session->GetRecvQueuePeak(), session->GetRecvThrottleCount());
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleServerAuraPoolCommand(char* /*args*/)
+{
+    AuraPoolStatistics stats;
+    AuraPool::GetStatistics(stats);
+
+    const uint64 requests = stats.hits + stats.misses;
+    PSendSysMessage("Spell auras: " UI64FMTD " pooled allocations, hit rate %.1f%%, " UI64FMTD " released to the heap, " UI64FMTD " unpooled",
+                    requests, requests ? stats.hits * 100.0f / requests : 0.0f, stats.released, stats.unpooled);
+    return true;
+}
+
+bool ChatHandler::HandleServerPacketPoolCommand(char* /*args*/)
+{
+    MaNGOS::ByteBufferPool::Snapshot pool;
+    MaNGOS::ByteBufferPool::GetSnapshot(pool);
+
+    uint64 hits = 0;
+    uint64 misses = 0;
+    uint64 retainedBytes = 0;
+    for (MaNGOS::ByteBufferPool::ClassSnapshot const& sizeClass : pool.classes)
+    {
+        hits += sizeClass.hits;
+        misses += sizeClass.misses;
+        retainedBytes += sizeClass.retained * sizeClass.size;
+    }
+
+    const uint64 requests = hits + misses;
+    PSendSysMessage("Packet buffers: " UI64FMTD " pooled requests, hit rate %.1f%%, " UI64FMTD " unpooled, at least " UI64FMTD " KB retained (" UI64FMTD " KB shared)",
+                    requests, requests ? hits * 100.0f / requests : 0.0f, pool.unpooled, retainedBytes / 1024, pool.sharedBytes / 1024);
+
+    for (MaNGOS::ByteBufferPool::ClassSnapshot const& sizeClass : pool.classes)
+    {
+        const uint64 classRequests = sizeClass.hits + sizeClass.misses;
+        if (!classRequests && !sizeClass.released)
+            continue;
+
+        PSendSysMessage("  " SIZEFMTD " bytes: hits " UI64FMTD " (%.1f%%), misses " UI64FMTD ", released " UI64FMTD ", discarded " UI64FMTD ", retained " UI64FMTD,
+                        sizeClass.size, sizeClass.hits, classRequests ? sizeClass.hits * 100.0f / classRequests : 0.0f,
+                        sizeClass.misses, sizeClass.released, sizeClass.discarded, sizeClass.retained);
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleServerSaveStatsCommand(char* /*args*/)
+{
+    PlayerSaveStatistics const& saves = Player::GetSaveStatistics();
+    const uint64 saveCount = saves.saves;
+    PSendSysMessage("Character saves: " UI64FMTD ", average %.1f us in SaveToDB", saveCount,
+                    saveCount ? double(saves.buildTime) / saveCount : 0.0);
+
+    SqlTransactionStatistics const& transactions = saves.transactions;
+    uint64 count = transactions.transactions;
+    if (count)
+        PSendSysMessage("  executed: " UI64FMTD ", average %.1f statements in %.1f round trips, %.1f us in database",
+                        count, double(transactions.statements) / count, double(transactions.roundTrips) / count,
+                        double(transactions.executeTime) / count);
+
+    SqlTransactionStatistics const& all = CharacterDatabase.GetTransactionStatistics();
+    count = all.transactions;
+    PSendSysMessage("Character database transactions: " UI64FMTD ", average %.1f statements in %.1f round trips, %.1f us (up to %u rows per insert)",
+                    count, count ? double(all.statements) / count : 0.0, count ? double(all.roundTrips) / count : 0.0,
+                    count ? double(all.executeTime) / count : 0.0, CharacterDatabase.GetMaxBatchRows());
+    return true;
+}
+
+bool ChatHandler::HandleServerPreloadStatsCommand(char* /*args*/)
+{
+    GridPreloadStatistics const& stats = GridPreloader::GetStatistics();
+    const uint64 loaded = stats.loaded;
+    const uint64 misses = stats.misses;
+
+    PSendSysMessage("Grid preloader: %u threads, " UI64FMTD " tiles requested, " UI64FMTD " read, average %.1f us per tile",
+                    sMapMgr.GetGridPreloader().GetThreadCount(), uint64(stats.requested), loaded,
+                    loaded ? double(stats.loadTime) / loaded : 0.0);
+    PSendSysMessage("Grid loads: " UI64FMTD " found their tile preloaded, " UI64FMTD " read it in the map update (average %.1f us), " UI64FMTD " preloaded tiles wasted",
+                    uint64(stats.hits), misses, misses ? double(stats.syncLoadTime) / misses : 0.0, uint64(stats.wasted));
+    return true;
+}
+
+bool ChatHandler::HandleServerLosCacheStatsCommand(char* /*args*/)
+{
+    LineOfSightCacheStatistics const& stats = LineOfSightCache::GetGlobalStatistics();
+    PSendSysMessage("Line of sight cache, all maps: " UI64FMTD " hits, " UI64FMTD " only dynamic objects checked, " UI64FMTD " misses, " UI64FMTD " dynamic object changes",
+                    uint64(stats.hits), uint64(stats.staticHits), uint64(stats.misses), uint64(stats.invalidations));
+
+    if (m_session && m_session->GetPlayer()->IsInWorld())
+    {
+        Map* map = m_session->GetPlayer()->GetMap();
+        LineOfSightCacheStatistics const& mapStats = map->GetLineOfSightCache().GetStatistics();
+        const uint64 lookups = mapStats.hits + mapStats.staticHits + mapStats.misses;
+        PSendSysMessage("Line of sight cache, map %u instance %u: " UI64FMTD " hits, " UI64FMTD " only dynamic objects checked, " UI64FMTD " misses (%.1f%% saved), " UI64FMTD " dynamic object changes",
+                        map->GetId(), map->GetInstanceId(), uint64(mapStats.hits), uint64(mapStats.staticHits), uint64(mapStats.misses),
+                        lookups ? 100.0 * (lookups - mapStats.misses) / lookups : 0.0, uint64(mapStats.invalidations));
+    }
+    return true;
+}
+
+bool ChatHandler::HandleServerProcStatsCommand(char* /*args*/)
+{
+    ProcHolderIndexStatistics stats;
+    Unit::GetProcHolderIndexStatistics(stats);
+
+    const uint64 holders = stats.visited + stats.skipped;
+    PSendSysMessage("Proc checks: " UI64FMTD " events, " UI64FMTD " of " UI64FMTD " aura holders visited (%.1f%% skipped by the proc index)",
+                    stats.calls, stats.visited, holders, holders ? stats.skipped * 100.0f / holders : 0.0f);
+    return true;
+}
+
+bool ChatHandler::HandleServerProcBenchmarkCommand(char* args)
+{
+    uint32 events;
+    if (!ExtractOptUInt32(&args, events, 100000))
+        return false;
+
+    Unit* target = getSelectedUnit();
+    if (!target)
+    {
+        SendSysMessage(LANG_SELECT_CHAR_OR_CREATURE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    // proc flags of the events a fight passes to ProcDamageAndSpellFor, for the attacker and the victim side
+    static const uint32 procEvents[] =
+    {
+        PROC_FLAG_SUCCESSFUL_MELEE_HIT,
+        PROC_FLAG_TAKEN_MELEE_HIT | PROC_FLAG_TAKEN_ANY_DAMAGE,
+        PROC_FLAG_SUCCESSFUL_OFFHAND_HIT,
+        PROC_FLAG_SUCCESSFUL_MELEE_SPELL_HIT,
+        PROC_FLAG_TAKEN_MELEE_SPELL_HIT | PROC_FLAG_TAKEN_ANY_DAMAGE,
+        PROC_FLAG_SUCCESSFUL_RANGED_HIT,
+        PROC_FLAG_TAKEN_RANGED_HIT | PROC_FLAG_TAKEN_ANY_DAMAGE,
+        PROC_FLAG_DONE_SPELL_MAGIC_DMG_CLASS_NEG,
+        PROC_FLAG_TAKEN_SPELL_MAGIC_DMG_CLASS_NEG | PROC_FLAG_TAKEN_ANY_DAMAGE,
+        PROC_FLAG_DONE_SPELL_MAGIC_DMG_CLASS_POS,
+        PROC_FLAG_TAKEN_SPELL_MAGIC_DMG_CLASS_POS,
+        PROC_FLAG_ON_DO_PERIODIC,
+        PROC_FLAG_ON_TAKE_PERIODIC | PROC_FLAG_TAKEN_ANY_DAMAGE,
+    };
+    const uint32 procEventCount = sizeof(procEvents) / sizeof(procEvents[0]);
+
+    // the walk over all holders first, then the proc index, both on the same events
+    uint64 candidates[2] = { 0, 0 };
+    uint64 time[2];
+    for (uint32 useIndex = 0; useIndex < 2; ++useIndex)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32 i = 0; i < events; ++i)
+            candidates[useIndex] += target->CountProcCandidates(procEvents[i % procEventCount], useIndex != 0);
+        time[useIndex] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    PSendSysMessage("Proc benchmark: %u events on %s with " SIZEFMTD " aura holders, " UI64FMTD " proc candidates",
+                    events, target->GetName(), target->GetSpellAuraHolderMap().size(), candidates[1]);
+    PSendSysMessage("All holders: %.1f ns per event, proc index: %.1f ns per event",
+                    events ? double(time[0]) / events : 0.0, events ? double(time[1]) / events : 0.0);
+
+    if (candidates[0] != candidates[1])
+        PSendSysMessage("Candidate mismatch: " UI64FMTD " found by walking all holders", candidates[0]);
+
+    return true;
+}
+
+bool ChatHandler::HandleServerPathStatsCommand(char* /*args*/)
+{
+    PathFindStatistics const& stats = PathFinder::GetStatistics();
+    const uint64 built = stats.built;
+    const uint64 searched = stats.cacheHits + stats.cacheMisses;
+
+    PSendSysMessage("Path finder: " UI64FMTD " paths asked for, " UI64FMTD " built on the navmesh, average %.1f polygons and %.1f us per path",
+                    uint64(stats.calls), built, built ? double(stats.polys) / built : 0.0, built ? double(stats.buildTime) / built : 0.0);
+    PSendSysMessage("Path cache: " UI64FMTD " hits, " UI64FMTD " misses (%.1f%% saved), " UI64FMTD " corridor ends repaired",
+                    uint64(stats.cacheHits), uint64(stats.cacheMisses), searched ? 100.0 * stats.cacheHits / searched : 0.0, uint64(stats.repairs));
+
+    PathFinderStatistics const& threadStats = PathFinderService::GetStatistics();
+    const uint64 threadBuilt = threadStats.built;
+    PSendSysMessage("Path finder threads: %u, " UI64FMTD " paths queued, " UI64FMTD " built, " UI64FMTD " dropped, average wait %.1f us",
+                    sMapMgr.GetPathFinderService().GetThreadCount(), uint64(threadStats.requested), threadBuilt, uint64(threadStats.dropped),
+                    threadBuilt ? double(threadStats.waitTime) / threadBuilt : 0.0);
+    return true;
+}
+
 bool ChatHandler::HandleCastCommand(char* args)
 {
     if (!*args)
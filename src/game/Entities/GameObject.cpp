@@ -1838,7 +1838,7 @@ void GameObject::UpdateCollisionState() const
     if (!m_model || !IsInWorld())
         return;
 
-    m_model->enable(IsCollisionEnabled() ? true : false);
+    GetMap()->EnableGameObjectModel(*m_model, IsCollisionEnabled());
 }
 
 void GameObject::UpdateModel()
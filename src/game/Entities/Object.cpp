@@ -112,12 +112,12 @@ void Object::SendForcedObjectUpdate()
     BuildUpdateData(update_players);
     RemoveFromClientUpdateList();
 
-    WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
+    WorldPacket packet;
     for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
     {
         iter->second.BuildPacket(packet);
-        iter->first->GetSession()->SendPacket(packet);
-        packet.clear();                                     // clean the string
+        iter->first->GetSession()->SendPacket(std::move(packet));
+        packet.clear();                                     // storage was handed to the socket, reset positions
     }
 }
 
@@ -192,7 +192,7 @@ void Object::SendCreateUpdateToPlayer(Player* player) const
 
     BuildCreateUpdateBlockForPlayer(&upd, player);
     upd.BuildPacket(packet);
-    player->GetSession()->SendPacket(packet);
+    player->GetSession()->SendPacket(std::move(packet));
 }
 
 void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const
@@ -211,6 +211,52 @@ void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) c
     data->AddUpdateBlock(buf);
 }
 
+// values update block of an object as built for the first receiver with this update mask
+struct SharedValuesUpdateBlock
+{
+    SharedValuesUpdateBlock() : block(500) {}
+
+    UpdateMask updateMask;
+    ByteBuffer block;
+    std::vector<std::pair<uint16, size_t> > viewerFields;
+};
+
+bool Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, SharedValuesUpdateBlocks& sharedBlocks) const
+{
+    UpdateMask updateMask;
+    updateMask.SetCount(m_valuesCount);
+
+    _SetUpdateBits(&updateMask, target);
+
+    bool isActivateToQuest = false;
+    bool isPerCasterAuraState = false;
+    PrepareValuesUpdate(UPDATETYPE_VALUES, &updateMask, target, isActivateToQuest, isPerCasterAuraState);
+
+    for (SharedValuesUpdateBlocks::const_iterator itr = sharedBlocks.begin(); itr != sharedBlocks.end(); ++itr)
+    {
+        if (!(itr->updateMask == updateMask))
+            continue;
+
+        // same fields as an already built block, only the values depending on the receiver are computed again
+        size_t pos = data->AddUpdateBlock(itr->block);
+        for (ViewerFieldList::const_iterator field = itr->viewerFields.begin(); field != itr->viewerFields.end(); ++field)
+            data->SetBlockValue(pos + field->second, GetViewerFieldValue(field->first, target, isActivateToQuest, isPerCasterAuraState));
+
+        return true;
+    }
+
+    sharedBlocks.push_back(SharedValuesUpdateBlock());
+    SharedValuesUpdateBlock& shared = sharedBlocks.back();
+
+    shared.updateMask = updateMask;
+    shared.block << uint8(UPDATETYPE_VALUES);
+    shared.block << GetPackGUID();
+    WriteValuesUpdate(&shared.block, &updateMask, target, isActivateToQuest, isPerCasterAuraState, &shared.viewerFields);
+
+    data->AddUpdateBlock(shared.block);
+    return false;
+}
+
 void Object::BuildOutOfRangeUpdateBlock(UpdateData* data) const
 {
     data->AddOutOfRangeGUID(GetObjectGuid());
@@ -350,15 +396,21 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
     if (!target)
         return;
 
-    bool IsActivateToQuest = false;
-    bool IsPerCasterAuraState = false;
+    bool isActivateToQuest = false;
+    bool isPerCasterAuraState = false;
 
+    PrepareValuesUpdate(updatetype, updateMask, target, isActivateToQuest, isPerCasterAuraState);
+    WriteValuesUpdate(data, updateMask, target, isActivateToQuest, isPerCasterAuraState, nullptr);
+}
+
+void Object::PrepareValuesUpdate(uint8 updatetype, UpdateMask* updateMask, Player* target, bool& isActivateToQuest, bool& isPerCasterAuraState) const
+{
     if (updatetype == UPDATETYPE_CREATE_OBJECT || updatetype == UPDATETYPE_CREATE_OBJECT2)
     {
         if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsTransport())
         {
             if (((GameObject*)this)->ActivateToQuest(target) || target->isGameMaster())
-                IsActivateToQuest = true;
+                isActivateToQuest = true;
 
             updateMask->SetBit(GAMEOBJECT_DYN_FLAGS);
         }
@@ -366,7 +418,7 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
         {
             if (((Unit*)this)->HasAuraState(AURA_STATE_CONFLAGRATE))
             {
-                IsPerCasterAuraState = true;
+                isPerCasterAuraState = true;
                 updateMask->SetBit(UNIT_FIELD_AURASTATE);
             }
         }
@@ -376,7 +428,7 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
         if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsTransport())
         {
             if (((GameObject*)this)->ActivateToQuest(target) || target->isGameMaster())
-                IsActivateToQuest = true;
+                isActivateToQuest = true;
 
             updateMask->SetBit(GAMEOBJECT_DYN_FLAGS);
             updateMask->SetBit(GAMEOBJECT_ANIMPROGRESS);
@@ -385,12 +437,15 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
         {
             if (((Unit*)this)->HasAuraState(AURA_STATE_CONFLAGRATE))
             {
-                IsPerCasterAuraState = true;
+                isPerCasterAuraState = true;
                 updateMask->SetBit(UNIT_FIELD_AURASTATE);
             }
         }
     }
+}
 
+void Object::WriteValuesUpdate(ByteBuffer* data, UpdateMask* updateMask, Player* target, bool isActivateToQuest, bool isPerCasterAuraState, ViewerFieldList* viewerFields) const
+{
     MANGOS_ASSERT(updateMask && updateMask->GetCount() == m_valuesCount);
 
     *data << (uint8)updateMask->GetBlockCount();
@@ -403,64 +458,12 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
         {
             if (updateMask->GetBit(index))
             {
-                if (index == UNIT_NPC_FLAGS)
+                if (index == UNIT_NPC_FLAGS || index == UNIT_FIELD_AURASTATE || index == UNIT_FIELD_FLAGS || index == UNIT_DYNAMIC_FLAGS)
                 {
-                    uint32 appendValue = m_uint32Values[index];
-
-                    if (GetTypeId() == TYPEID_UNIT)
-                    {
-                        if (appendValue & UNIT_NPC_FLAG_TRAINER)
-                        {
-                            if (!((Creature*)this)->IsTrainerOf(target, false))
-                                appendValue &= ~(UNIT_NPC_FLAG_TRAINER | UNIT_NPC_FLAG_TRAINER_CLASS | UNIT_NPC_FLAG_TRAINER_PROFESSION);
-                        }
+                    if (viewerFields)
+                        viewerFields->push_back(ViewerFieldList::value_type(index, data->wpos()));
 
-                        if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
-                        {
-                            if (target->getClass() != CLASS_HUNTER)
-                                appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
-                        }
-                        
-                        if (appendValue & UNIT_NPC_FLAG_FLIGHTMASTER)
-                        {
-                            QuestRelationsMapBounds bounds = sObjectMgr.GetCreatureQuestRelationsMapBounds(((Creature*)this)->GetEntry());
-                            for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-                            {
-                                Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
-                                if (target->CanSeeStartQuest(pQuest))
-                                {
-                                    appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
-                                    break;
-                                }
-                            }
-
-                            bounds = sObjectMgr.GetCreatureQuestInvolvedRelationsMapBounds(((Creature*)this)->GetEntry());
-                            for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-                            {
-                                Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
-                                if (target->CanRewardQuest(pQuest, false))
-                                {
-                                    appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-
-                    *data << uint32(appendValue);
-                }
-                else if (index == UNIT_FIELD_AURASTATE)
-                {
-                    if (IsPerCasterAuraState)
-                    {
-                        // IsPerCasterAuraState set if related pet caster aura state set already
-                        if (((Unit*)this)->HasAuraStateForCaster(AURA_STATE_CONFLAGRATE, target->GetObjectGuid()))
-                            *data << m_uint32Values[index];
-                        else
-                            *data << (m_uint32Values[index] & ~(1 << (AURA_STATE_CONFLAGRATE - 1)));
-                    }
-                    else
-                        *data << m_uint32Values[index];
+                    *data << GetViewerFieldValue(index, target, isActivateToQuest, isPerCasterAuraState);
                 }
                 // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
                 else if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
@@ -477,76 +480,6 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
                 {
                     *data << uint32(m_floatValues[index]);
                 }
-
-                // Gamemasters should be always able to select units - remove not selectable flag
-                else if (index == UNIT_FIELD_FLAGS && target->isGameMaster())
-                {
-                    *data << (m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE);
-                }
-                // Hide lootable animation for unallowed players
-                // Handle tapped flag
-                else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_UNIT)
-                {
-                    Creature* creature = (Creature*)this;
-                    uint32 dynflagsValue = m_uint32Values[index];
-                    bool setTapFlags = false;
-
-                    if (creature->isAlive())
-                    {
-                        // creature is alive so, not lootable
-                        dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_LOOTABLE;
-
-                        if (creature->isInCombat())
-                        {
-                            // as creature is in combat we have to manage tap flags
-                            setTapFlags = true;
-                        }
-                        else
-                        {
-                            // creature is not in combat so its not tapped
-                            dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_TAPPED;
-                            //sLog.outString(">> %s is not in combat so not tapped by %s", this->GetObjectGuid().GetString().c_str(), target->GetObjectGuid().GetString().c_str());
-                        }
-                    }
-                    else
-                    {
-                        // check loot flag
-                        if (creature->loot && creature->loot->CanLoot(target))
-                        {
-                            // creature is dead and this player can loot it
-                            dynflagsValue = dynflagsValue | UNIT_DYNFLAG_LOOTABLE;
-                            //sLog.outString(">> %s is lootable for %s", this->GetObjectGuid().GetString().c_str(), target->GetObjectGuid().GetString().c_str());
-                        }
-                        else
-                        {
-                            // creature is dead but this player cannot loot it
-                            dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_LOOTABLE;
-                            //sLog.outString(">> %s is not lootable for %s", this->GetObjectGuid().GetString().c_str(), target->GetObjectGuid().GetString().c_str());
-                        }
-
-                        // as creature is died we have to manage tap flags
-                        setTapFlags = true;
-                    }
-
-                    // check tap flags
-                    if (setTapFlags)
-                    {
-                        if (creature->IsTappedBy(target))
-                        {
-                            // creature is in combat or died and tapped by this player
-                            dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_TAPPED;
-                            //sLog.outString(">> %s is tapped by %s", this->GetObjectGuid().GetString().c_str(), target->GetObjectGuid().GetString().c_str());
-                        }
-                        else
-                        {
-                            // creature is in combat or died but not tapped by this player
-                            dynflagsValue = dynflagsValue | UNIT_DYNFLAG_TAPPED;
-                            //sLog.outString(">> %s is not tapped by %s", this->GetObjectGuid().GetString().c_str(), target->GetObjectGuid().GetString().c_str());
-                        }
-                    }
-
-                    *data << dynflagsValue;
-                }
                 else                                        // Unhandled index, just send
                 {
                     // send in current format (float as float, uint32 as uint32)
@@ -564,38 +497,10 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
                 // send in current format (float as float, uint32 as uint32)
                 if (index == GAMEOBJECT_DYN_FLAGS)
                 {
-                    // GAMEOBJECT_TYPE_DUNGEON_DIFFICULTY can have lo flag = 2
-                    //      most likely related to "can enter map" and then should be 0 if can not enter
+                    if (viewerFields)
+                        viewerFields->push_back(ViewerFieldList::value_type(index, data->wpos()));
 
-                    if (IsActivateToQuest)
-                    {
-                        GameObject const* gameObject = static_cast<GameObject const*>(this);
-                        switch (((GameObject*)this)->GetGoType())
-                        {
-                            case GAMEOBJECT_TYPE_QUESTGIVER:
-                                *data << uint16(GO_DYNFLAG_LO_ACTIVATE);
-                                *data << uint16(0);
-                                break;
-                            case GAMEOBJECT_TYPE_CHEST:
-                                if (gameObject->getLootState() == GO_READY || gameObject->getLootState() == GO_ACTIVATED)
-                                    *data << uint16(GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE);
-                                else
-                                    *data << uint16(0);
-                                *data << uint16(0);
-                                break;
-                            case GAMEOBJECT_TYPE_GENERIC:
-                            case GAMEOBJECT_TYPE_SPELL_FOCUS:
-                            case GAMEOBJECT_TYPE_GOOBER:
-                                *data << uint16(GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE);
-                                *data << uint16(0);
-                                break;
-                            default:
-                                *data << uint32(0);         // unknown, not happen.
-                                break;
-                        }
-                    }
-                    else
-                        *data << uint32(0);                 // disable quest object
+                    *data << GetViewerFieldValue(index, target, isActivateToQuest, isPerCasterAuraState);
                 }
                 else
                     *data << m_uint32Values[index];         // other cases
@@ -615,6 +520,170 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
     }
 }
 
+uint32 Object::GetViewerFieldValue(uint16 index, Player* target, bool isActivateToQuest, bool isPerCasterAuraState) const
+{
+    if (isType(TYPEMASK_UNIT))
+    {
+        switch (index)
+        {
+            case UNIT_NPC_FLAGS:
+            {
+                uint32 appendValue = m_uint32Values[index];
+
+                if (GetTypeId() == TYPEID_UNIT)
+                {
+                    if (appendValue & UNIT_NPC_FLAG_TRAINER)
+                    {
+                        if (!((Creature*)this)->IsTrainerOf(target, false))
+                            appendValue &= ~(UNIT_NPC_FLAG_TRAINER | UNIT_NPC_FLAG_TRAINER_CLASS | UNIT_NPC_FLAG_TRAINER_PROFESSION);
+                    }
+
+                    if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
+                    {
+                        if (target->getClass() != CLASS_HUNTER)
+                            appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
+                    }
+
+                    if (appendValue & UNIT_NPC_FLAG_FLIGHTMASTER)
+                    {
+                        QuestRelationsMapBounds bounds = sObjectMgr.GetCreatureQuestRelationsMapBounds(((Creature*)this)->GetEntry());
+                        for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+                        {
+                            Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
+                            if (target->CanSeeStartQuest(pQuest))
+                            {
+                                appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
+                                break;
+                            }
+                        }
+
+                        bounds = sObjectMgr.GetCreatureQuestInvolvedRelationsMapBounds(((Creature*)this)->GetEntry());
+                        for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+                        {
+                            Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
+                            if (target->CanRewardQuest(pQuest, false))
+                            {
+                                appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                return appendValue;
+            }
+            case UNIT_FIELD_AURASTATE:
+            {
+                // IsPerCasterAuraState set if related pet caster aura state set already
+                if (isPerCasterAuraState && !((Unit*)this)->HasAuraStateForCaster(AURA_STATE_CONFLAGRATE, target->GetObjectGuid()))
+                    return m_uint32Values[index] & ~(1 << (AURA_STATE_CONFLAGRATE - 1));
+
+                return m_uint32Values[index];
+            }
+            case UNIT_FIELD_FLAGS:
+            {
+                // Gamemasters should be always able to select units - remove not selectable flag
+                if (target->isGameMaster())
+                    return m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE;
+
+                return m_uint32Values[index];
+            }
+            case UNIT_DYNAMIC_FLAGS:
+            {
+                if (GetTypeId() != TYPEID_UNIT)
+                    return m_uint32Values[index];
+
+                // Hide lootable animation for unallowed players
+                // Handle tapped flag
+                Creature* creature = (Creature*)this;
+                uint32 dynflagsValue = m_uint32Values[index];
+                bool setTapFlags = false;
+
+                if (creature->isAlive())
+                {
+                    // creature is alive so, not lootable
+                    dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_LOOTABLE;
+
+                    if (creature->isInCombat())
+                    {
+                        // as creature is in combat we have to manage tap flags
+                        setTapFlags = true;
+                    }
+                    else
+                    {
+                        // creature is not in combat so its not tapped
+                        dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_TAPPED;
+                    }
+                }
+                else
+                {
+                    // check loot flag
+                    if (creature->loot && creature->loot->CanLoot(target))
+                    {
+                        // creature is dead and this player can loot it
+                        dynflagsValue = dynflagsValue | UNIT_DYNFLAG_LOOTABLE;
+                    }
+                    else
+                    {
+                        // creature is dead but this player cannot loot it
+                        dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_LOOTABLE;
+                    }
+
+                    // as creature is died we have to manage tap flags
+                    setTapFlags = true;
+                }
+
+                // check tap flags
+                if (setTapFlags)
+                {
+                    if (creature->IsTappedBy(target))
+                    {
+                        // creature is in combat or died and tapped by this player
+                        dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_TAPPED;
+                    }
+                    else
+                    {
+                        // creature is in combat or died but not tapped by this player
+                        dynflagsValue = dynflagsValue | UNIT_DYNFLAG_TAPPED;
+                    }
+                }
+
+                return dynflagsValue;
+            }
+            default:
+                break;
+        }
+    }
+    else if (isType(TYPEMASK_GAMEOBJECT) && index == GAMEOBJECT_DYN_FLAGS)
+    {
+        // GAMEOBJECT_TYPE_DUNGEON_DIFFICULTY can have lo flag = 2
+        //      most likely related to "can enter map" and then should be 0 if can not enter
+
+        if (!isActivateToQuest)
+            return 0;                                       // disable quest object
+
+        // only the lo part is used, the hi part is always 0
+        GameObject const* gameObject = static_cast<GameObject const*>(this);
+        switch (gameObject->GetGoType())
+        {
+            case GAMEOBJECT_TYPE_QUESTGIVER:
+                return GO_DYNFLAG_LO_ACTIVATE;
+            case GAMEOBJECT_TYPE_CHEST:
+                if (gameObject->getLootState() == GO_READY || gameObject->getLootState() == GO_ACTIVATED)
+                    return GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE;
+                return 0;
+            case GAMEOBJECT_TYPE_GENERIC:
+            case GAMEOBJECT_TYPE_SPELL_FOCUS:
+            case GAMEOBJECT_TYPE_GOOBER:
+                return GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE;
+            default:
+                return 0;                                   // unknown, not happen.
+        }
+    }
+
+    return m_uint32Values[index];
+}
+
 void Object::ClearUpdateMask(bool remove)
 {
     if (m_uint32Values)
@@ -918,6 +987,20 @@ void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_play
     BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
 }
 
+bool Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, SharedValuesUpdateBlocks& sharedBlocks) const
+{
+    UpdateDataMapType::iterator iter = update_players.find(pl);
+
+    if (iter == update_players.end())
+    {
+        std::pair<UpdateDataMapType::iterator, bool> p = update_players.insert(UpdateDataMapType::value_type(pl, UpdateData()));
+        MANGOS_ASSERT(p.second);
+        iter = p.first;
+    }
+
+    return BuildValuesUpdateBlockForPlayer(&iter->second, iter->first, sharedBlocks);
+}
+
 void Object::AddToClientUpdateList()
 {
     sLog.outError("Unexpected call of Object::AddToClientUpdateList for object (TypeId: %u Update fields: %u)", GetTypeId(), m_valuesCount);
@@ -987,6 +1070,8 @@ void WorldObject::Relocate(float x, float y, float z, float orientation)
 
     if (isType(TYPEMASK_PLAYER))
         this->ToCPlayer()->HandleRelocate(x, y, z, orientation);
+
+    UpdateGridPosition();
 }
 
 void WorldObject::Relocate(float x, float y, float z)
@@ -1000,6 +1085,16 @@ void WorldObject::Relocate(float x, float y, float z)
 
     if (isType(TYPEMASK_PLAYER))
         this->ToCPlayer()->HandleRelocate(x, y, z, GetOrientation());
+
+    UpdateGridPosition();
+}
+
+void WorldObject::UpdateGridPosition()
+{
+    if (GetTypeId() == TYPEID_UNIT)
+        ((Creature*)this)->GetGridRef().UpdatePosition();
+    else if (GetTypeId() == TYPEID_PLAYER)
+        ((Player*)this)->GetGridRef().UpdatePosition();
 }
 
 void WorldObject::SetOrientation(float orientation)
@@ -1356,14 +1451,14 @@ void WorldObject::GetRandomPoint(float x, float y, float z, float distance, floa
     UpdateGroundPositionZ(rand_x, rand_y, rand_z);          // update to LOS height if available
 }
 
-void WorldObject::UpdateGroundPositionZ(float x, float y, float& z) const
+void WorldObject::UpdateGroundPositionZ(float x, float y, float& z, float const* staticHeight /*= nullptr*/) const
 {
-    float new_z = GetMap()->GetHeight(x, y, z);
+    float new_z = GetMap()->GetHeight(x, y, z, staticHeight);
     if (new_z > INVALID_HEIGHT)
         z = new_z + 0.05f;                                  // just to be sure that we are not a few pixel under the surface
 }
 
-void WorldObject::UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap /*=nullptr*/) const
+void WorldObject::UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap /*=nullptr*/, float const* staticHeight /*= nullptr*/) const
 {
     if (!atMap)
         atMap = GetMap();
@@ -1379,8 +1474,8 @@ void WorldObject::UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap
                 bool canSwim = ((Creature const*)this)->CanSwim();
                 float ground_z = z;
                 float max_z = canSwim
-                              ? atMap->GetTerrain()->GetWaterOrGroundLevel(x, y, z, &ground_z, !((Unit const*)this)->HasAuraType(SPELL_AURA_WATER_WALK))
-                              : ((ground_z = atMap->GetHeight(x, y, z)));
+                              ? atMap->GetTerrain()->GetWaterOrGroundLevel(x, y, z, &ground_z, !((Unit const*)this)->HasAuraType(SPELL_AURA_WATER_WALK), staticHeight)
+                              : ((ground_z = atMap->GetHeight(x, y, z, staticHeight)));
                 if (max_z > INVALID_HEIGHT)
                 {
                     if (z > max_z)
@@ -1391,7 +1486,7 @@ void WorldObject::UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap
             }
             else
             {
-                float ground_z = atMap->GetHeight(x, y, z);
+                float ground_z = atMap->GetHeight(x, y, z, staticHeight);
                 if (z < ground_z)
                     z = ground_z;
             }
@@ -1403,7 +1498,7 @@ void WorldObject::UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap
             if (!((Player const*)this)->CanFly())
             {
                 float ground_z = z;
-                float max_z = atMap->GetTerrain()->GetWaterOrGroundLevel(x, y, z, &ground_z, !((Unit const*)this)->HasAuraType(SPELL_AURA_WATER_WALK));
+                float max_z = atMap->GetTerrain()->GetWaterOrGroundLevel(x, y, z, &ground_z, !((Unit const*)this)->HasAuraType(SPELL_AURA_WATER_WALK), staticHeight);
                 if (max_z > INVALID_HEIGHT)
                 {
                     if (z > max_z)
@@ -1414,7 +1509,7 @@ void WorldObject::UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap
             }
             else
             {
-                float ground_z = atMap->GetHeight(x, y, z);
+                float ground_z = atMap->GetHeight(x, y, z, staticHeight);
                 if (z < ground_z)
                     z = ground_z;
             }
@@ -1422,7 +1517,7 @@ void WorldObject::UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap
         }
         default:
         {
-            float ground_z = atMap->GetHeight(x, y, z);
+            float ground_z = atMap->GetHeight(x, y, z, staticHeight);
             if (ground_z > INVALID_HEIGHT)
                 z = ground_z;
             break;
@@ -1806,26 +1901,50 @@ void WorldObject::GetNearPoint(WorldObject const* searcher, float& x, float& y,
         first_los_conflict = true;                          // first point have LOS problems
     }
 
+    // the other candidates are rarely needed, but then usually many of them: their heights are found in one batch
+    // and the first candidate that fits is taken
+    std::vector<StaticHeightQuery> candidates;
+    auto findFittingCandidate = [&]() -> bool
+    {
+        if (candidates.empty())
+            return false;
+
+        GetMap()->GetTerrain()->GetHeightStatic(candidates.data(), candidates.size());
+
+        for (StaticHeightQuery const& candidate : candidates)
+        {
+            x = candidate.x;
+            y = candidate.y;
+            z = candidate.z;
+
+            if (searcher)
+                searcher->UpdateAllowedPositionZ(x, y, z, GetMap(), &candidate.height); // update to LOS height if available
+            else
+                UpdateGroundPositionZ(x, y, z, &candidate.height);
+
+            if (fabs(init_z - z) < dist && IsWithinLOS(x, y, z))
+                return true;
+        }
+        return false;
+    };
+
     // set first used pos in lists
     selector.InitializeAngle();
 
     float angle;                                            // candidate of angle for free pos
 
-    // select in positions after current nodes (selection one by one)
+    // select in positions after current nodes
     while (selector.NextAngle(angle))                       // angle for free pos
     {
-        GetNearPoint2D(x, y, distance2d, absAngle + angle);
-        z = GetPositionZ();
-
-        if (searcher)
-            searcher->UpdateAllowedPositionZ(x, y, z, GetMap()); // update to LOS height if available
-        else
-            UpdateGroundPositionZ(x, y, z);
-
-        if (fabs(init_z - z) < dist && IsWithinLOS(x, y, z))
-            return;
+        StaticHeightQuery candidate;
+        GetNearPoint2D(candidate.x, candidate.y, distance2d, absAngle + angle);
+        candidate.z = GetPositionZ();
+        candidates.push_back(candidate);
     }
 
+    if (findFittingCandidate())
+        return;
+
     // BAD NEWS: not free pos (or used or have LOS problems)
     // Attempt find _used_ pos without LOS problem
     if (!first_los_conflict)
@@ -1842,22 +1961,20 @@ void WorldObject::GetNearPoint(WorldObject const* searcher, float& x, float& y,
 
     // set first used pos in lists
     selector.InitializeAngle();
+    candidates.clear();
 
-    // select in positions after current nodes (selection one by one)
+    // select in positions after current nodes
     while (selector.NextUsedAngle(angle))                   // angle for used pos but maybe without LOS problem
     {
-        GetNearPoint2D(x, y, distance2d, absAngle + angle);
-        z = GetPositionZ();
-
-        if (searcher)
-            searcher->UpdateAllowedPositionZ(x, y, z, GetMap()); // update to LOS height if available
-        else
-            UpdateGroundPositionZ(x, y, z);
-
-        if (fabs(init_z - z) < dist && IsWithinLOS(x, y, z))
-            return;
+        StaticHeightQuery candidate;
+        GetNearPoint2D(candidate.x, candidate.y, distance2d, absAngle + angle);
+        candidate.z = GetPositionZ();
+        candidates.push_back(candidate);
     }
 
+    if (findFittingCandidate())
+        return;
+
     // BAD BAD NEWS: all found pos (free and used) have LOS problem :(
     x = first_x;
     y = first_y;
@@ -1928,12 +2045,15 @@ struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
-    WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d) : i_updateDatas(d), i_object(obj)
+    SharedValuesUpdateBlocks i_sharedBlocks;                // the changed fields are serialized once per distinct update mask
+    uint32 i_blocksBuilt;
+    uint32 i_blocksShared;
+    WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d) : i_updateDatas(d), i_object(obj), i_blocksBuilt(0), i_blocksShared(0)
     {
         // send self fields changes in another way, otherwise
         // with new camera system when player's camera too far from player, camera wouldn't receive packets and changes from player
         if (i_object.isType(TYPEMASK_PLAYER))
-            i_object.BuildUpdateDataForPlayer((Player*)&i_object, i_updateDatas);
+            BuildUpdateDataFor((Player*)&i_object);
     }
 
     void Visit(CameraMapType& m)
@@ -1942,11 +2062,19 @@ struct WorldObjectChangeAccumulator
         {
             Player* owner = iter->getSource()->GetOwner();
             if (owner != &i_object && owner->HaveAtClient(&i_object))
-                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+                BuildUpdateDataFor(owner);
         }
     }
 
     template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+
+    void BuildUpdateDataFor(Player* player)
+    {
+        if (i_object.BuildUpdateDataForPlayer(player, i_updateDatas, i_sharedBlocks))
+            ++i_blocksShared;
+        else
+            ++i_blocksBuilt;
+    }
 };
 
 void WorldObject::BuildUpdateData(UpdateDataMapType& update_players)
@@ -1954,6 +2082,8 @@ void WorldObject::BuildUpdateData(UpdateDataMapType& update_players)
     WorldObjectChangeAccumulator notifier(*this, update_players);
     Cell::VisitWorldObjects(this, notifier, GetMap()->GetVisibilityDistance());
 
+    GetMap()->GetUpdateStatistics().AddValuesUpdateBlocks(notifier.i_blocksBuilt, notifier.i_blocksShared);
+
     ClearUpdateMask(false);
 }
 
@@ -84,6 +84,9 @@ struct SpellEntry;
 
 typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
 
+struct SharedValuesUpdateBlock;
+typedef std::vector<SharedValuesUpdateBlock> SharedValuesUpdateBlocks;
+
 // cooldown system
 typedef std::chrono::system_clock Clock;
 typedef std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds> TimePoint;
@@ -373,6 +376,8 @@ class Object
         void SendForcedObjectUpdate();
 
         void BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const;
+        // reuses a block already built for another receiver with the same update mask, returns true in that case
+        bool BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, SharedValuesUpdateBlocks& sharedBlocks) const;
         void BuildOutOfRangeUpdateBlock(UpdateData* data) const;
         void BuildMovementUpdateBlock(UpdateData* data, uint8 flags = 0) const;
 
@@ -578,6 +583,14 @@ class Object
         void BuildMovementUpdate(ByteBuffer* data, uint8 updateFlags) const;
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target) const;
         void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players) const;
+        bool BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, SharedValuesUpdateBlocks& sharedBlocks) const;
+
+        // field index and position of its value in the block, for the values depending on the receiver
+        typedef std::vector<std::pair<uint16, size_t> > ViewerFieldList;
+
+        void PrepareValuesUpdate(uint8 updatetype, UpdateMask* updateMask, Player* target, bool& isActivateToQuest, bool& isPerCasterAuraState) const;
+        void WriteValuesUpdate(ByteBuffer* data, UpdateMask* updateMask, Player* target, bool isActivateToQuest, bool isPerCasterAuraState, ViewerFieldList* viewerFields) const;
+        uint32 GetViewerFieldValue(uint16 index, Player* target, bool isActivateToQuest, bool isPerCasterAuraState) const;
 
         uint16 m_objectType;
 
@@ -653,6 +666,7 @@ class WorldObject : public Object
 
         void Relocate(float x, float y, float z, float orientation);
         void Relocate(float x, float y, float z);
+        void UpdateGridPosition();                          // keeps range searches of the grid in sync, see GridPositionIndex
 
         void SetOrientation(float orientation);
 
@@ -701,8 +715,9 @@ class WorldObject : public Object
         virtual float GetObjectBoundingRadius() const { return DEFAULT_WORLD_OBJECT_SIZE; }
 
         bool IsPositionValid() const;
-        void UpdateGroundPositionZ(float x, float y, float& z) const;
-        void UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap = nullptr) const;
+        // staticHeight: TerrainInfo::GetHeightStatic result for x, y, z if already known
+        void UpdateGroundPositionZ(float x, float y, float& z, float const* staticHeight = nullptr) const;
+        void UpdateAllowedPositionZ(float x, float y, float& z, Map* atMap = nullptr, float const* staticHeight = nullptr) const;
 
         void GetRandomPoint(float x, float y, float z, float distance, float& rand_x, float& rand_y, float& rand_z, float minDist = 0.0f, float const* ori = nullptr) const;
 
@@ -70,6 +70,7 @@
     #include "Config/Config.h"
 #endif
 
+#include <chrono>
 #include <cmath>
 
 #define ZONE_UPDATE_INTERVAL (1*IN_MILLISECONDS)
@@ -15944,6 +15945,13 @@ bool Player::_LoadHomeBind(QueryResult* result)
 /***                   SAVE SYSTEM                     ***/
 /*********************************************************/
 
+static PlayerSaveStatistics s_saveStatistics;
+
+PlayerSaveStatistics const& Player::GetSaveStatistics()
+{
+    return s_saveStatistics;
+}
+
 void Player::SaveToDB()
 {
     // we should assure this: ASSERT((m_nextSave != sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE)));
@@ -15963,7 +15971,10 @@ void Player::SaveToDB()
     DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     outDebugStatsValues();
 
-    CharacterDatabase.BeginTransaction();
+    const std::chrono::steady_clock::time_point saveStart = std::chrono::steady_clock::now();
+
+    // only own rows of the character are written here, so saves of different characters may run in parallel
+    CharacterDatabase.BeginTransaction(GetGUIDLow(), &s_saveStatistics.transactions);
 
     static SqlStatementID delChar ;
     static SqlStatementID insChar ;
@@ -16137,6 +16148,9 @@ void Player::SaveToDB()
 
     CharacterDatabase.CommitTransaction();
 
+    ++s_saveStatistics.saves;
+    s_saveStatistics.buildTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - saveStart).count();
+
     // check if stats should only be saved on logout
     // save stats can be out of transaction
     if (m_session->isLogingOut() || !sWorld.getConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT))
@@ -19231,7 +19245,7 @@ void Player::UpdateForQuestWorldObjects()
         }
     }
     udata.BuildPacket(packet);
-    GetSession()->SendPacket(packet);
+    GetSession()->SendPacket(std::move(packet));
 }
 
 void Player::SummonIfPossible(bool agree)
@@ -875,6 +875,16 @@ struct TradeStatusInfo
     uint8 Slot;
 };
 
+// counters of Player::SaveToDB, the database side is taken when the save transaction is executed
+struct PlayerSaveStatistics
+{
+    PlayerSaveStatistics() : saves(0), buildTime(0) {}
+
+    std::atomic<uint64> saves;
+    std::atomic<uint64> buildTime;                          // microseconds spent in SaveToDB
+    SqlTransactionStatistics transactions;
+};
+
 class TradeData
 {
     public:                                                 // constructors
@@ -1380,6 +1390,7 @@ class Player : public Unit
         /*********************************************************/
 
         void SaveToDB();
+        static PlayerSaveStatistics const& GetSaveStatistics();
         void SaveInventoryAndGoldToDB();                    // fast save function for item/money cheating preventing
         void SaveGoldToDB() const;
         static void SetUInt32ValueInArray(Tokens& data, uint16 index, uint32 value);
@@ -47,9 +47,11 @@
 #include "Movement/MoveSpline.h"
 #include "Entities/CreatureLinkingMgr.h"
 #include "Tools/Formulas.h"
+#include "ThreadCounters.h"
 
 #include <math.h>
 #include <array>
+#include <algorithm>
 
 float baseMoveSpeed[MAX_MOVE_TYPE] =
 {
@@ -206,6 +208,29 @@ static inline SpellPartialResistDistribution InitSpellPartialResistDistribution(
 
 static const SpellPartialResistDistribution SPELL_PARTIAL_RESIST_DISTRIBUTION = InitSpellPartialResistDistribution();
 
+namespace
+{
+    struct ProcIndexCounters
+    {
+        std::atomic<uint64> calls;
+        std::atomic<uint64> visited;
+        std::atomic<uint64> skipped;
+
+        ProcIndexCounters() : calls(0), visited(0), skipped(0) {}
+
+        void AddTo(ProcHolderIndexStatistics& statistics) const
+        {
+            statistics.calls += calls;
+            statistics.visited += visited;
+            statistics.skipped += skipped;
+        }
+    };
+
+    typedef MaNGOS::ThreadCounters<ProcIndexCounters, ProcHolderIndexStatistics> ProcIndexThreadCounters;
+
+    thread_local ProcIndexThreadCounters t_procIndexCounters;
+}
+
 ////////////////////////////////////////////////////////////
 // Methods of class MovementInfo
 
@@ -328,6 +353,7 @@ Unit::Unit() :
     // m_AurasCheck = 2000;
     // m_removeAuraTimer = 4;
     m_spellAuraHoldersUpdateIterator = m_spellAuraHolders.end();
+    m_procHolderIndexGeneration = sSpellMgr.GetSpellProcEventGeneration();
     m_AuraFlags = 0;
 
     m_Visibility = VISIBILITY_ON;
@@ -2079,9 +2105,9 @@ void Unit::CalculateDamageAbsorbAndResist(Unit* pCaster, SpellSchoolMask schoolM
         RemainingDamage -= currentAbsorb;
 
         // Reduce shield amount
-        mod->m_amount -= currentAbsorb;
+        (*i)->SetModifierAmount(mod->m_amount - currentAbsorb);
         if ((*i)->GetHolder()->DropAuraCharge())
-            mod->m_amount = 0;
+            (*i)->SetModifierAmount(0);
         // Need remove it later
         if (mod->m_amount <= 0)
             existExpired = true;
@@ -2137,7 +2163,7 @@ void Unit::CalculateDamageAbsorbAndResist(Unit* pCaster, SpellSchoolMask schoolM
             ApplyPowerMod(POWER_MANA, manaReduction, false);
         }
 
-        (*i)->GetModifier()->m_amount -= currentAbsorb;
+        (*i)->SetModifierAmount((*i)->GetModifier()->m_amount - currentAbsorb);
         if ((*i)->GetModifier()->m_amount <= 0)
         {
             RemoveAurasDueToSpell((*i)->GetId());
@@ -4020,50 +4046,67 @@ void Unit::DeMorph()
     SetDisplayId(GetNativeDisplayId());
 }
 
-int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+Unit::AuraModifierTotals const& Unit::GetAuraModifierTotals(AuraType auratype) const
 {
-    int32 modifier = 0;
+    AuraModifierTotals& totals = m_auraModifierTotals[auratype];
+    if (totals.valid)
+        return totals;
+
+    totals = AuraModifierTotals();
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
     for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        modifier += (*i)->GetModifier()->m_amount;
+    {
+        int32 amount = (*i)->GetModifier()->m_amount;
+        totals.total += amount;
+        totals.multiplier *= (100.0f + amount) / 100.0f;
+        if (amount > totals.maxPositive)
+            totals.maxPositive = amount;
+        if (amount < totals.maxNegative)
+            totals.maxNegative = amount;
+    }
 
-    return modifier;
+    totals.valid = true;
+    return totals;
 }
 
-float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+void Unit::InvalidateAuraModifierTotals(AuraType auratype)
 {
-    float multiplier = 1.0f;
+    AuraModifierTotalsMap::iterator itr = m_auraModifierTotals.find(auratype);
+    if (itr != m_auraModifierTotals.end())
+        itr->second.valid = false;
+}
 
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        multiplier *= (100.0f + (*i)->GetModifier()->m_amount) / 100.0f;
+int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+{
+    if (GetAurasByType(auratype).empty())
+        return 0;
 
-    return multiplier;
+    return GetAuraModifierTotals(auratype).total;
 }
 
-int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+float Unit::GetTotalAuraMultiplier(AuraType auratype) const
 {
-    int32 modifier = 0;
+    if (GetAurasByType(auratype).empty())
+        return 1.0f;
 
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetModifier()->m_amount > modifier)
-            modifier = (*i)->GetModifier()->m_amount;
+    return GetAuraModifierTotals(auratype).multiplier;
+}
 
-    return modifier;
+int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+{
+    if (GetAurasByType(auratype).empty())
+        return 0;
+
+    return GetAuraModifierTotals(auratype).maxPositive;
 }
 
 int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetModifier()->m_amount < modifier)
-            modifier = (*i)->GetModifier()->m_amount;
+    if (GetAurasByType(auratype).empty())
+        return 0;
 
-    return modifier;
+    return GetAuraModifierTotals(auratype).maxNegative;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
@@ -4254,7 +4297,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
                                     int32 remainingTicks = existing->GetAuraMaxTicks() - existing->GetAuraTicks();
                                     int32 remainingDamage = existing->GetModifier()->m_amount * remainingTicks;
 
-                                    aur->GetModifier()->m_amount += int32(remainingDamage / aur->GetAuraMaxTicks());
+                                    aur->SetModifierAmount(aur->GetModifier()->m_amount + int32(remainingDamage / aur->GetAuraMaxTicks()));
                                 }
                                 else
                                     DEBUG_LOG("Holder (spell %u) on target (lowguid: %u) doesn't have aura on effect index %u. skipping.", aurSpellInfo->Id, holder->GetTarget()->GetGUIDLow(), i);
@@ -4357,6 +4400,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
     if(m_spellUpdateHappening)
         holder->SetCreationDelayFlag();
     m_spellAuraHolders.insert(SpellAuraHolderMap::value_type(holder->GetId(), holder));
+    AddSpellAuraHolderToProcIndex(holder);
 
     for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
         if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
@@ -4376,7 +4420,10 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
 void Unit::AddAuraToModList(Aura* aura)
 {
     if (aura->GetModifier()->m_auraname < TOTAL_AURAS)
+    {
         m_modAuras[aura->GetModifier()->m_auraname].push_back(aura);
+        InvalidateAuraModifierTotals(aura->GetModifier()->m_auraname);
+    }
 }
 
 void Unit::RemoveRankAurasDueToSpell(uint32 spellId)
@@ -4864,6 +4911,7 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolder* holder, AuraRemoveMode mode)
         if (itr->second == holder)
         {
             m_spellAuraHolders.erase(itr);
+            RemoveSpellAuraHolderFromProcIndex(holder);
             break;
         }
     }
@@ -4915,6 +4963,7 @@ void Unit::RemoveAura(Aura* Aur, AuraRemoveMode mode)
     if (Aur->GetModifier()->m_auraname < TOTAL_AURAS)
     {
         m_modAuras[Aur->GetModifier()->m_auraname].remove(Aur);
+        InvalidateAuraModifierTotals(Aur->GetModifier()->m_auraname);
     }
 
     // Set remove mode
@@ -8950,6 +8999,8 @@ void Unit::ApplyAuraProcTriggerDamage(Aura* aura, bool apply)
         tAuraProcTriggerDamage.push_back(aura);
     else
         tAuraProcTriggerDamage.remove(aura);
+
+    InvalidateAuraModifierTotals(SPELL_AURA_PROC_TRIGGER_DAMAGE);
 }
 
 uint32 Unit::GetCreatePowers(Powers power) const
@@ -9432,26 +9483,60 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, uint32 procFlag,
         }
     }
 
+    MaNGOS::AddThreadCounter<uint64>(t_procIndexCounters.calls, 1);
+
+    RebuildProcIndexIfNeeded();
+    if (!m_procHolderIndex)
+    {
+        MaNGOS::AddThreadCounter<uint64>(t_procIndexCounters.skipped, m_spellAuraHolders.size());
+        return;
+    }
+
     RemoveSpellList removedSpells;
     ProcTriggeredList procTriggered;
-    // Fill procTriggered list
-    for (SpellAuraHolderMap::const_iterator itr = GetSpellAuraHolderMap().begin(); itr != GetSpellAuraHolderMap().end(); ++itr)
+    uint32 visited = 0;
+    // Fill procTriggered list, only from the buckets of the event proc flags
+    for (uint32 bit = 0; bit < MAX_PROC_FLAG_BUCKETS; ++bit)
     {
-        // skip deleted auras (possible at recursive triggered call
-        if (itr->second->GetState() != SPELLAURAHOLDER_STATE_READY || itr->second->IsDeleted())
+        uint32 bucketFlag = uint32(1) << bit;
+        if (!(procFlag & bucketFlag))
             continue;
 
-        SpellProcEventEntry const* spellProcEvent = nullptr;
-        if (!IsTriggeredAtSpellProcEvent(pTarget, itr->second, procSpell, procFlag, procExtra, attType, isVictim, spellProcEvent, dontTriggerSpecial))
+        std::vector<SpellAuraHolder*> const& bucket = m_procHolderIndex->buckets[bit];
+        if (bucket.empty())
             continue;
 
-        procTriggered.push_back(ProcTriggeredData(spellProcEvent, itr->second));
+        for (SpellAuraHolder* holder : bucket)
+        {
+            // already visited in the bucket of a lower flag
+            if (holder->GetProcIndexFlags() & procFlag & (bucketFlag - 1))
+                continue;
+
+            ++visited;
+
+            // skip deleted auras (possible at recursive triggered call
+            if (holder->GetState() != SPELLAURAHOLDER_STATE_READY || holder->IsDeleted())
+                continue;
+
+            SpellProcEventEntry const* spellProcEvent = nullptr;
+            if (!IsTriggeredAtSpellProcEvent(pTarget, holder, procSpell, procFlag, procExtra, attType, isVictim, spellProcEvent, dontTriggerSpecial))
+                continue;
+
+            procTriggered.push_back(ProcTriggeredData(spellProcEvent, holder));
+        }
     }
 
+    MaNGOS::AddThreadCounter<uint64>(t_procIndexCounters.visited, visited);
+    MaNGOS::AddThreadCounter<uint64>(t_procIndexCounters.skipped, m_spellAuraHolders.size() - visited);
+
     // Nothing found
     if (procTriggered.empty())
         return;
 
+    // buckets are in apply order, keep handling the procs in spell id order like the holder map
+    if (procTriggered.size() > 1)
+        procTriggered.sort([](ProcTriggeredData const& a, ProcTriggeredData const& b) { return a.triggeredByHolder->GetId() < b.triggeredByHolder->GetId(); });
+
     // Handle effects proceed this time
     for (ProcTriggeredList::const_iterator itr = procTriggered.begin(); itr != procTriggered.end(); ++itr)
     {
@@ -9530,6 +9615,101 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, uint32 procFlag,
     }
 }
 
+void Unit::AddSpellAuraHolderToProcIndex(SpellAuraHolder* holder)
+{
+    uint32 procFlags = sSpellMgr.GetSpellProcFlags(holder->GetSpellProto());
+    holder->SetProcIndexFlags(procFlags);
+    if (!procFlags)
+        return;
+
+    if (!m_procHolderIndex)
+        m_procHolderIndex.reset(new ProcHolderIndex);
+
+    for (uint32 bit = 0; bit < MAX_PROC_FLAG_BUCKETS; ++bit)
+        if (procFlags & (uint32(1) << bit))
+            m_procHolderIndex->buckets[bit].push_back(holder);
+}
+
+void Unit::RemoveSpellAuraHolderFromProcIndex(SpellAuraHolder* holder)
+{
+    uint32 procFlags = holder->GetProcIndexFlags();
+    if (!procFlags || !m_procHolderIndex)
+        return;
+
+    // erase instead of swapping with the last one, buckets keep the apply order
+    for (uint32 bit = 0; bit < MAX_PROC_FLAG_BUCKETS; ++bit)
+    {
+        if (!(procFlags & (uint32(1) << bit)))
+            continue;
+
+        std::vector<SpellAuraHolder*>& bucket = m_procHolderIndex->buckets[bit];
+        std::vector<SpellAuraHolder*>::iterator itr = std::find(bucket.begin(), bucket.end(), holder);
+        if (itr != bucket.end())
+            bucket.erase(itr);
+    }
+
+    holder->SetProcIndexFlags(0);
+}
+
+void Unit::RebuildProcIndexIfNeeded()
+{
+    uint32 generation = sSpellMgr.GetSpellProcEventGeneration();
+    if (m_procHolderIndexGeneration == generation)
+        return;
+
+    // spell_proc_event was reloaded, proc flags of the applied holders may have changed
+    m_procHolderIndexGeneration = generation;
+    m_procHolderIndex.reset();
+    for (SpellAuraHolderMap::const_iterator itr = m_spellAuraHolders.begin(); itr != m_spellAuraHolders.end(); ++itr)
+        AddSpellAuraHolderToProcIndex(itr->second);
+}
+
+void Unit::GetProcHolderIndexStatistics(ProcHolderIndexStatistics& statistics)
+{
+    ProcIndexThreadCounters::Sum(statistics);
+}
+
+uint32 Unit::CountProcCandidates(uint32 procFlag, bool useIndex)
+{
+    uint32 candidates = 0;
+
+    if (!useIndex)
+    {
+        // what ProcDamageAndSpellFor did before the index: look up the proc flags of every holder
+        for (SpellAuraHolderMap::const_iterator itr = m_spellAuraHolders.begin(); itr != m_spellAuraHolders.end(); ++itr)
+        {
+            SpellAuraHolder const* holder = itr->second;
+            if (holder->GetState() == SPELLAURAHOLDER_STATE_READY && !holder->IsDeleted() &&
+                (sSpellMgr.GetSpellProcFlags(holder->GetSpellProto()) & procFlag))
+                ++candidates;
+        }
+        return candidates;
+    }
+
+    RebuildProcIndexIfNeeded();
+    if (!m_procHolderIndex)
+        return 0;
+
+    // same walk as ProcDamageAndSpellFor
+    for (uint32 bit = 0; bit < MAX_PROC_FLAG_BUCKETS; ++bit)
+    {
+        uint32 bucketFlag = uint32(1) << bit;
+        if (!(procFlag & bucketFlag))
+            continue;
+
+        for (SpellAuraHolder const* holder : m_procHolderIndex->buckets[bit])
+        {
+            if (holder->GetProcIndexFlags() & procFlag & (bucketFlag - 1))
+                continue;
+
+            if (holder->GetState() == SPELLAURAHOLDER_STATE_READY && !holder->IsDeleted())
+                ++candidates;
+        }
+    }
+
+    return candidates;
+}
+
 SpellSchoolMask Unit::GetMeleeDamageSchoolMask() const
 {
     return SPELL_SCHOOL_MASK_NORMAL;
@@ -9874,6 +10054,7 @@ void Unit::UpdateModelData()
     {
         // we expect values in database to be relative to scale = 1.0
         SetFloatValue(UNIT_FIELD_BOUNDINGRADIUS, GetObjectScale() * modelInfo->bounding_radius);
+        UpdateGridPosition();
 
         // never actually update combat_reach for player, it's always the same. Below player case is for initialization
         if (GetTypeId() == TYPEID_PLAYER)
@@ -44,6 +44,7 @@
 #include "AI/BaseAI/CreatureAI.h"
 
 #include <list>
+#include <memory>
 
 enum SpellInterruptFlags
 {
@@ -1146,6 +1147,16 @@ enum PowerDefaults
 
 struct SpellProcEventEntry;                                 // used only privately
 
+#define MAX_PROC_FLAG_BUCKETS 32                            // one per bit of ProcFlags
+
+/// Counters of the proc index, summed over all units and threads
+struct ProcHolderIndexStatistics
+{
+    uint64 calls;                                           // Unit::ProcDamageAndSpellFor calls
+    uint64 visited;                                         // holders checked because they can proc from the event
+    uint64 skipped;                                         // holders on the unit which were not looked at
+};
+
 class Unit : public WorldObject
 {
     public:
@@ -2002,6 +2013,8 @@ class Unit : public WorldObject
         void ApplyAuraProcTriggerDamage(Aura* aura, bool apply);
 
         int32 GetTotalAuraModifier(AuraType auratype) const;
+        // the totals below are cached per aura type, dropped when an aura of the type is added, removed or changes its amount
+        void InvalidateAuraModifierTotals(AuraType auratype);
         float GetTotalAuraMultiplier(AuraType auratype) const;
         int32 GetMaxPositiveAuraModifier(AuraType auratype) const;
         int32 GetMaxNegativeAuraModifier(AuraType auratype) const;
@@ -2065,6 +2078,9 @@ class Unit : public WorldObject
         uint32 MeleeDamageBonusTaken(Unit* pCaster, uint32 pdamage, WeaponAttackType attType, SpellEntry const* spellProto = nullptr, DamageEffectType damagetype = DIRECT_DAMAGE, uint32 stack = 1);
 
         bool IsTriggeredAtSpellProcEvent(Unit* pVictim, SpellAuraHolder* holder, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, SpellProcEventEntry const*& spellProcEvent, bool dontTriggerSpecial);
+        static void GetProcHolderIndexStatistics(ProcHolderIndexStatistics& statistics);
+        // holders ProcDamageAndSpellFor would check for procFlag, found by the proc index or by walking all holders, for .server procbenchmark
+        uint32 CountProcCandidates(uint32 procFlag, bool useIndex);
         // Aura proc handlers
         SpellAuraProcResult HandleDummyAuraProc(Unit* pVictim, uint32 damage, Aura* triggeredByAura, SpellEntry const* procSpell, uint32 procFlag, uint32 procEx, uint32 cooldown);
         SpellAuraProcResult HandleHasteAuraProc(Unit* pVictim, uint32 damage, Aura* triggeredByAura, SpellEntry const* procSpell, uint32 procFlag, uint32 procEx, uint32 cooldown);
@@ -2233,6 +2249,23 @@ class Unit : public WorldObject
         AuraList m_deletedAuras;                            // auras removed while in ApplyModifier and waiting deleted
         SpellAuraHolderList m_deletedHolders;
 
+        /**
+         * Holders which can proc, listed once for every proc flag bit they react to, so
+         * ProcDamageAndSpellFor only visits the holders interested in the event instead of
+         * looking up the proc data of every holder on the unit. Built at first proc aura.
+         */
+        struct ProcHolderIndex
+        {
+            std::vector<SpellAuraHolder*> buckets[MAX_PROC_FLAG_BUCKETS];
+        };
+
+        void AddSpellAuraHolderToProcIndex(SpellAuraHolder* holder);
+        void RemoveSpellAuraHolderFromProcIndex(SpellAuraHolder* holder);
+        void RebuildProcIndexIfNeeded();
+
+        std::unique_ptr<ProcHolderIndex> m_procHolderIndex;
+        uint32 m_procHolderIndexGeneration;                 // SpellMgr proc event generation the index was built with
+
         // Store Auras for which the target must be tracked
         TrackedAuraTargetMap m_trackedAuraTargets[MAX_TRACKED_AURA_TYPES];
 
@@ -2246,6 +2279,21 @@ class Unit : public WorldObject
         uint32 m_transform;
 
         AuraList m_modAuras[TOTAL_AURAS];
+
+        struct AuraModifierTotals
+        {
+            AuraModifierTotals() : total(0), multiplier(1.0f), maxPositive(0), maxNegative(0), valid(false) {}
+
+            int32 total;
+            float multiplier;
+            int32 maxPositive;
+            int32 maxNegative;
+            bool valid;
+        };
+        typedef std::unordered_map<uint32 /*AuraType*/, AuraModifierTotals> AuraModifierTotalsMap;
+
+        AuraModifierTotals const& GetAuraModifierTotals(AuraType auratype) const;
+        mutable AuraModifierTotalsMap m_auraModifierTotals; // only types which had auras, entries are kept when invalidated
         float m_auraModifiersGroup[UNIT_MOD_END][MODIFIER_TYPE_END];
         float m_weaponDamage[MAX_ATTACK][2];
         bool m_canModifyStats;
@@ -27,6 +27,8 @@
 #include "World/World.h"
 #include "Entities/ObjectGuid.h"
 
+#include <chrono>
+
 UpdateData::UpdateData() : m_blockCount(0)
 {
 }
@@ -41,66 +43,145 @@ void UpdateData::AddOutOfRangeGUID(ObjectGuid const& guid)
     m_outOfRangeGUIDs.insert(guid);
 }
 
-void UpdateData::AddUpdateBlock(const ByteBuffer& block)
+size_t UpdateData::AddUpdateBlock(const ByteBuffer& block)
 {
+    size_t pos = m_data.wpos();
     m_data.append(block);
     ++m_blockCount;
+    return pos;
 }
 
-void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
-{
-    z_stream c_stream;
+UpdateCompressionStatistics UpdateData::m_compressionStats;
 
-    c_stream.zalloc = (alloc_func)nullptr;
-    c_stream.zfree = (free_func)nullptr;
-    c_stream.opaque = (voidpf)nullptr;
+namespace
+{
+    // deflate state of the current thread, reset for every packet instead of allocating it again
+    class DeflateStream
+    {
+        public:
+            DeflateStream() : m_initialized(false), m_level(0) {}
+            ~DeflateStream() { End(); }
+
+            z_stream* Get(int level)
+            {
+                // level changed by config reload
+                if (m_initialized && level != m_level)
+                    End();
+
+                if (m_initialized)
+                {
+                    int z_res = deflateReset(&m_stream);
+                    if (z_res == Z_OK)
+                        return &m_stream;
+
+                    sLog.outError("Can't compress update packet (zlib: deflateReset) Error code: %i (%s)", z_res, zError(z_res));
+                    End();
+                }
+
+                m_stream.zalloc = (alloc_func)nullptr;
+                m_stream.zfree = (free_func)nullptr;
+                m_stream.opaque = (voidpf)nullptr;
+
+                int z_res = deflateInit(&m_stream, level);
+                if (z_res != Z_OK)
+                {
+                    sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                    return nullptr;
+                }
+
+                m_initialized = true;
+                m_level = level;
+                return &m_stream;
+            }
+
+            void End()
+            {
+                if (!m_initialized)
+                    return;
+
+                deflateEnd(&m_stream);
+                m_initialized = false;
+            }
+
+        private:
+            z_stream m_stream;
+            bool m_initialized;
+            int m_level;
+    };
+
+    thread_local DeflateStream s_deflateStream;
+}
 
+void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
+{
     // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
+    z_stream* c_stream = s_deflateStream.Get(sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
+    if (!c_stream)
     {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
         *dst_size = 0;
         return;
     }
 
-    c_stream.next_out = (Bytef*)dst;
-    c_stream.avail_out = *dst_size;
-    c_stream.next_in = (Bytef*)src;
-    c_stream.avail_in = (uInt)src_size;
+    c_stream->next_out = (Bytef*)dst;
+    c_stream->avail_out = *dst_size;
+    c_stream->next_in = (Bytef*)src;
+    c_stream->avail_in = (uInt)src_size;
 
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
+    int z_res = deflate(c_stream, Z_NO_FLUSH);
     if (z_res != Z_OK)
     {
         sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
+        s_deflateStream.End();
         *dst_size = 0;
         return;
     }
 
-    if (c_stream.avail_in != 0)
+    if (c_stream->avail_in != 0)
     {
         sLog.outError("Can't compress update packet (zlib: deflate not greedy)");
+        s_deflateStream.End();
         *dst_size = 0;
         return;
     }
 
-    z_res = deflate(&c_stream, Z_FINISH);
+    z_res = deflate(c_stream, Z_FINISH);
     if (z_res != Z_STREAM_END)
     {
         sLog.outError("Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
+        s_deflateStream.End();
         *dst_size = 0;
         return;
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
+    *dst_size = c_stream->total_out;
+}
 
-    *dst_size = c_stream.total_out;
+bool UpdateData::CompressPacket(WorldPacket& packet, uint8 const* data, size_t size)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    uint32 destsize = compressBound(size);
+    packet.resize(destsize + sizeof(uint32));
+
+    packet.put<uint32>(0, size);
+    Compress(const_cast<uint8*>(packet.contents()) + sizeof(uint32), &destsize, (void*)data, size);
+    if (destsize == 0)
+        return false;
+
+    packet.resize(destsize + sizeof(uint32));
+    packet.SetOpcode(SMSG_COMPRESSED_UPDATE_OBJECT);
+
+    ++m_compressionStats.packets;
+    m_compressionStats.bytesIn += size;
+    m_compressionStats.bytesOut += packet.size();
+    m_compressionStats.time += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    return true;
+}
+
+bool UpdateData::NeedsCompression(WorldPacket const& packet)
+{
+    return packet.GetOpcode() == SMSG_UPDATE_OBJECT && packet.size() > MaxUncompressedSize;
 }
 
 bool UpdateData::BuildPacket(WorldPacket& packet, bool hasTransport)
@@ -125,21 +206,20 @@ bool UpdateData::BuildPacket(WorldPacket& packet, bool hasTransport)
 
     size_t pSize = buf.wpos();                              // use real used data size
 
-    if (pSize > 100)                                        // compress large packets
-    {
-        uint32 destsize = compressBound(pSize);
-        packet.resize(destsize + sizeof(uint32));
+    const uint32 offloadSize = sWorld.getConfig(CONFIG_UINT32_COMPRESSION_OFFLOAD_SIZE);
 
-        packet.put<uint32>(0, pSize);
-        Compress(const_cast<uint8*>(packet.contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
-        if (destsize == 0)
+    if (pSize > MaxUncompressedSize && (!offloadSize || pSize < offloadSize))
+    {
+        // compress large packets
+        if (!CompressPacket(packet, buf.contents(), pSize))
             return false;
-
-        packet.resize(destsize + sizeof(uint32));
-        packet.SetOpcode(SMSG_COMPRESSED_UPDATE_OBJECT);
     }
     else                                                    // send small packets without compression
     {
+        // large ones are compressed by the network thread of the receiver, see WorldSocket::SendPacket
+        if (pSize > MaxUncompressedSize)
+            ++m_compressionStats.offloaded;
+
         packet.append(buf);
         packet.SetOpcode(SMSG_UPDATE_OBJECT);
     }
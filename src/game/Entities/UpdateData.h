@@ -22,6 +22,8 @@
 #include "ByteBuffer.h"
 #include "Entities/ObjectGuid.h"
 
+#include <atomic>
+
 class WorldPacket;
 
 enum ObjectUpdateType
@@ -46,25 +48,51 @@ enum ObjectUpdateFlags
     UPDATEFLAG_HAS_POSITION         = 0x0040,
 };
 
+/// Update packet compression counters of all threads, times in microseconds
+struct UpdateCompressionStatistics
+{
+    UpdateCompressionStatistics() : packets(0), bytesIn(0), bytesOut(0), time(0), offloaded(0) {}
+
+    std::atomic<uint64> packets;
+    std::atomic<uint64> bytesIn;
+    std::atomic<uint64> bytesOut;
+    std::atomic<uint64> time;
+    std::atomic<uint64> offloaded;                          // packets left uncompressed for the network threads
+};
+
 class UpdateData
 {
     public:
+        /// Packets up to this size are sent without compression
+        static const size_t MaxUncompressedSize = 100;
+
         UpdateData();
 
         void AddOutOfRangeGUID(GuidSet& guids);
         void AddOutOfRangeGUID(ObjectGuid const& guid);
-        void AddUpdateBlock(const ByteBuffer& block);
+        // returns the position of the block, used to overwrite single values afterwards
+        size_t AddUpdateBlock(const ByteBuffer& block);
+        void SetBlockValue(size_t pos, uint32 value) { m_data.put<uint32>(pos, value); }
         bool BuildPacket(WorldPacket& packet, bool hasTransport = false);
         bool HasData() const { return m_blockCount > 0 || !m_outOfRangeGUIDs.empty(); }
         void Clear();
 
         GuidSet const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
 
+        /// Packs the update object content into a compressed update packet
+        static bool CompressPacket(WorldPacket& packet, uint8 const* data, size_t size);
+        /// True for update packets built without compression because it was left to the network thread
+        static bool NeedsCompression(WorldPacket const& packet);
+
+        static UpdateCompressionStatistics const& GetCompressionStatistics() { return m_compressionStats; }
+
     protected:
         uint32 m_blockCount;
         GuidSet m_outOfRangeGUIDs;
         ByteBuffer m_data;
 
         static void Compress(void* dst, uint32* dst_size, void* src, int src_size);
+
+        static UpdateCompressionStatistics m_compressionStats;
 };
 #endif
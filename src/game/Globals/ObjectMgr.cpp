@@ -416,6 +416,19 @@ void ObjectMgr::LoadPointOfInterestLocales()
     sLog.outString();
 }
 
+// script ids are indexes into the list of all script names, so a snapshot of a table with script names needs the same list
+static uint32 GetScriptNamesSnapshotContext()
+{
+    uint32 hash = 2166136261u;                              // FNV-1a over all names including their terminators
+    for (uint32 i = 0; i < sScriptDevAIMgr.GetScriptIdsCount(); ++i)
+    {
+        char const* name = sScriptDevAIMgr.GetScriptName(i);
+        for (size_t j = 0, length = strlen(name); j <= length; ++j)
+            hash = (hash ^ uint8(name[j])) * 16777619u;
+    }
+    return hash;
+}
+
 struct SQLCreatureLoader : public SQLStorageLoaderBase<SQLCreatureLoader, SQLStorage>
 {
     template<class D>
@@ -423,6 +436,8 @@ struct SQLCreatureLoader : public SQLStorageLoaderBase<SQLCreatureLoader, SQLSto
     {
         dst = D(sScriptDevAIMgr.GetScriptId(src));
     }
+
+    uint32 GetSnapshotContext() const { return GetScriptNamesSnapshotContext(); }
 };
 
 void ObjectMgr::LoadCreatureTemplates()
@@ -691,8 +706,10 @@ void ObjectMgr::LoadCreatureTemplates()
     sLog.outString();
 }
 
-void ObjectMgr::ConvertCreatureAddonAuras(CreatureDataAddon* addon, char const* table, char const* guidEntryStr)
+void ObjectMgr::ConvertCreatureAddonAuras(SQLStorage& creatureaddons, CreatureDataAddon* addon, char const* guidEntryStr)
 {
+    char const* table = creatureaddons.GetTableName();
+
     // Now add the auras, format "spell1 spell2 ..."
     char* p, *s;
     std::vector<int> val;
@@ -712,7 +729,7 @@ void ObjectMgr::ConvertCreatureAddonAuras(CreatureDataAddon* addon, char const*
             val.push_back(atoi(s));
 
         // free char* loaded memory
-        delete[](char*)reinterpret_cast<char const*>(addon->auras);
+        creatureaddons.ReleaseFieldValue(reinterpret_cast<char const*>(addon->auras));
     }
 
     // empty list
@@ -724,6 +741,7 @@ void ObjectMgr::ConvertCreatureAddonAuras(CreatureDataAddon* addon, char const*
 
     // replace by new structures array
     const_cast<uint32*&>(addon->auras) = new uint32[val.size() + 1];
+    creatureaddons.AdoptFieldValue((char*)addon->auras);
 
     uint32 i = 0;
     for (uint32 j = 0; j < val.size(); ++j)
@@ -794,7 +812,7 @@ void ObjectMgr::LoadCreatureAddons(SQLStorage& creatureaddons, char const* entry
             const_cast<CreatureDataAddon*>(addon)->emote = 0;
         }
 
-        ConvertCreatureAddonAuras(const_cast<CreatureDataAddon*>(addon), creatureaddons.GetTableName(), entryName);
+        ConvertCreatureAddonAuras(creatureaddons, const_cast<CreatureDataAddon*>(addon), entryName);
     }
 
     sLog.outString(">> Loaded %u %s", creatureaddons.GetRecordCount(), comment);
@@ -1250,8 +1268,8 @@ void ObjectMgr::LoadCreatureModelRace()
 void ObjectMgr::LoadCreatures()
 {
     uint32 count = 0;
-    //                                                0                       1   2    3
-    QueryResult* result = WorldDatabase.Query("SELECT creature.guid, creature.id, map, modelid,"
+    //                                                                                                                                          0                       1   2    3
+    QueryResult* result = SQLStorageSnapshot::Query("creature", "creature, game_event_creature, pool_creature, pool_creature_template", "SELECT creature.guid, creature.id, map, modelid,"
                           //   4             5           6           7           8            9              10               11         12
                           "equipment_id, position_x, position_y, position_z, orientation, spawntimesecsmin, spawntimesecsmax, spawndist, currentwaypoint,"
                           //   13         14       15          16            17         18
@@ -1467,8 +1485,8 @@ void ObjectMgr::LoadGameObjects()
 {
     uint32 count = 0;
 
-    //                                                0                           1   2    3           4           5           6
-    QueryResult* result = WorldDatabase.Query("SELECT gameobject.guid, gameobject.id, map, position_x, position_y, position_z, orientation,"
+    //                                                                                                                                                    0                           1   2    3           4           5           6
+    QueryResult* result = SQLStorageSnapshot::Query("gameobject", "gameobject, game_event_gameobject, pool_gameobject, pool_gameobject_template", "SELECT gameobject.guid, gameobject.id, map, position_x, position_y, position_z, orientation,"
                           //   7          8          9          10         11             12               13            14     15         16
                           "rotation0, rotation1, rotation2, rotation3, spawntimesecsmin, spawntimesecsmax, animprogress, state, spawnMask, event,"
                           //   17                          18
@@ -1838,6 +1856,8 @@ struct SQLItemLoader : public SQLStorageLoaderBase<SQLItemLoader, SQLStorage>
     {
         dst = D(sScriptDevAIMgr.GetScriptId(src));
     }
+
+    uint32 GetSnapshotContext() const { return GetScriptNamesSnapshotContext(); }
 };
 
 void ObjectMgr::LoadItemPrototypes()
@@ -3449,8 +3469,8 @@ void ObjectMgr::LoadQuests()
 
     m_ExclusiveQuestGroups.clear();
 
-    //                                                0      1       2           3         4           5     6                7              8              9
-    QueryResult* result = WorldDatabase.Query("SELECT entry, Method, ZoneOrSort, MinLevel, QuestLevel, Type, RequiredClasses, RequiredRaces, RequiredSkill, RequiredSkillValue,"
+    //                                                                                          0      1       2           3         4           5     6                7              8              9
+    QueryResult* result = SQLStorageSnapshot::Query("quest_template", "quest_template", "SELECT entry, Method, ZoneOrSort, MinLevel, QuestLevel, Type, RequiredClasses, RequiredRaces, RequiredSkill, RequiredSkillValue,"
                           //   10                   11                 12                     13                   14                     15                   16                17
                           "RepObjectiveFaction, RepObjectiveValue, RequiredMinRepFaction, RequiredMinRepValue, RequiredMaxRepFaction, RequiredMaxRepValue, SuggestedPlayers, LimitTime,"
                           //   18          19            20           21           22           23              24                25         26            27
@@ -4604,6 +4624,8 @@ struct SQLInstanceLoader : public SQLStorageLoaderBase<SQLInstanceLoader, SQLSto
     {
         dst = D(sScriptDevAIMgr.GetScriptId(src));
     }
+
+    uint32 GetSnapshotContext() const { return GetScriptNamesSnapshotContext(); }
 };
 
 void ObjectMgr::LoadInstanceTemplate()
@@ -4684,6 +4706,8 @@ struct SQLWorldLoader : public SQLStorageLoaderBase<SQLWorldLoader, SQLStorage>
     {
         dst = D(sScriptDevAIMgr.GetScriptId(src));
     }
+
+    uint32 GetSnapshotContext() const { return GetScriptNamesSnapshotContext(); }
 };
 
 void ObjectMgr::LoadWorldTemplate()
@@ -5919,6 +5943,8 @@ struct SQLGameObjectLoader : public SQLStorageLoaderBase<SQLGameObjectLoader, SQ
     {
         dst = D(sScriptDevAIMgr.GetScriptId(src));
     }
+
+    uint32 GetSnapshotContext() const { return GetScriptNamesSnapshotContext(); }
 };
 
 inline void CheckGOLockId(GameObjectInfo const* goInfo, uint32 dataN, uint32 N)
@@ -7058,6 +7084,7 @@ int ObjectMgr::GetOrNewIndexForLocale(LocaleConstant loc)
     if (loc == LOCALE_enUS)
         return -1;
 
+    std::lock_guard<std::mutex> guard(m_LocalForIndexLock);
     for (size_t i = 0; i < m_LocalForIndex.size(); ++i)
         if (m_LocalForIndex[i] == loc)
             return i;
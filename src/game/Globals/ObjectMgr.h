@@ -36,6 +36,7 @@
 
 #include <map>
 #include <climits>
+#include <mutex>
 
 class Group;
 class ArenaTeam;
@@ -1127,6 +1128,7 @@ class ObjectMgr
 
         typedef             std::vector<LocaleConstant> LocalForIndex;
         LocalForIndex        m_LocalForIndex;
+        std::mutex           m_LocalForIndexLock;           // locale loaders may run in parallel at startup
 
         ExclusiveQuestGroupsMap m_ExclusiveQuestGroups;
 
@@ -1139,7 +1141,7 @@ class ObjectMgr
 
     private:
         void LoadCreatureAddons(SQLStorage& creatureaddons, char const* entryName, char const* comment);
-        void ConvertCreatureAddonAuras(CreatureDataAddon* addon, char const* table, char const* guidEntryStr);
+        void ConvertCreatureAddonAuras(SQLStorage& creatureaddons, CreatureDataAddon* addon, char const* guidEntryStr);
         void LoadQuestRelationsHelper(QuestRelationsMap& map, char const* table);
         void LoadVendors(char const* tableName, bool isTemplates);
         void LoadTrainers(char const* tableName, bool isTemplates);
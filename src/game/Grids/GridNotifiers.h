@@ -32,6 +32,48 @@
 
 namespace MaNGOS
 {
+    // Range searches over grid lists with a GridPositionIndex only touch the units which may pass
+    // their check, if the check tells the area it accepts units in:
+    //     bool GetSearchArea(float& x, float& y, float& range) const
+    // where a unit may be accepted only if its bounding circle reaches within range of (x, y)
+
+    // search area of checks accepting units obj->IsWithinDistInMap(unit, dist)
+    inline bool GetObjectSearchArea(WorldObject const* obj, float dist, float& x, float& y, float& range)
+    {
+        x = obj->GetPositionX();
+        y = obj->GetPositionY();
+        range = dist + obj->GetObjectBoundingRadius();
+        return true;
+    }
+
+    template<class Check>
+    inline auto GetCheckSearchArea(Check const& check, float& x, float& y, float& range, int) -> decltype(check.GetSearchArea(x, y, range))
+    {
+        return check.GetSearchArea(x, y, range);
+    }
+
+    template<class Check>
+    inline bool GetCheckSearchArea(Check const& /*check*/, float& /*x*/, float& /*y*/, float& /*range*/, long)
+    {
+        return false;
+    }
+
+    // calls func for the objects of m which may pass check, until func returns false
+    template<class T, class Check, class FUNC>
+    inline void VisitSearchCandidates(GridRefManager<T>& m, Check const& check, FUNC func)
+    {
+        float x, y, range;
+        if (GridPositionIndex<T>::IsEnabled() && GetCheckSearchArea(check, x, y, range, 0))
+        {
+            m.GetPositionIndex().VisitInRange(x, y, range, func);
+            return;
+        }
+
+        for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+            if (!func(itr->getSource()))
+                return;
+    }
+
     struct VisibleNotifier
     {
         Camera& i_camera;
@@ -682,6 +724,7 @@ namespace MaNGOS
         public:
             MostHPMissingInRangeCheck(Unit const* obj, float range, uint32 hp, bool onlyInCombat = true) : i_obj(obj), i_range(range), i_hp(hp), i_onlyInCombat(onlyInCombat) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 if (!u->isAlive() || (i_onlyInCombat && !u->isInCombat()))
@@ -706,6 +749,7 @@ namespace MaNGOS
         public:
             FriendlyCCedInRangeCheck(WorldObject const* obj, float range) : i_obj(obj), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 if (u->isAlive() && u->isInCombat() && !i_obj->IsHostileTo(u) && i_obj->IsWithinDistInMap(u, i_range) &&
@@ -726,6 +770,7 @@ namespace MaNGOS
         public:
             FriendlyMissingBuffInRangeCheck(WorldObject const* obj, float range, uint32 spellid) : i_obj(obj), i_range(range), i_spell(spellid) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 if (u->isAlive() && u->isInCombat() && !i_obj->IsHostileTo(u) && i_obj->IsWithinDistInMap(u, i_range) &&
@@ -749,6 +794,7 @@ namespace MaNGOS
                 i_controlledByPlayer = obj->IsControlledByPlayer();
             }
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 if (u->isAlive() && (i_controlledByPlayer ? !i_obj->IsFriendlyTo(u) : i_obj->IsHostileTo(u))
@@ -769,6 +815,7 @@ namespace MaNGOS
             AnyUnfriendlyVisibleUnitInObjectRangeCheck(WorldObject const* obj, Unit const* funit, float range)
                 : i_obj(obj), i_funit(funit), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 return u->isAlive()
@@ -787,6 +834,7 @@ namespace MaNGOS
         public:
             AnyFriendlyUnitInObjectRangeCheck(WorldObject const* obj, float range) : i_obj(obj), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 if (u->isAlive() && i_obj->IsWithinDistInMap(u, i_range) && i_obj->IsFriendlyTo(u))
@@ -804,6 +852,7 @@ namespace MaNGOS
         public:
             AnyUnitInObjectRangeCheck(WorldObject const* obj, float range) : i_obj(obj), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 if (u->isAlive() && i_obj->IsWithinDistInMap(u, i_range))
@@ -822,6 +871,7 @@ namespace MaNGOS
         public:
             NearestAttackableUnitInObjectRangeCheck(WorldObject const* obj, Unit const* funit, float range) : i_obj(obj), i_funit(funit), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 if (u->isTargetableForAttack() && i_obj->IsWithinDistInMap(u, i_range) &&
@@ -852,6 +902,7 @@ namespace MaNGOS
                 i_targetForPlayer = (i_originalCaster->GetTypeId() == TYPEID_PLAYER);
             }
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 // Check contains checks for: live, non-selectable, non-attackable flags, flight check and GM check, ignore totems
@@ -888,6 +939,7 @@ namespace MaNGOS
                 i_targetForPlayer = i_obj->IsControlledByPlayer();
             }
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Unit* u)
             {
                 // Check contains checks for: live, non-selectable, non-attackable flags, flight check and GM check, ignore totems
@@ -984,6 +1036,7 @@ namespace MaNGOS
             NearestAssistCreatureInCreatureRangeCheck(Creature* obj, Unit* enemy, float range)
                 : i_obj(obj), i_enemy(enemy), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Creature* u)
             {
                 if (u == i_obj)
@@ -1051,6 +1104,7 @@ namespace MaNGOS
         public:
             AllCreaturesOfEntryInRangeCheck(const WorldObject* pObject, uint32 uiEntry, float fMaxRange) : m_pObject(pObject), m_uiEntry(uiEntry), m_fRange(fMaxRange) {}
             WorldObject const& GetFocusObject() const { return *m_pObject; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(m_pObject, m_fRange, x, y, range); }
             bool operator()(Unit* pUnit)
             {
                 if (pUnit->GetEntry() == m_uiEntry && m_pObject->IsWithinDist(pUnit, m_fRange, false))
@@ -1075,6 +1129,7 @@ namespace MaNGOS
         public:
             AnyPlayerInObjectRangeCheck(WorldObject const* obj, float range) : i_obj(obj), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Player* u)
             {
                 if (u->isAlive() && i_obj->IsWithinDistInMap(u, i_range))
@@ -1093,6 +1148,7 @@ namespace MaNGOS
             AnyPlayerInObjectRangeWithAuraCheck(WorldObject const* obj, float range, uint32 spellId)
                 : i_obj(obj), i_range(range), i_spellId(spellId) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Player* u)
             {
                 return u->isAlive()
@@ -1111,6 +1167,7 @@ namespace MaNGOS
             AnyPlayerInCapturePointRange(WorldObject const* obj, float range)
                 : i_obj(obj), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            bool GetSearchArea(float& x, float& y, float& range) const { return GetObjectSearchArea(i_obj, i_range, x, y, range); }
             bool operator()(Player* u)
             {
                 return u->CanUseCapturePoint() &&
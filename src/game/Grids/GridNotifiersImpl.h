@@ -408,14 +408,14 @@ void MaNGOS::UnitSearcher<Check>::Visit(CreatureMapType& m)
     if (i_object)
         return;
 
-    for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+    VisitSearchCandidates(m, i_check, [this](Creature* creature)
     {
-        if (i_check(itr->getSource()))
-        {
-            i_object = itr->getSource();
-            return;
-        }
-    }
+        if (!i_check(creature))
+            return true;
+
+        i_object = creature;
+        return false;
+    });
 }
 
 template<class Check>
@@ -425,50 +425,58 @@ void MaNGOS::UnitSearcher<Check>::Visit(PlayerMapType& m)
     if (i_object)
         return;
 
-    for (PlayerMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+    VisitSearchCandidates(m, i_check, [this](Player* player)
     {
-        if (i_check(itr->getSource()))
-        {
-            i_object = itr->getSource();
-            return;
-        }
-    }
+        if (!i_check(player))
+            return true;
+
+        i_object = player;
+        return false;
+    });
 }
 
 template<class Check>
 void MaNGOS::UnitLastSearcher<Check>::Visit(CreatureMapType& m)
 {
-    for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+    VisitSearchCandidates(m, i_check, [this](Creature* creature)
     {
-        if (i_check(itr->getSource()))
-            i_object = itr->getSource();
-    }
+        if (i_check(creature))
+            i_object = creature;
+        return true;
+    });
 }
 
 template<class Check>
 void MaNGOS::UnitLastSearcher<Check>::Visit(PlayerMapType& m)
 {
-    for (PlayerMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+    VisitSearchCandidates(m, i_check, [this](Player* player)
     {
-        if (i_check(itr->getSource()))
-            i_object = itr->getSource();
-    }
+        if (i_check(player))
+            i_object = player;
+        return true;
+    });
 }
 
 template<class Check>
 void MaNGOS::UnitListSearcher<Check>::Visit(PlayerMapType& m)
 {
-    for (PlayerMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->getSource()))
-            i_objects.push_back(itr->getSource());
+    VisitSearchCandidates(m, i_check, [this](Player* player)
+    {
+        if (i_check(player))
+            i_objects.push_back(player);
+        return true;
+    });
 }
 
 template<class Check>
 void MaNGOS::UnitListSearcher<Check>::Visit(CreatureMapType& m)
 {
-    for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->getSource()))
-            i_objects.push_back(itr->getSource());
+    VisitSearchCandidates(m, i_check, [this](Creature* creature)
+    {
+        if (i_check(creature))
+            i_objects.push_back(creature);
+        return true;
+    });
 }
 
 // Creature searchers
@@ -480,32 +488,36 @@ void MaNGOS::CreatureSearcher<Check>::Visit(CreatureMapType& m)
     if (i_object)
         return;
 
-    for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+    VisitSearchCandidates(m, i_check, [this](Creature* creature)
     {
-        if (i_check(itr->getSource()))
-        {
-            i_object = itr->getSource();
-            return;
-        }
-    }
+        if (!i_check(creature))
+            return true;
+
+        i_object = creature;
+        return false;
+    });
 }
 
 template<class Check>
 void MaNGOS::CreatureLastSearcher<Check>::Visit(CreatureMapType& m)
 {
-    for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+    VisitSearchCandidates(m, i_check, [this](Creature* creature)
     {
-        if (i_check(itr->getSource()))
-            i_object = itr->getSource();
-    }
+        if (i_check(creature))
+            i_object = creature;
+        return true;
+    });
 }
 
 template<class Check>
 void MaNGOS::CreatureListSearcher<Check>::Visit(CreatureMapType& m)
 {
-    for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->getSource()))
-            i_objects.push_back(itr->getSource());
+    VisitSearchCandidates(m, i_check, [this](Creature* creature)
+    {
+        if (i_check(creature))
+            i_objects.push_back(creature);
+        return true;
+    });
 }
 
 template<class Check>
@@ -515,22 +527,25 @@ void MaNGOS::PlayerSearcher<Check>::Visit(PlayerMapType& m)
     if (i_object)
         return;
 
-    for (PlayerMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+    VisitSearchCandidates(m, i_check, [this](Player* player)
     {
-        if (i_check(itr->getSource()))
-        {
-            i_object = itr->getSource();
-            return;
-        }
-    }
+        if (!i_check(player))
+            return true;
+
+        i_object = player;
+        return false;
+    });
 }
 
 template<class Check>
 void MaNGOS::PlayerListSearcher<Check>::Visit(PlayerMapType& m)
 {
-    for (PlayerMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->getSource()))
-            i_objects.push_back(itr->getSource());
+    VisitSearchCandidates(m, i_check, [this](Player* player)
+    {
+        if (i_check(player))
+            i_objects.push_back(player);
+        return true;
+    });
 }
 
 template<class Builder>
@@ -98,8 +98,9 @@ void LootStore::LoadLootTable()
     // Clearing store (for reloading case)
     Clear();
 
-    //                                                 0      1     2                    3        4              5         6
-    QueryResult* result = WorldDatabase.PQuery("SELECT entry, item, ChanceOrQuestChance, groupid, mincountOrRef, maxcount, condition_id FROM %s", GetName());
+    //                                      0      1     2                    3        4              5         6
+    std::string query = std::string("SELECT entry, item, ChanceOrQuestChance, groupid, mincountOrRef, maxcount, condition_id FROM ") + GetName();
+    QueryResult* result = SQLStorageSnapshot::Query(GetName(), GetName(), query.c_str());
 
     if (result)
     {
@@ -55,6 +55,10 @@ class Camera;
 #define MAP_SIZE                (SIZE_OF_GRIDS*MAX_NUMBER_OF_GRIDS)
 #define MAP_HALFSIZE            (MAP_SIZE/2)
 
+// units keep packed positions in their grid lists for range searches, see GridPositionIndex
+template<> struct GridPositionIndexTraits<Creature> { enum { Enabled = 1 }; };
+template<> struct GridPositionIndexTraits<Player> { enum { Enabled = 1 }; };
+
 // Creature used instead pet to simplify *::Visit templates (not required duplicate code for Creature->Pet case)
 // Cameras in world list just because linked with Player objects
 typedef TYPELIST_4(Player, Creature/*pets*/, Corpse/*resurrectable*/, Camera)           AllWorldObjectTypes;
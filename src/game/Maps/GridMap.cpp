@@ -22,12 +22,14 @@
 #include "Server/DBCEnums.h"
 #include "Server/DBCStores.h"
 #include "Maps/GridMap.h"
+#include "Maps/GridPreloader.h"
 #include "VMapFactory.h"
 #include "MotionGenerators/MoveMap.h"
 #include "World/World.h"
 #include "Policies/Singleton.h"
 #include "Util.h"
 
+#include <chrono>
 #include <mutex>
 
 char const* MAP_MAGIC         = "MAPS";
@@ -71,103 +73,156 @@ GridMap::~GridMap()
     unloadData();
 }
 
-bool GridMap::loadData(char* filename)
+// reads the sections of a map file either through stdio or straight from a mapping of the file
+class GridMapReader
 {
-    // Unload old data if exist
-    unloadData();
+    public:
+        explicit GridMapReader(FILE* file) : m_file(file), m_mapping(nullptr), m_pos(0) {}
+        explicit GridMapReader(MaNGOS::MappedFile const& mapping) : m_file(nullptr), m_mapping(&mapping), m_pos(0) {}
 
-    GridMapFileHeader header;
-    // Not return error if file not found
-    FILE* in = fopen(filename, "rb");
-    if (!in)
-        return true;
-
-    fread(&header, sizeof(header), 1, in);
-    if (header.mapMagic     == *((uint32 const*)(MAP_MAGIC)) &&
-            header.versionMagic == *((uint32 const*)(MAP_VERSION_MAGIC)))
-    {
-        // loadup area data
-        if (header.areaMapOffset && !loadAreaData(in, header.areaMapOffset, header.areaMapSize))
+        bool Seek(uint32 offset)
         {
-            sLog.outError("Error loading map area data\n");
-            fclose(in);
-            return false;
-        }
+            if (m_file)
+                return fseek(m_file, offset, SEEK_SET) == 0;
 
-        // loadup holes data
-        if (header.holesOffset && !loadHolesData(in, header.holesOffset, header.holesSize))
-        {
-            sLog.outError("Error loading map holes data\n");
-            fclose(in);
-            return false;
+            if (offset > m_mapping->GetSize())
+                return false;
+
+            m_pos = offset;
+            return true;
         }
 
-        // loadup height data
-        if (header.heightMapOffset && !loadHeightData(in, header.heightMapOffset, header.heightMapSize))
+        bool Read(void* dest, size_t size)
         {
-            sLog.outError("Error loading map height data\n");
-            fclose(in);
-            return false;
+            if (m_file)
+                return fread(dest, size, 1, m_file) == 1;
+
+            if (!m_mapping->Contains(m_mapping->GetData() + m_pos, size))
+                return false;
+
+            memcpy(dest, m_mapping->GetData() + m_pos, size);
+            m_pos += size;
+            return true;
         }
 
-        // loadup liquid data
-        if (header.liquidMapOffset && !loadGridMapLiquidData(in, header.liquidMapOffset, header.liquidMapSize))
+        // points array into the mapping, sections read through stdio or not aligned for T are copied to the heap
+        template<typename T>
+        bool ReadArray(T const*& array, size_t count)
         {
-            sLog.outError("Error loading map liquids data\n");
-            fclose(in);
-            return false;
+            if (m_mapping)
+            {
+                uint8 const* data = m_mapping->GetData() + m_pos;
+                if (!m_mapping->Contains(data, count * sizeof(T)))
+                    return false;
+
+                if (reinterpret_cast<uintptr_t>(data) % alignof(T) == 0)
+                {
+                    array = reinterpret_cast<T const*>(data);
+                    m_pos += count * sizeof(T);
+                    return true;
+                }
+            }
+
+            T* copy = new T[count];
+            if (!Read(copy, count * sizeof(T)))
+            {
+                delete[] copy;
+                return false;
+            }
+
+            array = copy;
+            return true;
         }
 
-        fclose(in);
-        return true;
+    private:
+        FILE* m_file;
+        MaNGOS::MappedFile const* m_mapping;
+        size_t m_pos;
+};
+
+bool GridMap::loadData(char* filename, bool memoryMapped)
+{
+    // Unload old data if exist
+    unloadData();
+
+    // Not return error if file not found
+    FILE* in = nullptr;
+    if (!memoryMapped || !m_mapping.Open(filename))
+    {
+        in = fopen(filename, "rb");
+        if (!in)
+            return true;
     }
 
-    sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.", filename);
-    fclose(in);
-    return false;
+    GridMapReader reader = in ? GridMapReader(in) : GridMapReader(m_mapping);
+    GridMapFileHeader header;
+    bool result = false;
+
+    if (!reader.Read(&header, sizeof(header)) ||
+            header.mapMagic     != *((uint32 const*)(MAP_MAGIC)) ||
+            header.versionMagic != *((uint32 const*)(MAP_VERSION_MAGIC)))
+        sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.", filename);
+    // loadup area data
+    else if (header.areaMapOffset && !loadAreaData(reader, header.areaMapOffset, header.areaMapSize))
+        sLog.outError("Error loading map area data\n");
+    // loadup holes data
+    else if (header.holesOffset && !loadHolesData(reader, header.holesOffset, header.holesSize))
+        sLog.outError("Error loading map holes data\n");
+    // loadup height data
+    else if (header.heightMapOffset && !loadHeightData(reader, header.heightMapOffset, header.heightMapSize))
+        sLog.outError("Error loading map height data\n");
+    // loadup liquid data
+    else if (header.liquidMapOffset && !loadGridMapLiquidData(reader, header.liquidMapOffset, header.liquidMapSize))
+        sLog.outError("Error loading map liquids data\n");
+    else
+        result = true;
+
+    if (in)
+        fclose(in);
+    return result;
+}
+
+template<typename T>
+void GridMap::unloadArray(T const*& array)
+{
+    if (array && !m_mapping.Contains(array))
+        delete[] array;
+    array = nullptr;
 }
 
 void GridMap::unloadData()
 {
-    delete[] m_area_map;
-    delete[] m_V9;
-    delete[] m_V8;
-    delete[] m_liquidEntry;
-    delete[] m_liquidFlags;
-    delete[] m_liquid_map;
+    unloadArray(m_area_map);
+    unloadArray(m_V9);
+    unloadArray(m_V8);
+    unloadArray(m_liquidEntry);
+    unloadArray(m_liquidFlags);
+    unloadArray(m_liquid_map);
+    m_mapping.Close();
 
-    m_area_map = nullptr;
-    m_V9 = nullptr;
-    m_V8 = nullptr;
-    m_liquidEntry = nullptr;
-    m_liquidFlags = nullptr;
-    m_liquid_map  = nullptr;
     m_gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
-bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadAreaData(GridMapReader& in, uint32 offset, uint32 /*size*/)
 {
     GridMapAreaHeader header;
-    fseek(in, offset, SEEK_SET);
-    fread(&header, sizeof(header), 1, in);
+    if (!in.Seek(offset) || !in.Read(&header, sizeof(header)))
+        return false;
     if (header.fourcc != *((uint32 const*)(MAP_AREA_MAGIC)))
         return false;
 
     m_gridArea = header.gridArea;
     if (!(header.flags & MAP_AREA_NO_AREA))
-    {
-        m_area_map = new uint16 [16 * 16];
-        fread(m_area_map, sizeof(uint16), 16 * 16, in);
-    }
+        return in.ReadArray(m_area_map, 16 * 16);
 
     return true;
 }
 
-bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadHeightData(GridMapReader& in, uint32 offset, uint32 /*size*/)
 {
     GridMapHeightHeader header;
-    fseek(in, offset, SEEK_SET);
-    fread(&header, sizeof(header), 1, in);
+    if (!in.Seek(offset) || !in.Read(&header, sizeof(header)))
+        return false;
     if (header.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
         return false;
 
@@ -176,28 +231,22 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     {
         if ((header.flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16 [129 * 129];
-            m_uint16_V8 = new uint16 [128 * 128];
-            fread(m_uint16_V9, sizeof(uint16), 129 * 129, in);
-            fread(m_uint16_V8, sizeof(uint16), 128 * 128, in);
+            if (!in.ReadArray(m_uint16_V9, 129 * 129) || !in.ReadArray(m_uint16_V8, 128 * 128))
+                return false;
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
             m_gridGetHeight = &GridMap::getHeightFromUint16;
         }
         else if ((header.flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8 [129 * 129];
-            m_uint8_V8 = new uint8 [128 * 128];
-            fread(m_uint8_V9, sizeof(uint8), 129 * 129, in);
-            fread(m_uint8_V8, sizeof(uint8), 128 * 128, in);
+            if (!in.ReadArray(m_uint8_V9, 129 * 129) || !in.ReadArray(m_uint8_V8, 128 * 128))
+                return false;
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
             m_gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float [129 * 129];
-            m_V8 = new float [128 * 128];
-            fread(m_V9, sizeof(float), 129 * 129, in);
-            fread(m_V8, sizeof(float), 128 * 128, in);
+            if (!in.ReadArray(m_V9, 129 * 129) || !in.ReadArray(m_V8, 128 * 128))
+                return false;
             m_gridGetHeight = &GridMap::getHeightFromFloat;
         }
     }
@@ -207,21 +256,21 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     return true;
 }
 
-bool GridMap::loadHolesData(FILE* in, uint32 offset, uint32 size)
+bool GridMap::loadHolesData(GridMapReader& in, uint32 offset, uint32 /*size*/)
 {
-    if (fseek(in, offset, SEEK_SET) != 0)
+    if (!in.Seek(offset))
         return false;
 
-    if (fread(&m_holes, sizeof(m_holes), 1, in) != 1)
+    if (!in.Read(&m_holes, sizeof(m_holes)))
         return false;
     return true;
 }
 
-bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadGridMapLiquidData(GridMapReader& in, uint32 offset, uint32 /*size*/)
 {
     GridMapLiquidHeader header;
-    fseek(in, offset, SEEK_SET);
-    fread(&header, sizeof(header), 1, in);
+    if (!in.Seek(offset) || !in.Read(&header, sizeof(header)))
+        return false;
     if (header.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
         return false;
 
@@ -234,17 +283,14 @@ bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
 
     if (!(header.flags & MAP_LIQUID_NO_TYPE))
     {
-        m_liquidEntry = new uint16[16 * 16];
-        fread(m_liquidEntry, sizeof(uint16), 16 * 16, in);
-
-        m_liquidFlags = new uint8[16 * 16];
-        fread(m_liquidFlags, sizeof(uint8), 16 * 16, in);
+        if (!in.ReadArray(m_liquidEntry, 16 * 16) || !in.ReadArray(m_liquidFlags, 16 * 16))
+            return false;
     }
 
     if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
     {
-        m_liquid_map = new float [m_liquid_width * m_liquid_height];
-        fread(m_liquid_map, sizeof(float), m_liquid_width * m_liquid_height, in);
+        if (!in.ReadArray(m_liquid_map, m_liquid_width * m_liquid_height))
+            return false;
     }
 
     return true;
@@ -380,7 +426,7 @@ float GridMap::getHeightFromUint8(float x, float y) const
     y_int &= (MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint8* V9_h1_ptr = &m_uint8_V9[x_int * 128 + x_int + y_int];
+    uint8 const* V9_h1_ptr = &m_uint8_V9[x_int * 128 + x_int + y_int];
     if (x + y < 1)
     {
         if (x > y)
@@ -448,7 +494,7 @@ float GridMap::getHeightFromUint16(float x, float y) const
     y_int &= (MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint16* V9_h1_ptr = &m_uint16_V9[x_int * 128 + x_int + y_int];
+    uint16 const* V9_h1_ptr = &m_uint16_V9[x_int * 128 + x_int + y_int];
     if (x + y < 1)
     {
         if (x > y)
@@ -686,7 +732,7 @@ bool GridMap::ExistVMap(uint32 mapid, int gx, int gy)
 }
 
 //////////////////////////////////////////////////////////////////////////
-TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
+TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid), m_vmapGeneration(0)
 {
     for (int k = 0; k < MAX_NUMBER_OF_GRIDS; ++k)
     {
@@ -694,6 +740,8 @@ TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
         {
             m_GridMaps[i][k] = nullptr;
             m_GridRef[i][k] = 0;
+            m_PreloadedMaps[i][k] = nullptr;
+            m_PreloadedStale[i][k] = false;
         }
     }
 
@@ -710,7 +758,10 @@ TerrainInfo::~TerrainInfo()
 {
     for (int k = 0; k < MAX_NUMBER_OF_GRIDS; ++k)
         for (int i = 0; i < MAX_NUMBER_OF_GRIDS; ++i)
+        {
             delete m_GridMaps[i][k];
+            delete m_PreloadedMaps[i][k];
+        }
 
     VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId);
     MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId);
@@ -759,22 +810,45 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
     {
         for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
         {
+            // preloaded tiles are kept for one full interval
+            if (m_PreloadedMaps[x][y])
+            {
+                LOCK_GUARD lock(m_mutex);
+
+                if (GridMap* pPreloaded = m_PreloadedMaps[x][y])
+                {
+                    if (m_PreloadedStale[x][y])
+                    {
+                        m_PreloadedMaps[x][y] = nullptr;
+                        delete pPreloaded;
+                        ++GridPreloader::GetStatistics().wasted;
+                    }
+                    else
+                        m_PreloadedStale[x][y] = true;
+                }
+            }
+
             const int16& iRef = m_GridRef[x][y];
             GridMap* pMap = m_GridMaps[x][y];
 
             // delete those GridMap objects which have refcount = 0
             if (pMap && iRef == 0)
             {
-                m_GridMaps[x][y] = nullptr;
+                {
+                    // preload threads look at the loaded grids under this lock
+                    LOCK_GUARD lock(m_mutex);
+                    m_GridMaps[x][y] = nullptr;
+                }
                 // delete grid data if reference count == 0
                 pMap->unloadData();
                 delete pMap;
 
                 // unload VMAPS...
                 VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId, x, y);
+                ++m_vmapGeneration;
 
-                // unload mmap...
-                MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId, x, y);
+                // the navmesh tile stays until it is unused for a while
+                MMAP::MMapFactory::createOrGetMMapManager()->ReleaseGridTile(m_mapId, x, y);
             }
         }
     }
@@ -840,6 +914,84 @@ float TerrainInfo::GetHeightStatic(float x, float y, float z, bool useVmaps/*=tr
         }
     }
 
+    return SelectStaticHeight(z, mapHeight, vmapHeight);
+}
+
+void TerrainInfo::GetHeightStatic(StaticHeightQuery* queries, uint32 count, bool useVmaps/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/) const
+{
+    std::vector<float> mapHeights(count, VMAP_INVALID_HEIGHT_VALUE);
+    std::vector<VMAP::HeightQuery> vmapQueries(count);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        StaticHeightQuery const& query = queries[i];
+        if (GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(query.x, query.y))
+            mapHeights[i] = gmap->getHeight(query.x, query.y);
+
+        // same search ranges as the single point version
+        VMAP::HeightQuery& vmapQuery = vmapQueries[i];
+        vmapQuery.x = query.x;
+        vmapQuery.y = query.y;
+        vmapQuery.z = query.z + 2.f;
+        vmapQuery.maxSearchDist = maxSearchDist;
+        if (mapHeights[i] > INVALID_HEIGHT && vmapQuery.z - mapHeights[i] > maxSearchDist)
+            vmapQuery.maxSearchDist = vmapQuery.z - mapHeights[i] + 1.0f;
+        vmapQuery.height = VMAP_INVALID_HEIGHT_VALUE;
+    }
+
+    if (useVmaps)
+    {
+        VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
+        if (vmgr->isHeightCalcEnabled())
+        {
+            vmgr->getHeight(GetMapId(), vmapQueries.data(), count);
+
+            // points not found are searched again with the wider ranges, one batch per stage
+            std::vector<uint32> retryIndex;
+            std::vector<VMAP::HeightQuery> retryQueries;
+            for (uint32 i = 0; i < count; ++i)
+            {
+                if (vmapQueries[i].height <= INVALID_HEIGHT)
+                {
+                    retryIndex.push_back(i);
+                    retryQueries.push_back(vmapQueries[i]);
+                    retryQueries.back().maxSearchDist = 10000.0f;
+                }
+            }
+            if (!retryQueries.empty())
+            {
+                vmgr->getHeight(GetMapId(), retryQueries.data(), retryQueries.size());
+                for (uint32 i = 0; i < retryIndex.size(); ++i)
+                    vmapQueries[retryIndex[i]].height = retryQueries[i].height;
+            }
+
+            retryIndex.clear();
+            retryQueries.clear();
+            for (uint32 i = 0; i < count; ++i)
+            {
+                if (vmapQueries[i].height <= INVALID_HEIGHT && mapHeights[i] > INVALID_HEIGHT && vmapQueries[i].z < mapHeights[i])
+                {
+                    retryIndex.push_back(i);
+                    retryQueries.push_back(vmapQueries[i]);
+                    retryQueries.back().z = mapHeights[i] + 2.0f;
+                    retryQueries.back().maxSearchDist = DEFAULT_HEIGHT_SEARCH;
+                }
+            }
+            if (!retryQueries.empty())
+            {
+                vmgr->getHeight(GetMapId(), retryQueries.data(), retryQueries.size());
+                for (uint32 i = 0; i < retryIndex.size(); ++i)
+                    vmapQueries[retryIndex[i]].height = retryQueries[i].height;
+            }
+        }
+    }
+
+    for (uint32 i = 0; i < count; ++i)
+        queries[i].height = SelectStaticHeight(queries[i].z, mapHeights[i], vmapQueries[i].height);
+}
+
+float TerrainInfo::SelectStaticHeight(float z, float mapHeight, float vmapHeight)
+{
     // mapHeight set for any above raw ground Z or <= INVALID_HEIGHT
     // vmapheight set for any under Z value or <= INVALID_HEIGHT
     if (vmapHeight > INVALID_HEIGHT)
@@ -1074,12 +1226,12 @@ bool TerrainInfo::IsUnderWater(float x, float y, float z) const
  *
  * @return           calculated z coordinate
  */
-float TerrainInfo::GetWaterOrGroundLevel(float x, float y, float z, float* pGround /*= nullptr*/, bool swim /*= false*/) const
+float TerrainInfo::GetWaterOrGroundLevel(float x, float y, float z, float* pGround /*= nullptr*/, bool swim /*= false*/, float const* staticHeight /*= nullptr*/) const
 {
     if (const_cast<TerrainInfo*>(this)->GetGrid(x, y))
     {
         // we need ground level (including grid height version) for proper return water level in point
-        float ground_z = GetHeightStatic(x, y, z, true, DEFAULT_WATER_SEARCH);
+        float ground_z = staticHeight ? *staticHeight : GetHeightStatic(x, y, z, true, DEFAULT_WATER_SEARCH);
         if (pGround)
             *pGround = ground_z;
 
@@ -1115,21 +1267,22 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
 
         if (!m_GridMaps[x][y])
         {
-            GridMap* map = new GridMap();
-
-            // map file name
-            int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
-            char* tmp = new char[len];
-            snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
+            GridPreloadStatistics& statistics = GridPreloader::GetStatistics();
+            GridMap* map = m_PreloadedMaps[x][y];
 
-            if (!map->loadData(tmp))
+            if (map)
+            {
+                m_PreloadedMaps[x][y] = nullptr;
+                ++statistics.hits;
+            }
+            else
             {
-                sLog.outError("Error load map file: \n %s\n", tmp);
-                // ASSERT(false);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                map = LoadGridMap(x, y);
+                ++statistics.misses;
+                statistics.syncLoadTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
             }
 
-            delete[] tmp;
             m_GridMaps[x][y] = map;
 
             // load VMAPs for current map/grid...
@@ -1141,6 +1294,7 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
             {
                 case VMAP::VMAP_LOAD_RESULT_OK:
                     DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "VMAP loaded name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
+                    ++m_vmapGeneration;
                     break;
                 case VMAP::VMAP_LOAD_RESULT_ERROR:
                     DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Could not load VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
@@ -1150,14 +1304,61 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
                     break;
             }
 
-            // load navmesh
-            MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y);
+            // load navmesh, tiles outside of loaded grids are loaded when paths are asked for on them
+            MMAP::MMapFactory::createOrGetMMapManager()->LoadGridTile(m_mapId, x, y);
         }
     }
 
     return  m_GridMaps[x][y];
 }
 
+GridMap* TerrainInfo::LoadGridMap(const uint32 x, const uint32 y) const
+{
+    GridMap* map = new GridMap();
+
+    // map file name
+    int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
+    char* tmp = new char[len];
+    snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
+    DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
+
+    if (!map->loadData(tmp, sWorld.getConfig(CONFIG_BOOL_GRIDMAP_MEMORY_MAPPED)))
+    {
+        sLog.outError("Error load map file: \n %s\n", tmp);
+        // ASSERT(false);
+    }
+
+    delete[] tmp;
+    return map;
+}
+
+bool TerrainInfo::Preload(const uint32 x, const uint32 y)
+{
+    MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
+    MANGOS_ASSERT(y < MAX_NUMBER_OF_GRIDS);
+
+    if (!IsPreloadNeeded(x, y))
+        return false;
+
+    // read the tile without holding the lock, map updates may need it for other tiles meanwhile
+    GridMap* map = LoadGridMap(x, y);
+    map->prefetchData();
+
+    LOCK_GUARD lock(m_mutex);
+
+    if (!IsPreloadNeeded(x, y))
+    {
+        // a map update was faster
+        delete map;
+        ++GridPreloader::GetStatistics().wasted;
+        return false;
+    }
+
+    m_PreloadedMaps[x][y] = map;
+    m_PreloadedStale[x][y] = false;
+    return true;
+}
+
 float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= nullptr*/) const
 {
     if (const_cast<TerrainInfo*>(this)->GetGrid(x, y))
@@ -22,6 +22,7 @@
 #include "Platform/Define.h"
 #include "Policies/Singleton.h"
 #include "Maps/GridDefines.h"
+#include "MappedFile.h"
 
 #include <atomic>
 #include <mutex>
@@ -33,6 +34,7 @@ class InstanceData;
 class Group;
 class BattleGround;
 class Map;
+class GridMapReader;
 
 struct GridMapFileHeader
 {
@@ -122,22 +124,22 @@ class GridMap
 
         // Area data
         uint16 m_gridArea;
-        uint16* m_area_map;
+        uint16 const* m_area_map;
 
         // Height level data
         float m_gridHeight;
         float m_gridIntHeightMultiplier;
         union
         {
-            float* m_V9;
-            uint16* m_uint16_V9;
-            uint8* m_uint8_V9;
+            float const* m_V9;
+            uint16 const* m_uint16_V9;
+            uint8 const* m_uint8_V9;
         };
         union
         {
-            float* m_V8;
-            uint16* m_uint16_V8;
-            uint8* m_uint8_V8;
+            float const* m_V8;
+            uint16 const* m_uint16_V8;
+            uint8 const* m_uint8_V8;
         };
 
         // Liquid data
@@ -147,14 +149,19 @@ class GridMap
         uint8 m_liquid_width;
         uint8 m_liquid_height;
         float m_liquidLevel;
-        uint16* m_liquidEntry;
-        uint8* m_liquidFlags;
-        float* m_liquid_map;
-
-        bool loadAreaData(FILE* in, uint32 offset, uint32 size);
-        bool loadHeightData(FILE* in, uint32 offset, uint32 size);
-        bool loadGridMapLiquidData(FILE* in, uint32 offset, uint32 size);
-        bool loadHolesData(FILE* in, uint32 offset, uint32 size);
+        uint16 const* m_liquidEntry;
+        uint8 const* m_liquidFlags;
+        float const* m_liquid_map;
+
+        // mapping of the tile file the arrays above point into, if it was loaded memory mapped
+        MaNGOS::MappedFile m_mapping;
+
+        bool loadAreaData(GridMapReader& in, uint32 offset, uint32 size);
+        bool loadHeightData(GridMapReader& in, uint32 offset, uint32 size);
+        bool loadGridMapLiquidData(GridMapReader& in, uint32 offset, uint32 size);
+        bool loadHolesData(GridMapReader& in, uint32 offset, uint32 size);
+        template<typename T>
+        void unloadArray(T const*& array);
         bool isHole(int row, int col) const;
 
         // Get height functions and pointers
@@ -170,8 +177,11 @@ class GridMap
         GridMap();
         ~GridMap();
 
-        bool loadData(char* filaname);
+        // memoryMapped maps the tile instead of reading it, falls back to reading if mapping fails
+        bool loadData(char* filaname, bool memoryMapped = false);
         void unloadData();
+        // reads the pages of a memory mapped tile ahead of use
+        void prefetchData() const { m_mapping.Prefetch(); }
 
         static bool ExistMap(uint32 mapid, int gx, int gy);
         static bool ExistVMap(uint32 mapid, int gx, int gy);
@@ -207,6 +217,13 @@ class Referencable
 #define DEFAULT_HEIGHT_SEARCH     10.0f                     // default search distance to find height at nearby locations
 #define DEFAULT_WATER_SEARCH      50.0f                     // default search distance to case detection water level
 
+// one point of a batched TerrainInfo::GetHeightStatic call
+struct StaticHeightQuery
+{
+    float x, y, z;
+    float height;                                           // result, same as the single point version would return
+};
+
 // class for sharing and managin GridMap objects
 class TerrainInfo : public Referencable<std::atomic_long>
 {
@@ -215,12 +232,18 @@ class TerrainInfo : public Referencable<std::atomic_long>
         ~TerrainInfo();
 
         uint32 GetMapId() const { return m_mapId; }
+        // changes whenever a vmap tile of the terrain is loaded or unloaded
+        uint32 GetVMapGeneration() const { return m_vmapGeneration; }
 
         // TODO: move all terrain/vmaps data info query functions
         // from 'Map' class into this class
         float GetHeightStatic(float x, float y, float z, bool checkVMap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
+        // many points at once, the vmap searches of all points are done in batches
+        // maxSearchDist only limits the first vmap search, so the heights also serve callers using another distance
+        void GetHeightStatic(StaticHeightQuery* queries, uint32 count, bool checkVMap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
         float GetWaterLevel(float x, float y, float z, float* pGround = nullptr) const;
-        float GetWaterOrGroundLevel(float x, float y, float z, float* pGround = nullptr, bool swim = false) const;
+        // staticHeight: GetHeightStatic result for x, y, z if already known
+        float GetWaterOrGroundLevel(float x, float y, float z, float* pGround = nullptr, bool swim = false, float const* staticHeight = nullptr) const;
         bool IsInWater(float x, float y, float z, GridMapLiquidData* data = nullptr) const;
         bool IsSwimmable(float x, float y, float pZ, float radius = 1.5f, GridMapLiquidData* data = nullptr) const;
         bool IsUnderWater(float x, float y, float z) const;
@@ -244,6 +267,10 @@ class TerrainInfo : public Referencable<std::atomic_long>
         // THIS METHOD IS NOT THREAD-SAFE!!!! AND IT SHOULDN'T BE THREAD-SAFE!!!!
         void CleanUpGrids(const uint32 diff);
 
+        // used by GridPreloader to read a tile before any map needs it
+        bool IsPreloadNeeded(const uint32 x, const uint32 y) const { return !m_GridMaps[x][y] && !m_PreloadedMaps[x][y]; }
+        bool Preload(const uint32 x, const uint32 y);
+
     protected:
         friend class Map;
         // load/unload terrain data
@@ -254,8 +281,11 @@ class TerrainInfo : public Referencable<std::atomic_long>
         TerrainInfo(const TerrainInfo&);
         TerrainInfo& operator=(const TerrainInfo&);
 
+        static float SelectStaticHeight(float z, float mapHeight, float vmapHeight);
+
         GridMap* GetGrid(const float x, const float y);
         GridMap* LoadMapAndVMap(const uint32 x, const uint32 y);
+        GridMap* LoadGridMap(const uint32 x, const uint32 y) const;
 
         int RefGrid(const uint32& x, const uint32& y);
         int UnrefGrid(const uint32& x, const uint32& y);
@@ -265,6 +295,12 @@ class TerrainInfo : public Referencable<std::atomic_long>
         GridMap* m_GridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
         int16 m_GridRef[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
+        // tiles read by GridPreloader which no map has loaded yet, stale ones are dropped at the next clean up
+        GridMap* m_PreloadedMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+        bool m_PreloadedStale[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+
+        std::atomic<uint32> m_vmapGeneration;
+
         // global garbage collection timer
         ShortIntervalTimer i_timer;
 
@@ -0,0 +1,176 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/GridPreloader.h"
+#include "Maps/GridMap.h"
+#include "World/World.h"
+#include "MappedFile.h"
+#include "MapTree.h"
+#include "VMapFactory.h"
+#include "Log.h"
+
+#include <chrono>
+
+GridPreloader::GridPreloader() : m_cancel(false)
+{
+}
+
+GridPreloader::~GridPreloader()
+{
+    Deactivate();
+}
+
+void GridPreloader::Activate(uint32 numThreads)
+{
+    Deactivate();
+
+    m_cancel = false;
+    for (uint32 i = 0; i < numThreads; ++i)
+        m_workerThreads.push_back(std::thread(&GridPreloader::WorkerThread, this));
+
+    sLog.outString("Grid preloader: %u threads started", numThreads);
+}
+
+void GridPreloader::Deactivate()
+{
+    if (m_workerThreads.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        m_cancel = true;
+
+        // drop what was not started yet, the terrain references are released below
+        for (std::deque<PreloadRequest>::const_iterator itr = m_queue.begin(); itr != m_queue.end(); ++itr)
+            m_finished.push_back(*itr);
+        m_queue.clear();
+    }
+    m_queueCondition.notify_all();
+
+    for (std::vector<std::thread>::iterator itr = m_workerThreads.begin(); itr != m_workerThreads.end(); ++itr)
+        itr->join();
+
+    m_workerThreads.clear();
+    m_pending.clear();
+
+    Update();
+}
+
+void GridPreloader::Preload(TerrainInfo* terrain, uint32 x, uint32 y)
+{
+    if (!IsActive() || !terrain->IsPreloadNeeded(x, y))
+        return;
+
+    PreloadRequest request(terrain, x, y);
+
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        if (!m_pending.insert(GetRequestKey(request)).second)
+            return;
+
+        // keep the terrain alive until Update has seen the request finished
+        terrain->AddRef();
+        m_queue.push_back(request);
+    }
+    m_queueCondition.notify_one();
+
+    ++GetStatistics().requested;
+}
+
+void GridPreloader::Update()
+{
+    std::vector<PreloadRequest> finished;
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        finished.swap(m_finished);
+    }
+
+    for (std::vector<PreloadRequest>::const_iterator itr = finished.begin(); itr != finished.end(); ++itr)
+    {
+        // the last map using the terrain may have been unloaded meanwhile
+        if (itr->terrain->Release())
+            sTerrainMgr.UnloadTerrain(itr->terrain->GetMapId());
+    }
+}
+
+GridPreloadStatistics& GridPreloader::GetStatistics()
+{
+    static GridPreloadStatistics statistics;
+    return statistics;
+}
+
+uint32 GridPreloader::GetRequestKey(PreloadRequest const& request)
+{
+    return (request.terrain->GetMapId() << 12) | (request.x << 6) | request.y;
+}
+
+void GridPreloader::PrefetchFile(std::string const& filename)
+{
+    MaNGOS::MappedFile file;
+    if (file.Open(filename.c_str()))
+        file.Prefetch();
+}
+
+void GridPreloader::WorkerThread()
+{
+    for (;;)
+    {
+        std::unique_lock<std::mutex> guard(m_queueLock);
+        m_queueCondition.wait(guard, [this] { return m_cancel || !m_queue.empty(); });
+
+        if (m_cancel)
+            return;
+
+        PreloadRequest request = m_queue.front();
+        m_queue.pop_front();
+        guard.unlock();
+
+        ProcessRequest(request);
+
+        guard.lock();
+        m_pending.erase(GetRequestKey(request));
+        m_finished.push_back(request);
+    }
+}
+
+void GridPreloader::ProcessRequest(PreloadRequest const& request)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (!request.terrain->Preload(request.x, request.y))
+        return;
+
+    // vmap and mmap tiles are linked into trees shared with running queries,
+    // so only their files are read here and the map update links them from the page cache
+    uint32 mapId = request.terrain->GetMapId();
+    if (VMAP::VMapFactory::createOrGetVMapManager()->isMapLoadingEnabled())
+        PrefetchFile(sWorld.GetDataPath() + "vmaps/" + VMAP::StaticMapTree::getTileFileName(mapId, request.x, request.y));
+
+    if (sWorld.getConfig(CONFIG_BOOL_MMAP_ENABLED))
+    {
+        char tileName[32];
+        snprintf(tileName, sizeof(tileName), "mmaps/%03u%02u%02u.mmtile", mapId, request.x, request.y);
+        PrefetchFile(sWorld.GetDataPath() + tileName);
+    }
+
+    std::chrono::microseconds elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    GridPreloadStatistics& statistics = GetStatistics();
+    ++statistics.loaded;
+    statistics.loadTime += elapsed.count();
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_GRIDPRELOADER_H
+#define MANGOS_GRIDPRELOADER_H
+
+#include "Common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+class TerrainInfo;
+
+/// Counters of the grid preloader, times in microseconds
+struct GridPreloadStatistics
+{
+    GridPreloadStatistics() : requested(0), loaded(0), hits(0), misses(0), wasted(0), loadTime(0), syncLoadTime(0) {}
+
+    std::atomic<uint64> requested;                          // tiles queued for preloading
+    std::atomic<uint64> loaded;                             // tiles read by the preload threads
+    std::atomic<uint64> hits;                               // grid loads which found their tile preloaded
+    std::atomic<uint64> misses;                             // grid loads which had to read their tile in the map update
+    std::atomic<uint64> wasted;                             // preloaded tiles dropped without being used
+    std::atomic<uint64> loadTime;                           // time spent by the preload threads
+    std::atomic<uint64> syncLoadTime;                       // time spent reading tiles in the map update
+};
+
+/**
+ * Pool of threads reading terrain tiles before a grid is entered.
+ *
+ * Maps predict the grids their players are heading to and queue them here. The preload
+ * threads read the GridMap of the tile into the TerrainInfo and pull the vmap and mmap tile
+ * files into the page cache, so the map update only has to link the already read data.
+ * Spawning the objects of a grid still happens in the map update.
+ */
+class GridPreloader
+{
+    public:
+        GridPreloader();
+        ~GridPreloader();
+
+        void Activate(uint32 numThreads);
+        void Deactivate();
+        bool IsActive() const { return !m_workerThreads.empty(); }
+        uint32 GetThreadCount() const { return m_workerThreads.size(); }
+
+        // map update threads only, x and y are terrain tile coordinates
+        void Preload(TerrainInfo* terrain, uint32 x, uint32 y);
+
+        // world thread only, releases the terrain of finished requests
+        void Update();
+
+        static GridPreloadStatistics& GetStatistics();
+
+    private:
+        struct PreloadRequest
+        {
+            PreloadRequest(TerrainInfo* _terrain, uint32 _x, uint32 _y) : terrain(_terrain), x(_x), y(_y) {}
+
+            TerrainInfo* terrain;
+            uint32 x;
+            uint32 y;
+        };
+
+        GridPreloader(GridPreloader const&);
+        GridPreloader& operator=(GridPreloader const&);
+
+        static uint32 GetRequestKey(PreloadRequest const& request);
+        static void PrefetchFile(std::string const& filename);
+
+        void WorkerThread();
+        void ProcessRequest(PreloadRequest const& request);
+
+        std::vector<std::thread> m_workerThreads;
+
+        std::mutex m_queueLock;
+        std::condition_variable m_queueCondition;
+        std::deque<PreloadRequest> m_queue;
+        std::unordered_set<uint32> m_pending;               // queued and running requests
+        std::vector<PreloadRequest> m_finished;
+        bool m_cancel;
+};
+
+#endif
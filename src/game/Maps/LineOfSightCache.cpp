@@ -0,0 +1,136 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/LineOfSightCache.h"
+#include "Timer.h"
+
+#include <cmath>
+
+LineOfSightCache::Key::Key(float x1, float y1, float z1, float x2, float y2, float z2)
+{
+    coords[0] = int32(std::floor(x1 / LOS_CACHE_PRECISION));
+    coords[1] = int32(std::floor(y1 / LOS_CACHE_PRECISION));
+    coords[2] = int32(std::floor(z1 / LOS_CACHE_PRECISION));
+    coords[3] = int32(std::floor(x2 / LOS_CACHE_PRECISION));
+    coords[4] = int32(std::floor(y2 / LOS_CACHE_PRECISION));
+    coords[5] = int32(std::floor(z2 / LOS_CACHE_PRECISION));
+}
+
+bool LineOfSightCache::Key::operator==(Key const& other) const
+{
+    for (int i = 0; i < 6; ++i)
+        if (coords[i] != other.coords[i])
+            return false;
+    return true;
+}
+
+uint32 LineOfSightCache::Key::GetHash() const
+{
+    // FNV-1a over the rounded coordinates
+    uint32 hash = 2166136261u;
+    for (int i = 0; i < 6; ++i)
+    {
+        hash ^= uint32(coords[i]);
+        hash *= 16777619u;
+    }
+    return hash ^ (hash >> 16);
+}
+
+LineOfSightCache::LineOfSightCache() : m_mask(0), m_expiry(0), m_dynamicGeneration(0)
+{
+}
+
+void LineOfSightCache::Initialize(uint32 size, uint32 expiry)
+{
+    m_entries.clear();
+    m_mask = 0;
+    m_expiry = expiry;
+
+    if (!size)
+        return;
+
+    uint32 tableSize = 1;
+    while (tableSize < size)
+        tableSize <<= 1;
+
+    m_entries.resize(tableSize);
+    m_mask = tableSize - 1;
+}
+
+LineOfSightCache::LookupResult LineOfSightCache::Lookup(Key const& key, uint32 staticGeneration, bool& staticResult, bool& result)
+{
+    Entry const& entry = m_entries[key.GetHash() & m_mask];
+
+    LookupResult lookup = LOS_CACHE_MISS;
+    if (entry.used && entry.key == key && entry.staticGeneration == staticGeneration
+            && WorldTimer::getMSTimeDiff(entry.storeTime, WorldTimer::getMSTime()) <= m_expiry)
+    {
+        staticResult = entry.staticResult;
+        result = entry.result;
+        lookup = entry.dynamicGeneration == m_dynamicGeneration ? LOS_CACHE_HIT : LOS_CACHE_STATIC;
+    }
+
+    LineOfSightCacheStatistics& global = GetGlobalStatistics();
+    switch (lookup)
+    {
+        case LOS_CACHE_HIT:
+            ++m_statistics.hits;
+            ++global.hits;
+            break;
+        case LOS_CACHE_STATIC:
+            ++m_statistics.staticHits;
+            ++global.staticHits;
+            break;
+        case LOS_CACHE_MISS:
+            ++m_statistics.misses;
+            ++global.misses;
+            break;
+    }
+
+    return lookup;
+}
+
+void LineOfSightCache::Store(Key const& key, uint32 staticGeneration, bool staticResult, bool result)
+{
+    Entry& entry = m_entries[key.GetHash() & m_mask];
+    entry.key = key;
+    entry.storeTime = WorldTimer::getMSTime();
+    entry.staticGeneration = staticGeneration;
+    entry.dynamicGeneration = m_dynamicGeneration;
+    entry.staticResult = staticResult;
+    entry.result = result;
+    entry.used = true;
+}
+
+void LineOfSightCache::InvalidateDynamic()
+{
+    if (!IsEnabled())
+        return;
+
+    // entries of older generations keep their static result
+    ++m_dynamicGeneration;
+
+    ++m_statistics.invalidations;
+    ++GetGlobalStatistics().invalidations;
+}
+
+LineOfSightCacheStatistics& LineOfSightCache::GetGlobalStatistics()
+{
+    static LineOfSightCacheStatistics statistics;
+    return statistics;
+}
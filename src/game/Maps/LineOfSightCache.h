@@ -0,0 +1,110 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_LINEOFSIGHTCACHE_H
+#define MANGOS_LINEOFSIGHTCACHE_H
+
+#include "Common.h"
+
+#include <atomic>
+#include <vector>
+
+#define LOS_CACHE_PRECISION 0.5f                            // ray endpoints closer than this share a cache entry
+
+/// Counters of line of sight caches
+struct LineOfSightCacheStatistics
+{
+    LineOfSightCacheStatistics() : hits(0), staticHits(0), misses(0), invalidations(0) {}
+
+    std::atomic<uint64> hits;                               // rays answered from the cache
+    std::atomic<uint64> staticHits;                         // rays which only had to check dynamic objects again
+    std::atomic<uint64> misses;                             // rays traced completely
+    std::atomic<uint64> invalidations;                      // dynamic object changes dropping the cached dynamic results
+};
+
+/**
+ * Recent line of sight results of one map.
+ *
+ * A ray is keyed on its endpoints rounded to LOS_CACHE_PRECISION, so casters checking
+ * the same target spell after spell only trace it once. The result against the static
+ * vmap models is kept apart from the one including dynamic objects: opening a door only
+ * costs the dynamic check again, while loading or unloading a vmap tile of the terrain
+ * drops everything. Entries also expire after a while, as moving inside the rounding
+ * does not change the key. The table has a fixed size and a new ray replaces whatever
+ * was stored in its slot.
+ */
+class LineOfSightCache
+{
+    public:
+        enum LookupResult
+        {
+            LOS_CACHE_MISS,                                 // nothing valid is known about the ray
+            LOS_CACHE_STATIC,                               // only the static result is still valid
+            LOS_CACHE_HIT,                                  // both results are valid
+        };
+
+        struct Key
+        {
+            Key() {}
+            Key(float x1, float y1, float z1, float x2, float y2, float z2);
+
+            bool operator==(Key const& other) const;
+            uint32 GetHash() const;
+
+            int32 coords[6];
+        };
+
+        LineOfSightCache();
+
+        // size is rounded up to a power of two, 0 disables the cache
+        void Initialize(uint32 size, uint32 expiry);
+        bool IsEnabled() const { return !m_entries.empty(); }
+
+        // staticGeneration is the vmap generation of the terrain, see TerrainInfo::GetVMapGeneration
+        LookupResult Lookup(Key const& key, uint32 staticGeneration, bool& staticResult, bool& result);
+        void Store(Key const& key, uint32 staticGeneration, bool staticResult, bool result);
+
+        // the dynamic objects of the map changed
+        void InvalidateDynamic();
+
+        LineOfSightCacheStatistics const& GetStatistics() const { return m_statistics; }
+        static LineOfSightCacheStatistics& GetGlobalStatistics();
+
+    private:
+        struct Entry
+        {
+            Entry() : storeTime(0), staticGeneration(0), dynamicGeneration(0), staticResult(false), result(false), used(false) {}
+
+            Key key;
+            uint32 storeTime;
+            uint32 staticGeneration;
+            uint32 dynamicGeneration;
+            bool staticResult;
+            bool result;
+            bool used;
+        };
+
+        std::vector<Entry> m_entries;
+        uint32 m_mask;
+        uint32 m_expiry;
+        uint32 m_dynamicGeneration;
+
+        LineOfSightCacheStatistics m_statistics;
+};
+
+#endif
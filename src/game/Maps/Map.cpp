@@ -33,10 +33,12 @@
 #include "Server/DBCEnums.h"
 #include "Maps/MapPersistentStateMgr.h"
 #include "VMapFactory.h"
+#include "vmap/GameObjectModel.h"
 #include "MotionGenerators/MoveMap.h"
 #include "Chat/Chat.h"
 #include "Weather/Weather.h"
 #include "Grids/ObjectGridLoader.h"
+#include "MotionGenerators/WaypointMovementGenerator.h"
 #include "AI/ScriptDevAI/ScriptDevAIMgr.h"
 
 Map::~Map()
@@ -101,6 +103,8 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
     // lets initialize visibility distance for map
     Map::InitVisibilityDistance();
 
+    m_losCache.Initialize(sWorld.getConfig(CONFIG_UINT32_VMAP_LOS_CACHE_SIZE), sWorld.getConfig(CONFIG_UINT32_VMAP_LOS_CACHE_EXPIRY));
+
     // add reference for TerrainData object
     m_TerrainData->AddRef();
 
@@ -259,6 +263,66 @@ Map::EnsureGridLoadedAtEnter(const Cell& cell, Player* player)
         AddToGrid(player, grid, cell);
 }
 
+void Map::PreloadGridsAhead(Player* player, float oldX, float oldY)
+{
+    if (!sMapMgr.GetGridPreloader().IsActive())
+        return;
+
+    float distance = sWorld.getConfig(CONFIG_FLOAT_GRID_PRELOAD_DISTANCE);
+    float x = player->GetPositionX();
+    float y = player->GetPositionY();
+
+    // flight paths are known in advance, follow the next nodes on this map
+    if (player->IsTaxiFlying() && player->GetMotionMaster()->GetCurrentMovementGeneratorType() == FLIGHT_MOTION_TYPE)
+    {
+        FlightPathMovementGenerator* flight = (FlightPathMovementGenerator*)(player->GetMotionMaster()->top());
+        TaxiPathNodeList const& path = flight->GetPath();
+
+        // flying is about four times faster than a mount
+        float remaining = 4 * distance;
+        for (uint32 i = flight->GetCurrentNode(); i < path.size() && remaining > 0.0f; ++i)
+        {
+            TaxiPathNodeEntry const* node = path[i];
+            if (node->mapid != GetId())
+                break;
+
+            remaining -= sqrt((node->x - x) * (node->x - x) + (node->y - y) * (node->y - y));
+            x = node->x;
+            y = node->y;
+            PreloadGrid(x, y);
+        }
+        return;
+    }
+
+    // otherwise continue the last move, or look where the player faces if it did not move
+    float dx = x - oldX;
+    float dy = y - oldY;
+    float length = sqrt(dx * dx + dy * dy);
+    if (length < 0.1f)
+    {
+        dx = cos(player->GetOrientation());
+        dy = sin(player->GetOrientation());
+    }
+    else
+    {
+        dx /= length;
+        dy /= length;
+    }
+
+    PreloadGrid(x + dx * distance / 2, y + dy * distance / 2);
+    PreloadGrid(x + dx * distance, y + dy * distance);
+}
+
+void Map::PreloadGrid(float x, float y)
+{
+    if (!MaNGOS::IsValidMapCoord(x, y))
+        return;
+
+    // terrain tiles are numbered the other way round than grids, see EnsureGridCreated
+    GridPair p = MaNGOS::ComputeGridPair(x, y);
+    sMapMgr.GetGridPreloader().Preload(m_TerrainData, (MAX_NUMBER_OF_GRIDS - 1) - p.x_coord, (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord);
+}
+
 bool Map::EnsureGridLoaded(const Cell& cell)
 {
     EnsureGridCreated(GridPair(cell.GridX(), cell.GridY()));
@@ -689,6 +753,8 @@ Map::PlayerRelocation(Player* player, float x, float y, float z, float orientati
     Cell new_cell(new_val);
     bool same_cell = (new_cell == old_cell);
 
+    float oldX = player->GetPositionX();
+    float oldY = player->GetPositionY();
     player->Relocate(x, y, z, orientation);
 
     if (old_cell.DiffGrid(new_cell) || old_cell.DiffCell(new_cell))
@@ -704,6 +770,8 @@ Map::PlayerRelocation(Player* player, float x, float y, float z, float orientati
 
         NGridType* newGrid = getNGrid(new_cell.GridX(), new_cell.GridY());
         player->GetViewPoint().Event_GridChanged(&(*newGrid)(new_cell.CellX(), new_cell.CellY()));
+
+        PreloadGridsAhead(player, oldX, oldY);
     }
 
     player->OnRelocated();
@@ -920,7 +988,7 @@ void Map::SendInitSelf(Player* player) const
 
     WorldPacket packet;
     data.BuildPacket(packet, hasTransport);
-    player->GetSession()->SendPacket(packet);
+    player->GetSession()->SendPacket(std::move(packet));
 }
 
 void Map::SendInitTransports(Player* player) const
@@ -950,7 +1018,7 @@ void Map::SendInitTransports(Player* player) const
 
     WorldPacket packet;
     transData.BuildPacket(packet, hasTransport);
-    player->GetSession()->SendPacket(packet);
+    player->GetSession()->SendPacket(std::move(packet));
 }
 
 void Map::SendRemoveTransports(Player* player) const
@@ -973,7 +1041,7 @@ void Map::SendRemoveTransports(Player* player) const
 
     WorldPacket packet;
     transData.BuildPacket(packet);
-    player->GetSession()->SendPacket(packet);
+    player->GetSession()->SendPacket(std::move(packet));
 }
 
 inline void Map::setNGrid(NGridType* grid, uint32 x, uint32 y)
@@ -1858,12 +1926,12 @@ void Map::SendObjectUpdates()
         obj->BuildUpdateData(update_players);
     }
 
-    WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
+    WorldPacket packet;
     for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
     {
         iter->second.BuildPacket(packet);
-        iter->first->GetSession()->SendPacket(packet);
-        packet.clear();                                     // clean the string
+        iter->first->GetSession()->SendPacket(std::move(packet));
+        packet.clear();                                     // storage was handed to the socket, reset positions
     }
 }
 
@@ -1991,8 +2059,86 @@ void Map::PlayDirectSoundToMap(uint32 soundId, uint32 zoneId /*=0*/) const
  */
 bool Map::IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ)
-           && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ);
+    if (!m_losCache.IsEnabled())
+        return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ)
+               && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ);
+
+    LineOfSightCache::Key key(srcX, srcY, srcZ, destX, destY, destZ);
+    uint32 staticGeneration = m_TerrainData->GetVMapGeneration();
+    bool staticResult, result;
+    LineOfSightCache::LookupResult cached = m_losCache.Lookup(key, staticGeneration, staticResult, result);
+    if (cached == LineOfSightCache::LOS_CACHE_HIT)
+        return result;
+
+    if (cached == LineOfSightCache::LOS_CACHE_MISS)
+        staticResult = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ);
+
+    result = staticResult && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ);
+    m_losCache.Store(key, staticGeneration, staticResult, result);
+    return result;
+}
+
+/**
+ * line of sight of many rays at once, the static models are tested in packets of rays
+ * and the dynamic objects only for the rays which passed them
+ */
+void Map::IsInLineOfSight(VMAP::LineOfSightQuery* queries, uint32 count) const
+{
+    if (!m_losCache.IsEnabled())
+    {
+        VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), queries, count);
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            VMAP::LineOfSightQuery& query = queries[i];
+            if (query.result)
+                query.result = m_dyn_tree.isInLineOfSight(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2);
+        }
+        return;
+    }
+
+    // only rays unknown to the cache are traced against the static models
+    uint32 staticGeneration = m_TerrainData->GetVMapGeneration();
+    std::vector<bool> staticResults(count);
+    std::vector<bool> cachedResults(count);
+    std::vector<uint32> missIndex;
+    std::vector<VMAP::LineOfSightQuery> misses;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        VMAP::LineOfSightQuery& query = queries[i];
+        bool staticResult = false, result = false;
+        switch (m_losCache.Lookup(LineOfSightCache::Key(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2), staticGeneration, staticResult, result))
+        {
+            case LineOfSightCache::LOS_CACHE_HIT:
+                cachedResults[i] = true;
+                query.result = result;
+                break;
+            case LineOfSightCache::LOS_CACHE_STATIC:
+                staticResults[i] = staticResult;
+                break;
+            case LineOfSightCache::LOS_CACHE_MISS:
+                missIndex.push_back(i);
+                misses.push_back(query);
+                break;
+        }
+    }
+
+    if (!misses.empty())
+    {
+        VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), misses.data(), misses.size());
+        for (uint32 i = 0; i < misses.size(); ++i)
+            staticResults[missIndex[i]] = misses[i].result;
+    }
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (cachedResults[i])
+            continue;
+
+        VMAP::LineOfSightQuery& query = queries[i];
+        query.result = staticResults[i] && m_dyn_tree.isInLineOfSight(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2);
+        m_losCache.Store(LineOfSightCache::Key(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2), staticGeneration, staticResults[i], query.result);
+    }
 }
 
 /**
@@ -2078,9 +2224,9 @@ bool Map::GetHeightInRange(float x, float y, float& z, float maxSearchDist /*= 4
     return true;
 }
 
-float Map::GetHeight(float x, float y, float z) const
+float Map::GetHeight(float x, float y, float z, float const* knownStaticHeight /*= nullptr*/) const
 {
-    float staticHeight = m_TerrainData->GetHeightStatic(x, y, z);
+    float staticHeight = knownStaticHeight ? *knownStaticHeight : m_TerrainData->GetHeightStatic(x, y, z);
 
     // Get Dynamic Height around static Height (if valid)
     float dynSearchHeight = 2.0f + (z < staticHeight ? staticHeight : z);
@@ -2090,11 +2236,13 @@ float Map::GetHeight(float x, float y, float z) const
 void Map::InsertGameObjectModel(const GameObjectModel& mdl)
 {
     m_dyn_tree.insert(mdl);
+    m_losCache.InvalidateDynamic();
 }
 
 void Map::RemoveGameObjectModel(const GameObjectModel& mdl)
 {
     m_dyn_tree.remove(mdl);
+    m_losCache.InvalidateDynamic();
 }
 
 bool Map::ContainsGameObjectModel(const GameObjectModel& mdl) const
@@ -2102,6 +2250,15 @@ bool Map::ContainsGameObjectModel(const GameObjectModel& mdl) const
     return m_dyn_tree.contains(mdl);
 }
 
+void Map::EnableGameObjectModel(GameObjectModel& mdl, bool enable)
+{
+    if (mdl.isEnabled() == enable)
+        return;
+
+    mdl.enable(enable);
+    m_losCache.InvalidateDynamic();
+}
+
 // This will generate a random point to all directions in water for the provided point in radius range.
 bool Map::GetRandomPointUnderWater(float& x, float& y, float& z, float radius, GridMapLiquidData& liquid_status) const
 {
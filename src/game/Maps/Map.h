@@ -29,11 +29,13 @@
 #include "Entities/Object.h"
 #include "Globals/SharedDefines.h"
 #include "Maps/GridMap.h"
+#include "Maps/MapUpdater.h"
 #include "GameSystem/GridRefManager.h"
 #include "MapRefManager.h"
 #include "DBScripts/ScriptMgr.h"
 #include "Entities/CreatureLinkingMgr.h"
 #include "vmap/DynamicTree.h"
+#include "Maps/LineOfSightCache.h"
 
 #include <bitset>
 
@@ -53,6 +55,11 @@ class GridMap;
 class GameObjectModel;
 class WeatherSystem;
 
+namespace VMAP
+{
+    struct LineOfSightQuery;
+}
+
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
 #if defined( __GNUC__ )
 #pragma pack(1)
@@ -261,6 +268,7 @@ class Map : public GridRefManager<NGridType>
 
         // get corresponding TerrainData object for this particular map
         const TerrainInfo* GetTerrain() const { return m_TerrainData; }
+        LineOfSightCache const& GetLineOfSightCache() const { return m_losCache; }
 
         void CreateInstanceData(bool load);
         InstanceData* GetInstanceData() const { return i_data; }
@@ -271,15 +279,18 @@ class Map : public GridRefManager<NGridType>
         void PlayDirectSoundToMap(uint32 soundId, uint32 zoneId = 0) const;
 
         // Dynamic VMaps
-        float GetHeight(float x, float y, float z) const;
+        // staticHeight: TerrainInfo::GetHeightStatic result for x, y, z if already known
+        float GetHeight(float x, float y, float z, float const* staticHeight = nullptr) const;
         bool GetHeightInRange(float x, float y, float& z, float maxSearchDist = 4.0f) const;
         bool IsInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2) const;
+        void IsInLineOfSight(VMAP::LineOfSightQuery* queries, uint32 count) const;
         bool GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, float modifyDist) const;
 
         // Object Model insertion/remove/test for dynamic vmaps use
         void InsertGameObjectModel(const GameObjectModel& mdl);
         void RemoveGameObjectModel(const GameObjectModel& mdl);
         bool ContainsGameObjectModel(const GameObjectModel& mdl) const;
+        void EnableGameObjectModel(GameObjectModel& mdl, bool enable);
 
         // Get Holder for Creature Linking
         CreatureLinkingHolder* GetCreatureLinkingHolder() { return &m_creatureLinkingHolder; }
@@ -304,6 +315,10 @@ class Map : public GridRefManager<NGridType>
         bool GetRandomPointUnderWater(float& x, float& y, float& z, float radius, GridMapLiquidData& liquid_status) const;
 
         TimePoint GetCurrentClockTime();
+
+        // update time statistics, filled by MapUpdater
+        MapUpdateStatistics& GetUpdateStatistics() { return m_updateStats; }
+        MapUpdateStatistics const& GetUpdateStatistics() const { return m_updateStats; }
     private:
         void LoadMapAndVMap(int gx, int gy);
 
@@ -321,6 +336,10 @@ class Map : public GridRefManager<NGridType>
         bool EnsureGridLoaded(Cell const&);
         void EnsureGridLoadedAtEnter(Cell const&, Player* player = nullptr);
 
+        // queue the terrain of grids the player is heading to at the grid preloader
+        void PreloadGridsAhead(Player* player, float oldX, float oldY);
+        void PreloadGrid(float x, float y);
+
         void buildNGridLinkage(NGridType* pNGridType) { pNGridType->link(this); }
 
         NGridType* getNGrid(uint32 x, uint32 y) const
@@ -392,9 +411,12 @@ class Map : public GridRefManager<NGridType>
 
         // Dynamic Map tree object
         DynamicMapTree m_dyn_tree;
+        mutable LineOfSightCache m_losCache;
 
         // WeatherSystem
         WeatherSystem* m_weatherSystem;
+
+        MapUpdateStatistics m_updateStats;
 };
 
 class WorldMap : public Map
@@ -26,13 +26,16 @@
 #include "World/World.h"
 #include "Grids/CellImpl.h"
 #include "Globals/ObjectMgr.h"
+#include "MotionGenerators/MoveMap.h"
+
+#include <chrono>
 
 #define CLASS_LOCK MaNGOS::ClassLevelLockable<MapManager, std::recursive_mutex>
 INSTANTIATE_SINGLETON_2(MapManager, CLASS_LOCK);
 INSTANTIATE_CLASS_MUTEX(MapManager, std::recursive_mutex);
 
 MapManager::MapManager()
-    : i_GridStateErrorCount(0), i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN))
+    : i_GridStateErrorCount(0), i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN)), m_lastMapsUpdateTime(0)
 {
     i_timer.SetInterval(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
 }
@@ -53,6 +56,17 @@ MapManager::Initialize()
 {
     InitStateMachine();
     InitMaxInstanceId();
+
+    // with a single thread maps are updated directly by the world thread
+    uint32 numThreads = sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_THREADS);
+    if (numThreads > 1)
+        m_updater.Activate(numThreads);
+
+    if (uint32 preloadThreads = sWorld.getConfig(CONFIG_UINT32_GRID_PRELOAD_THREADS))
+        m_preloader.Activate(preloadThreads);
+
+    if (uint32 pathFinderThreads = sWorld.getConfig(CONFIG_UINT32_PATH_FIND_THREADS))
+        m_pathFinder.Activate(pathFinderThreads);
 }
 
 void MapManager::InitStateMachine()
@@ -172,8 +186,21 @@ void MapManager::Update(uint32 diff)
     if (!i_timer.Passed())
         return;
 
+    std::chrono::steady_clock::time_point updateStart = std::chrono::steady_clock::now();
+
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
-        iter->second->Update((uint32)i_timer.GetCurrent());
+        m_updater.ScheduleUpdate(*iter->second, (uint32)i_timer.GetCurrent());
+
+    // all maps must be finished before transports, map unloading and the global managers touch them
+    m_updater.Wait();
+
+    // return the terrain references of preloaded tiles, possibly unloading terrain no map uses anymore
+    m_preloader.Update();
+
+    // link the navmesh tiles asked for by the maps and drop the ones nobody used for a while
+    MMAP::MMapFactory::createOrGetMMapManager()->Update();
+
+    m_lastMapsUpdateTime = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - updateStart).count());
 
     for (TransportSet::iterator iter = m_Transports.begin(); iter != m_Transports.end(); ++iter)
     {
@@ -226,6 +253,10 @@ bool MapManager::IsValidMAP(uint32 mapid)
 
 void MapManager::UnloadAll()
 {
+    m_updater.Deactivate();
+    m_preloader.Deactivate();
+    m_pathFinder.Deactivate();
+
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
         iter->second->UnloadAll(true);
 
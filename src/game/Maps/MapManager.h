@@ -23,6 +23,9 @@
 #include "Platform/Define.h"
 #include "Policies/Singleton.h"
 #include "Maps/Map.h"
+#include "Maps/MapUpdater.h"
+#include "Maps/GridPreloader.h"
+#include "MotionGenerators/PathFinderService.h"
 #include "Grids/GridStates.h"
 
 class Transport;
@@ -144,6 +147,12 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         /* statistics */
         uint32 GetNumInstances();
         uint32 GetNumPlayersInInstances();
+        uint32 GetMapUpdateThreadCount() const { return m_updater.GetThreadCount(); }
+        // time in microseconds from scheduling the first map to the end of the update barrier in last tick
+        uint32 GetLastMapsUpdateTime() const { return m_lastMapsUpdateTime; }
+
+        GridPreloader& GetGridPreloader() { return m_preloader; }
+        PathFinderService& GetPathFinderService() { return m_pathFinder; }
 
 
         // get list of all maps
@@ -178,6 +187,11 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         IntervalTimer i_timer;
 
         uint32 i_MaxInstanceId;
+
+        MapUpdater m_updater;
+        GridPreloader m_preloader;
+        PathFinderService m_pathFinder;
+        uint32 m_lastMapsUpdateTime;
 };
 
 template<typename Do>
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/MapUpdater.h"
+#include "Maps/Map.h"
+#include "Log.h"
+
+#include <chrono>
+
+MapUpdater::MapUpdater() : m_pendingRequests(0), m_cancel(false)
+{
+}
+
+MapUpdater::~MapUpdater()
+{
+    Deactivate();
+}
+
+void MapUpdater::Activate(uint32 numThreads)
+{
+    Deactivate();
+
+    m_cancel = false;
+    for (uint32 i = 0; i < numThreads; ++i)
+        m_workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+
+    sLog.outString("Map updater: %u worker threads started", numThreads);
+}
+
+void MapUpdater::Deactivate()
+{
+    if (m_workerThreads.empty())
+        return;
+
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        m_cancel = true;
+    }
+    m_queueCondition.notify_all();
+
+    for (std::vector<std::thread>::iterator itr = m_workerThreads.begin(); itr != m_workerThreads.end(); ++itr)
+        itr->join();
+
+    m_workerThreads.clear();
+}
+
+void MapUpdater::ScheduleUpdate(Map& map, uint32 diff)
+{
+    if (!IsActive())
+    {
+        UpdateMap(map, diff);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        m_queue.push_back(MapUpdateRequest(map, diff));
+        ++m_pendingRequests;
+    }
+    m_queueCondition.notify_one();
+}
+
+void MapUpdater::Wait()
+{
+    std::unique_lock<std::mutex> guard(m_queueLock);
+    m_doneCondition.wait(guard, [this] { return m_pendingRequests == 0; });
+}
+
+void MapUpdater::UpdateMap(Map& map, uint32 diff)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    map.Update(diff);
+
+    std::chrono::microseconds elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    map.GetUpdateStatistics().AddUpdateTime(uint32(elapsed.count()));
+}
+
+void MapUpdater::WorkerThread()
+{
+    for (;;)
+    {
+        std::unique_lock<std::mutex> guard(m_queueLock);
+        m_queueCondition.wait(guard, [this] { return m_cancel || !m_queue.empty(); });
+
+        if (m_queue.empty())                                // only reached at cancel
+            return;
+
+        MapUpdateRequest request = m_queue.front();
+        m_queue.pop_front();
+        guard.unlock();
+
+        UpdateMap(request.map, request.diff);
+
+        guard.lock();
+        if (--m_pendingRequests == 0)
+            m_doneCondition.notify_all();
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MAPUPDATER_H
+#define MANGOS_MAPUPDATER_H
+
+#include "Common.h"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+class Map;
+
+/// Update time statistics of a single map, all times in microseconds
+/// Only the thread updating the map writes them, .server mapstats reads them from the world thread
+struct MapUpdateStatistics
+{
+    MapUpdateStatistics() : lastTime(0), maxTime(0), averageTime(0), updateCount(0), valuesBlocksBuilt(0), valuesBlocksShared(0) {}
+
+    void AddUpdateTime(uint32 time)
+    {
+        lastTime.store(time, std::memory_order_relaxed);
+        if (time > maxTime.load(std::memory_order_relaxed))
+            maxTime.store(time, std::memory_order_relaxed);
+
+        // exponential moving average over roughly the last 32 ticks
+        uint32 count = updateCount.load(std::memory_order_relaxed);
+        uint32 average = averageTime.load(std::memory_order_relaxed);
+        averageTime.store(count ? (average * 31 + time) / 32 : time, std::memory_order_relaxed);
+        updateCount.store(count + 1, std::memory_order_relaxed);
+    }
+
+    void AddValuesUpdateBlocks(uint32 built, uint32 shared)
+    {
+        valuesBlocksBuilt.fetch_add(built, std::memory_order_relaxed);
+        valuesBlocksShared.fetch_add(shared, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32> lastTime;
+    std::atomic<uint32> maxTime;
+    std::atomic<uint32> averageTime;
+    std::atomic<uint32> updateCount;
+
+    // values update blocks of changed objects serialized for a receiver, and those reused from another receiver
+    std::atomic<uint64> valuesBlocksBuilt;
+    std::atomic<uint64> valuesBlocksShared;
+};
+
+/**
+ * Pool of worker threads updating independent maps at the same time.
+ *
+ * MapManager schedules every map for the tick and then waits on the barrier,
+ * so nothing running after MapManager::Update (remove lists, global managers)
+ * ever sees a map that is still being updated.
+ * Without activated workers the maps are updated directly in the calling thread.
+ */
+class MapUpdater
+{
+    public:
+        MapUpdater();
+        ~MapUpdater();
+
+        void Activate(uint32 numThreads);
+        void Deactivate();
+        bool IsActive() const { return !m_workerThreads.empty(); }
+        uint32 GetThreadCount() const { return m_workerThreads.size(); }
+
+        void ScheduleUpdate(Map& map, uint32 diff);
+        void Wait();
+
+        // update and measure a single map in the current thread
+        static void UpdateMap(Map& map, uint32 diff);
+
+    private:
+        struct MapUpdateRequest
+        {
+            MapUpdateRequest(Map& _map, uint32 _diff) : map(_map), diff(_diff) {}
+
+            Map& map;
+            uint32 diff;
+        };
+
+        MapUpdater(MapUpdater const&);
+        MapUpdater& operator=(MapUpdater const&);
+
+        void WorkerThread();
+
+        std::vector<std::thread> m_workerThreads;
+
+        std::mutex m_queueLock;
+        std::condition_variable m_queueCondition;
+        std::condition_variable m_doneCondition;
+        std::deque<MapUpdateRequest> m_queue;
+        uint32 m_pendingRequests;
+        bool m_cancel;
+};
+
+#endif
@@ -17,11 +17,21 @@
  */
 
 #include "Log.h"
+#include "Timer.h"
 #include "World/World.h"
 #include "Entities/Creature.h"
 #include "MotionGenerators/MoveMap.h"
 #include "MoveMapSharedDefines.h"
 
+#include <algorithm>
+#include <vector>
+
+// tile data is used in place right behind the header, detour needs it 4 byte aligned
+static_assert(sizeof(MmapTileHeader) % 4 == 0, "mmtile data must stay aligned in the mapping");
+
+#define MMAP_EVICTION_INTERVAL      10000       // ms between two looks for unused tiles
+#define MMAP_EVICTION_MIN_IDLE      60000       // ms a tile stays loaded after its last query, even above mmap.maxLoadedTiles
+
 namespace MMAP
 {
     // ######################## MMapFactory ########################
@@ -134,8 +144,11 @@ namespace MMAP
     bool MMapManager::loadMapData(uint32 mapId)
     {
         // we already have this map loaded?
-        if (loadedMMaps.find(mapId) != loadedMMaps.end())
-            return true;
+        {
+            boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+            if (loadedMMaps.find(mapId) != loadedMMaps.end())
+                return true;
+        }
 
         // load and init dtNavMesh - read parameters from file
         uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i.mmap") + 1;
@@ -173,8 +186,20 @@ namespace MMAP
         // store inside our map list
         MMapData* mmap_data = new MMapData(mesh);
         mmap_data->mmapLoadedTiles.clear();
+        mmap_data->pathCache.Initialize(sWorld.getConfig(CONFIG_UINT32_PATH_FIND_CACHE_SIZE));
+
+        bool inserted;
+        LockQueryThreads();
+        {
+            boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+            inserted = loadedMMaps.insert(std::pair<uint32, MMapData*>(mapId, mmap_data)).second;
+        }
+        UnlockQueryThreads();
+
+        // another map update thread loaded it meanwhile
+        if (!inserted)
+            delete mmap_data;
 
-        loadedMMaps.insert(std::pair<uint32, MMapData*>(mapId, mmap_data));
         return true;
     }
 
@@ -190,15 +215,23 @@ namespace MMAP
             return false;
 
         // get this mmap data
-        MMapData* mmap = loadedMMaps[mapId];
-        MANGOS_ASSERT(mmap->navMesh);
-
-        // check if we already have this tile loaded
+        MMapData* mmap;
         uint32 packedGridPos = packTileID(x, y);
-        if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
         {
-            sLog.outError("MMAP:loadMap: Asked to load already loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
-            return false;
+            boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+            MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+            if (itr == loadedMMaps.end())
+                return false;
+
+            mmap = itr->second;
+            MANGOS_ASSERT(mmap->navMesh);
+
+            // check if we already have this tile loaded
+            if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
+            {
+                sLog.outError("MMAP:loadMap: Asked to load already loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
+                return false;
+            }
         }
 
         // load this tile :: mmaps/MMMXXYY.mmtile
@@ -206,23 +239,33 @@ namespace MMAP
         char* fileName = new char[pathLen];
         snprintf(fileName, pathLen, (sWorld.GetDataPath() + "mmaps/%03i%02i%02i.mmtile").c_str(), mapId, x, y);
 
-        FILE* file = fopen(fileName, "rb");
-        if (!file)
+        // the tile is used straight from a copy-on-write mapping: pages only read by detour stay
+        // in the page cache, shared with every other process using the same files, and only
+        // the pages detour writes its links into get a private copy
+        MaNGOS::MappedFile* file = new MaNGOS::MappedFile();
+        if (!file->Open(fileName, true))
         {
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "ERROR: MMAP:loadMap: Could not open mmtile file '%s'", fileName);
             delete[] fileName;
+            delete file;
             return false;
         }
         delete[] fileName;
 
-        // read header
+        // check header
         MmapTileHeader fileHeader;
-        fread(&fileHeader, sizeof(MmapTileHeader), 1, file);
+        if (file->GetSize() < sizeof(MmapTileHeader))
+        {
+            sLog.outError("MMAP:loadMap: Bad header in mmap %03u%02i%02i.mmtile", mapId, x, y);
+            delete file;
+            return false;
+        }
+        memcpy(&fileHeader, file->GetData(), sizeof(MmapTileHeader));
 
         if (fileHeader.mmapMagic != MMAP_MAGIC)
         {
             sLog.outError("MMAP:loadMap: Bad header in mmap %03u%02i%02i.mmtile", mapId, x, y);
-            fclose(file);
+            delete file;
             return false;
         }
 
@@ -230,66 +273,91 @@ namespace MMAP
         {
             sLog.outError("MMAP:loadMap: %03u%02i%02i.mmtile was built with generator v%i, expected v%i",
                           mapId, x, y, fileHeader.mmapVersion, MMAP_VERSION);
-            fclose(file);
+            delete file;
             return false;
         }
 
-        unsigned char* data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
-        MANGOS_ASSERT(data);
-
-        size_t result = fread(data, fileHeader.size, 1, file);
-        if (!result)
+        if (!fileHeader.size || file->GetSize() - sizeof(MmapTileHeader) < fileHeader.size)
         {
             sLog.outError("MMAP:loadMap: Bad header or data in mmap %03u%02i%02i.mmtile", mapId, x, y);
-            fclose(file);
+            delete file;
             return false;
         }
 
-        fclose(file);
-
+        unsigned char* data = file->GetWritableData() + sizeof(MmapTileHeader);
         dtMeshHeader* header = (dtMeshHeader*)data;
         dtTileRef tileRef = 0;
 
-        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
-        dtStatus dtResult = mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef);
+        // the mapping stays owned by us, detour must not free the data
+        dtStatus dtResult;
+        LockQueryThreads();
+        {
+            boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+            dtResult = mmap->navMesh->addTile(data, fileHeader.size, 0, 0, &tileRef);
+            if (dtStatusSucceed(dtResult))
+            {
+                MMapTile& tile = mmap->mmapLoadedTiles[packedGridPos];
+                tile.tileRef = tileRef;
+                tile.file = file;
+                ++loadedTiles;
+            }
+        }
+        UnlockQueryThreads();
         if (dtStatusFailed(dtResult))
         {
             sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
-            dtFree(data);
+            delete file;
             return false;
         }
 
-        mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
-        ++loadedTiles;
         DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Loaded mmtile %03i[%02i,%02i] into %03i[%02i,%02i]", mapId, x, y, mapId, header->x, header->y);
         return true;
     }
 
     bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
     {
-        // check if we have this map loaded
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        MMapData* mmap;
+        MMapTile tile;
+        uint32 packedGridPos = packTileID(x, y);
         {
-            // file may not exist, therefore not loaded
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Asked to unload not loaded navmesh map. %03u%02i%02i.mmtile", mapId, x, y);
-            return false;
-        }
+            boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
 
-        MMapData* mmap = loadedMMaps[mapId];
+            // check if we have this map loaded
+            MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+            if (itr == loadedMMaps.end())
+            {
+                // file may not exist, therefore not loaded
+                DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Asked to unload not loaded navmesh map. %03u%02i%02i.mmtile", mapId, x, y);
+                return false;
+            }
 
-        // check if we have this tile loaded
-        uint32 packedGridPos = packTileID(x, y);
-        if (mmap->mmapLoadedTiles.find(packedGridPos) == mmap->mmapLoadedTiles.end())
-        {
-            // file may not exist, therefore not loaded
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Asked to unload not loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
-            return false;
-        }
+            mmap = itr->second;
+
+            // check if we have this tile loaded
+            MMapTileSet::const_iterator tileItr = mmap->mmapLoadedTiles.find(packedGridPos);
+            if (tileItr == mmap->mmapLoadedTiles.end())
+            {
+                // file may not exist, therefore not loaded
+                DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Asked to unload not loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
+                return false;
+            }
 
-        dtTileRef tileRef = mmap->mmapLoadedTiles[packedGridPos];
+            tile = tileItr->second;
+        }
 
         // unload, and mark as non loaded
-        dtStatus dtResult = mmap->navMesh->removeTile(tileRef, nullptr, nullptr);
+        dtStatus dtResult;
+        LockQueryThreads();
+        {
+            boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+            dtResult = mmap->navMesh->removeTile(tile.tileRef, nullptr, nullptr);
+            if (dtStatusSucceed(dtResult))
+            {
+                mmap->mmapLoadedTiles.erase(packedGridPos);
+                --loadedTiles;
+            }
+        }
+        UnlockQueryThreads();
         if (dtStatusFailed(dtResult))
         {
             // this is technically a memory leak
@@ -300,8 +368,7 @@ namespace MMAP
         }
         else
         {
-            mmap->mmapLoadedTiles.erase(packedGridPos);
-            --loadedTiles;
+            delete tile.file;
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Unloaded mmtile %03i[%02i,%02i] from %03i", mapId, x, y, mapId);
             return true;
         }
@@ -311,31 +378,43 @@ namespace MMAP
 
     bool MMapManager::unloadMap(uint32 mapId)
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        LockQueryThreads();
+        boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+
+        MMapDataSet::iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
         {
+            lock.unlock();
+            UnlockQueryThreads();
+
             // file may not exist, therefore not loaded
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Asked to unload not loaded navmesh map %03u", mapId);
             return false;
         }
 
         // unload all tiles from given map
-        MMapData* mmap = loadedMMaps[mapId];
+        MMapData* mmap = itr->second;
         for (MMapTileSet::iterator i = mmap->mmapLoadedTiles.begin(); i != mmap->mmapLoadedTiles.end(); ++i)
         {
             uint32 x = (i->first >> 16);
             uint32 y = (i->first & 0x0000FFFF);
-            dtStatus dtResult = mmap->navMesh->removeTile(i->second, nullptr, nullptr);
+            dtStatus dtResult = mmap->navMesh->removeTile(i->second.tileRef, nullptr, nullptr);
             if (dtStatusFailed(dtResult))
                 sLog.outError("MMAP:unloadMap: Could not unload %03u%02i%02i.mmtile from navmesh", mapId, x, y);
             else
             {
+                delete i->second.file;
+                i->second.file = nullptr;
                 --loadedTiles;
                 DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Unloaded mmtile %03i[%02i,%02i] from %03i", mapId, x, y, mapId);
             }
         }
 
         delete mmap;
-        loadedMMaps.erase(mapId);
+        loadedMMaps.erase(itr);
+
+        lock.unlock();
+        UnlockQueryThreads();
         DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Unloaded %03i.mmap", mapId);
 
         return true;
@@ -343,61 +422,296 @@ namespace MMAP
 
     bool MMapManager::unloadMapInstance(uint32 mapId, uint32 instanceId)
     {
+        boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+
         // check if we have this map loaded
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
         {
             // file may not exist, therefore not loaded
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMapInstance: Asked to unload not loaded navmesh map %03u", mapId);
             return false;
         }
 
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+        MMapData* mmap = itr->second;
+        NavMeshQuerySet::iterator query = mmap->navMeshQueries.find(instanceId);
+        if (query == mmap->navMeshQueries.end())
         {
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMapInstance: Asked to unload not loaded dtNavMeshQuery mapId %03u instanceId %u", mapId, instanceId);
             return false;
         }
 
-        dtNavMeshQuery* query = mmap->navMeshQueries[instanceId];
-
-        dtFreeNavMeshQuery(query);
-        mmap->navMeshQueries.erase(instanceId);
+        dtFreeNavMeshQuery(query->second);
+        mmap->navMeshQueries.erase(query);
         DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMapInstance: Unloaded mapId %03u instanceId %u", mapId, instanceId);
 
         return true;
     }
 
+    bool MMapManager::UseTiles(uint32 mapId, float x1, float y1, float x2, float y2)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
+            return false;
+
+        MMapData* mmap = itr->second;
+
+        // grid coords as computed by TerrainInfo::GetGrid, also used in the mmtile names
+        int32 gx1 = int32(32 - x1 / SIZE_OF_GRIDS);
+        int32 gy1 = int32(32 - y1 / SIZE_OF_GRIDS);
+        int32 gx2 = int32(32 - x2 / SIZE_OF_GRIDS);
+        int32 gy2 = int32(32 - y2 / SIZE_OF_GRIDS);
+
+        int32 minX = std::max(std::min(gx1, gx2), 0);
+        int32 maxX = std::min(std::max(gx1, gx2), MAX_NUMBER_OF_GRIDS - 1);
+        int32 minY = std::max(std::min(gy1, gy2), 0);
+        int32 maxY = std::min(std::max(gy1, gy2), MAX_NUMBER_OF_GRIDS - 1);
+
+        uint32 now = WorldTimer::getMSTime();
+        bool loaded = true;
+
+        // tiles are only loaded and unloaded by Update while no map is updated
+        for (int32 x = minX; x <= maxX; ++x)
+        {
+            for (int32 y = minY; y <= maxY; ++y)
+            {
+                mmap->tileLastUse[x][y].store(now, std::memory_order_relaxed);
+
+                uint32 packedGridPos = packTileID(x, y);
+                if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end() ||
+                    mmap->missingTiles.find(packedGridPos) != mmap->missingTiles.end())
+                    continue;
+
+                loaded = false;
+
+                std::lock_guard<std::mutex> guard(m_requestLock);
+                m_requestedTiles.insert((mapId << 12) | (x << 6) | y);
+            }
+        }
+
+        return loaded;
+    }
+
+    void MMapManager::LoadGridTile(uint32 mapId, int32 x, int32 y)
+    {
+        if (!loadMapData(mapId))
+            return;
+
+        uint32 packedGridPos = packTileID(x, y);
+        MMapData* mmap;
+        bool loaded;
+        {
+            boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+            MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+            if (itr == loadedMMaps.end())
+                return;
+
+            mmap = itr->second;
+            loaded = mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end() ||
+                     mmap->missingTiles.find(packedGridPos) != mmap->missingTiles.end();
+        }
+
+        // tiles of a grid exist right away, the first paths on it must not go through walls
+        if (!loaded && !loadMap(mapId, x, y))
+        {
+            boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+            mmap->missingTiles.insert(packedGridPos);
+            return;
+        }
+
+        boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+        mmap->gridTiles.insert(packedGridPos);
+    }
+
+    void MMapManager::ReleaseGridTile(uint32 mapId, int32 x, int32 y)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
+            return;
+
+        // counts as used now, so it stays for MMAP_EVICTION_MIN_IDLE at least
+        if (itr->second->gridTiles.erase(packTileID(x, y)))
+            itr->second->tileLastUse[x][y].store(WorldTimer::getMSTime(), std::memory_order_relaxed);
+    }
+
+    void MMapManager::Update()
+    {
+        std::unordered_set<uint32> requested;
+        {
+            std::lock_guard<std::mutex> guard(m_requestLock);
+            requested.swap(m_requestedTiles);
+        }
+
+        for (std::unordered_set<uint32>::const_iterator itr = requested.begin(); itr != requested.end(); ++itr)
+        {
+            uint32 mapId = *itr >> 12;
+            int32 x = (*itr >> 6) & 0x3F;
+            int32 y = *itr & 0x3F;
+
+            // the terrain may have been unloaded meanwhile
+            MMapData* mmap;
+            {
+                boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+                MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+                if (itr == loadedMMaps.end() || itr->second->mmapLoadedTiles.find(packTileID(x, y)) != itr->second->mmapLoadedTiles.end())
+                    continue;
+
+                mmap = itr->second;
+            }
+
+            // most maps have holes without navmesh, do not look for their files again
+            if (!loadMap(mapId, x, y))
+            {
+                boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+                mmap->missingTiles.insert(packTileID(x, y));
+            }
+        }
+
+        uint32 now = WorldTimer::getMSTime();
+        if (WorldTimer::getMSTimeDiff(m_evictionCheckTime, now) >= MMAP_EVICTION_INTERVAL)
+        {
+            m_evictionCheckTime = now;
+            EvictTiles();
+        }
+    }
+
+    void MMapManager::EvictTiles()
+    {
+        uint32 expiry = sWorld.getConfig(CONFIG_UINT32_MMAP_TILE_EXPIRY) * IN_MILLISECONDS;
+        uint32 maxTiles = sWorld.getConfig(CONFIG_UINT32_MMAP_MAX_TILES);
+        if (!expiry && !maxTiles)
+            return;
+
+        struct IdleTile
+        {
+            uint32 idle;
+            uint32 mapId;
+            int32 x;
+            int32 y;
+
+            bool operator<(IdleTile const& other) const { return idle > other.idle; }
+        };
+
+        uint32 now = WorldTimer::getMSTime();
+        std::vector<IdleTile> candidates;
+
+        boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+        for (MMapDataSet::const_iterator itr = loadedMMaps.begin(); itr != loadedMMaps.end(); ++itr)
+        {
+            MMapData* mmap = itr->second;
+            for (MMapTileSet::const_iterator tile = mmap->mmapLoadedTiles.begin(); tile != mmap->mmapLoadedTiles.end(); ++tile)
+            {
+                if (mmap->gridTiles.find(tile->first) != mmap->gridTiles.end())
+                    continue;
+
+                IdleTile idleTile;
+                idleTile.mapId = itr->first;
+                idleTile.x = tile->first >> 16;
+                idleTile.y = tile->first & 0x0000FFFF;
+                idleTile.idle = WorldTimer::getMSTimeDiff(mmap->tileLastUse[idleTile.x][idleTile.y].load(std::memory_order_relaxed), now);
+                if (idleTile.idle >= MMAP_EVICTION_MIN_IDLE)
+                    candidates.push_back(idleTile);
+            }
+        }
+
+        lock.unlock();
+
+        // longest unused first
+        std::sort(candidates.begin(), candidates.end());
+
+        for (std::vector<IdleTile>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+        {
+            bool expired = expiry && itr->idle >= expiry;
+            bool overBudget = maxTiles && loadedTiles > maxTiles;
+            if (!expired && !overBudget)
+                break;
+
+            if (unloadMap(itr->mapId, itr->x, itr->y))
+                ++evictedTiles;
+        }
+    }
+
+    void MMapManager::LockQueryThreads()
+    {
+        // always taken in the same order, so map updates changing tiles at once cannot deadlock
+        for (uint32 i = 0; i < MMAP_MAX_QUERY_THREADS; ++i)
+            m_queryThreadLocks[i].lock();
+    }
+
+    void MMapManager::UnlockQueryThreads()
+    {
+        for (uint32 i = 0; i < MMAP_MAX_QUERY_THREADS; ++i)
+            m_queryThreadLocks[i].unlock();
+    }
+
+    uint32 MMapManager::getLoadedMapsCount() const
+    {
+        boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+        return loadedMMaps.size();
+    }
+
     dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
             return nullptr;
 
-        return loadedMMaps[mapId]->navMesh;
+        return itr->second->navMesh;
     }
 
-    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
+    PathCache* MMapManager::GetPathCache(uint32 mapId)
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
             return nullptr;
 
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+        return &itr->second->pathCache;
+    }
+
+    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
+    {
+        MMapData* mmap;
         {
-            // allocate mesh query
-            dtNavMeshQuery* query = dtAllocNavMeshQuery();
-            MANGOS_ASSERT(query);
-            dtStatus dtResult = query->init(mmap->navMesh, 1024);
-            if (dtStatusFailed(dtResult))
-            {
-                dtFreeNavMeshQuery(query);
-                sLog.outError("MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
+            boost::shared_lock<boost::shared_mutex> lock(m_mapsLock);
+
+            MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+            if (itr == loadedMMaps.end())
                 return nullptr;
-            }
 
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-            mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
+            mmap = itr->second;
+            NavMeshQuerySet::const_iterator query = mmap->navMeshQueries.find(instanceId);
+            if (query != mmap->navMeshQueries.end())
+                return query->second;
+        }
+
+        // allocate mesh query
+        dtNavMeshQuery* query = dtAllocNavMeshQuery();
+        MANGOS_ASSERT(query);
+        dtStatus dtResult = query->init(mmap->navMesh, 1024);
+        if (dtStatusFailed(dtResult))
+        {
+            dtFreeNavMeshQuery(query);
+            sLog.outError("MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
+            return nullptr;
         }
 
-        return mmap->navMeshQueries[instanceId];
+        boost::unique_lock<boost::shared_mutex> lock(m_mapsLock);
+
+        // created meanwhile by another thread asking for the same instance
+        std::pair<NavMeshQuerySet::iterator, bool> inserted = mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
+        if (!inserted.second)
+            dtFreeNavMeshQuery(query);
+        else
+            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
+
+        return inserted.first->second;
     }
 }
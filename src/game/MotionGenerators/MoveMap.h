@@ -20,12 +20,24 @@
 #define _MOVE_MAP_H
 
 #include "Common.h"
+#include "Maps/GridDefines.h"
+#include "MotionGenerators/PathCache.h"
+#include "MappedFile.h"
 #include <Detour/Include/DetourAlloc.h>
 #include <Detour/Include/DetourNavMesh.h>
 #include <Detour/Include/DetourNavMeshQuery.h>
 
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
 class Unit;
 
+#define MMAP_MAX_QUERY_THREADS 16
+
 //  memory management
 inline void* dtCustomAlloc(int size, dtAllocHint /*hint*/)
 {
@@ -40,13 +52,27 @@ inline void dtCustomFree(void* ptr)
 //  move map related classes
 namespace MMAP
 {
-    typedef std::unordered_map<uint32, dtTileRef> MMapTileSet;
+    struct MMapTile
+    {
+        MMapTile() : tileRef(0), file(nullptr) {}
+
+        dtTileRef tileRef;
+        MaNGOS::MappedFile* file;           // copy-on-write mapping holding the tile data
+    };
+
+    typedef std::unordered_map<uint32, MMapTile> MMapTileSet;
     typedef std::unordered_map<uint32, dtNavMeshQuery*> NavMeshQuerySet;
 
     // dummy struct to hold map's mmap data
     struct MMapData
     {
-        MMapData(dtNavMesh* mesh) : navMesh(mesh) {}
+        MMapData(dtNavMesh* mesh) : navMesh(mesh)
+        {
+            for (uint32 x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
+                for (uint32 y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
+                    tileLastUse[x][y] = 0;
+        }
+
         ~MMapData()
         {
             for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
@@ -54,6 +80,10 @@ namespace MMAP
 
             if (navMesh)
                 dtFreeNavMesh(navMesh);
+
+            // tiles still linked do not own their data, it is only released with the navmesh
+            for (MMapTileSet::iterator i = mmapLoadedTiles.begin(); i != mmapLoadedTiles.end(); ++i)
+                delete i->second.file;
         }
 
         dtNavMesh* navMesh;
@@ -61,6 +91,12 @@ namespace MMAP
         // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
         NavMeshQuerySet navMeshQueries;     // instanceId to query
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
+        std::unordered_set<uint32> missingTiles;    // [map grid coords] without a tile file
+        std::unordered_set<uint32> gridTiles;       // [map grid coords] of loaded terrain grids, never evicted
+        PathCache pathCache;                // corridors found on navMesh, shared by all instances
+
+        // WorldTimer::getMSTime of the last query of each tile, set by map update threads
+        std::atomic<uint32> tileLastUse[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
     };
 
 
@@ -68,12 +104,17 @@ namespace MMAP
 
     // singelton class
     // holds all all access to mmap loading unloading and meshes
+    //
+    // the tiles of loaded terrain grids are loaded with the grid and kept while it is loaded, see LoadGridTile
+    // tiles beyond them are loaded when a path is asked for on them and unloaded when nobody asked
+    // for one for a while, see UseTiles and Update
     class MMapManager
     {
         public:
-            MMapManager() : loadedTiles(0) {}
+            MMapManager() : loadedTiles(0), evictedTiles(0), m_evictionCheckTime(0) {}
             ~MMapManager();
 
+            bool loadMapData(uint32 mapId);
             bool loadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
@@ -82,15 +123,46 @@ namespace MMAP
             // the returned [dtNavMeshQuery const*] is NOT threadsafe
             dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
+            PathCache* GetPathCache(uint32 mapId);
+
+            // terrain grid loading, the tile stays loaded until ReleaseGridTile, then it is unloaded as any unused tile
+            void LoadGridTile(uint32 mapId, int32 x, int32 y);
+            void ReleaseGridTile(uint32 mapId, int32 x, int32 y);
+
+            // map update threads, marks the tiles between both positions as used
+            // return: false if some are not loaded yet, they are loaded after the map updates of this tick
+            bool UseTiles(uint32 mapId, float x1, float y1, float x2, float y2);
+
+            // world thread while no map is updated, loads the tiles asked for and unloads unused ones
+            void Update();
 
             uint32 getLoadedTilesCount() const { return loadedTiles; }
-            uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
+            uint32 getLoadedMapsCount() const;
+            uint32 getEvictedTilesCount() const { return evictedTiles; }
+
+            // threads querying navmeshes outside of the map updates hold their lock while doing so,
+            // tiles and navmeshes are only added or removed while all of them are held
+            // they are always taken before m_mapsLock
+            std::mutex& GetQueryThreadLock(uint32 thread) { return m_queryThreadLocks[thread]; }
         private:
-            bool loadMapData(uint32 mapId);
             uint32 packTileID(int32 x, int32 y) const;
+            void EvictTiles();
+
+            void LockQueryThreads();
+            void UnlockQueryThreads();
 
+            // loadedMMaps and the tile, missing tile and query sets of its maps
+            // navmeshes are loaded by map update threads, so lookups take it shared as well
+            mutable boost::shared_mutex m_mapsLock;
             MMapDataSet loadedMMaps;
             uint32 loadedTiles;
+            uint32 evictedTiles;
+
+            std::mutex m_requestLock;
+            std::unordered_set<uint32> m_requestedTiles;    // map id and grid coords of tiles to load
+            uint32 m_evictionCheckTime;
+
+            std::mutex m_queryThreadLocks[MMAP_MAX_QUERY_THREADS];
     };
 
     // static class
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MotionGenerators/PathCache.h"
+
+#include <cstring>
+
+PathCache::PathCache() : m_mask(0)
+{
+}
+
+void PathCache::Initialize(uint32 size)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_entries.clear();
+    m_mask = 0;
+
+    if (!size)
+        return;
+
+    uint32 tableSize = 1;
+    while (tableSize < size)
+        tableSize <<= 1;
+
+    m_entries.resize(tableSize);
+    m_mask = tableSize - 1;
+}
+
+uint32 PathCache::GetSlot(dtPolyRef startPoly, dtPolyRef endPoly) const
+{
+    // FNV-1a over both references
+    uint64 refs[2] = { uint64(startPoly), uint64(endPoly) };
+    uint32 hash = 2166136261u;
+    for (int i = 0; i < 2; ++i)
+    {
+        for (int shift = 0; shift < 64; shift += 16)
+        {
+            hash ^= uint32((refs[i] >> shift) & 0xFFFF);
+            hash *= 16777619u;
+        }
+    }
+    return (hash ^ (hash >> 16)) & m_mask;
+}
+
+uint32 PathCache::Lookup(dtPolyRef startPoly, dtPolyRef endPoly, uint16 includeFlags, uint16 excludeFlags, dtPolyRef* path)
+{
+    if (!IsEnabled())
+        return 0;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    Entry const& entry = m_entries[GetSlot(startPoly, endPoly)];
+    if (!entry.length || entry.startPoly != startPoly || entry.endPoly != endPoly ||
+            entry.includeFlags != includeFlags || entry.excludeFlags != excludeFlags)
+        return 0;
+
+    memcpy(path, entry.path, entry.length * sizeof(dtPolyRef));
+    return entry.length;
+}
+
+void PathCache::Store(dtPolyRef startPoly, dtPolyRef endPoly, uint16 includeFlags, uint16 excludeFlags, dtPolyRef const* path, uint32 length)
+{
+    if (!IsEnabled() || !length || length > PATH_CACHE_MAX_LENGTH)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    Entry& entry = m_entries[GetSlot(startPoly, endPoly)];
+    entry.startPoly = startPoly;
+    entry.endPoly = endPoly;
+    entry.includeFlags = includeFlags;
+    entry.excludeFlags = excludeFlags;
+    entry.length = length;
+    memcpy(entry.path, path, length * sizeof(dtPolyRef));
+}
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PATHCACHE_H
+#define MANGOS_PATHCACHE_H
+
+#include "Common.h"
+
+#include <Detour/Include/DetourNavMesh.h>
+
+#include <mutex>
+#include <vector>
+
+#define PATH_CACHE_MAX_LENGTH   74                          // same as MAX_PATH_LENGTH of PathFinder
+
+/**
+ * Recently found polygon corridors of one navmesh.
+ *
+ * Creatures chasing the same target, or one creature running the same way again, ask
+ * findPath for the same pair of start and end polygons. The corridor found for a pair is
+ * kept with the filter flags it was searched with, so the next path between them only
+ * has to be smoothed. Polygon references carry the salt of their tile, users check them
+ * with dtNavMesh::isValidPolyRef to notice tiles which were reloaded meanwhile. The table
+ * has a fixed size and is shared by all instances of the map and the path finder threads.
+ */
+class PathCache
+{
+    public:
+        PathCache();
+
+        // size is rounded up to a power of two, 0 disables the cache
+        void Initialize(uint32 size);
+        bool IsEnabled() const { return !m_entries.empty(); }
+
+        // copies the corridor into path, returns its length or 0 if none is known
+        uint32 Lookup(dtPolyRef startPoly, dtPolyRef endPoly, uint16 includeFlags, uint16 excludeFlags, dtPolyRef* path);
+        void Store(dtPolyRef startPoly, dtPolyRef endPoly, uint16 includeFlags, uint16 excludeFlags, dtPolyRef const* path, uint32 length);
+
+    private:
+        struct Entry
+        {
+            Entry() : startPoly(0), endPoly(0), includeFlags(0), excludeFlags(0), length(0) {}
+
+            dtPolyRef startPoly;
+            dtPolyRef endPoly;
+            uint16 includeFlags;
+            uint16 excludeFlags;
+            uint32 length;
+            dtPolyRef path[PATH_CACHE_MAX_LENGTH];
+        };
+
+        uint32 GetSlot(dtPolyRef startPoly, dtPolyRef endPoly) const;
+
+        std::mutex m_lock;
+        std::vector<Entry> m_entries;
+        uint32 m_mask;
+};
+
+#endif
@@ -23,23 +23,33 @@
 #include "Log.h"
 #include "World/World.h"
 
+#include <chrono>
+
 #include <Detour/Include/DetourCommon.h>
 #include <Detour/Include/DetourMath.h>
 
+// the cached corridors are copied straight into m_pathPolyRefs
+static_assert(PATH_CACHE_MAX_LENGTH == MAX_PATH_LENGTH, "PathCache entries must hold a full PathFinder corridor");
+
 ////////////////// PathFinder //////////////////
 PathFinder::PathFinder(const Unit* owner) :
     m_polyLength(0), m_type(PATHFIND_BLANK),
     m_useStraightPath(false), m_forceDestination(false), m_pointPathLimit(MAX_POINT_PATH_LENGTH),
-    m_sourceUnit(owner), m_navMesh(nullptr), m_navMeshQuery(nullptr)
+    m_sourceUnit(owner), m_navMesh(nullptr), m_navMeshQuery(nullptr), m_pathCache(nullptr),
+    m_sourceGuidLow(owner->GetGUIDLow()), m_mapId(owner->GetMapId()),
+    m_sourceIsCreature(false), m_sourceCanSwim(false), m_sourceCanFly(false),
+    m_pending(false), m_normalizeNeeded(false)
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceUnit->GetGUIDLow());
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceGuidLow);
 
-    uint32 mapId = m_sourceUnit->GetMapId();
-    if (MMAP::MMapFactory::IsPathfindingEnabled(mapId, owner))
+    m_underWater[0] = m_underWater[1] = -1;
+
+    if (MMAP::MMapFactory::IsPathfindingEnabled(m_mapId, owner))
     {
         MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-        m_navMesh = mmap->GetNavMesh(mapId);
-        m_navMeshQuery = mmap->GetNavMeshQuery(mapId, m_sourceUnit->GetInstanceId());
+        m_navMesh = mmap->GetNavMesh(m_mapId);
+        m_navMeshQuery = mmap->GetNavMeshQuery(m_mapId, m_sourceUnit->GetInstanceId());
+        m_pathCache = mmap->GetPathCache(m_mapId);
     }
 
     createFilter();
@@ -47,18 +57,50 @@ PathFinder::PathFinder(const Unit* owner) :
 
 PathFinder::~PathFinder()
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceUnit->GetGUIDLow());
+    // the owner may be gone already when a path finder thread releases the last reference
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceGuidLow);
 }
 
 bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest)
 {
+    switch (prepare(destX, destY, destZ, forceDest, false))
+    {
+        case PREPARE_INVALID:
+            return false;
+        case PREPARE_BUILD:
+            Build();
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+void PathFinder::finish()
+{
+    MANGOS_ASSERT(!isPending());
+
+    if (m_normalizeNeeded)
+    {
+        m_normalizeNeeded = false;
+        NormalizePath();
+    }
+}
+
+PathFinder::PrepareResult PathFinder::prepare(float destX, float destY, float destZ, bool forceDest, bool async)
+{
+    m_normalizeNeeded = false;
+
+    ++GetStatistics().calls;
+
     if (!MaNGOS::IsValidMapCoord(destX, destY, destZ))
-        return false;
+        return PREPARE_INVALID;
 
     float x, y, z;
     m_sourceUnit->GetPosition(x, y, z);
     if (!MaNGOS::IsValidMapCoord(x, y, z))
-        return false;
+        return PREPARE_INVALID;
 
     Vector3 start(x, y, z);
     setStartPosition(start);
@@ -68,7 +110,11 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
 
     m_forceDestination = forceDest;
 
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceUnit->GetGUIDLow());
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceGuidLow);
+
+    // tiles of loaded grids are always there, others are loaded when first asked for, until then we go straight
+    if (m_navMesh)
+        MMAP::MMapFactory::createOrGetMMapManager()->UseTiles(m_mapId, x, y, destX, destY);
 
     // make sure navMesh works - we can run on map w/o mmap
     // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
@@ -77,13 +123,42 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
     {
         BuildShortcut();
         m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
-        return true;
+        return PREPARE_DONE;
     }
 
     updateFilter();
 
-    BuildPolyPath(start, dest);
-    return true;
+    m_sourceIsCreature = m_sourceUnit->GetTypeId() == TYPEID_UNIT;
+    m_sourceCanSwim = m_sourceIsCreature && ((Creature*)m_sourceUnit)->CanSwim();
+    m_sourceCanFly = m_sourceIsCreature && ((Creature*)m_sourceUnit)->CanFly();
+
+    // the terrain cannot be used from a path finder thread, look up now what BuildPolyPath may need
+    m_underWater[0] = m_underWater[1] = -1;
+    if (async && m_sourceCanSwim != m_sourceCanFly)
+    {
+        isUnderWater(false);
+        isUnderWater(true);
+    }
+
+    return PREPARE_BUILD;
+}
+
+void PathFinder::Build()
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    BuildPolyPath(m_startPosition, m_endPosition);
+
+    PathFindStatistics& statistics = GetStatistics();
+    ++statistics.built;
+    statistics.polys += m_polyLength;
+    statistics.buildTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+PathFindStatistics& PathFinder::GetStatistics()
+{
+    static PathFindStatistics statistics;
+    return statistics;
 }
 
 dtPolyRef PathFinder::getPathPolyByPosition(const dtPolyRef* polyPath, uint32 polyPathSize, const float* point, float* distance) const
@@ -174,14 +249,14 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: (startPoly == 0 || endPoly == 0)\n");
         BuildShortcut();
 
-        if (m_sourceUnit->GetTypeId() == TYPEID_UNIT)
+        if (m_sourceIsCreature)
         {
-            // Check for swimming or flying shortcut
-            if ((startPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsUnderWater(startPos.x, startPos.y, startPos.z)) ||
-                    (endPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsUnderWater(endPos.x, endPos.y, endPos.z)))
-                m_type = ((Creature*)m_sourceUnit)->CanSwim() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+            // Check for swimming or flying shortcut, water only matters when the creature can do just one of them
+            if (m_sourceCanSwim != m_sourceCanFly &&
+                    ((startPoly == INVALID_POLYREF && isUnderWater(false)) || (endPoly == INVALID_POLYREF && isUnderWater(true))))
+                m_type = m_sourceCanSwim ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
             else
-                m_type = ((Creature*)m_sourceUnit)->CanFly() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+                m_type = m_sourceCanFly ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
         }
         else
             m_type = PATHFIND_NOPATH;
@@ -196,21 +271,18 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: farFromPoly distToStartPoly=%.3f distToEndPoly=%.3f\n", distToStartPoly, distToEndPoly);
 
         bool buildShotrcut = false;
-        if (m_sourceUnit->GetTypeId() == TYPEID_UNIT)
+        if (m_sourceIsCreature)
         {
-            Creature* owner = (Creature*)m_sourceUnit;
-
-            Vector3 p = (distToStartPoly > 7.0f) ? startPos : endPos;
-            if (m_sourceUnit->GetTerrain()->IsUnderWater(p.x, p.y, p.z))
+            if (m_sourceCanSwim != m_sourceCanFly && isUnderWater(distToStartPoly <= 7.0f))
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: underWater case\n");
-                if (owner->CanSwim())
+                if (m_sourceCanSwim)
                     buildShotrcut = true;
             }
             else
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: flying case\n");
-                if (owner->CanFly())
+                if (m_sourceCanFly)
                     buildShotrcut = true;
             }
         }
@@ -269,7 +341,7 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
                 sLog.outError("Invalid poly ref in BuildPolyPath. polyLength: %u, pathStartIndex: %u,"
                     " startPos: %s, endPos: %s, mapId: %u",
                     m_polyLength, pathStartIndex, startPos.toString().c_str(), endPos.toString().c_str(),
-                    m_sourceUnit->GetMapId());
+                    m_mapId);
                 break;
             }
 
@@ -309,60 +381,69 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         // so we have atleast part of poly-path ready
 
         m_polyLength -= pathStartIndex;
+        memmove(m_pathPolyRefs, m_pathPolyRefs + pathStartIndex, m_polyLength * sizeof(dtPolyRef));
 
-        // try to adjust the suffix of the path instead of recalculating entire length
-        // at given interval the target cannot get too far from its last location
-        // thus we have less poly to cover
-        // sub-path of optimal path is optimal
+        // the target only moved a bit, walk the end of the corridor over to it
+        if (RepairCorridorEnd(endPoint, endPoly))
+        {
+            DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: corridor end repaired, m_polyLength=%u\n", m_polyLength);
+            ++GetStatistics().repairs;
+        }
+        else
+        {
+            // try to adjust the suffix of the path instead of recalculating entire length
+            // at given interval the target cannot get too far from its last location
+            // thus we have less poly to cover
+            // sub-path of optimal path is optimal
 
-        // take ~80% of the original length
-        // TODO : play with the values here
-        uint32 prefixPolyLength = uint32(m_polyLength * 0.8f + 0.5f);
-        memmove(m_pathPolyRefs, m_pathPolyRefs + pathStartIndex, prefixPolyLength * sizeof(dtPolyRef));
+            // take ~80% of the original length
+            // TODO : play with the values here
+            uint32 prefixPolyLength = uint32(m_polyLength * 0.8f + 0.5f);
 
-        dtPolyRef suffixStartPoly = m_pathPolyRefs[prefixPolyLength - 1];
+            dtPolyRef suffixStartPoly = m_pathPolyRefs[prefixPolyLength - 1];
 
-        // we need any point on our suffix start poly to generate poly-path, so we need last poly in prefix data
-        float suffixEndPoint[VERTEX_SIZE];
-        if (dtStatusFailed(m_navMeshQuery->closestPointOnPoly(suffixStartPoly, endPoint, suffixEndPoint, nullptr)))
-        {
-            // we can hit offmesh connection as last poly - closestPointOnPoly() don't like that
-            // try to recover by using prev polyref
-            --prefixPolyLength;
-            suffixStartPoly = m_pathPolyRefs[prefixPolyLength - 1];
+            // we need any point on our suffix start poly to generate poly-path, so we need last poly in prefix data
+            float suffixEndPoint[VERTEX_SIZE];
             if (dtStatusFailed(m_navMeshQuery->closestPointOnPoly(suffixStartPoly, endPoint, suffixEndPoint, nullptr)))
             {
-                // suffixStartPoly is still invalid, error state
-                BuildShortcut();
-                m_type = PATHFIND_NOPATH;
-                return;
+                // we can hit offmesh connection as last poly - closestPointOnPoly() don't like that
+                // try to recover by using prev polyref
+                --prefixPolyLength;
+                suffixStartPoly = m_pathPolyRefs[prefixPolyLength - 1];
+                if (dtStatusFailed(m_navMeshQuery->closestPointOnPoly(suffixStartPoly, endPoint, suffixEndPoint, nullptr)))
+                {
+                    // suffixStartPoly is still invalid, error state
+                    BuildShortcut();
+                    m_type = PATHFIND_NOPATH;
+                    return;
+                }
             }
-        }
-
-        // generate suffix
-        uint32 suffixPolyLength = 0;
-        dtResult = m_navMeshQuery->findPath(
-                       suffixStartPoly,    // start polygon
-                       endPoly,            // end polygon
-                       suffixEndPoint,     // start position
-                       endPoint,           // end position
-                       &m_filter,            // polygon search filter
-                       m_pathPolyRefs + prefixPolyLength - 1,    // [out] path
-                       (int*)&suffixPolyLength,
-                       MAX_PATH_LENGTH - prefixPolyLength); // max number of polygons in output path
 
-        if (!suffixPolyLength || dtStatusFailed(dtResult))
-        {
-            // this is probably an error state, but we'll leave it
-            // and hopefully recover on the next Update
-            // we still need to copy our preffix
-            sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
-        }
+            // generate suffix
+            uint32 suffixPolyLength = 0;
+            dtResult = m_navMeshQuery->findPath(
+                           suffixStartPoly,    // start polygon
+                           endPoly,            // end polygon
+                           suffixEndPoint,     // start position
+                           endPoint,           // end position
+                           &m_filter,            // polygon search filter
+                           m_pathPolyRefs + prefixPolyLength - 1,    // [out] path
+                           (int*)&suffixPolyLength,
+                           MAX_PATH_LENGTH - prefixPolyLength); // max number of polygons in output path
+
+            if (!suffixPolyLength || dtStatusFailed(dtResult))
+            {
+                // this is probably an error state, but we'll leave it
+                // and hopefully recover on the next Update
+                // we still need to copy our preffix
+                sLog.outError("%u's Path Build failed: 0 length path", m_sourceGuidLow);
+            }
 
-        DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n", m_polyLength, prefixPolyLength, suffixPolyLength);
+            DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n", m_polyLength, prefixPolyLength, suffixPolyLength);
 
-        // new path = prefix + suffix - overlap
-        m_polyLength = prefixPolyLength + suffixPolyLength - 1;
+            // new path = prefix + suffix - overlap
+            m_polyLength = prefixPolyLength + suffixPolyLength - 1;
+        }
     }
     else
     {
@@ -375,23 +456,50 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         // free and invalidate old path data
         clear();
 
-        dtResult = m_navMeshQuery->findPath(
-                       startPoly,          // start polygon
-                       endPoly,            // end polygon
-                       startPoint,         // start position
-                       endPoint,           // end position
-                       &m_filter,           // polygon search filter
-                       m_pathPolyRefs,     // [out] path
-                       (int*)&m_polyLength,
-                       MAX_PATH_LENGTH);   // max number of polygons in output path
+        // another path between these polygons may have been searched recently
+        uint16 includeFlags = m_filter.getIncludeFlags();
+        uint16 excludeFlags = m_filter.getExcludeFlags();
+        if (m_pathCache)
+            m_polyLength = m_pathCache->Lookup(startPoly, endPoly, includeFlags, excludeFlags, m_pathPolyRefs);
 
-        if (!m_polyLength || dtStatusFailed(dtResult))
+        // tiles on the way may have been reloaded since
+        for (uint32 i = 0; i < m_polyLength; ++i)
         {
-            // only happens if we passed bad data to findPath(), or navmesh is messed up
-            sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
-            BuildShortcut();
-            m_type = PATHFIND_NOPATH;
-            return;
+            if (!m_navMesh->isValidPolyRef(m_pathPolyRefs[i]))
+            {
+                m_polyLength = 0;
+                break;
+            }
+        }
+
+        if (m_polyLength)
+            ++GetStatistics().cacheHits;
+        else
+        {
+            ++GetStatistics().cacheMisses;
+
+            dtResult = m_navMeshQuery->findPath(
+                           startPoly,          // start polygon
+                           endPoly,            // end polygon
+                           startPoint,         // start position
+                           endPoint,           // end position
+                           &m_filter,           // polygon search filter
+                           m_pathPolyRefs,     // [out] path
+                           (int*)&m_polyLength,
+                           MAX_PATH_LENGTH);   // max number of polygons in output path
+
+            if (!m_polyLength || dtStatusFailed(dtResult))
+            {
+                // only happens if we passed bad data to findPath(), or navmesh is messed up
+                sLog.outError("%u's Path Build failed: 0 length path", m_sourceGuidLow);
+                BuildShortcut();
+                m_type = PATHFIND_NOPATH;
+                return;
+            }
+
+            // partial corridors depend on the start and end position, not only on the polygons
+            if (m_pathCache && m_pathPolyRefs[m_polyLength - 1] == endPoly)
+                m_pathCache->Store(startPoly, endPoly, includeFlags, excludeFlags, m_pathPolyRefs, m_polyLength);
         }
     }
 
@@ -548,6 +656,13 @@ void PathFinder::NormalizePath()
     if (!sWorld.getConfig(CONFIG_BOOL_PATH_FIND_NORMALIZE_Z))
         return;
 
+    // the owner can only be used from its map update, done by finish()
+    if (isPending())
+    {
+        m_normalizeNeeded = true;
+        return;
+    }
+
     for (uint32 i = 0; i < m_pathPoints.size(); ++i)
         m_sourceUnit->UpdateAllowedPositionZ(m_pathPoints[i].x, m_pathPoints[i].y, m_pathPoints[i].z);
 }
@@ -648,6 +763,67 @@ bool PathFinder::HaveTile(const Vector3& p) const
     return (m_navMesh->getTileAt(tx, ty, 0) != nullptr); // Don't use layer so always set to 0
 }
 
+bool PathFinder::isUnderWater(bool atEnd) const
+{
+    if (m_underWater[atEnd] < 0)
+    {
+        Vector3 const& p = atEnd ? m_endPosition : m_startPosition;
+        m_underWater[atEnd] = m_sourceUnit->GetTerrain()->IsUnderWater(p.x, p.y, p.z) ? 1 : 0;
+    }
+
+    return m_underWater[atEnd] > 0;
+}
+
+bool PathFinder::RepairCorridorEnd(const float* endPoint, dtPolyRef endPoly)
+{
+    // same as dtPathCorridor::moveTargetPosition, starting from where the old corridor ends closest to the target
+    dtPolyRef lastPoly = m_pathPolyRefs[m_polyLength - 1];
+    float lastPoint[VERTEX_SIZE];
+    if (dtStatusFailed(m_navMeshQuery->closestPointOnPoly(lastPoly, endPoint, lastPoint, nullptr)))
+        return false;                                       // off-mesh connection
+
+    if (dtVdistSqr(lastPoint, endPoint) > CORRIDOR_REPAIR_DIST * CORRIDOR_REPAIR_DIST)
+        return false;
+
+    const static uint32 MAX_VISIT_POLY = 16;
+    dtPolyRef visited[MAX_VISIT_POLY];
+    uint32 nvisited = 0;
+    float result[VERTEX_SIZE];
+    if (dtStatusFailed(m_navMeshQuery->moveAlongSurface(lastPoly, lastPoint, endPoint, &m_filter, result, visited, (int*)&nvisited, MAX_VISIT_POLY)))
+        return false;
+
+    // blocked by a wall on the way, or the target is on another level
+    if (!nvisited || visited[nvisited - 1] != endPoly || dtVdist2DSqr(result, endPoint) > SMOOTH_PATH_SLOP * SMOOTH_PATH_SLOP)
+        return false;
+
+    // cut the corridor at its first polygon which was visited, backtracking targets shorten it
+    int32 furthestPath = -1;
+    int32 furthestVisited = -1;
+    for (uint32 i = 0; i < m_polyLength && furthestPath < 0; ++i)
+    {
+        for (int32 j = nvisited - 1; j >= 0; --j)
+        {
+            if (m_pathPolyRefs[i] == visited[j])
+            {
+                furthestPath = i;
+                furthestVisited = j;
+            }
+        }
+    }
+
+    // lastPoly is always visited first
+    MANGOS_ASSERT(furthestPath >= 0);
+
+    uint32 pathPos = furthestPath + 1;
+    uint32 visitedPos = furthestVisited + 1;
+    if (pathPos + (nvisited - visitedPos) > MAX_PATH_LENGTH)
+        return false;
+
+    memcpy(m_pathPolyRefs + pathPos, visited + visitedPos, (nvisited - visitedPos) * sizeof(dtPolyRef));
+    m_polyLength = pathPos + nvisited - visitedPos;
+    return true;
+}
+
 uint32 PathFinder::fixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited)
 {
     int32 furthestPath = -1;
@@ -26,6 +26,8 @@
 
 #include "Movement/MoveSplineInitArgs.h"
 
+#include <atomic>
+
 using Movement::Vector3;
 using Movement::PointsArray;
 
@@ -48,6 +50,9 @@ class Unit;
 #define VERTEX_SIZE             3
 #define INVALID_POLYREF         0
 
+// targets moving less than this only get the end of their corridor patched
+#define CORRIDOR_REPAIR_DIST    8.0f
+
 enum PathType
 {
     PATHFIND_BLANK          = 0x0000,   // path not built yet
@@ -59,8 +64,26 @@ enum PathType
     PATHFIND_SHORT          = 0x0020,   // path is longer or equal to its limited path length
 };
 
+/// Counters of all path finders, times in microseconds
+struct PathFindStatistics
+{
+    PathFindStatistics() : calls(0), built(0), cacheHits(0), cacheMisses(0), repairs(0), polys(0), buildTime(0) {}
+
+    std::atomic<uint64> calls;                              // paths asked for
+    std::atomic<uint64> built;                              // paths built on the navmesh
+    std::atomic<uint64> cacheHits;                          // corridors taken from the path cache
+    std::atomic<uint64> cacheMisses;                        // corridors searched with findPath
+    std::atomic<uint64> repairs;                            // corridors whose end was patched after a small target move
+    std::atomic<uint64> polys;                              // length of the corridors of built paths
+    std::atomic<uint64> buildTime;                          // time spent building paths
+};
+
+class PathCache;
+
 class PathFinder
 {
+        friend class PathFinderService;
+
     public:
         PathFinder(Unit const* owner);
         ~PathFinder();
@@ -69,6 +92,11 @@ class PathFinder
         // return: true if new path was calculated, false otherwise (no change needed)
         bool calculate(float destX, float destY, float destZ, bool forceDest = false);
 
+        // path is being built by a path finder thread, see PathFinderService::Calculate
+        // nothing else may be used until it is done and finish() was called
+        bool isPending() const { return m_pending.load(std::memory_order_acquire); }
+        void finish();
+
         // option setters - use optional
         void setUseStrightPath(bool useStraightPath) { m_useStraightPath = useStraightPath; };
         void setPathLengthLimit(float distance) { m_pointPathLimit = std::min<uint32>(uint32(distance / SMOOTH_PATH_STEP_SIZE), MAX_POINT_PATH_LENGTH); };
@@ -81,7 +109,15 @@ class PathFinder
         PointsArray& getPath() { return m_pathPoints; }
         PathType getPathType() const { return m_type; }
 
+        static PathFindStatistics& GetStatistics();
+
     private:
+        enum PrepareResult
+        {
+            PREPARE_INVALID,                                // invalid positions, nothing changed
+            PREPARE_DONE,                                   // path was made without the navmesh
+            PREPARE_BUILD,                                  // BuildPolyPath has to be called
+        };
 
         dtPolyRef      m_pathPolyRefs[MAX_PATH_LENGTH];   // array of detour polygon references
         uint32         m_polyLength;                      // number of polygons in the path
@@ -100,9 +136,21 @@ class PathFinder
         const Unit* const       m_sourceUnit;       // the unit that is moving
         const dtNavMesh*        m_navMesh;          // the nav mesh
         const dtNavMeshQuery*   m_navMeshQuery;     // the nav mesh query used to find the path
+        PathCache*              m_pathCache;        // corridors found on the nav mesh
 
         dtQueryFilter m_filter;                     // use single filter for all movements, update it when needed
 
+        // state of the owner BuildPolyPath depends on, taken in prepare as the path may be built on another thread
+        uint32         m_sourceGuidLow;
+        uint32         m_mapId;
+        bool           m_sourceIsCreature;
+        bool           m_sourceCanSwim;
+        bool           m_sourceCanFly;
+        mutable int8   m_underWater[2];    // start and end position, -1 if not looked up yet
+
+        std::atomic<bool> m_pending;       // being built by a path finder thread
+        bool           m_normalizeNeeded;  // NormalizePath was skipped while pending
+
         void setStartPosition(const Vector3& point) { m_startPosition = point; }
         void setEndPosition(const Vector3& point) { m_actualEndPosition = point; m_endPosition = point; }
         void setActualEndPosition(const Vector3& point) { m_actualEndPosition = point; }
@@ -121,8 +169,13 @@ class PathFinder
         dtPolyRef getPathPolyByPosition(const dtPolyRef* polyPath, uint32 polyPathSize, const float* point, float* distance = nullptr) const;
         dtPolyRef getPolyByLocation(const float* point, float* distance) const;
         bool HaveTile(const Vector3& p) const;
+        bool isUnderWater(bool atEnd) const;
+
+        PrepareResult prepare(float destX, float destY, float destZ, bool forceDest, bool async);
 
+        void Build();
         void BuildPolyPath(const Vector3& startPos, const Vector3& endPos);
+        bool RepairCorridorEnd(const float* endPoint, dtPolyRef endPoly);
         void BuildPointPath(const float* startPoint, const float* endPoint);
         void BuildShortcut();
 
@@ -0,0 +1,184 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MotionGenerators/PathFinderService.h"
+#include "MotionGenerators/PathFinder.h"
+#include "MotionGenerators/MoveMap.h"
+#include "Log.h"
+
+PathFinderService::PathFinderService() : m_cancel(false)
+{
+}
+
+PathFinderService::~PathFinderService()
+{
+    Deactivate();
+}
+
+void PathFinderService::Activate(uint32 numThreads)
+{
+    Deactivate();
+
+    if (numThreads > MMAP_MAX_QUERY_THREADS)
+    {
+        sLog.outError("Path finder: %u threads requested, only %u supported", numThreads, MMAP_MAX_QUERY_THREADS);
+        numThreads = MMAP_MAX_QUERY_THREADS;
+    }
+
+    m_cancel = false;
+    for (uint32 i = 0; i < numThreads; ++i)
+        m_workerThreads.push_back(std::thread(&PathFinderService::WorkerThread, this, i));
+
+    sLog.outString("Path finder: %u threads started", numThreads);
+}
+
+void PathFinderService::Deactivate()
+{
+    if (m_workerThreads.empty())
+        return;
+
+    std::deque<PathRequest> dropped;
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        m_cancel = true;
+        dropped.swap(m_queue);
+    }
+    m_queueCondition.notify_all();
+
+    for (std::vector<std::thread>::iterator itr = m_workerThreads.begin(); itr != m_workerThreads.end(); ++itr)
+        itr->join();
+
+    m_workerThreads.clear();
+
+    // movement generators still waiting get the old straight line
+    for (std::deque<PathRequest>::const_iterator itr = dropped.begin(); itr != dropped.end(); ++itr)
+    {
+        itr->path->BuildShortcut();
+        itr->path->m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+        itr->path->m_pending.store(false, std::memory_order_release);
+    }
+}
+
+bool PathFinderService::Calculate(std::shared_ptr<PathFinder> const& path, float destX, float destY, float destZ, bool forceDest)
+{
+    MANGOS_ASSERT(!path->isPending());
+
+    if (!IsActive())
+    {
+        path->calculate(destX, destY, destZ, forceDest);
+        return true;
+    }
+
+    if (path->prepare(destX, destY, destZ, forceDest, true) != PathFinder::PREPARE_BUILD)
+        return true;
+
+    path->m_pending.store(true, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> guard(m_queueLock);
+        m_queue.push_back(PathRequest(path));
+    }
+    m_queueCondition.notify_one();
+
+    ++GetStatistics().requested;
+    return false;
+}
+
+PathFinderStatistics& PathFinderService::GetStatistics()
+{
+    static PathFinderStatistics statistics;
+    return statistics;
+}
+
+void PathFinderService::WorkerThread(uint32 index)
+{
+    NavMeshQueryMap queries;
+
+    for (;;)
+    {
+        std::unique_lock<std::mutex> guard(m_queueLock);
+        m_queueCondition.wait(guard, [this] { return m_cancel || !m_queue.empty(); });
+
+        if (m_cancel)
+            break;
+
+        PathRequest request = m_queue.front();
+        m_queue.pop_front();
+        guard.unlock();
+
+        ProcessRequest(request, queries, index);
+    }
+
+    // queries only reference their navmesh, nothing to lock for freeing them
+    for (NavMeshQueryMap::iterator itr = queries.begin(); itr != queries.end(); ++itr)
+        dtFreeNavMeshQuery(itr->second.query);
+}
+
+void PathFinderService::ProcessRequest(PathRequest const& request, NavMeshQueryMap& queries, uint32 index)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    PathFinder& path = *request.path;
+    bool built = false;
+
+    {
+        MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+        std::lock_guard<std::mutex> guard(mmap->GetQueryThreadLock(index));
+
+        // the navmesh of the map may have been unloaded since the path was queued
+        dtNavMesh const* navMesh = mmap->GetNavMesh(path.m_mapId);
+        if (navMesh && navMesh == path.m_navMesh)
+        {
+            NavMeshQuery& query = queries[path.m_mapId];
+            if (query.navMesh != navMesh)
+            {
+                if (!query.query)
+                    query.query = dtAllocNavMeshQuery();
+                MANGOS_ASSERT(query.query);
+
+                query.navMesh = dtStatusSucceed(query.query->init(navMesh, 1024)) ? navMesh : nullptr;
+            }
+
+            if (query.navMesh)
+            {
+                // the query of the instance belongs to the map update, use the one of this thread meanwhile
+                dtNavMeshQuery const* instanceQuery = path.m_navMeshQuery;
+                path.m_navMeshQuery = query.query;
+                path.Build();
+                path.m_navMeshQuery = instanceQuery;
+                built = true;
+            }
+        }
+    }
+
+    PathFinderStatistics& statistics = GetStatistics();
+    if (built)
+    {
+        ++statistics.built;
+        statistics.waitTime += std::chrono::duration_cast<std::chrono::microseconds>(start - request.queueTime).count();
+        statistics.buildTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    else
+    {
+        ++statistics.dropped;
+        path.BuildShortcut();
+        path.m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+    }
+
+    path.m_pending.store(false, std::memory_order_release);
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PATHFINDERSERVICE_H
+#define MANGOS_PATHFINDERSERVICE_H
+
+#include "Common.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class PathFinder;
+class dtNavMesh;
+class dtNavMeshQuery;
+
+/// Counters of the path finder threads, times in microseconds
+struct PathFinderStatistics
+{
+    PathFinderStatistics() : requested(0), built(0), dropped(0), waitTime(0), buildTime(0) {}
+
+    std::atomic<uint64> requested;                          // paths queued for the path finder threads
+    std::atomic<uint64> built;                              // paths built by the path finder threads
+    std::atomic<uint64> dropped;                            // paths whose navmesh was unloaded before they were built
+    std::atomic<uint64> waitTime;                           // time paths spent in the queue
+    std::atomic<uint64> buildTime;                          // time spent building paths
+};
+
+/**
+ * Pool of threads building movement paths out of the map updates.
+ *
+ * The map update takes everything the path depends on from the moving unit and queues the
+ * PathFinder here, a path finder thread builds it with a dtNavMeshQuery of its own for the map
+ * and the movement generator picks the result up on its next update. Each thread holds its
+ * MMapManager query lock while building, so tiles cannot be changed below it.
+ */
+class PathFinderService
+{
+    public:
+        PathFinderService();
+        ~PathFinderService();
+
+        void Activate(uint32 numThreads);
+        void Deactivate();
+        bool IsActive() const { return !m_workerThreads.empty(); }
+        uint32 GetThreadCount() const { return m_workerThreads.size(); }
+
+        // map update threads only, same as PathFinder::calculate when no path finder thread runs
+        // return: true if the path is ready, false if it was queued and is pending
+        bool Calculate(std::shared_ptr<PathFinder> const& path, float destX, float destY, float destZ, bool forceDest = false);
+
+        static PathFinderStatistics& GetStatistics();
+
+    private:
+        struct PathRequest
+        {
+            PathRequest(std::shared_ptr<PathFinder> const& _path) : path(_path), queueTime(std::chrono::steady_clock::now()) {}
+
+            std::shared_ptr<PathFinder> path;
+            std::chrono::steady_clock::time_point queueTime;
+        };
+
+        // per thread query of each map, rebound when the navmesh of the map was reloaded
+        struct NavMeshQuery
+        {
+            NavMeshQuery() : navMesh(nullptr), query(nullptr) {}
+
+            dtNavMesh const* navMesh;
+            dtNavMeshQuery* query;
+        };
+        typedef std::unordered_map<uint32, NavMeshQuery> NavMeshQueryMap;
+
+        PathFinderService(PathFinderService const&);
+        PathFinderService& operator=(PathFinderService const&);
+
+        void WorkerThread(uint32 index);
+        void ProcessRequest(PathRequest const& request, NavMeshQueryMap& queries, uint32 index);
+
+        std::vector<std::thread> m_workerThreads;
+
+        std::mutex m_queueLock;
+        std::condition_variable m_queueCondition;
+        std::deque<PathRequest> m_queue;
+        bool m_cancel;
+};
+
+#endif
@@ -18,6 +18,7 @@
 
 #include "MotionGenerators/TargetedMovementGenerator.h"
 #include "MotionGenerators/PathFinder.h"
+#include "Maps/MapManager.h"
 #include "Entities/Unit.h"
 #include "Entities/Creature.h"
 #include "Entities/Player.h"
@@ -35,6 +36,16 @@ void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T& owner, bool up
     if (owner.hasUnitState(UNIT_STAT_NOT_MOVE))
         return;
 
+    // only one path is built at a time, the newest destination is asked for when it arrived
+    if (i_path && i_path->isPending())
+    {
+        i_repath = true;
+        return;
+    }
+
+    // a finished path not picked up yet is replaced by the new one
+    i_waitingForPath = false;
+
     float x, y, z;
 
     // i_path can be nullptr in case this is the first call for this MMGen (via Update)
@@ -70,14 +81,48 @@ void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T& owner, bool up
     }
 
     if (!i_path)
-        i_path = new PathFinder(&owner);
+        i_path = std::make_shared<PathFinder>(&owner);
 
     // allow pets following their master to cheat while generating paths
     bool forceDest = (owner.GetTypeId() == TYPEID_UNIT && ((Creature*)&owner)->IsPet()
                       && owner.hasUnitState(UNIT_STAT_FOLLOW));
-    i_path->calculate(x, y, z, forceDest);
+    if (sMapMgr.GetPathFinderService().Calculate(i_path, x, y, z, forceDest))
+    {
+        _launchPath(owner);
+        return;
+    }
+
+    i_waitingForPath = true;
+    i_repath = false;
+
+    // keep following the old path meanwhile, or go straight when standing
+    if (!owner.movespline->Finalized() || !i_reachable)
+        return;
+
+    D::_addUnitStateMove(owner);
+    i_targetReached = false;
+    i_movingStraight = true;
+
+    Movement::MoveSplineInit init(owner);
+    init.MoveTo(x, y, z);
+    init.SetWalk(((D*)this)->EnableWalking());
+    init.Launch();
+}
+
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T, D>::_launchPath(T& owner)
+{
+    bool movingStraight = i_movingStraight;
+    i_movingStraight = false;
+    i_reachable = (i_path->getPathType() & PATHFIND_NORMAL) != 0;
+
     if (i_path->getPathType() & PATHFIND_NOPATH)
+    {
+        // the straight line was only a guess
+        if (movingStraight)
+            owner.StopMoving();
         return;
+    }
 
     D::_addUnitStateMove(owner);
     i_targetReached = false;
@@ -125,6 +170,20 @@ bool TargetedMovementGeneratorMedium<T, D>::Update(T& owner, const uint32& time_
         return true;
     }
 
+    // the path finder threads are done with i_path
+    if (i_waitingForPath && !i_path->isPending())
+    {
+        i_waitingForPath = false;
+        i_path->finish();
+        _launchPath(owner);
+
+        if (i_repath)
+        {
+            i_repath = false;
+            _setTargetLocation(owner, true);
+        }
+    }
+
     bool targetMoved = false;
     i_recheckDistance.Update(time_diff);
     if (i_recheckDistance.Passed())
@@ -154,7 +213,7 @@ bool TargetedMovementGeneratorMedium<T, D>::Update(T& owner, const uint32& time_
 template<class T, typename D>
 bool TargetedMovementGeneratorMedium<T, D>::IsReachable() const
 {
-    return (i_path) ? (i_path->getPathType() & PATHFIND_NORMAL) : true;
+    return i_reachable;
 }
 
 template<class T, typename D>
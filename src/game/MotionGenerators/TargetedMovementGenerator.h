@@ -22,6 +22,8 @@
 #include "MotionGenerators/MovementGenerator.h"
 #include "MotionGenerators/FollowerReference.h"
 
+#include <memory>
+
 class PathFinder;
 
 class TargetedMovementGeneratorBase
@@ -43,10 +45,10 @@ class TargetedMovementGeneratorMedium
             i_recheckDistance(0),
             i_offset(offset), i_angle(angle),
             m_speedChanged(false), i_targetReached(false),
-            i_path(nullptr)
+            i_waitingForPath(false), i_repath(false), i_movingStraight(false), i_reachable(true)
         {
         }
-        ~TargetedMovementGeneratorMedium() { delete i_path; }
+        ~TargetedMovementGeneratorMedium() {}
 
     public:
         bool Update(T&, const uint32&);
@@ -59,6 +61,7 @@ class TargetedMovementGeneratorMedium
 
     protected:
         void _setTargetLocation(T&, bool updateDestination);
+        void _launchPath(T&);
         bool RequiresNewPosition(T& owner, float x, float y, float z) const;
         virtual float GetDynamicTargetDistance(T& /*owner*/, bool /*forRangeCheck*/) const { return i_offset; }
 
@@ -67,8 +70,13 @@ class TargetedMovementGeneratorMedium
         float i_angle;
         bool m_speedChanged : 1;
         bool i_targetReached : 1;
+        bool i_waitingForPath : 1;                          // i_path was queued on the path finder threads
+        bool i_repath : 1;                                  // destination changed while waiting for i_path
+        bool i_movingStraight : 1;                          // moving straight to the destination until i_path arrives
+        bool i_reachable : 1;
 
-        PathFinder* i_path;
+        // shared with the path finder thread building it
+        std::shared_ptr<PathFinder> i_path;
 };
 
 template<class T>
@@ -93,7 +93,8 @@ WorldSession::WorldSession(uint32 id, WorldSocket* sock, AccountTypes sec, uint8
     _player(nullptr), m_Socket(sock ? sock->shared<WorldSocket>() : nullptr), _security(sec), _accountId(id), m_expansion(expansion), _logoutTime(0),
     m_inQueue(false), m_playerLoading(false), m_playerLogout(false), m_playerRecentlyLogout(false), m_playerSave(false),
     m_sessionDbcLocale(sWorld.GetAvailableDbcLocale(locale)), m_sessionDbLocaleIndex(sObjectMgr.GetIndexForLocale(locale)),
-    m_latency(0), m_clientTimeDelay(0), m_tutorialState(TUTORIALDATA_UNCHANGED)
+    m_latency(0), m_clientTimeDelay(0), m_tutorialState(TUTORIALDATA_UNCHANGED),
+    m_recvQueue(sWorld.getConfig(CONFIG_UINT32_NETWORK_RECV_QUEUE_SIZE)), m_recvBatchPos(0), m_recvQueuePeak(0), m_recvThrottleCount(0)
 {}
 
 /// WorldSession destructor
@@ -121,8 +122,8 @@ char const* WorldSession::GetPlayerName() const
     return GetPlayer() ? GetPlayer()->GetName() : "<none>";
 }
 
-/// Send a packet to the client
-void WorldSession::SendPacket(WorldPacket const& packet) const
+/// Common checks before a packet is handed to the socket, false if it must not be sent
+bool WorldSession::CanSendPacket(WorldPacket const& packet) const
 {
 #ifdef BUILD_PLAYERBOT
     // Send packet to bot AI
@@ -135,11 +136,11 @@ void WorldSession::SendPacket(WorldPacket const& packet) const
     }
     
     if (!m_Socket)
-        return;
+        return false;
 #endif
 
     if (m_Socket->IsClosed())
-        return;
+        return false;
 
 #ifdef MANGOS_DEBUG
 
@@ -177,14 +178,27 @@ void WorldSession::SendPacket(WorldPacket const& packet) const
 
 #endif                                                  // !MANGOS_DEBUG
 
-    m_Socket->SendPacket(packet);
+    return true;
+}
+
+/// Send a packet to the client
+void WorldSession::SendPacket(WorldPacket const& packet) const
+{
+    if (CanSendPacket(packet))
+        m_Socket->SendPacket(packet);
+}
+
+/// Send a finished packet to the client, its content is moved to the socket instead of copied where possible
+void WorldSession::SendPacket(WorldPacket&& packet) const
+{
+    if (CanSendPacket(packet))
+        m_Socket->SendPacket(std::move(packet));
 }
 
 /// Add an incoming packet to the queue
-void WorldSession::QueuePacket(std::unique_ptr<WorldPacket> new_packet)
+bool WorldSession::QueuePacket(std::unique_ptr<WorldPacket> new_packet)
 {
-    std::lock_guard<std::mutex> guard(m_recvQueueLock);
-    m_recvQueue.push_back(std::move(new_packet));
+    return m_recvQueue.Push(std::move(new_packet));
 }
 /// Logging helper for unexpected opcodes
 void WorldSession::LogUnexpectedOpcode(WorldPacket const& packet, const char* reason) const
@@ -207,14 +221,46 @@ void WorldSession::LogUnprocessedTail(WorldPacket const& packet) const
 /// Update the WorldSession (triggered by World update)
 bool WorldSession::Update(PacketFilter& updater)
 {
-    std::lock_guard<std::mutex> guard(m_recvQueueLock);
+    ///- Take the packets received so far in one batch, packets arriving meanwhile wait for the next update
+    const uint32 queued = uint32(m_recvQueue.Size());
+    if (queued > m_recvQueuePeak)
+        m_recvQueuePeak = queued;
+
+    // a batch the filter stopped is finished first, so the packets keep their order
+    if (m_recvBatchPos == m_recvBatch.size())
+    {
+        m_recvBatch.clear();
+        m_recvBatchPos = 0;
+        m_recvQueue.PopBatch(m_recvBatch, m_recvQueue.Capacity());
+    }
+
+    // the socket stops reading when the queue gets too long, continue now that it has room again
+    if (m_Socket && m_Socket->IsReadSuspended())
+        m_Socket->ResumeRead();
+
+#ifdef BUILD_PLAYERBOT
+    // the bot manager is not thread safe, master packets of the map update are passed to it here first
+    if (updater.ProcessLogout() && !m_masterPacketsForBots.empty())
+    {
+        if (_player && _player->GetPlayerbotMgr())
+            for (std::vector<WorldPacket>::const_iterator itr = m_masterPacketsForBots.begin(); itr != m_masterPacketsForBots.end(); ++itr)
+                _player->GetPlayerbotMgr()->HandleMasterIncomingPacket(*itr);
+        m_masterPacketsForBots.clear();
+    }
+#endif
 
     ///- Retrieve packets from the receive queue and call the appropriate handlers
     /// not process packets if socket already closed
-    while (m_Socket && !m_Socket->IsClosed() && !m_recvQueue.empty())
+    for (; m_recvBatchPos < m_recvBatch.size(); ++m_recvBatchPos)
     {
-        auto const packet = std::move(m_recvQueue.front());
-        m_recvQueue.pop_front();
+        if (!m_Socket || m_Socket->IsClosed())
+            break;
+
+        std::unique_ptr<WorldPacket> const& packet = m_recvBatch[m_recvBatchPos];
+
+        // a packet for the other update (map or world thread) and all packets behind it wait for that update
+        if (!updater.Process(*packet))
+            break;
 
         /*#if 1
         sLog.outError( "MOEP: %s (0x%.4X)",
@@ -241,7 +287,12 @@ bool WorldSession::Update(PacketFilter& updater)
 
 #ifdef BUILD_PLAYERBOT
                     if (_player && _player->GetPlayerbotMgr())
-                        _player->GetPlayerbotMgr()->HandleMasterIncomingPacket(*packet);
+                    {
+                        if (updater.ProcessLogout())
+                            _player->GetPlayerbotMgr()->HandleMasterIncomingPacket(*packet);
+                        else
+                            m_masterPacketsForBots.push_back(*packet);
+                    }
 #endif
                     break;
                 case STATUS_LOGGEDIN_OR_RECENTLY_LOGGEDOUT:
@@ -318,7 +369,8 @@ bool WorldSession::Update(PacketFilter& updater)
     // The PlayerbotAI class adds to the packet queue to simulate a real player
     // since Playerbots are known to the World obj only by its master's WorldSession object
     // we need to process all master's bot's packets.
-    if (GetPlayer() && GetPlayer()->GetPlayerbotMgr()) {
+    // They are not filtered, so they are only handled by the world update, which never runs together with map updates
+    if (updater.ProcessLogout() && GetPlayer() && GetPlayer()->GetPlayerbotMgr()) {
         for (PlayerBotMap::const_iterator itr = GetPlayer()->GetPlayerbotMgr()->GetPlayerBotsBegin();
                 itr != GetPlayer()->GetPlayerbotMgr()->GetPlayerBotsEnd(); ++itr)
         {
@@ -328,15 +380,12 @@ bool WorldSession::Update(PacketFilter& updater)
                 botPlayer->GetPlayerbotAI()->HandleTeleportAck();
             else if (botPlayer->IsInWorld())
             {
-                while(!pBotWorldSession->m_recvQueue.empty())
+                std::unique_ptr<WorldPacket> botpacket;
+                while (pBotWorldSession->m_recvQueue.Pop(botpacket))
                 {
-                    auto const botpacket = std::move(pBotWorldSession->m_recvQueue.front());
-                    pBotWorldSession->m_recvQueue.pop_front();
-
                     OpcodeHandler const& opHandle = opcodeTable[botpacket->GetOpcode()];
                     pBotWorldSession->ExecuteOpcode(opHandle, *botpacket);
-                };
-                pBotWorldSession->m_recvQueue.clear();
+                }
             }
         }
     }
@@ -29,10 +29,12 @@
 #include "AuctionHouse/AuctionHouseMgr.h"
 #include "Entities/Item.h"
 #include "WorldSocket.h"
+#include "MPSCQueue.h"
 
 #include <deque>
 #include <mutex>
 #include <memory>
+#include <vector>
 
 struct ItemPrototype;
 struct AuctionEntry;
@@ -162,6 +164,7 @@ class WorldSession
         void SizeError(WorldPacket const& packet, uint32 size) const;
 
         void SendPacket(WorldPacket const& packet) const;
+        void SendPacket(WorldPacket&& packet) const;
         void SendNotification(const char* format, ...) const ATTR_PRINTF(2, 3);
         void SendNotification(int32 string_id, ...) const;
         void SendPetNameInvalid(uint32 error, const std::string& name, DeclinedName* declinedName) const;
@@ -182,6 +185,8 @@ class WorldSession
 #else
         const std::string GetRemoteAddress() const { return m_Socket->GetRemoteAddress(); }
 #endif
+        /// Queued to sent latency of the packets of this session, null for sessions without connection
+        MaNGOS::LatencyHistogram const* GetSendLatency() const { return m_Socket ? &m_Socket->GetSendLatency() : nullptr; }
         void SetPlayer(Player* plr) { _player = plr; }
         uint8 Expansion() const { return m_expansion; }
 
@@ -206,7 +211,15 @@ class WorldSession
         void LogoutPlayer(bool Save);
         void KickPlayer();
 
-        void QueuePacket(std::unique_ptr<WorldPacket> new_packet);
+        /// Add an incoming packet, may be called from any thread. Returns false if the receive queue is full
+        bool QueuePacket(std::unique_ptr<WorldPacket> new_packet);
+
+        /// Receive queue statistics, the depth is approximate
+        uint32 GetRecvQueueSize() const { return uint32(m_recvQueue.Size()); }
+        uint32 GetRecvQueueCapacity() const { return uint32(m_recvQueue.Capacity()); }
+        uint32 GetRecvQueuePeak() const { return m_recvQueuePeak; }
+        uint32 GetRecvThrottleCount() const { return m_recvThrottleCount; }
+        void AddRecvThrottle() { ++m_recvThrottleCount; }
 
         bool Update(PacketFilter& updater);
 
@@ -749,6 +762,8 @@ class WorldSession
 
         void ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket& packet);
 
+        bool CanSendPacket(WorldPacket const& packet) const;
+
         // logging helper
         void LogUnexpectedOpcode(WorldPacket const& packet, const char* reason) const;
         void LogUnprocessedTail(WorldPacket const& packet) const;
@@ -773,8 +788,17 @@ class WorldSession
         uint32 m_Tutorials[8];
         TutorialDataState m_tutorialState;
 
-        std::mutex m_recvQueueLock;
-        std::deque<std::unique_ptr<WorldPacket>> m_recvQueue;
+        // filled by the network threads (and the bots' AI), drained by Update() which world and map updates never run concurrently for one session
+        MaNGOS::MPSCQueue<std::unique_ptr<WorldPacket>> m_recvQueue;
+        std::vector<std::unique_ptr<WorldPacket>> m_recvBatch;   // taken from m_recvQueue, processed up to m_recvBatchPos
+        size_t m_recvBatchPos;
+        std::atomic<uint32> m_recvQueuePeak;
+        std::atomic<uint32> m_recvThrottleCount;
+
+#ifdef BUILD_PLAYERBOT
+        // packets handled by a map update, the bots only see them on the next world update
+        std::vector<WorldPacket> m_masterPacketsForBots;
+#endif
 };
 #endif
 /// @}
@@ -31,6 +31,7 @@
 #include "Server/WorldSession.h"
 #include "Log.h"
 #include "Server/DBCStores.h"
+#include "Entities/UpdateData.h"
 
 #include <chrono>
 #include <functional>
@@ -59,14 +60,109 @@ WorldSocket::WorldSocket(boost::asio::io_service &service, std::function<void (S
       m_useExistingHeader(false), m_session(nullptr),m_seed(urand())
 {}
 
-void WorldSocket::SendPacket(const WorldPacket& pct, bool immediate)
+WorldSocket::~WorldSocket()
 {
-    if (IsClosed())
-        return;
+}
 
-    // Dump outgoing packet.
-    sLog.outWorldPacketDump(GetRemoteEndpoint().c_str(), pct.GetOpcode(), pct.GetOpcodeName(), pct, false);
+WorldSocket::DeferredPacket::DeferredPacket(WorldPacket* _packet, bool _immediate) : packet(_packet), immediate(_immediate)
+{
+}
 
+// longest time the packet may wait in the output buffer, depending on the opcode class
+static uint32 GetWriteDelay(uint16 opcode)
+{
+    switch (opcode)
+    {
+        case MSG_MOVE_START_FORWARD:
+        case MSG_MOVE_START_BACKWARD:
+        case MSG_MOVE_STOP:
+        case MSG_MOVE_START_STRAFE_LEFT:
+        case MSG_MOVE_START_STRAFE_RIGHT:
+        case MSG_MOVE_STOP_STRAFE:
+        case MSG_MOVE_JUMP:
+        case MSG_MOVE_START_TURN_LEFT:
+        case MSG_MOVE_START_TURN_RIGHT:
+        case MSG_MOVE_STOP_TURN:
+        case MSG_MOVE_START_PITCH_UP:
+        case MSG_MOVE_START_PITCH_DOWN:
+        case MSG_MOVE_STOP_PITCH:
+        case MSG_MOVE_SET_RUN_MODE:
+        case MSG_MOVE_SET_WALK_MODE:
+        case MSG_MOVE_TELEPORT:
+        case MSG_MOVE_TELEPORT_ACK:
+        case MSG_MOVE_FALL_LAND:
+        case MSG_MOVE_START_SWIM:
+        case MSG_MOVE_STOP_SWIM:
+        case MSG_MOVE_SET_FACING:
+        case MSG_MOVE_SET_PITCH:
+        case MSG_MOVE_ROOT:
+        case MSG_MOVE_UNROOT:
+        case MSG_MOVE_HEARTBEAT:
+        case MSG_MOVE_KNOCK_BACK:
+        case MSG_MOVE_HOVER:
+        case MSG_MOVE_FEATHER_FALL:
+        case MSG_MOVE_WATER_WALK:
+        case MSG_MOVE_START_ASCEND:
+        case MSG_MOVE_STOP_ASCEND:
+        case MSG_MOVE_START_DESCEND:
+        case SMSG_MONSTER_MOVE:
+        case SMSG_MONSTER_MOVE_TRANSPORT:
+        case SMSG_MOVE_KNOCK_BACK:
+        case SMSG_FORCE_MOVE_ROOT:
+        case SMSG_FORCE_MOVE_UNROOT:
+        case SMSG_FORCE_RUN_SPEED_CHANGE:
+        case SMSG_FORCE_RUN_BACK_SPEED_CHANGE:
+        case SMSG_FORCE_SWIM_SPEED_CHANGE:
+        case SMSG_FORCE_SWIM_BACK_SPEED_CHANGE:
+        case SMSG_FORCE_WALK_SPEED_CHANGE:
+        case SMSG_FORCE_TURN_RATE_CHANGE:
+        case SMSG_FORCE_FLIGHT_SPEED_CHANGE:
+        case SMSG_FORCE_FLIGHT_BACK_SPEED_CHANGE:
+        case SMSG_SPLINE_SET_RUN_SPEED:
+        case SMSG_SPLINE_SET_RUN_BACK_SPEED:
+        case SMSG_SPLINE_SET_SWIM_SPEED:
+        case SMSG_SPLINE_SET_SWIM_BACK_SPEED:
+        case SMSG_SPLINE_SET_WALK_SPEED:
+        case SMSG_SPLINE_SET_TURN_RATE:
+        case SMSG_SPLINE_SET_FLIGHT_SPEED:
+        case SMSG_SPLINE_SET_FLIGHT_BACK_SPEED:
+        case SMSG_SPLINE_MOVE_ROOT:
+        case SMSG_SPLINE_MOVE_UNROOT:
+            return sWorld.getConfig(CONFIG_UINT32_NETWORK_WRITE_DELAY_MOVEMENT);
+        case SMSG_CAST_RESULT:
+        case SMSG_SPELL_START:
+        case SMSG_SPELL_GO:
+        case SMSG_SPELL_FAILURE:
+        case SMSG_SPELL_FAILED_OTHER:
+        case SMSG_SPELL_DELAYED:
+        case SMSG_SPELL_COOLDOWN:
+        case SMSG_PET_CAST_FAILED:
+        case SMSG_CANCEL_AUTO_REPEAT:
+        case MSG_CHANNEL_START:
+        case MSG_CHANNEL_UPDATE:
+        case SMSG_ATTACKSTART:
+        case SMSG_ATTACKSTOP:
+        case SMSG_ATTACKSWING_NOTINRANGE:
+        case SMSG_ATTACKSWING_BADFACING:
+        case SMSG_ATTACKSWING_NOTSTANDING:
+        case SMSG_ATTACKSWING_DEADTARGET:
+        case SMSG_ATTACKSWING_CANT_ATTACK:
+        case SMSG_ATTACKERSTATEUPDATE:
+        case SMSG_SPELLNONMELEEDAMAGELOG:
+        case SMSG_SPELLHEALLOG:
+        case SMSG_SPELLENERGIZELOG:
+        case SMSG_SPELLLOGMISS:
+        case SMSG_SPELLLOGEXECUTE:
+        case SMSG_PERIODICAURALOG:
+            return sWorld.getConfig(CONFIG_UINT32_NETWORK_WRITE_DELAY_SPELL);
+        default:
+            return sWorld.getConfig(CONFIG_UINT32_NETWORK_WRITE_DELAY_DEFAULT);
+    }
+}
+
+// note that the header must be encrypted in the same order the packets are written to the socket
+static ServerPktHeader MakeServerPktHeader(const WorldPacket& pct, AuthCrypt& crypt)
+{
     ServerPktHeader header;
 
     header.cmd = pct.GetOpcode();
@@ -75,15 +171,109 @@ void WorldSocket::SendPacket(const WorldPacket& pct, bool immediate)
     header.size = static_cast<uint16>(pct.size() + 2);
     EndianConvertReverse(header.size);
 
-    m_crypt.EncryptSend(reinterpret_cast<uint8 *>(&header), sizeof(header));
+    crypt.EncryptSend(reinterpret_cast<uint8 *>(&header), sizeof(header));
+
+    return header;
+}
+
+void WorldSocket::SendPacket(const WorldPacket& pct, bool immediate)
+{
+    if (IsClosed())
+        return;
+
+    // Dump outgoing packet.
+    sLog.outWorldPacketDump(GetRemoteEndpoint().c_str(), pct.GetOpcode(), pct.GetOpcodeName(), pct, false);
+
+    std::lock_guard<std::mutex> guard(m_sendLock);
+
+    if (!m_deferredPackets.empty() || UpdateData::NeedsCompression(pct))
+        DeferPacket(new WorldPacket(pct), immediate);
+    else
+        WritePacket(pct, immediate);
+}
+
+void WorldSocket::SendPacket(WorldPacket&& pct, bool immediate)
+{
+    if (IsClosed())
+        return;
+
+    // Dump outgoing packet.
+    sLog.outWorldPacketDump(GetRemoteEndpoint().c_str(), pct.GetOpcode(), pct.GetOpcodeName(), pct, false);
+
+    std::lock_guard<std::mutex> guard(m_sendLock);
+
+    if (!m_deferredPackets.empty() || UpdateData::NeedsCompression(pct))
+        DeferPacket(new WorldPacket(std::move(pct)), immediate);
+    else
+        WritePacket(std::move(pct), immediate);
+}
+
+void WorldSocket::WritePacket(const WorldPacket& pct, bool immediate)
+{
+    ServerPktHeader header = MakeServerPktHeader(pct, m_crypt);
+    const uint32 maxDelay = immediate ? 0 : GetWriteDelay(pct.GetOpcode());
 
     if (pct.size() > 0)
-        Write(reinterpret_cast<const char *>(&header), sizeof(header), reinterpret_cast<const char *>(pct.contents()), pct.size());
+        Write(reinterpret_cast<const char *>(&header), sizeof(header), reinterpret_cast<const char *>(pct.contents()), pct.size(), maxDelay);
     else
-        Write(reinterpret_cast<const char *>(&header), sizeof(header));
+        Write(reinterpret_cast<const char *>(&header), sizeof(header), maxDelay);
+}
+
+void WorldSocket::WritePacket(WorldPacket&& pct, bool immediate)
+{
+    // small packets are cheaper to copy into the output buffer than to reference
+    if (pct.size() < ZeroCopyPacketSize)
+    {
+        WritePacket(static_cast<const WorldPacket&>(pct), immediate);
+        return;
+    }
+
+    ServerPktHeader header = MakeServerPktHeader(pct, m_crypt);
+    const uint32 maxDelay = immediate ? 0 : GetWriteDelay(pct.GetOpcode());
+
+    // the packet content is sent straight from its own storage, only the header is copied
+    Write(reinterpret_cast<const char *>(&header), sizeof(header), std::make_shared<const WorldPacket>(std::move(pct)), maxDelay);
+}
+
+void WorldSocket::DeferPacket(WorldPacket* pct, bool immediate)
+{
+    m_deferredPackets.push_back(DeferredPacket(pct, immediate));
+
+    // the network thread drains the whole queue, so it only has to be woken for the first packet
+    if (m_deferredPackets.size() > 1)
+        return;
+
+    std::shared_ptr<WorldSocket> ptr = shared<WorldSocket>();
+    boost::asio::post(GetAsioSocket().get_executor(), [ptr]() { ptr->SendDeferredPackets(); });
+}
+
+void WorldSocket::SendDeferredPackets()
+{
+    std::unique_lock<std::mutex> guard(m_sendLock);
+
+    while (!m_deferredPackets.empty())
+    {
+        // new packets are only added at the back, so the reference stays valid while unlocked
+        DeferredPacket& deferred = m_deferredPackets.front();
+        bool valid = true;
+
+        if (UpdateData::NeedsCompression(*deferred.packet))
+        {
+            guard.unlock();
+
+            WorldPacket compressed;
+            valid = UpdateData::CompressPacket(compressed, deferred.packet->contents(), deferred.packet->size());
+            if (valid)
+                *deferred.packet = std::move(compressed);
+
+            guard.lock();
+        }
+
+        if (valid && !IsClosed())
+            WritePacket(std::move(*deferred.packet), deferred.immediate);
 
-    if (immediate)
-        ForceFlushOut();
+        m_deferredPackets.pop_front();
+    }
 }
 
 bool WorldSocket::Open()
@@ -205,7 +395,20 @@ bool WorldSocket::ProcessIncomingData()
                     return false;
                 }
 
-                m_session->QueuePacket(std::move(pct));
+                if (!m_session->QueuePacket(std::move(pct)))
+                {
+                    sLog.outError("WorldSocket::ProcessIncomingData: receive queue of account %u is full (%u packets), disconnecting client %s",
+                                  m_session->GetAccountId(), m_session->GetRecvQueueCapacity(), GetRemoteAddress().c_str());
+                    return false;
+                }
+
+                // stop reading from a client sending faster than its session is updated, the session continues the reads once it has caught up
+                const uint32 throttle = sWorld.getConfig(CONFIG_UINT32_NETWORK_RECV_QUEUE_THROTTLE);
+                if (throttle && m_session->GetRecvQueueSize() >= throttle && !IsReadSuspended())
+                {
+                    m_session->AddRecvThrottle();
+                    SuspendRead();
+                }
 
                 return true;
             }
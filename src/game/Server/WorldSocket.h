@@ -31,7 +31,10 @@
 #include "Network/Socket.hpp"
 
 #include <chrono>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 class WorldPacket;
 class WorldSession;
@@ -98,6 +101,9 @@ class WorldSocket : public MaNGOS::Socket
         /// Keep track of over-speed pings ,to prevent ping flood.
         uint32 m_overSpeedPings;
 
+        /// Packets moved into SendPacket from this size on are referenced instead of copied
+        static const size_t ZeroCopyPacketSize = 1024;
+
         ClientPktHeader m_existingHeader;
         bool m_useExistingHeader;
 
@@ -112,6 +118,28 @@ class WorldSocket : public MaNGOS::Socket
 
         BigNumber m_s;
 
+        struct DeferredPacket
+        {
+            DeferredPacket(WorldPacket* _packet, bool _immediate);  // defined where WorldPacket is complete
+
+            std::unique_ptr<WorldPacket> packet;
+            bool immediate;
+        };
+
+        /// Packets waiting for the network thread to compress them, and all packets sent after them
+        std::deque<DeferredPacket> m_deferredPackets;
+        /// Keeps header encryption in send order while packets are deferred
+        std::mutex m_sendLock;
+
+        /// Encrypt the header and write the packet, the send lock must be held
+        void WritePacket(const WorldPacket& pct, bool immediate);
+        void WritePacket(WorldPacket&& pct, bool immediate);
+
+        /// Queue the packet behind packets waiting for compression, the send lock must be held
+        void DeferPacket(WorldPacket* pct, bool immediate);
+        /// Compress and write deferred packets, runs in the network thread
+        void SendDeferredPackets();
+
         /// process one incoming packet.
         virtual bool ProcessIncomingData() override;
 
@@ -123,9 +151,12 @@ class WorldSocket : public MaNGOS::Socket
 
     public:
         WorldSocket(boost::asio::io_service &service, std::function<void (Socket *)> closeHandler);
+        ~WorldSocket();
 
         // send a packet \o/
         void SendPacket(const WorldPacket& pct, bool immediate = false);
+        // send a finished packet, large ones are queued without copying their content
+        void SendPacket(WorldPacket&& pct, bool immediate = false);
 
         void FinalizeSession() { m_session = nullptr; }
 
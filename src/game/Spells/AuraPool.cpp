@@ -0,0 +1,114 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Spells/AuraPool.h"
+#include "SizeClassPool.h"
+
+#include <new>
+#include <utility>
+
+#define AURA_POOL_GRANULARITY   64                          // bytes between two size classes
+#define AURA_POOL_CLASS_COUNT   16                          // largest pooled object is AURA_POOL_GRANULARITY * AURA_POOL_CLASS_COUNT bytes
+
+namespace AuraPool
+{
+    namespace
+    {
+        // a heap block of a full size class, freed when destroyed
+        struct Block
+        {
+            void* memory;
+
+            Block() : memory(nullptr) {}
+            explicit Block(void* memory) : memory(memory) {}
+            Block(Block&& other) noexcept : memory(other.memory) { other.memory = nullptr; }
+            Block& operator=(Block&& other) noexcept { std::swap(memory, other.memory); return *this; }
+            ~Block() { ::operator delete(memory); }
+        };
+
+        struct BlockTraits
+        {
+            typedef Block Item;
+
+            static const uint32 ClassCount = AURA_POOL_CLASS_COUNT;
+            static const uint32 DefaultThreadCache = 1024;
+            static const size_t DefaultMaxSharedBytes = 16 * 1024 * 1024;
+
+            static size_t GetBytes(Item const& /*block*/, uint32 sizeClass) { return (sizeClass + 1) * AURA_POOL_GRANULARITY; }
+        };
+
+        typedef MaNGOS::SizeClassPool<BlockTraits> BlockPool;
+
+        // size class of size bytes, AURA_POOL_CLASS_COUNT if not pooled
+        uint32 GetSizeClass(size_t size)
+        {
+            uint32 sizeClass = uint32((size + AURA_POOL_GRANULARITY - 1) / AURA_POOL_GRANULARITY);
+            return sizeClass > 0 && sizeClass <= AURA_POOL_CLASS_COUNT ? sizeClass - 1 : AURA_POOL_CLASS_COUNT;
+        }
+    }
+
+    void* Allocate(size_t size)
+    {
+        uint32 sizeClass = GetSizeClass(size);
+        if (sizeClass == AURA_POOL_CLASS_COUNT)
+        {
+            BlockPool::CountUnpooled();
+            return ::operator new(size);
+        }
+
+        // always the full class size, so the block can serve any object of the class later
+        Block block;
+        if (!BlockPool::Take(sizeClass, block))
+            return ::operator new((sizeClass + 1) * AURA_POOL_GRANULARITY);
+
+        void* memory = block.memory;
+        block.memory = nullptr;
+        return memory;
+    }
+
+    void Deallocate(void* ptr, size_t size)
+    {
+        if (!ptr)
+            return;
+
+        uint32 sizeClass = GetSizeClass(size);
+        if (sizeClass == AURA_POOL_CLASS_COUNT)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        Block block(ptr);
+        BlockPool::Give(sizeClass, block);
+    }
+
+    void GetStatistics(AuraPoolStatistics& statistics)
+    {
+        BlockPool::Totals totals;
+        BlockPool::GetTotals(totals);
+
+        statistics = AuraPoolStatistics();
+        for (BlockPool::ClassTotals const& sizeClass : totals.classes)
+        {
+            statistics.hits += sizeClass.hits;
+            statistics.misses += sizeClass.misses;
+            statistics.released += sizeClass.discarded;
+        }
+        statistics.unpooled = totals.unpooled;
+    }
+}
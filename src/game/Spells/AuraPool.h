@@ -0,0 +1,50 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_AURAPOOL_H
+#define MANGOS_AURAPOOL_H
+
+#include "Common.h"
+
+/// Counters of the aura pool, summed over all threads
+struct AuraPoolStatistics
+{
+    uint64 hits;                                            // allocations served from a free list
+    uint64 misses;                                          // allocations taken from the heap
+    uint64 released;                                        // blocks given back to the heap because the pool was full
+    uint64 unpooled;                                        // allocations too large for the pool
+};
+
+/**
+ * Storage of SpellAuraHolder and Aura objects.
+ *
+ * Auras come and go all the time, every buff refresh and debuff tick creates and deletes a few.
+ * Freed objects are kept in a MaNGOS::SizeClassPool of 64 byte size classes and handed out again
+ * by the next allocation of the same class, so applying auras stops going to the heap once a map
+ * update thread has seen its usual amount of auras. Blocks freed by another thread than the one
+ * which allocated them come back through the shared depot of the pool.
+ */
+namespace AuraPool
+{
+    void* Allocate(size_t size);
+    void Deallocate(void* ptr, size_t size);
+
+    void GetStatistics(AuraPoolStatistics& statistics);
+}
+
+#endif
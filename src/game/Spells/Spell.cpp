@@ -682,9 +682,12 @@ void Spell::FillTargetMap()
             }
         }
 
+        // line of sight of many targets is checked in one batch after all other checks
+        WorldObject* losSource = tmpUnitLists[effToIndex[i]].size() > 1 ? GetTargetLoSSource(SpellEffectIndex(i)) : nullptr;
+
         for (UnitList::iterator itr = tmpUnitLists[effToIndex[i]].begin(); itr != tmpUnitLists[effToIndex[i]].end();)
         {
-            if (!CheckTarget(*itr, SpellEffectIndex(i)))
+            if (!CheckTarget(*itr, SpellEffectIndex(i), !losSource))
             {
                 itr = tmpUnitLists[effToIndex[i]].erase(itr);
                 continue;
@@ -693,6 +696,9 @@ void Spell::FillTargetMap()
                 ++itr;
         }
 
+        if (losSource)
+            CheckTargetsLoS(tmpUnitLists[effToIndex[i]], losSource);
+
         if (m_affectedTargetCount && tmpUnitLists[effToIndex[i]].size() > m_affectedTargetCount)
         {
             // remove random units from the map
@@ -6459,7 +6465,72 @@ CurrentSpellTypes Spell::GetCurrentContainer() const
         return (CURRENT_GENERIC_SPELL);
 }
 
-bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff) const
+WorldObject* Spell::GetTargetLoSSource(SpellEffectIndex eff) const
+{
+    // effects with their own line of sight handling in CheckTarget
+    switch (m_spellInfo->Effect[eff])
+    {
+        case SPELL_EFFECT_SUMMON_PLAYER:
+        case SPELL_EFFECT_DUMMY:
+        case SPELL_EFFECT_RESURRECT_NEW:
+            return nullptr;
+        default:
+            break;
+    }
+
+    if (IsIgnoreLosSpell(m_spellInfo))
+        return nullptr;
+
+    if (m_spellInfo->EffectImplicitTargetA[eff] == TARGET_DYNAMIC_OBJECT_COORDINATES)
+        return m_caster->GetDynObject(m_triggeredByAuraSpell ? m_triggeredByAuraSpell->Id : m_spellInfo->Id);
+
+    return GetCastingObject();
+}
+
+void Spell::CheckTargetsLoS(UnitList& targetList, WorldObject* source) const
+{
+    // same rays as WorldObject::IsWithinLOSInMap, traced together
+    std::vector<VMAP::LineOfSightQuery> queries;
+    std::vector<UnitList::iterator> queryTargets;
+    queries.reserve(targetList.size());
+    queryTargets.reserve(targetList.size());
+
+    for (UnitList::iterator itr = targetList.begin(); itr != targetList.end();)
+    {
+        Unit* target = *itr;
+        if (target == m_caster)
+        {
+            ++itr;
+            continue;
+        }
+
+        if (!target->IsInMap(source))
+        {
+            itr = targetList.erase(itr);
+            continue;
+        }
+
+        VMAP::LineOfSightQuery query;
+        target->GetPosition(query.x1, query.y1, query.z1);
+        source->GetPosition(query.x2, query.y2, query.z2);
+        query.z1 += 2.0f;
+        query.z2 += 2.0f;
+        queries.push_back(query);
+        queryTargets.push_back(itr);
+        ++itr;
+    }
+
+    if (queries.empty())
+        return;
+
+    source->GetMap()->IsInLineOfSight(queries.data(), queries.size());
+
+    for (uint32 i = 0; i < queries.size(); ++i)
+        if (!queries[i].result)
+            targetList.erase(queryTargets[i]);
+}
+
+bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff, bool checkLoS) const
 {
     // Check targets for creature type mask and remove not appropriate (skip explicit self target case, maybe need other explicit targets)
     if (m_spellInfo->EffectImplicitTargetA[eff] != TARGET_SELF)
@@ -6543,21 +6614,10 @@ bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff) const
             // all ok by some way or another, skip normal check
             break;
         default:                                            // normal case
-            if (!IsIgnoreLosSpell(m_spellInfo))
-            {
-                if (target != m_caster)
-                {
-                    if (m_spellInfo->EffectImplicitTargetA[eff] == TARGET_DYNAMIC_OBJECT_COORDINATES)
-                    {
-                        if (DynamicObject* dynObj = m_caster->GetDynObject(m_triggeredByAuraSpell ? m_triggeredByAuraSpell->Id : m_spellInfo->Id))
-                            if (!target->IsWithinLOSInMap(dynObj))
-                                return false;
-                    }
-                    else if (WorldObject* caster = GetCastingObject())
-                        if (!target->IsWithinLOSInMap(caster))
-                            return false;
-                }
-            }
+            if (checkLoS && target != m_caster)
+                if (WorldObject* source = GetTargetLoSSource(eff))
+                    if (!target->IsWithinLOSInMap(source))
+                        return false;
             break;
     }
 
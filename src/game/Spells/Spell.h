@@ -440,7 +440,8 @@ class Spell
 
         template<typename T> WorldObject* FindCorpseUsing();
 
-        bool CheckTarget(Unit* target, SpellEffectIndex eff) const;
+        // checkLoS false skips the normal line of sight check, for targets passed to CheckTargetsLoS afterwards
+        bool CheckTarget(Unit* target, SpellEffectIndex eff, bool checkLoS = true) const;
         bool CanAutoCast(Unit* target);
 
         static void SendCastResult(Player* caster, SpellEntry const* spellInfo, uint8 cast_count, SpellCastResult result, bool isPetCastResult = false);
@@ -604,6 +605,8 @@ class Spell
         //*****************************************
         void FillTargetMap();
         void SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList& targetUnitMap);
+        WorldObject* GetTargetLoSSource(SpellEffectIndex eff) const;
+        void CheckTargetsLoS(UnitList& targetList, WorldObject* source) const;
         static void CheckSpellScriptTargets(SQLMultiStorage::SQLMSIteratorBounds<SpellTargetEntry> &bounds, UnitList &tempTargetUnitMap, UnitList &targetUnitMap, SpellEffectIndex effIndex);
 
         void FillAreaTargets(UnitList& targetUnitMap, float radius, SpellNotifyPushType pushType, SpellTargets spellTargets, WorldObject* originalCaster = nullptr);
@@ -753,6 +753,14 @@ void PersistentAreaAura::Update(uint32 diff)
         GetTarget()->RemoveAura(GetId(), GetEffIndex());
 }
 
+void Aura::SetModifierAmount(int32 amount)
+{
+    m_modifier.m_amount = amount;
+
+    if (m_modifier.m_auraname < TOTAL_AURAS)
+        GetTarget()->InvalidateAuraModifierTotals(m_modifier.m_auraname);
+}
+
 void Aura::ApplyModifier(bool apply, bool Real)
 {
     AuraType aura = m_modifier.m_auraname;
@@ -2125,8 +2133,8 @@ void Aura::HandleAuraDummy(bool apply, bool Real)
                     {
                         if (Unit* caster = GetCaster())
                         {
-                            m_modifier.m_amount = caster->SpellHealingBonusDone(target, GetSpellProto(), m_modifier.m_amount, SPELL_DIRECT_DAMAGE);
-                            m_modifier.m_amount = target->SpellHealingBonusTaken(caster, GetSpellProto(), m_modifier.m_amount, SPELL_DIRECT_DAMAGE);
+                            SetModifierAmount(caster->SpellHealingBonusDone(target, GetSpellProto(), m_modifier.m_amount, SPELL_DIRECT_DAMAGE));
+                            SetModifierAmount(target->SpellHealingBonusTaken(caster, GetSpellProto(), m_modifier.m_amount, SPELL_DIRECT_DAMAGE));
                         }
                     }
                     return;
@@ -2566,9 +2574,9 @@ void Aura::HandleAuraDummy(bool apply, bool Real)
                         if (target->GetTypeId() != TYPEID_PLAYER || !((Player*)target)->GetSession()->PlayerLoading())
                         {
                             // Lifebloom ignore stack amount
-                            m_modifier.m_amount /= GetStackAmount();
-                            m_modifier.m_amount = caster->SpellHealingBonusDone(target, GetSpellProto(), m_modifier.m_amount, SPELL_DIRECT_DAMAGE);
-                            m_modifier.m_amount = target->SpellHealingBonusTaken(caster, GetSpellProto(), m_modifier.m_amount, SPELL_DIRECT_DAMAGE);
+                            SetModifierAmount(m_modifier.m_amount / GetStackAmount());
+                            SetModifierAmount(caster->SpellHealingBonusDone(target, GetSpellProto(), m_modifier.m_amount, SPELL_DIRECT_DAMAGE));
+                            SetModifierAmount(target->SpellHealingBonusTaken(caster, GetSpellProto(), m_modifier.m_amount, SPELL_DIRECT_DAMAGE));
                         }
                     }
                 }
@@ -3873,7 +3881,7 @@ void Aura::HandleModThreat(bool apply, bool Real)
     }
 
     if (level_diff > 0)
-        m_modifier.m_amount += multiplier * level_diff;
+        SetModifierAmount(m_modifier.m_amount + multiplier * level_diff);
 
     if (target->GetTypeId() == TYPEID_PLAYER)
         for (int8 x = 0; x < MAX_SPELL_SCHOOL; ++x)
@@ -4300,7 +4308,7 @@ void Aura::HandlePrayerOfMending(bool apply, bool /*Real*/)
     if (apply) // only on initial cast apply SP
         if (const SpellEntry* entry = GetSpellProto())
             if (GetHolder()->GetAuraCharges() == entry->procCharges)
-                m_modifier.m_amount = GetCaster()->SpellHealingBonusDone(GetTarget(), GetSpellProto(), m_modifier.m_amount, HEAL);
+                SetModifierAmount(GetCaster()->SpellHealingBonusDone(GetTarget(), GetSpellProto(), m_modifier.m_amount, HEAL));
 }
 
 void Aura::HandleAuraPeriodicDummy(bool apply, bool Real)
@@ -4363,7 +4371,7 @@ void Aura::HandlePeriodicHeal(bool apply, bool /*Real*/)
         if (!caster)
             return;
 
-        m_modifier.m_amount = caster->SpellHealingBonusDone(target, GetSpellProto(), m_modifier.m_amount, DOT, GetStackAmount());
+        SetModifierAmount(caster->SpellHealingBonusDone(target, GetSpellProto(), m_modifier.m_amount, DOT, GetStackAmount()));
     }
 }
 
@@ -4403,7 +4411,7 @@ void Aura::HandlePeriodicDamage(bool apply, bool Real)
                     int32 mws = caster->GetAttackTime(BASE_ATTACK);
                     float mwb_min = caster->GetWeaponDamageRange(BASE_ATTACK, MINDAMAGE);
                     float mwb_max = caster->GetWeaponDamageRange(BASE_ATTACK, MAXDAMAGE);
-                    m_modifier.m_amount += int32(((mwb_min + mwb_max) / 2 + ap * mws / 14000) * 0.00743f);
+                    SetModifierAmount(m_modifier.m_amount + int32(((mwb_min + mwb_max) / 2 + ap * mws / 14000) * 0.00743f));
                 }
                 break;
             }
@@ -4425,13 +4433,13 @@ void Aura::HandlePeriodicDamage(bool apply, bool Real)
                     {
                         if ((*itr)->GetId() == 34241)
                         {
-                            m_modifier.m_amount += cp * (*itr)->GetModifier()->m_amount;
+                            SetModifierAmount(m_modifier.m_amount + cp * (*itr)->GetModifier()->m_amount);
                             break;
                         }
                     }
 
                     if (cp > 4) cp = 4;
-                    m_modifier.m_amount += int32(caster->GetTotalAttackPowerValue(BASE_ATTACK) * cp / 100);
+                    SetModifierAmount(m_modifier.m_amount + int32(caster->GetTotalAttackPowerValue(BASE_ATTACK) * cp / 100));
                 }
                 break;
             }
@@ -4445,7 +4453,7 @@ void Aura::HandlePeriodicDamage(bool apply, bool Real)
                     // Dmg/tick = $AP*min(0.01*$cp, 0.03) [Like Rip: only the first three CP increase the contribution from AP]
                     uint8 cp = ((Player*)caster)->GetComboPoints();
                     if (cp > 3) cp = 3;
-                    m_modifier.m_amount += int32(caster->GetTotalAttackPowerValue(BASE_ATTACK) * cp / 100);
+                    SetModifierAmount(m_modifier.m_amount + int32(caster->GetTotalAttackPowerValue(BASE_ATTACK) * cp / 100));
                 }
                 break;
             }
@@ -4457,12 +4465,12 @@ void Aura::HandlePeriodicDamage(bool apply, bool Real)
         {
             // SpellDamageBonusDone for magic spells
             if (spellProto->DmgClass == SPELL_DAMAGE_CLASS_NONE || spellProto->DmgClass == SPELL_DAMAGE_CLASS_MAGIC)
-                m_modifier.m_amount = caster->SpellDamageBonusDone(target, GetSpellProto(), m_modifier.m_amount, DOT, GetStackAmount());
+                SetModifierAmount(caster->SpellDamageBonusDone(target, GetSpellProto(), m_modifier.m_amount, DOT, GetStackAmount()));
             // MeleeDamagebonusDone for weapon based spells
             else
             {
                 WeaponAttackType attackType = GetWeaponAttackType(GetSpellProto());
-                m_modifier.m_amount = caster->MeleeDamageBonusDone(target, m_modifier.m_amount, attackType, GetSpellProto(), DOT, GetStackAmount());
+                SetModifierAmount(caster->MeleeDamageBonusDone(target, m_modifier.m_amount, attackType, GetSpellProto(), DOT, GetStackAmount()));
             }
         }
     }
@@ -4504,7 +4512,7 @@ void Aura::HandlePeriodicLeech(bool apply, bool /*Real*/)
         if (!caster)
             return;
 
-        m_modifier.m_amount = caster->SpellDamageBonusDone(GetTarget(), GetSpellProto(), m_modifier.m_amount, DOT, GetStackAmount());
+        SetModifierAmount(caster->SpellDamageBonusDone(GetTarget(), GetSpellProto(), m_modifier.m_amount, DOT, GetStackAmount()));
     }
 }
 
@@ -4530,7 +4538,7 @@ void Aura::HandlePeriodicHealthFunnel(bool apply, bool /*Real*/)
         if (!caster)
             return;
 
-        m_modifier.m_amount = caster->SpellDamageBonusDone(GetTarget(), GetSpellProto(), m_modifier.m_amount, DOT, GetStackAmount());
+        SetModifierAmount(caster->SpellDamageBonusDone(GetTarget(), GetSpellProto(), m_modifier.m_amount, DOT, GetStackAmount()));
     }
 }
 
@@ -5775,7 +5783,7 @@ void Aura::HandleSchoolAbsorb(bool apply, bool Real)
 
             DoneActualBenefit *= caster->CalculateLevelPenalty(spellProto);
 
-            m_modifier.m_amount += (int32)DoneActualBenefit;
+            SetModifierAmount(m_modifier.m_amount + (int32)DoneActualBenefit);
         }
     }
 }
@@ -6562,7 +6570,7 @@ void Aura::PeriodicDummyTick()
                 // Search SPELL_AURA_MOD_POWER_REGEN aura for this spell and add bonus
                 if (Aura* aura = GetHolder()->GetAuraByEffectIndex(SpellEffectIndex(GetEffIndex() - 1)))
                 {
-                    aura->GetModifier()->m_amount = m_modifier.m_amount;
+                    aura->SetModifierAmount(m_modifier.m_amount);
                     ((Player*)target)->UpdateManaRegen();
                     // Disable continue
                     m_isPeriodic = false;
@@ -6594,7 +6602,7 @@ void Aura::PeriodicDummyTick()
                     float regen_pct = 1.20f - 1.1f * mana / max_mana;
                     if (regen_pct > 1.0f) regen_pct = 1.0f;
                     else if (regen_pct < 0.2f) regen_pct = 0.2f;
-                    m_modifier.m_amount = int32(base_regen * regen_pct);
+                    SetModifierAmount(int32(base_regen * regen_pct));
                     ((Player*)target)->UpdateManaRegen();
                     return;
                 }
@@ -6658,7 +6666,7 @@ void Aura::HandleManaShield(bool apply, bool Real)
 
             DoneActualBenefit *= caster->CalculateLevelPenalty(GetSpellProto());
 
-            m_modifier.m_amount += (int32)DoneActualBenefit;
+            SetModifierAmount(m_modifier.m_amount + (int32)DoneActualBenefit);
         }
     }
 }
@@ -6766,7 +6774,7 @@ SpellAuraHolder::SpellAuraHolder(SpellEntry const* spellproto, Unit* target, Wor
     m_spellProto(spellproto), m_triggeredBy(triggeredBy),
     m_target(target), m_castItemGuid(castItem ? castItem->GetObjectGuid() : ObjectGuid()),
     m_auraSlot(MAX_AURAS), m_auraLevel(1),
-    m_procCharges(0), m_stackAmount(1),
+    m_procCharges(0), m_stackAmount(1), m_procIndexFlags(0),
     m_timeCla(1000), m_removeMode(AURA_REMOVE_BY_DEFAULT), m_AuraDRGroup(DIMINISHING_NONE),
     m_permanent(false), m_isRemovedOnShapeLost(true), m_deleted(false),
     m_spellAuraHolderState(SPELLAURAHOLDER_STATE_CREATED), m_skipUpdate(false)
@@ -7120,7 +7128,7 @@ void SpellAuraHolder::SetStackAmount(uint32 stackAmount)
                 if (amount != aur->GetModifier()->m_amount)
                 {
                     aur->ApplyModifier(false, true);
-                    aur->GetModifier()->m_amount = amount;
+                    aur->SetModifierAmount(amount);
                     aur->ApplyModifier(true, true);
                 }
             }
@@ -19,6 +19,7 @@
 #define MANGOS_SPELLAURAS_H
 
 #include "Spells/SpellAuraDefines.h"
+#include "Spells/AuraPool.h"
 #include "Server/DBCEnums.h"
 #include "Entities/ObjectGuid.h"
 
@@ -86,6 +87,9 @@ class SpellAuraHolder
     public:
         SpellAuraHolder(SpellEntry const* spellproto, Unit* target, WorldObject* caster, Item* castItem, SpellEntry const* triggeredBy);
         ~SpellAuraHolder();
+
+        static void* operator new(size_t size) { return AuraPool::Allocate(size); }
+        static void operator delete(void* ptr, size_t size) { AuraPool::Deallocate(ptr, size); }
         Aura* m_auras[MAX_EFFECT_INDEX];
 
         void AddAura(Aura* aura, SpellEffectIndex index);
@@ -171,6 +175,9 @@ class SpellAuraHolder
 
         time_t GetAuraApplyTime() const { return m_applyTime; }
 
+        uint32 GetProcIndexFlags() const { return m_procIndexFlags; }
+        void SetProcIndexFlags(uint32 procFlags) { m_procIndexFlags = procFlags; }
+
         void SetRemoveMode(AuraRemoveMode mode) { m_removeMode = mode; }
         void SetLoadedState(ObjectGuid const& casterGUID, ObjectGuid const& itemGUID, uint32 stackAmount, uint32 charges, int32 maxduration, int32 duration)
         {
@@ -209,6 +216,7 @@ class SpellAuraHolder
         uint8 m_auraLevel;                                  // Aura level (store caster level for correct show level dep amount)
         uint32 m_procCharges;                               // Aura charges (0 for infinite)
         uint32 m_stackAmount;                               // Aura stack amount
+        uint32 m_procIndexFlags;                            // Proc flags the holder is listed under in the target proc index
         int32 m_maxDuration;                                // Max aura duration
         int32 m_duration;                                   // Current time
         int32 m_timeCla;                                    // Timer for power per sec calculation
@@ -397,9 +405,14 @@ class Aura
 
         virtual ~Aura();
 
+        // the size passed to delete is the one of the most derived aura class
+        static void* operator new(size_t size) { return AuraPool::Allocate(size); }
+        static void operator delete(void* ptr, size_t size) { AuraPool::Deallocate(ptr, size); }
+
         void SetModifier(AuraType t, int32 a, uint32 pt, int32 miscValue);
         Modifier*       GetModifier()       { return &m_modifier; }
         Modifier const* GetModifier() const { return &m_modifier; }
+        void SetModifierAmount(int32 amount);               // use instead of writing m_amount while applied, keeps the target's totals right
         int32 GetMiscValue() const { return m_spellAuraHolder->GetSpellProto()->EffectMiscValue[m_effIndex]; }
         int32 GetMiscBValue() const { return m_spellAuraHolder->GetSpellProto()->EffectMiscValueB[m_effIndex]; }
 
@@ -39,7 +39,7 @@ bool IsPrimaryProfessionSkill(uint32 skill)
     return true;
 }
 
-SpellMgr::SpellMgr()
+SpellMgr::SpellMgr() : m_spellProcEventGeneration(0)
 {
 }
 
@@ -778,6 +778,7 @@ struct DoSpellProcEvent
 void SpellMgr::LoadSpellProcEvents()
 {
     mSpellProcEventMap.clear();                             // need for reload case
+    ++m_spellProcEventGeneration;                           // units rebuild their proc index
 
     //                                                0      1           2                3                 4                 5                 6          7       8        9             10
     QueryResult* result = WorldDatabase.Query("SELECT entry, SchoolMask, SpellFamilyName, SpellFamilyMask0, SpellFamilyMask1, SpellFamilyMask2, procFlags, procEx, ppmRate, CustomChance, Cooldown FROM spell_proc_event");
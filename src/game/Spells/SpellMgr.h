@@ -2105,6 +2105,18 @@ class SpellMgr
             return nullptr;
         }
 
+        // proc flags of the spell, spell_proc_event overrides the dbc value
+        uint32 GetSpellProcFlags(SpellEntry const* spellProto) const
+        {
+            SpellProcEventEntry const* spellProcEvent = GetSpellProcEvent(spellProto->Id);
+            if (spellProcEvent && spellProcEvent->procFlags)
+                return spellProcEvent->procFlags;
+            return spellProto->procFlags;
+        }
+
+        // changed at every spell_proc_event (re)load
+        uint32 GetSpellProcEventGeneration() const { return m_spellProcEventGeneration; }
+
         // Spell procs from item enchants
         float GetItemEnchantProcChance(uint32 spellid) const
         {
@@ -2325,6 +2337,7 @@ class SpellMgr
         SpellElixirMap     mSpellElixirs;
         SpellThreatMap     mSpellThreatMap;
         SpellProcEventMap  mSpellProcEventMap;
+        uint32             m_spellProcEventGeneration;
         SpellProcItemEnchantMap mSpellProcItemEnchantMap;
         SpellBonusMap      mSpellBonusMap;
         SkillLineAbilityMap mSkillLineAbilityMap;
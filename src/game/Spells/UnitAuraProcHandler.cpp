@@ -938,7 +938,7 @@ SpellAuraProcResult Unit::HandleDummyAuraProc(Unit* pVictim, uint32 damage, Aura
                 }
 
                 // Damage counting
-                mod->m_amount -= damage;
+                triggeredByAura->SetModifierAmount(mod->m_amount - damage);
                 return SPELL_AURA_PROC_OK;
             }
             // Seed of Corruption (Mobs cast) - no die req
@@ -959,7 +959,7 @@ SpellAuraProcResult Unit::HandleDummyAuraProc(Unit* pVictim, uint32 damage, Aura
                     return SPELL_AURA_PROC_OK;              // no hidden cooldown
                 }
                 // Damage counting
-                mod->m_amount -= damage;
+                triggeredByAura->SetModifierAmount(mod->m_amount - damage);
                 return SPELL_AURA_PROC_OK;
             }
             switch (dummySpell->Id)
@@ -2489,9 +2489,9 @@ SpellAuraProcResult Unit::HandleAttackPowerAttackerBonusAuraProc(Unit* /*pVictim
             {
                 int32 basevalue = triggeredByAura->GetBasePoints();
 
-                triggeredByAura->GetModifier()->m_amount += basevalue / 10;
+                triggeredByAura->SetModifierAmount(triggeredByAura->GetModifier()->m_amount + basevalue / 10);
                 if (triggeredByAura->GetModifier()->m_amount > basevalue * 4)
-                    triggeredByAura->GetModifier()->m_amount = basevalue * 4;
+                    triggeredByAura->SetModifierAmount(basevalue * 4);
             }
             break;
         }
@@ -0,0 +1,191 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "World/StartupLoader.h"
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+#include "ProgressBar.h"
+#include "Timer.h"
+
+#include <thread>
+
+StartupLoader::StartupLoader() : m_finishedTasks(0), m_runStartTime(0), m_runTime(0), m_threadCount(0)
+{
+}
+
+StartupLoader::TaskId StartupLoader::Add(char const* name, TaskFunction const& function, TaskIdList const& dependencies)
+{
+    TaskId id = TaskId(m_tasks.size());
+
+    // only earlier tasks, so the graph has no cycles and the added order is a valid sequential order
+    for (TaskIdList::const_iterator itr = dependencies.begin(); itr != dependencies.end(); ++itr)
+        MANGOS_ASSERT(*itr < id);
+
+    m_tasks.push_back(Task(name, function, dependencies));
+    return id;
+}
+
+StartupLoader::TaskId StartupLoader::AddSequential(char const* name, TaskFunction const& function)
+{
+    TaskIdList dependencies;
+    if (!m_tasks.empty())
+        dependencies.push_back(TaskId(m_tasks.size() - 1));
+
+    return Add(name, function, dependencies);
+}
+
+void StartupLoader::RunTask(Task& task)
+{
+    task.startTime = WorldTimer::getMSTimeDiff(m_runStartTime, WorldTimer::getMSTime());
+    task.function();
+    task.endTime = WorldTimer::getMSTimeDiff(m_runStartTime, WorldTimer::getMSTime());
+}
+
+void StartupLoader::Run(uint32 numThreads)
+{
+    m_runStartTime = WorldTimer::getMSTime();
+    m_threadCount = std::max(numThreads, uint32(1));
+
+    if (m_threadCount == 1)
+    {
+        for (std::vector<Task>::iterator itr = m_tasks.begin(); itr != m_tasks.end(); ++itr)
+            RunTask(*itr);
+    }
+    else
+    {
+        m_finishedTasks = 0;
+        m_readyTasks.clear();
+        for (TaskId id = 0; id < m_tasks.size(); ++id)
+        {
+            Task& task = m_tasks[id];
+            task.pendingDependencies = uint32(task.dependencies.size());
+            for (TaskIdList::const_iterator itr = task.dependencies.begin(); itr != task.dependencies.end(); ++itr)
+                m_tasks[*itr].dependents.push_back(id);
+
+            if (!task.pendingDependencies)
+                m_readyTasks.insert(id);
+        }
+
+        // the bars of tasks running at the same time would be drawn over each other
+        bool showProgressBars = BarGoLink::GetOutputState();
+        BarGoLink::SetOutputState(false);
+
+        std::vector<std::thread> workerThreads;
+        for (uint32 i = 0; i < m_threadCount; ++i)
+            workerThreads.push_back(std::thread(&StartupLoader::WorkerThread, this));
+
+        for (std::vector<std::thread>::iterator itr = workerThreads.begin(); itr != workerThreads.end(); ++itr)
+            itr->join();
+
+        BarGoLink::SetOutputState(showProgressBars);
+    }
+
+    m_runTime = WorldTimer::getMSTimeDiff(m_runStartTime, WorldTimer::getMSTime());
+}
+
+void StartupLoader::WorkerThread()
+{
+    WorldDatabase.ThreadStart();                            // one call covers all databases of the thread
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (m_finishedTasks < m_tasks.size())
+    {
+        if (m_readyTasks.empty())
+        {
+            m_taskFinished.wait(lock);
+            continue;
+        }
+
+        TaskId id = *m_readyTasks.begin();
+        m_readyTasks.erase(m_readyTasks.begin());
+
+        lock.unlock();
+        RunTask(m_tasks[id]);
+        lock.lock();
+
+        ++m_finishedTasks;
+        TaskIdList const& dependents = m_tasks[id].dependents;
+        for (TaskIdList::const_iterator itr = dependents.begin(); itr != dependents.end(); ++itr)
+            if (--m_tasks[*itr].pendingDependencies == 0)
+                m_readyTasks.insert(*itr);
+
+        m_taskFinished.notify_all();
+    }
+    lock.unlock();
+
+    WorldDatabase.ThreadEnd();
+}
+
+void StartupLoader::LogTimings() const
+{
+    if (m_tasks.empty())
+        return;
+
+    uint32 totalTaskTime = 0;
+    TaskId last = 0;
+    for (TaskId id = 0; id < m_tasks.size(); ++id)
+    {
+        Task const& task = m_tasks[id];
+        totalTaskTime += task.endTime - task.startTime;
+        if (task.endTime >= m_tasks[last].endTime)
+            last = id;
+
+        DETAIL_LOG("Startup task '%s': started after %u ms, took %u ms", task.name, task.startTime, task.endTime - task.startTime);
+    }
+
+    sLog.outString(">> Loaded world data in %u ms with %u thread(s), the loaders took %u ms together", m_runTime, m_threadCount, totalTaskTime);
+
+    // walk back from the task finishing last, always through the dependency finishing last
+    TaskIdList criticalPath;
+    for (TaskId id = last;;)
+    {
+        criticalPath.push_back(id);
+
+        Task const& task = m_tasks[id];
+        if (task.dependencies.empty())
+            break;
+
+        TaskId latest = task.dependencies.front();
+        for (TaskIdList::const_iterator itr = task.dependencies.begin(); itr != task.dependencies.end(); ++itr)
+            if (m_tasks[*itr].endTime > m_tasks[latest].endTime)
+                latest = *itr;
+        id = latest;
+    }
+
+    // tasks below 1% of the total are only counted
+    uint32 minTime = m_runTime / 100;
+    uint32 shortTasks = 0;
+    uint32 shortTime = 0;
+    sLog.outString(">> Critical path (%u tasks):", uint32(criticalPath.size()));
+    for (TaskIdList::const_reverse_iterator itr = criticalPath.rbegin(); itr != criticalPath.rend(); ++itr)
+    {
+        Task const& task = m_tasks[*itr];
+        uint32 taskTime = task.endTime - task.startTime;
+        if (taskTime < minTime)
+        {
+            ++shortTasks;
+            shortTime += taskTime;
+            continue;
+        }
+
+        sLog.outString("   %6u ms  %s", taskTime, task.name);
+    }
+    if (shortTasks)
+        sLog.outString("   %6u ms  %u shorter tasks", shortTime, shortTasks);
+    sLog.outString();
+}
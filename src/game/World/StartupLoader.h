@@ -0,0 +1,85 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_STARTUPLOADER_H
+#define MANGOS_STARTUPLOADER_H
+
+#include "Common.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <vector>
+
+/**
+ * Graph of the data loaders run by World::SetInitialWorldSettings.
+ *
+ * Every task names the earlier tasks whose data it needs. With one thread the tasks run in
+ * the order they were added. With more threads a task starts as soon as all the tasks it
+ * needs are done, the lowest ready task first. Tasks without declared dependencies must not
+ * touch data of any task that can run at the same time.
+ * After the run the time of every task and the chain of tasks which decided the total time
+ * are logged.
+ */
+class StartupLoader
+{
+    public:
+        typedef uint32 TaskId;
+        typedef std::function<void()> TaskFunction;
+        typedef std::vector<TaskId> TaskIdList;
+
+        StartupLoader();
+
+        TaskId Add(char const* name, TaskFunction const& function, TaskIdList const& dependencies = TaskIdList());
+        // the task depends on the task added before it
+        TaskId AddSequential(char const* name, TaskFunction const& function);
+
+        void Run(uint32 numThreads);
+        void LogTimings() const;
+
+    private:
+        struct Task
+        {
+            Task(char const* _name, TaskFunction const& _function, TaskIdList const& _dependencies)
+                : name(_name), function(_function), dependencies(_dependencies), pendingDependencies(0), startTime(0), endTime(0) {}
+
+            char const* name;
+            TaskFunction function;
+            TaskIdList dependencies;
+            TaskIdList dependents;
+            uint32 pendingDependencies;
+            uint32 startTime;                               // ms since the start of Run
+            uint32 endTime;
+        };
+
+        void RunTask(Task& task);
+        void WorkerThread();
+
+        std::vector<Task> m_tasks;
+        std::set<TaskId> m_readyTasks;
+        uint32 m_finishedTasks;
+        uint32 m_runStartTime;
+        uint32 m_runTime;
+        uint32 m_threadCount;
+
+        std::mutex m_lock;
+        std::condition_variable m_taskFinished;
+};
+
+#endif
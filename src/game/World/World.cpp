@@ -54,6 +54,7 @@
 #include "GameEvents/GameEventMgr.h"
 #include "Pools/PoolManager.h"
 #include "Database/DatabaseImpl.h"
+#include "Database/SQLStorageSnapshot.h"
 #include "Grids/GridNotifiersImpl.h"
 #include "Grids/CellImpl.h"
 #include "Maps/MapPersistentStateMgr.h"
@@ -64,6 +65,7 @@
 #include "Tools/CharacterDatabaseCleaner.h"
 #include "Entities/CreatureLinkingMgr.h"
 #include "Weather/Weather.h"
+#include "World/StartupLoader.h"
 
 #include <algorithm>
 #include <mutex>
@@ -451,9 +453,11 @@ void World::LoadConfigSettings(bool reload)
 
     ///- Read other configuration items from the config file
     setConfigMinMax(CONFIG_UINT32_COMPRESSION, "Compression", 1, 1, 9);
+    setConfig(CONFIG_UINT32_COMPRESSION_OFFLOAD_SIZE, "Compression.OffloadSize", 0);
     setConfig(CONFIG_BOOL_ADDON_CHANNEL, "AddonChannel", true);
     setConfig(CONFIG_BOOL_CLEAN_CHARACTER_DB, "CleanCharacterDB", true);
     setConfig(CONFIG_BOOL_GRID_UNLOAD, "GridUnload", true);
+    setConfig(CONFIG_BOOL_GRIDMAP_MEMORY_MAPPED, "GridMap.MemoryMapped", true);
     setConfig(CONFIG_UINT32_MAX_WHOLIST_RETURNS, "MaxWhoListReturns", 49);
 
     std::string forceLoadGridOnMaps = sConfig.GetStringDefault("LoadAllGridsOnMaps");
@@ -478,6 +482,15 @@ void World::LoadConfigSettings(bool reload)
     if (reload)
         sMapMgr.SetMapUpdateInterval(getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
 
+    if (configNoReload(reload, CONFIG_UINT32_MAPUPDATE_THREADS, "MapUpdateThreads", 1))
+        setConfigMinMax(CONFIG_UINT32_MAPUPDATE_THREADS, "MapUpdateThreads", 1, 1, 64);
+
+    if (configNoReload(reload, CONFIG_UINT32_GRID_PRELOAD_THREADS, "GridPreload.Threads", 1))
+        setConfigMinMax(CONFIG_UINT32_GRID_PRELOAD_THREADS, "GridPreload.Threads", 1, 0, 16);
+    setConfigPos(CONFIG_FLOAT_GRID_PRELOAD_DISTANCE, "GridPreload.Distance", 250.0f);
+
+    setConfigMinMax(CONFIG_UINT32_STARTUP_LOAD_THREADS, "StartupLoad.Threads", 1, 1, 16);
+
     setConfig(CONFIG_UINT32_INTERVAL_CHANGEWEATHER, "ChangeWeatherInterval", 10 * MINUTE * IN_MILLISECONDS);
 
     if (configNoReload(reload, CONFIG_UINT32_PORT_WORLD, "WorldServerPort", DEFAULT_WORLDSERVER_PORT))
@@ -695,6 +708,14 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_OFFHAND_CHECK_AT_TALENTS_RESET, "OffhandCheckAtTalentsReset", false);
 
     setConfig(CONFIG_BOOL_KICK_PLAYER_ON_BAD_PACKET, "Network.KickOnBadPacket", false);
+    setConfigMinMax(CONFIG_UINT32_NETWORK_WRITE_DELAY_MOVEMENT, "Network.WriteDelay.Movement", 0, 0, 1000);
+    setConfigMinMax(CONFIG_UINT32_NETWORK_WRITE_DELAY_SPELL, "Network.WriteDelay.Spell", 0, 0, 1000);
+    setConfigMinMax(CONFIG_UINT32_NETWORK_WRITE_DELAY_DEFAULT, "Network.WriteDelay.Default", 50, 0, 1000);
+    setConfigMinMax(CONFIG_UINT32_NETWORK_RECV_QUEUE_SIZE, "Network.RecvQueue.Size", 1024, 64, 65536);
+    setConfigMin(CONFIG_UINT32_NETWORK_RECV_QUEUE_THROTTLE, "Network.RecvQueue.Throttle", 256, 0);
+    setConfigMinMax(CONFIG_UINT32_PACKET_POOL_THREAD_CACHE, "PacketPool.ThreadCache", 64, 0, 4096);
+    setConfig(CONFIG_UINT32_PACKET_POOL_SHARED_SIZE, "PacketPool.SharedSize", 16384);
+    MaNGOS::ByteBufferPool::Configure(getConfig(CONFIG_UINT32_PACKET_POOL_THREAD_CACHE), size_t(getConfig(CONFIG_UINT32_PACKET_POOL_SHARED_SIZE)) * 1024);
 
     setConfig(CONFIG_BOOL_PLAYER_COMMANDS, "PlayerCommands", true);
 
@@ -807,7 +828,15 @@ void World::LoadConfigSettings(bool reload)
         sLog.outString("Using DataDir %s", m_dataPath.c_str());
     }
 
+    ///- Read the directory of the world database snapshots, empty disables them
+    std::string snapshotPath = sConfig.GetStringDefault("SnapshotDir", "");
+    SQLStorageSnapshot::SetDirectory(snapshotPath);
+    if (!snapshotPath.empty())
+        sLog.outString("Using SnapshotDir %s", snapshotPath.c_str());
+
     setConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK, "vmap.enableIndoorCheck", true);
+    setConfig(CONFIG_UINT32_VMAP_LOS_CACHE_SIZE, "vmap.losCache.Size", 1024);
+    setConfig(CONFIG_UINT32_VMAP_LOS_CACHE_EXPIRY, "vmap.losCache.Expiry", 2000);
     bool enableLOS = sConfig.GetBoolDefault("vmap.enableLOS", false);
     bool enableHeight = sConfig.GetBoolDefault("vmap.enableHeight", false);
     std::string ignoreSpellIds = sConfig.GetStringDefault("vmap.ignoreSpellIds");
@@ -829,6 +858,11 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_BOOL_PATH_FIND_OPTIMIZE, "PathFinder.OptimizePath", true);
     setConfig(CONFIG_BOOL_PATH_FIND_NORMALIZE_Z, "PathFinder.NormalizeZ", false);
+    if (configNoReload(reload, CONFIG_UINT32_PATH_FIND_THREADS, "PathFinder.Threads", 1))
+        setConfigMinMax(CONFIG_UINT32_PATH_FIND_THREADS, "PathFinder.Threads", 1, 0, MMAP_MAX_QUERY_THREADS);
+    setConfig(CONFIG_UINT32_PATH_FIND_CACHE_SIZE, "PathFinder.CacheSize", 256);
+    setConfig(CONFIG_UINT32_MMAP_TILE_EXPIRY, "mmap.tileExpiry", 600);
+    setConfig(CONFIG_UINT32_MMAP_MAX_TILES, "mmap.maxLoadedTiles", 0);
 
     sLog.outString();
 }
@@ -922,311 +956,526 @@ void World::SetInitialWorldSettings()
     sObjectMgr.SetHighestGuids();                           // must be after PackInstances() and PackGroupIds()
     sLog.outString();
 
-    sLog.outString("Loading Page Texts...");
-    sObjectMgr.LoadPageTexts();
-
-    sLog.outString("Loading Game Object Templates...");     // must be after LoadPageTexts
-    sObjectMgr.LoadGameobjectInfo();
-
-    sLog.outString("Loading GameObject models...");
-    LoadGameObjectModelList();
-    sLog.outString();
-
-    sLog.outString("Loading Spell Chain Data...");
-    sSpellMgr.LoadSpellChains();
-
-    sLog.outString("Loading Spell Elixir types...");
-    sSpellMgr.LoadSpellElixirs();
-
-    sLog.outString("Loading Spell Learn Skills...");
-    sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
-
-    sLog.outString("Loading Spell Learn Spells...");
-    sSpellMgr.LoadSpellLearnSpells();
-
-    sLog.outString("Loading Spell Proc Event conditions...");
-    sSpellMgr.LoadSpellProcEvents();
-
-    sLog.outString("Loading Spell Bonus Data...");
-    sSpellMgr.LoadSpellBonuses();
-
-    sLog.outString("Loading Spell Proc Item Enchant...");
-    sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
-
-    sLog.outString("Loading Aggro Spells Definitions...");
-    sSpellMgr.LoadSpellThreats();
-
-    sLog.outString("Loading NPC Texts...");
-    sObjectMgr.LoadGossipText();
-
-    sLog.outString("Loading Item Random Enchantments Table...");
-    LoadRandomEnchantmentsTable();
-
-    sLog.outString("Loading Item Templates...");            // must be after LoadRandomEnchantmentsTable and LoadPageTexts
-    sObjectMgr.LoadItemPrototypes();
-
-    sLog.outString("Loading Item Texts...");
-    sObjectMgr.LoadItemTexts();
-
-    sLog.outString("Loading Creature Model Based Info Data...");
-    sObjectMgr.LoadCreatureModelInfo();
-
-    sLog.outString("Loading Equipment templates...");
-    sObjectMgr.LoadEquipmentTemplates();
-
-    sLog.outString("Loading Creature Stats...");
-    sObjectMgr.LoadCreatureClassLvlStats();
-
-    sLog.outString("Loading Creature templates...");
-    sObjectMgr.LoadCreatureTemplates();
-
-    sLog.outString("Loading Creature template spells...");
-    sObjectMgr.LoadCreatureTemplateSpells();
-
-    sLog.outString("Loading Creature Model for race...");   // must be after creature templates
-    sObjectMgr.LoadCreatureModelRace();
-
-    sLog.outString("Loading SpellsScriptTarget...");
-    sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates and LoadGameobjectInfo
-
-    sLog.outString("Loading ItemRequiredTarget...");
-    sObjectMgr.LoadItemRequiredTarget();
-
-    sLog.outString("Loading Reputation Reward Rates...");
-    sObjectMgr.LoadReputationRewardRate();
-
-    sLog.outString("Loading Creature Reputation OnKill Data...");
-    sObjectMgr.LoadReputationOnKill();
-
-    sLog.outString("Loading Reputation Spillover Data...");
-    sObjectMgr.LoadReputationSpilloverTemplate();
-
-    sLog.outString("Loading Points Of Interest Data...");
-    sObjectMgr.LoadPointsOfInterest();
-
-    sLog.outString("Loading Pet Create Spells...");
-    sObjectMgr.LoadPetCreateSpells();
-
-    sLog.outString("Loading Creature Data...");
-    sObjectMgr.LoadCreatures();
-
-    sLog.outString("Loading Creature Addon Data...");
-    sObjectMgr.LoadCreatureAddons();                        // must be after LoadCreatureTemplates() and LoadCreatures()
-    sLog.outString(">>> Creature Addon Data loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Gameobject Data...");
-    sObjectMgr.LoadGameObjects();
-
-    sLog.outString("Loading CreatureLinking Data...");      // must be after Creatures
-    sCreatureLinkingMgr.LoadFromDB();
-
-    sLog.outString("Loading Objects Pooling Data...");
-    sPoolMgr.LoadFromDB();
-
-    sLog.outString("Loading Weather Data...");
-    sWeatherMgr.LoadWeatherZoneChances();
-
-    sLog.outString("Loading Quests...");
-    sObjectMgr.LoadQuests();                                // must be loaded after DBCs, creature_template, item_template, gameobject tables
-
-    sLog.outString("Loading Quests Relations...");
-    sObjectMgr.LoadQuestRelations();                        // must be after quest load
-    sLog.outString(">>> Quests Relations loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Game Event Data...");           // must be after sPoolMgr.LoadFromDB and quests to properly load pool events and quests for events
-    sGameEventMgr.LoadFromDB();
-    sLog.outString(">>> Game Event Data loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Dungeon Encounters...");
-    sObjectMgr.LoadDungeonEncounters();                     // Load DungeonEncounter.dbc from DB
-
-    sLog.outString("Loading Conditions...");                // Load Conditions
-    sObjectMgr.LoadConditions();
-
-    sLog.outString("Creating map persistent states for non-instanceable maps...");     // must be after PackInstances(), LoadCreatures(), sPoolMgr.LoadFromDB(), sGameEventMgr.LoadFromDB();
-    sMapPersistentStateMgr.InitWorldMaps();
-    sLog.outString();
-
-    sLog.outString("Loading Creature Respawn Data...");     // must be after LoadCreatures(), and sMapPersistentStateMgr.InitWorldMaps()
-    sMapPersistentStateMgr.LoadCreatureRespawnTimes();
-
-    sLog.outString("Loading Gameobject Respawn Data...");   // must be after LoadGameObjects(), and sMapPersistentStateMgr.InitWorldMaps()
-    sMapPersistentStateMgr.LoadGameobjectRespawnTimes();
-
-    sLog.outString("Loading SpellArea Data...");            // must be after quest load
-    sSpellMgr.LoadSpellAreas();
-
-    sLog.outString("Loading AreaTrigger definitions...");
-    sObjectMgr.LoadAreaTriggerTeleports();                  // must be after item template load
-
-    sLog.outString("Loading Quest Area Triggers...");
-    sObjectMgr.LoadQuestAreaTriggers();                     // must be after LoadQuests
-
-    sLog.outString("Loading Tavern Area Triggers...");
-    sObjectMgr.LoadTavernAreaTriggers();
-
-    sLog.outString("Loading AreaTrigger script names...");
-    sScriptDevAIMgr.LoadAreaTriggerScripts();
-
-    sLog.outString("Loading event id script names...");
-    sScriptDevAIMgr.LoadEventIdScripts();
-
-    sLog.outString("Loading Graveyard-zone links...");
-    sObjectMgr.LoadGraveyardZones();
-
-    sLog.outString("Loading spell target destination coordinates...");
-    sSpellMgr.LoadSpellTargetPositions();
-
-    sLog.outString("Loading SpellAffect definitions...");
-    sSpellMgr.LoadSpellAffects();
-
-    sLog.outString("Loading spell pet auras...");
-    sSpellMgr.LoadSpellPetAuras();
-
-    sLog.outString("Loading Player Create Info & Level Stats...");
-    sObjectMgr.LoadPlayerInfo();
-    sLog.outString(">>> Player Create Info & Level Stats loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Exploration BaseXP Data...");
-    sObjectMgr.LoadExplorationBaseXP();
-
-    sLog.outString("Loading Pet Name Parts...");
-    sObjectMgr.LoadPetNames();
-
-    CharacterDatabaseCleaner::CleanDatabase();
-    sLog.outString();
-
-    sLog.outString("Loading the max pet number...");
-    sObjectMgr.LoadPetNumber();
-
-    sLog.outString("Loading pet level stats...");
-    sObjectMgr.LoadPetLevelInfo();
-
-    sLog.outString("Loading Player Corpses...");
-    sObjectMgr.LoadCorpses();
-
-    sLog.outString("Loading Player level dependent mail rewards...");
-    sObjectMgr.LoadMailLevelRewards();
-
-    sLog.outString("Loading Loot Tables...");
-    LoadLootTables();
-    sLog.outString(">>> Loot Tables loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Skill Discovery Table...");
-    LoadSkillDiscoveryTable();
-
-    sLog.outString("Loading Skill Extra Item Table...");
-    LoadSkillExtraItemTable();
-
-    sLog.outString("Loading Skill Fishing base level requirements...");
-    sObjectMgr.LoadFishingBaseSkillLevel();
-
-    sLog.outString("Loading Instance encounters data...");  // must be after Creature loading
-    sObjectMgr.LoadInstanceEncounters();
-
-    sLog.outString("Loading Npc Text Id...");
-    sObjectMgr.LoadNpcGossips();                            // must be after load Creature and LoadGossipText
-
-    sLog.outString("Loading Scripts random templates...");  // must be before String calls
-    sScriptMgr.LoadDbScriptRandomTemplates();
-                                                            ///- Load and initialize DBScripts Engine
-    sLog.outString("Loading DB-Scripts Engine...");
-    sScriptMgr.LoadRelayScripts();                          // must be first in dbscripts loading
-    sScriptMgr.LoadGossipScripts();                         // must be before gossip menu options
-    sScriptMgr.LoadQuestStartScripts();                     // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
-    sScriptMgr.LoadQuestEndScripts();                       // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
-    sScriptMgr.LoadSpellScripts();                          // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadGameObjectScripts();                     // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadGameObjectTemplateScripts();             // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadEventScripts();                          // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadCreatureDeathScripts();                  // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadCreatureMovementScripts();               // before loading from creature_movement
-    sLog.outString(">>> Scripts loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Scripts text locales...");      // must be after Load*Scripts calls
-    sScriptMgr.LoadDbScriptStrings();
-
-    sLog.outString("Loading Gossip Menus...");
-    sObjectMgr.LoadGossipMenus();
-
-    sLog.outString("Loading Vendors...");
-    sObjectMgr.LoadVendorTemplates();                       // must be after load ItemTemplate
-    sObjectMgr.LoadVendors();                               // must be after load CreatureTemplate, VendorTemplate, and ItemTemplate
-
-    sLog.outString("Loading Trainers...");
-    sObjectMgr.LoadTrainerTemplates();                      // must be after load CreatureTemplate
-    sObjectMgr.LoadTrainers();                              // must be after load CreatureTemplate, TrainerTemplate
-
-    sLog.outString("Loading Waypoint scripts...");          
-
-    sLog.outString("Loading Waypoints...");
-    sWaypointMgr.Load();
-
-    sLog.outString("Loading ReservedNames...");
-    sObjectMgr.LoadReservedPlayersNames();
-
-    sLog.outString("Loading GameObjects for quests...");
-    sObjectMgr.LoadGameObjectForQuests();
-
-    sLog.outString("Loading BattleMasters...");
-    sBattleGroundMgr.LoadBattleMastersEntry();
-
-    sLog.outString("Loading BattleGround event indexes...");
-    sBattleGroundMgr.LoadBattleEventIndexes();
-
-    sLog.outString("Loading GameTeleports...");
-    sObjectMgr.LoadGameTele();
-
-    ///- Loading localization data
-    sLog.outString("Loading Localization strings...");
-    sObjectMgr.LoadCreatureLocales();                       // must be after CreatureInfo loading
-    sObjectMgr.LoadGameObjectLocales();                     // must be after GameobjectInfo loading
-    sObjectMgr.LoadItemLocales();                           // must be after ItemPrototypes loading
-    sObjectMgr.LoadQuestLocales();                          // must be after QuestTemplates loading
-    sObjectMgr.LoadGossipTextLocales();                     // must be after LoadGossipText
-    sObjectMgr.LoadPageTextLocales();                       // must be after PageText loading
-    sObjectMgr.LoadGossipMenuItemsLocales();                // must be after gossip menu items loading
-    sObjectMgr.LoadPointOfInterestLocales();                // must be after POI loading
-    sLog.outString(">>> Localization strings loaded");
-    sLog.outString();
+    ///- Load the world tables, see StartupLoader for how the dependencies are used
+    StartupLoader loader;
+
+    // templates: independent lanes, the "must be after" rules of the loaders decide the dependencies
+    StartupLoader::TaskId pageTexts = loader.Add("Page Texts", []()
+    {
+        sLog.outString("Loading Page Texts...");
+        sObjectMgr.LoadPageTexts();
+    });
+    StartupLoader::TaskId gameObjectTemplates = loader.Add("Game Object Templates", []()
+    {
+        sLog.outString("Loading Game Object Templates...");     // must be after LoadPageTexts
+        sObjectMgr.LoadGameobjectInfo();
+    }, { pageTexts });
+    StartupLoader::TaskId gameObjectModels = loader.Add("GameObject models", []()
+    {
+        sLog.outString("Loading GameObject models...");
+        LoadGameObjectModelList();
+        sLog.outString();
+    });
+    StartupLoader::TaskId spellChains = loader.Add("Spell Chain Data", []()
+    {
+        sLog.outString("Loading Spell Chain Data...");
+        sSpellMgr.LoadSpellChains();
+    });
+    loader.AddSequential("Spell Elixir types", []()
+    {
+        sLog.outString("Loading Spell Elixir types...");
+        sSpellMgr.LoadSpellElixirs();
+    });
+    loader.AddSequential("Spell Learn Skills", []()
+    {
+        sLog.outString("Loading Spell Learn Skills...");
+        sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
+    });
+    loader.AddSequential("Spell Learn Spells", []()
+    {
+        sLog.outString("Loading Spell Learn Spells...");
+        sSpellMgr.LoadSpellLearnSpells();
+    });
+    loader.AddSequential("Spell Proc Event conditions", []()
+    {
+        sLog.outString("Loading Spell Proc Event conditions...");
+        sSpellMgr.LoadSpellProcEvents();
+    });
+    loader.AddSequential("Spell Bonus Data", []()
+    {
+        sLog.outString("Loading Spell Bonus Data...");
+        sSpellMgr.LoadSpellBonuses();
+    });
+    loader.AddSequential("Spell Proc Item Enchant", []()
+    {
+        sLog.outString("Loading Spell Proc Item Enchant...");
+        sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
+    });
+    StartupLoader::TaskId spellThreats = loader.AddSequential("Aggro Spells Definitions", []()
+    {
+        sLog.outString("Loading Aggro Spells Definitions...");
+        sSpellMgr.LoadSpellThreats();
+    });
+    StartupLoader::TaskId npcTexts = loader.Add("NPC Texts", []()
+    {
+        sLog.outString("Loading NPC Texts...");
+        sObjectMgr.LoadGossipText();
+    });
+    StartupLoader::TaskId randomEnchantments = loader.Add("Item Random Enchantments Table", []()
+    {
+        sLog.outString("Loading Item Random Enchantments Table...");
+        LoadRandomEnchantmentsTable();
+    });
+    StartupLoader::TaskId itemTemplates = loader.Add("Item Templates", []()
+    {
+        sLog.outString("Loading Item Templates...");            // must be after LoadRandomEnchantmentsTable and LoadPageTexts
+        sObjectMgr.LoadItemPrototypes();
+    }, { randomEnchantments, pageTexts });
+    StartupLoader::TaskId itemTexts = loader.Add("Item Texts", []()
+    {
+        sLog.outString("Loading Item Texts...");
+        sObjectMgr.LoadItemTexts();
+    });
+    StartupLoader::TaskId creatureModelInfo = loader.Add("Creature Model Based Info Data", []()
+    {
+        sLog.outString("Loading Creature Model Based Info Data...");
+        sObjectMgr.LoadCreatureModelInfo();
+    });
+    StartupLoader::TaskId equipmentTemplates = loader.Add("Equipment templates", []()
+    {
+        sLog.outString("Loading Equipment templates...");
+        sObjectMgr.LoadEquipmentTemplates();
+    }, { itemTemplates });
+    StartupLoader::TaskId creatureStats = loader.Add("Creature Stats", []()
+    {
+        sLog.outString("Loading Creature Stats...");
+        sObjectMgr.LoadCreatureClassLvlStats();
+    });
+    StartupLoader::TaskId creatureTemplates = loader.Add("Creature templates", []()
+    {
+        sLog.outString("Loading Creature templates...");
+        sObjectMgr.LoadCreatureTemplates();
+    }, { creatureModelInfo, equipmentTemplates, creatureStats });
+    StartupLoader::TaskId creatureTemplateSpells = loader.Add("Creature template spells", []()
+    {
+        sLog.outString("Loading Creature template spells...");
+        sObjectMgr.LoadCreatureTemplateSpells();
+    }, { creatureTemplates });
+    StartupLoader::TaskId creatureModelRace = loader.Add("Creature Model for race", []()
+    {
+        sLog.outString("Loading Creature Model for race...");   // must be after creature templates
+        sObjectMgr.LoadCreatureModelRace();
+    }, { creatureTemplates });
+
+    // everything else in the old order, the world data is used all over
+    loader.Add("SpellsScriptTarget", []()
+    {
+        sLog.outString("Loading SpellsScriptTarget...");
+        sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates and LoadGameobjectInfo
+    }, { gameObjectTemplates, gameObjectModels, spellThreats, npcTexts, itemTexts, creatureTemplateSpells, creatureModelRace });
+    loader.AddSequential("ItemRequiredTarget", []()
+    {
+        sLog.outString("Loading ItemRequiredTarget...");
+        sObjectMgr.LoadItemRequiredTarget();
+    });
+    loader.AddSequential("Reputation Reward Rates", []()
+    {
+        sLog.outString("Loading Reputation Reward Rates...");
+        sObjectMgr.LoadReputationRewardRate();
+    });
+    loader.AddSequential("Creature Reputation OnKill Data", []()
+    {
+        sLog.outString("Loading Creature Reputation OnKill Data...");
+        sObjectMgr.LoadReputationOnKill();
+    });
+    loader.AddSequential("Reputation Spillover Data", []()
+    {
+        sLog.outString("Loading Reputation Spillover Data...");
+        sObjectMgr.LoadReputationSpilloverTemplate();
+    });
+    loader.AddSequential("Points Of Interest Data", []()
+    {
+        sLog.outString("Loading Points Of Interest Data...");
+        sObjectMgr.LoadPointsOfInterest();
+    });
+    loader.AddSequential("Pet Create Spells", []()
+    {
+        sLog.outString("Loading Pet Create Spells...");
+        sObjectMgr.LoadPetCreateSpells();
+    });
+    loader.AddSequential("Creature Data", []()
+    {
+        sLog.outString("Loading Creature Data...");
+        sObjectMgr.LoadCreatures();
+    });
+    loader.AddSequential("Creature Addon Data", []()
+    {
+        sLog.outString("Loading Creature Addon Data...");
+        sObjectMgr.LoadCreatureAddons();                        // must be after LoadCreatureTemplates() and LoadCreatures()
+        sLog.outString(">>> Creature Addon Data loaded");
+        sLog.outString();
+    });
+    loader.AddSequential("Gameobject Data", []()
+    {
+        sLog.outString("Loading Gameobject Data...");
+        sObjectMgr.LoadGameObjects();
+    });
+    loader.AddSequential("CreatureLinking Data", []()
+    {
+        sLog.outString("Loading CreatureLinking Data...");      // must be after Creatures
+        sCreatureLinkingMgr.LoadFromDB();
+    });
+    loader.AddSequential("Objects Pooling Data", []()
+    {
+        sLog.outString("Loading Objects Pooling Data...");
+        sPoolMgr.LoadFromDB();
+    });
+    loader.AddSequential("Weather Data", []()
+    {
+        sLog.outString("Loading Weather Data...");
+        sWeatherMgr.LoadWeatherZoneChances();
+    });
+    loader.AddSequential("Quests", []()
+    {
+        sLog.outString("Loading Quests...");
+        sObjectMgr.LoadQuests();                                // must be loaded after DBCs, creature_template, item_template, gameobject tables
+    });
+    loader.AddSequential("Quests Relations", []()
+    {
+        sLog.outString("Loading Quests Relations...");
+        sObjectMgr.LoadQuestRelations();                        // must be after quest load
+        sLog.outString(">>> Quests Relations loaded");
+        sLog.outString();
+    });
+    loader.AddSequential("Game Event Data", []()
+    {
+        sLog.outString("Loading Game Event Data...");           // must be after sPoolMgr.LoadFromDB and quests to properly load pool events and quests for events
+        sGameEventMgr.LoadFromDB();
+        sLog.outString(">>> Game Event Data loaded");
+        sLog.outString();
+    });
+    loader.AddSequential("Dungeon Encounters", []()
+    {
+        sLog.outString("Loading Dungeon Encounters...");
+        sObjectMgr.LoadDungeonEncounters();                     // Load DungeonEncounter.dbc from DB
+    });
+    loader.AddSequential("Conditions", []()
+    {
+        sLog.outString("Loading Conditions...");                // Load Conditions
+        sObjectMgr.LoadConditions();
+    });
+    loader.AddSequential("Creating map persistent states for non-instanceable maps", []()
+    {
+        sLog.outString("Creating map persistent states for non-instanceable maps...");     // must be after PackInstances(), LoadCreatures(), sPoolMgr.LoadFromDB(), sGameEventMgr.LoadFromDB();
+        sMapPersistentStateMgr.InitWorldMaps();
+        sLog.outString();
+    });
+    loader.AddSequential("Creature Respawn Data", []()
+    {
+        sLog.outString("Loading Creature Respawn Data...");     // must be after LoadCreatures(), and sMapPersistentStateMgr.InitWorldMaps()
+        sMapPersistentStateMgr.LoadCreatureRespawnTimes();
+    });
+    loader.AddSequential("Gameobject Respawn Data", []()
+    {
+        sLog.outString("Loading Gameobject Respawn Data...");   // must be after LoadGameObjects(), and sMapPersistentStateMgr.InitWorldMaps()
+        sMapPersistentStateMgr.LoadGameobjectRespawnTimes();
+    });
+    loader.AddSequential("SpellArea Data", []()
+    {
+        sLog.outString("Loading SpellArea Data...");            // must be after quest load
+        sSpellMgr.LoadSpellAreas();
+    });
+    loader.AddSequential("AreaTrigger definitions", []()
+    {
+        sLog.outString("Loading AreaTrigger definitions...");
+        sObjectMgr.LoadAreaTriggerTeleports();                  // must be after item template load
+    });
+    loader.AddSequential("Quest Area Triggers", []()
+    {
+        sLog.outString("Loading Quest Area Triggers...");
+        sObjectMgr.LoadQuestAreaTriggers();                     // must be after LoadQuests
+    });
+    loader.AddSequential("Tavern Area Triggers", []()
+    {
+        sLog.outString("Loading Tavern Area Triggers...");
+        sObjectMgr.LoadTavernAreaTriggers();
+    });
+    loader.AddSequential("AreaTrigger script names", []()
+    {
+        sLog.outString("Loading AreaTrigger script names...");
+        sScriptDevAIMgr.LoadAreaTriggerScripts();
+    });
+    loader.AddSequential("event id script names", []()
+    {
+        sLog.outString("Loading event id script names...");
+        sScriptDevAIMgr.LoadEventIdScripts();
+    });
+    loader.AddSequential("Graveyard-zone links", []()
+    {
+        sLog.outString("Loading Graveyard-zone links...");
+        sObjectMgr.LoadGraveyardZones();
+    });
+    loader.AddSequential("spell target destination coordinates", []()
+    {
+        sLog.outString("Loading spell target destination coordinates...");
+        sSpellMgr.LoadSpellTargetPositions();
+    });
+    loader.AddSequential("SpellAffect definitions", []()
+    {
+        sLog.outString("Loading SpellAffect definitions...");
+        sSpellMgr.LoadSpellAffects();
+    });
+    loader.AddSequential("spell pet auras", []()
+    {
+        sLog.outString("Loading spell pet auras...");
+        sSpellMgr.LoadSpellPetAuras();
+    });
+    loader.AddSequential("Player Create Info & Level Stats", []()
+    {
+        sLog.outString("Loading Player Create Info & Level Stats...");
+        sObjectMgr.LoadPlayerInfo();
+        sLog.outString(">>> Player Create Info & Level Stats loaded");
+        sLog.outString();
+    });
+    loader.AddSequential("Exploration BaseXP Data", []()
+    {
+        sLog.outString("Loading Exploration BaseXP Data...");
+        sObjectMgr.LoadExplorationBaseXP();
+    });
+    loader.AddSequential("Pet Name Parts", []()
+    {
+        sLog.outString("Loading Pet Name Parts...");
+        sObjectMgr.LoadPetNames();
+    });
+    loader.AddSequential("Cleaning character database", []()
+    {
+        CharacterDatabaseCleaner::CleanDatabase();
+        sLog.outString();
+    });
+    loader.AddSequential("the max pet number", []()
+    {
+        sLog.outString("Loading the max pet number...");
+        sObjectMgr.LoadPetNumber();
+    });
+    loader.AddSequential("pet level stats", []()
+    {
+        sLog.outString("Loading pet level stats...");
+        sObjectMgr.LoadPetLevelInfo();
+    });
+    loader.AddSequential("Player Corpses", []()
+    {
+        sLog.outString("Loading Player Corpses...");
+        sObjectMgr.LoadCorpses();
+    });
+    StartupLoader::TaskId mailLevelRewards = loader.AddSequential("Player level dependent mail rewards", []()
+    {
+        sLog.outString("Loading Player level dependent mail rewards...");
+        sObjectMgr.LoadMailLevelRewards();
+    });
+
+    // loot is only needed again by the gameobjects for quests
+    StartupLoader::TaskId lootTables = loader.Add("Loot Tables", []()
+    {
+        sLog.outString("Loading Loot Tables...");
+        LoadLootTables();
+        sLog.outString(">>> Loot Tables loaded");
+        sLog.outString();
+    }, { mailLevelRewards });
+    loader.Add("Skill Discovery Table", []()
+    {
+        sLog.outString("Loading Skill Discovery Table...");
+        LoadSkillDiscoveryTable();
+    }, { mailLevelRewards });
+    loader.AddSequential("Skill Extra Item Table", []()
+    {
+        sLog.outString("Loading Skill Extra Item Table...");
+        LoadSkillExtraItemTable();
+    });
+    loader.AddSequential("Skill Fishing base level requirements", []()
+    {
+        sLog.outString("Loading Skill Fishing base level requirements...");
+        sObjectMgr.LoadFishingBaseSkillLevel();
+    });
+    loader.AddSequential("Instance encounters data", []()
+    {
+        sLog.outString("Loading Instance encounters data...");  // must be after Creature loading
+        sObjectMgr.LoadInstanceEncounters();
+    });
+    loader.AddSequential("Npc Text Id", []()
+    {
+        sLog.outString("Loading Npc Text Id...");
+        sObjectMgr.LoadNpcGossips();                            // must be after load Creature and LoadGossipText
+    });
+    loader.AddSequential("Scripts random templates", []()
+    {
+        sLog.outString("Loading Scripts random templates...");  // must be before String calls
+        sScriptMgr.LoadDbScriptRandomTemplates();
+    });
+    loader.AddSequential("DB-Scripts Engine", []()
+    {
+        ///- Load and initialize DBScripts Engine
+        sLog.outString("Loading DB-Scripts Engine...");
+        sScriptMgr.LoadRelayScripts();                          // must be first in dbscripts loading
+        sScriptMgr.LoadGossipScripts();                         // must be before gossip menu options
+        sScriptMgr.LoadQuestStartScripts();                     // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
+        sScriptMgr.LoadQuestEndScripts();                       // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
+        sScriptMgr.LoadSpellScripts();                          // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadGameObjectScripts();                     // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadGameObjectTemplateScripts();             // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadEventScripts();                          // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadCreatureDeathScripts();                  // must be after load Creature/Gameobject(Template/Data)
+        sScriptMgr.LoadCreatureMovementScripts();               // before loading from creature_movement
+        sLog.outString(">>> Scripts loaded");
+        sLog.outString();
+    });
+    loader.AddSequential("Scripts text locales", []()
+    {
+        sLog.outString("Loading Scripts text locales...");      // must be after Load*Scripts calls
+        sScriptMgr.LoadDbScriptStrings();
+    });
+    loader.AddSequential("Gossip Menus", []()
+    {
+        sLog.outString("Loading Gossip Menus...");
+        sObjectMgr.LoadGossipMenus();
+    });
+    loader.AddSequential("Vendors", []()
+    {
+        sLog.outString("Loading Vendors...");
+        sObjectMgr.LoadVendorTemplates();                       // must be after load ItemTemplate
+        sObjectMgr.LoadVendors();                               // must be after load CreatureTemplate, VendorTemplate, and ItemTemplate
+    });
+    loader.AddSequential("Trainers", []()
+    {
+        sLog.outString("Loading Trainers...");
+        sObjectMgr.LoadTrainerTemplates();                      // must be after load CreatureTemplate
+        sObjectMgr.LoadTrainers();                              // must be after load CreatureTemplate, TrainerTemplate
+    });
+    loader.AddSequential("Waypoints", []()
+    {
+        sLog.outString("Loading Waypoints...");
+        sWaypointMgr.Load();
+    });
+    StartupLoader::TaskId reservedNames = loader.AddSequential("ReservedNames", []()
+    {
+        sLog.outString("Loading ReservedNames...");
+        sObjectMgr.LoadReservedPlayersNames();
+    });
+    loader.Add("GameObjects for quests", []()
+    {
+        sLog.outString("Loading GameObjects for quests...");
+        sObjectMgr.LoadGameObjectForQuests();
+    }, { reservedNames, lootTables });
+    loader.AddSequential("BattleMasters", []()
+    {
+        sLog.outString("Loading BattleMasters...");
+        sBattleGroundMgr.LoadBattleMastersEntry();
+    });
+    loader.AddSequential("BattleGround event indexes", []()
+    {
+        sLog.outString("Loading BattleGround event indexes...");
+        sBattleGroundMgr.LoadBattleEventIndexes();
+    });
+    StartupLoader::TaskId gameTeleports = loader.AddSequential("GameTeleports", []()
+    {
+        sLog.outString("Loading GameTeleports...");
+        sObjectMgr.LoadGameTele();
+    });
+
+    ///- Loading localization data, each table only after its base data
+    StartupLoader::TaskId creatureLocales = loader.Add("Creature Locales", []()
+    {
+        sLog.outString("Loading Creature Locales...");
+        sObjectMgr.LoadCreatureLocales();                       // must be after CreatureInfo loading
+    }, { gameTeleports });
+    StartupLoader::TaskId gameObjectLocales = loader.Add("Game Object Locales", []()
+    {
+        sLog.outString("Loading Game Object Locales...");
+        sObjectMgr.LoadGameObjectLocales();                     // must be after GameobjectInfo loading
+    }, { gameTeleports });
+    StartupLoader::TaskId itemLocales = loader.Add("Item Locales", []()
+    {
+        sLog.outString("Loading Item Locales...");
+        sObjectMgr.LoadItemLocales();                           // must be after ItemPrototypes loading
+    }, { gameTeleports });
+    StartupLoader::TaskId questLocales = loader.Add("Quest Locales", []()
+    {
+        sLog.outString("Loading Quest Locales...");
+        sObjectMgr.LoadQuestLocales();                          // must be after QuestTemplates loading
+    }, { gameTeleports });
+    StartupLoader::TaskId gossipTextLocales = loader.Add("Gossip Text Locales", []()
+    {
+        sLog.outString("Loading Gossip Text Locales...");
+        sObjectMgr.LoadGossipTextLocales();                     // must be after LoadGossipText
+    }, { gameTeleports });
+    StartupLoader::TaskId pageTextLocales = loader.Add("Page Text Locales", []()
+    {
+        sLog.outString("Loading Page Text Locales...");
+        sObjectMgr.LoadPageTextLocales();                       // must be after PageText loading
+    }, { gameTeleports });
+    StartupLoader::TaskId gossipMenuItemsLocales = loader.Add("Gossip Menu Items Locales", []()
+    {
+        sLog.outString("Loading Gossip Menu Items Locales...");
+        sObjectMgr.LoadGossipMenuItemsLocales();                // must be after gossip menu items loading
+    }, { gameTeleports });
+    StartupLoader::TaskId pointOfInterestLocales = loader.Add("Point Of Interest Locales", []()
+    {
+        sLog.outString("Loading Point Of Interest Locales...");
+        sObjectMgr.LoadPointOfInterestLocales();                // must be after POI loading
+    }, { gameTeleports });
 
     ///- Load dynamic data tables from the database
-    sLog.outString("Loading Auctions...");
-    sAuctionMgr.LoadAuctionItems();
-    sAuctionMgr.LoadAuctions();
-    sLog.outString(">>> Auctions loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Guilds...");
-    sGuildMgr.LoadGuilds();
-
-    sLog.outString("Loading ArenaTeams...");
-    sObjectMgr.LoadArenaTeams();
-
-    sLog.outString("Loading Groups...");
-    sObjectMgr.LoadGroups();
-
-    sLog.outString("Returning old mails...");
-    sObjectMgr.ReturnOrDeleteOldMails(false);
-
-    sLog.outString("Loading GM tickets...");
-    sTicketMgr.LoadGMTickets();
-
-    ///- Load and initialize EventAI Scripts
-    sLog.outString("Loading CreatureEventAI Texts...");
-    sEventAIMgr.LoadCreatureEventAI_Texts(false);           // false, will checked in LoadCreatureEventAI_Scripts
-
-    sLog.outString("Loading CreatureEventAI Summons...");
-    sEventAIMgr.LoadCreatureEventAI_Summons(false);         // false, will checked in LoadCreatureEventAI_Scripts
-
-    sLog.outString("Loading CreatureEventAI Scripts...");
-    sEventAIMgr.LoadCreatureEventAI_Scripts();
+    loader.Add("Auctions", []()
+    {
+        sLog.outString("Loading Auctions...");
+        sAuctionMgr.LoadAuctionItems();
+        sAuctionMgr.LoadAuctions();
+        sLog.outString(">>> Auctions loaded");
+        sLog.outString();
+    }, { creatureLocales, gameObjectLocales, itemLocales, questLocales, gossipTextLocales, pageTextLocales, gossipMenuItemsLocales, pointOfInterestLocales, lootTables });
+    loader.AddSequential("Guilds", []()
+    {
+        sLog.outString("Loading Guilds...");
+        sGuildMgr.LoadGuilds();
+    });
+    loader.AddSequential("ArenaTeams", []()
+    {
+        sLog.outString("Loading ArenaTeams...");
+        sObjectMgr.LoadArenaTeams();
+    });
+    loader.AddSequential("Groups", []()
+    {
+        sLog.outString("Loading Groups...");
+        sObjectMgr.LoadGroups();
+    });
+    loader.AddSequential("Returning old mails", []()
+    {
+        sLog.outString("Returning old mails...");
+        sObjectMgr.ReturnOrDeleteOldMails(false);
+    });
+    loader.AddSequential("GM tickets", []()
+    {
+        sLog.outString("Loading GM tickets...");
+        sTicketMgr.LoadGMTickets();
+    });
+    loader.AddSequential("CreatureEventAI Texts", []()
+    {
+        ///- Load and initialize EventAI Scripts
+        sLog.outString("Loading CreatureEventAI Texts...");
+        sEventAIMgr.LoadCreatureEventAI_Texts(false);           // false, will checked in LoadCreatureEventAI_Scripts
+    });
+    loader.AddSequential("CreatureEventAI Summons", []()
+    {
+        sLog.outString("Loading CreatureEventAI Summons...");
+        sEventAIMgr.LoadCreatureEventAI_Summons(false);         // false, will checked in LoadCreatureEventAI_Scripts
+    });
+    loader.AddSequential("CreatureEventAI Scripts", []()
+    {
+        sLog.outString("Loading CreatureEventAI Scripts...");
+        sEventAIMgr.LoadCreatureEventAI_Scripts();
+    });
+
+    loader.Run(getConfig(CONFIG_UINT32_STARTUP_LOAD_THREADS));
+    loader.LogTimings();
 
     ///- Load and initialize scripting library
     sLog.outString("Initializing Scripting Library...");
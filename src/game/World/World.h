@@ -83,9 +83,19 @@ enum WorldTimers
 enum eConfigUInt32Values
 {
     CONFIG_UINT32_COMPRESSION = 0,
+    CONFIG_UINT32_COMPRESSION_OFFLOAD_SIZE,
     CONFIG_UINT32_INTERVAL_SAVE,
     CONFIG_UINT32_INTERVAL_GRIDCLEAN,
     CONFIG_UINT32_INTERVAL_MAPUPDATE,
+    CONFIG_UINT32_MAPUPDATE_THREADS,
+    CONFIG_UINT32_GRID_PRELOAD_THREADS,
+    CONFIG_UINT32_STARTUP_LOAD_THREADS,
+    CONFIG_UINT32_VMAP_LOS_CACHE_SIZE,
+    CONFIG_UINT32_VMAP_LOS_CACHE_EXPIRY,
+    CONFIG_UINT32_PATH_FIND_THREADS,
+    CONFIG_UINT32_PATH_FIND_CACHE_SIZE,
+    CONFIG_UINT32_MMAP_TILE_EXPIRY,
+    CONFIG_UINT32_MMAP_MAX_TILES,
     CONFIG_UINT32_INTERVAL_CHANGEWEATHER,
     CONFIG_UINT32_PORT_WORLD,
     CONFIG_UINT32_GAME_TYPE,
@@ -185,6 +195,13 @@ enum eConfigUInt32Values
     CONFIG_UINT32_GUID_RESERVE_SIZE_GAMEOBJECT,
     CONFIG_UINT32_CREATURE_RESPAWN_AGGRO_DELAY,
     CONFIG_UINT32_MAX_WHOLIST_RETURNS,
+    CONFIG_UINT32_NETWORK_WRITE_DELAY_MOVEMENT,
+    CONFIG_UINT32_NETWORK_WRITE_DELAY_SPELL,
+    CONFIG_UINT32_NETWORK_WRITE_DELAY_DEFAULT,
+    CONFIG_UINT32_NETWORK_RECV_QUEUE_SIZE,
+    CONFIG_UINT32_NETWORK_RECV_QUEUE_THROTTLE,
+    CONFIG_UINT32_PACKET_POOL_THREAD_CACHE,
+    CONFIG_UINT32_PACKET_POOL_SHARED_SIZE,
     CONFIG_UINT32_VALUE_COUNT
 };
 
@@ -272,6 +289,7 @@ enum eConfigFloatValues
     CONFIG_FLOAT_THREAT_RADIUS,
     CONFIG_FLOAT_GHOST_RUN_SPEED_WORLD,
     CONFIG_FLOAT_GHOST_RUN_SPEED_BG,
+    CONFIG_FLOAT_GRID_PRELOAD_DISTANCE,
     CONFIG_FLOAT_VALUE_COUNT
 };
 
@@ -339,6 +357,7 @@ enum eConfigBoolValues
     CONFIG_BOOL_PLAYER_COMMANDS,
     CONFIG_BOOL_PATH_FIND_OPTIMIZE,
     CONFIG_BOOL_PATH_FIND_NORMALIZE_Z,
+    CONFIG_BOOL_GRIDMAP_MEMORY_MAPPED,
     CONFIG_BOOL_VALUE_COUNT
 };
 
@@ -61,6 +61,57 @@ struct AABound
     Vector3 lo, hi;
 };
 
+/** Up to RayPacket::Size rays traced together by BIH::intersectRayPacket.
+    Origins and inverse directions are kept as structure of arrays, so the per lane
+    loops of the traversal have a fixed trip count and get compiled to SIMD code.
+    Lanes past count are inactive, arrays of per lane distances always have Size entries.
+*/
+struct RayPacket
+{
+    static constexpr uint32 Size = 8;
+
+    RayPacket() { clear(); }
+
+    void clear()
+    {
+        count = 0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            std::fill(org[axis], org[axis] + Size, 0.f);
+            std::fill(invDir[axis], invDir[axis] + Size, 1.f);
+        }
+    }
+
+    void add(const Ray& ray)
+    {
+        rays[count] = ray;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            org[axis][count] = ray.origin()[axis];
+            // clamped instead of infinite, so a slab test of an axis parallel ray never computes 0 * inf
+            invDir[axis][count] = G3D::clamp(1.f / ray.direction()[axis], -1e30f, 1e30f);
+        }
+        ++count;
+    }
+
+    bool full() const { return count == Size; }
+    uint32 laneMask() const { return (1 << count) - 1; }
+
+    // bit i is set if the interval [tMin[i], tMax[i]] is not empty
+    static uint32 activeLanes(const float* tMin, const float* tMax)
+    {
+        uint32 mask = 0;
+        for (uint32 i = 0; i < Size; ++i)
+            mask |= uint32(tMin[i] <= tMax[i]) << i;
+        return mask;
+    }
+
+    uint32 count;
+    Ray rays[Size];
+    float org[3][Size];
+    float invDir[3][Size];
+};
+
 /** Bounding Interval Hierarchy Class.
     Building and Ray-Intersection functions based on BIH from
     Sunflow, a Java Raytracer, released under MIT/X11 License
@@ -262,6 +313,169 @@ class BIH
             }
         }
 
+        /** Traces all rays of the packet in a single traversal of the tree, for queries which come in batches.
+            maxDist holds one distance per lane and is lowered to the hit distance of a lane like in intersectRay,
+            with stopAtFirst a lane stops at its first hit. Returns the mask of the lanes which hit something.
+            The callback is called as callback(packet, object, laneMask, maxDist, stopAtFirst, checkLOS) for the lanes
+            reaching a leaf and returns the mask of the lanes it hit.
+        */
+        template<typename RayPacketCallback>
+        uint32 intersectRayPacket(const RayPacket& packet, RayPacketCallback& intersectCallback, float* maxDist, bool stopAtFirst = false, bool checkLOS = false) const
+        {
+            const uint32 Size = RayPacket::Size;
+            float tMin[Size];
+            float tMax[Size];
+            for (uint32 i = 0; i < Size; ++i)
+            {
+                tMin[i] = i < packet.count ? 0.f : 1.f;
+                tMax[i] = i < packet.count ? maxDist[i] : 0.f;
+            }
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float* org = packet.org[axis];
+                const float* invDir = packet.invDir[axis];
+                for (uint32 i = 0; i < Size; ++i)
+                {
+                    float t1 = (bounds.low()[axis] - org[i]) * invDir[i];
+                    float t2 = (bounds.high()[axis] - org[i]) * invDir[i];
+                    tMin[i] = std::max(tMin[i], std::min(t1, t2));
+                    tMax[i] = std::min(tMax[i], std::max(t1, t2));
+                }
+            }
+
+            uint32 hitLanes = 0;
+            uint32 doneLanes = 0;                           // lanes which stopped at their first hit
+            if (!RayPacket::activeLanes(tMin, tMax))
+                return hitLanes;
+
+            PacketStackNode stack[MAX_STACK_SIZE];
+            int stackPos = 0;
+            int node = 0;
+
+            while (true)
+            {
+                while (true)
+                {
+                    uint32 tn = tree[node];
+                    uint32 axis = (tn & (3 << 30)) >> 30;
+                    const bool BVH2 = !!(tn & (1 << 29));
+                    int offset = tn & ~(7 << 29);
+                    if (!BVH2)
+                    {
+                        if (axis < 3)
+                        {
+                            // "normal" interior node, split the interval of every lane at the clip planes
+                            const float clipLeft = intBitsToFloat(tree[node + 1]);
+                            const float clipRight = intBitsToFloat(tree[node + 2]);
+                            const float* org = packet.org[axis];
+                            const float* invDir = packet.invDir[axis];
+                            float leftMin[Size], leftMax[Size], rightMin[Size], rightMax[Size];
+                            for (uint32 i = 0; i < Size; ++i)
+                            {
+                                float tl = (clipLeft - org[i]) * invDir[i];
+                                float tr = (clipRight - org[i]) * invDir[i];
+                                bool positive = invDir[i] >= 0.f;
+                                leftMin[i] = positive ? tMin[i] : std::max(tMin[i], tl);
+                                leftMax[i] = positive ? std::min(tMax[i], tl) : tMax[i];
+                                rightMin[i] = positive ? std::max(tMin[i], tr) : tMin[i];
+                                rightMax[i] = positive ? tMax[i] : std::min(tMax[i], tr);
+                            }
+                            uint32 leftLanes = RayPacket::activeLanes(leftMin, leftMax) & ~doneLanes;
+                            uint32 rightLanes = RayPacket::activeLanes(rightMin, rightMax) & ~doneLanes;
+                            // packet passes between clip zones
+                            if (!leftLanes && !rightLanes)
+                                break;
+
+                            // the first active lane decides which child is visited first
+                            uint32 firstLane = 0;
+                            while (!((leftLanes | rightLanes) & (1 << firstLane)))
+                                ++firstLane;
+                            bool leftFirst = invDir[firstLane] >= 0.f;
+
+                            if (leftLanes && rightLanes)
+                            {
+                                // packet passes through both nodes, push back node
+                                PacketStackNode& back = stack[stackPos++];
+                                back.node = leftFirst ? offset + 3 : offset;
+                                std::copy(leftFirst ? rightMin : leftMin, (leftFirst ? rightMin : leftMin) + Size, back.tMin);
+                                std::copy(leftFirst ? rightMax : leftMax, (leftFirst ? rightMax : leftMax) + Size, back.tMax);
+                            }
+                            else
+                                leftFirst = leftLanes != 0;
+
+                            node = leftFirst ? offset : offset + 3;
+                            std::copy(leftFirst ? leftMin : rightMin, (leftFirst ? leftMin : rightMin) + Size, tMin);
+                            std::copy(leftFirst ? leftMax : rightMax, (leftFirst ? leftMax : rightMax) + Size, tMax);
+                            continue;
+                        }
+                        else
+                        {
+                            // leaf - test some objects with the lanes reaching it
+                            int n = tree[node + 1];
+                            while (n > 0)
+                            {
+                                uint32 lanes = RayPacket::activeLanes(tMin, tMax) & ~doneLanes;
+                                if (!lanes)
+                                    break;
+                                uint32 hit = intersectCallback(packet, objects[offset], lanes, maxDist, stopAtFirst, checkLOS);
+                                hitLanes |= hit;
+                                if (stopAtFirst)
+                                {
+                                    doneLanes |= hit;
+                                    if (doneLanes == packet.laneMask())
+                                        return hitLanes;
+                                }
+                                else if (hit)
+                                {
+                                    for (uint32 i = 0; i < Size; ++i)
+                                        tMax[i] = std::min(tMax[i], maxDist[i]);
+                                }
+                                --n;
+                                ++offset;
+                            }
+                            break;
+                        }
+                    }
+                    else
+                    {
+                        if (axis > 2)
+                            return hitLanes; // should not happen
+                        const float clipLow = intBitsToFloat(tree[node + 1]);
+                        const float clipHigh = intBitsToFloat(tree[node + 2]);
+                        const float* org = packet.org[axis];
+                        const float* invDir = packet.invDir[axis];
+                        for (uint32 i = 0; i < Size; ++i)
+                        {
+                            float t1 = (clipLow - org[i]) * invDir[i];
+                            float t2 = (clipHigh - org[i]) * invDir[i];
+                            tMin[i] = std::max(tMin[i], std::min(t1, t2));
+                            tMax[i] = std::min(tMax[i], std::max(t1, t2));
+                        }
+                        node = offset;
+                        if (!(RayPacket::activeLanes(tMin, tMax) & ~doneLanes))
+                            break;
+                        continue;
+                    }
+                } // traversal loop
+                do
+                {
+                    // stack is empty?
+                    if (stackPos == 0)
+                        return hitLanes;
+                    // move back up the stack, skipping lanes which got a closer hit meanwhile
+                    --stackPos;
+                    node = stack[stackPos].node;
+                    for (uint32 i = 0; i < Size; ++i)
+                    {
+                        tMin[i] = stack[stackPos].tMin[i];
+                        tMax[i] = std::min(stack[stackPos].tMax[i], maxDist[i]);
+                    }
+                }
+                while (!(RayPacket::activeLanes(tMin, tMax) & ~doneLanes));
+            }
+        }
+
         template<typename IsectCallback>
         void intersectPoint(const Vector3& p, IsectCallback& intersectCallback) const
         {
@@ -365,6 +579,12 @@ class BIH
             float tnear;
             float tfar;
         };
+        struct PacketStackNode
+        {
+            uint32 node;
+            float tMin[RayPacket::Size];
+            float tMax[RayPacket::Size];
+        };
 
         class BuildStats
         {
@@ -40,6 +40,22 @@ namespace VMAP
 #define VMAP_INVALID_HEIGHT       -100000.0f            // for check
 #define VMAP_INVALID_HEIGHT_VALUE -200000.0f            // real assigned value in unknown height case
 
+    /// one ray of a batched line of sight query
+    struct LineOfSightQuery
+    {
+        float x1, y1, z1;
+        float x2, y2, z2;
+        bool result;                                        // true if nothing is in the way
+    };
+
+    /// one point of a batched height query
+    struct HeightQuery
+    {
+        float x, y, z;
+        float maxSearchDist;
+        float height;                                       // VMAP_INVALID_HEIGHT_VALUE if nothing was found
+    };
+
     //===========================================================
     class IVMapManager
     {
@@ -62,6 +78,12 @@ namespace VMAP
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) = 0;
             /**
+            batched versions of the above, fill the result of every query
+            rays of the same batch are traced together, so they should be close to each other
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, LineOfSightQuery* queries, uint32 count) = 0;
+            virtual void getHeight(unsigned int pMapId, HeightQuery* queries, uint32 count) = 0;
+            /**
             test if we hit an object. return true if we hit one. rx,ry,rz will hold the hit position or the dest position, if no intersection was found
             return a position, that is pReduceDist closer to the origin
             */
@@ -48,6 +48,18 @@ namespace VMAP
             bool hit;
     };
 
+    class MapRayPacketCallback
+    {
+        public:
+            MapRayPacketCallback(ModelInstance* val): prims(val) {}
+            uint32 operator()(const RayPacket& packet, uint32 entry, uint32 lanes, float* distance, bool pStopAtFirstHit = true, bool pCheckLOS = false)
+            {
+                return prims[entry].intersectRayPacket(packet, lanes, distance, pStopAtFirstHit, pCheckLOS);
+            }
+        protected:
+            ModelInstance* prims;
+    };
+
     class AreaInfoCallback
     {
         public:
@@ -149,6 +161,17 @@ namespace VMAP
             pMaxDist = distance;
         return intersectionCallBack.didHit();
     }
+
+    /**
+    Same as getIntersectionTime for every lane of pPacket, pMaxDist has RayPacket::Size entries.
+    Returns the mask of the lanes which hit something.
+    */
+
+    uint32 StaticMapTree::getIntersectionTimes(const RayPacket& pPacket, float* pMaxDist, bool pStopAtFirstHit, bool pCheckLOS) const
+    {
+        MapRayPacketCallback intersectionCallBack(iTreeValues);
+        return iTree.intersectRayPacket(pPacket, intersectionCallBack, pMaxDist, pStopAtFirstHit, pCheckLOS);
+    }
     //=========================================================
 
     bool StaticMapTree::isInLineOfSight(const Vector3& pos1, const Vector3& pos2) const
@@ -227,6 +250,58 @@ namespace VMAP
 
     //=========================================================
 
+    void StaticMapTree::isInLineOfSight(const Vector3* pos1, const Vector3* pos2, bool* results, uint32 count) const
+    {
+        RayPacket packet;
+        uint32 queryIndex[RayPacket::Size];
+        float maxDist[RayPacket::Size] = {};
+        for (uint32 i = 0; i < count; ++i)
+        {
+            results[i] = true;
+            float dist = (pos2[i] - pos1[i]).magnitude();
+            MANGOS_ASSERT(dist < std::numeric_limits<float>::max());
+            if (dist >= 1e-10f)
+            {
+                queryIndex[packet.count] = i;
+                maxDist[packet.count] = dist;
+                packet.add(G3D::Ray::fromOriginAndDirection(pos1[i], (pos2[i] - pos1[i]) / dist));
+            }
+
+            if (packet.count && (packet.full() || i + 1 == count))
+            {
+                uint32 hitLanes = getIntersectionTimes(packet, maxDist, true, true);
+                for (uint32 lane = 0; lane < packet.count; ++lane)
+                    if (hitLanes & (1 << lane))
+                        results[queryIndex[lane]] = false;
+                packet.clear();
+            }
+        }
+    }
+
+    //=========================================================
+
+    void StaticMapTree::getHeight(const Vector3* pPos, const float* maxSearchDist, float* heights, uint32 count) const
+    {
+        RayPacket packet;
+        float maxDist[RayPacket::Size] = {};
+        for (uint32 i = 0; i < count; ++i)
+        {
+            maxDist[packet.count] = maxSearchDist[i];
+            packet.add(G3D::Ray(pPos[i], Vector3(0, 0, -1)));
+
+            if (packet.full() || i + 1 == count)
+            {
+                uint32 hitLanes = getIntersectionTimes(packet, maxDist);
+                uint32 first = i + 1 - packet.count;
+                for (uint32 lane = 0; lane < packet.count; ++lane)
+                    heights[first + lane] = (hitLanes & (1 << lane)) ? pPos[first + lane].z - maxDist[lane] : G3D::inf();
+                packet.clear();
+            }
+        }
+    }
+
+    //=========================================================
+
     bool StaticMapTree::CanLoadMap(const std::string& vmapPath, uint32 mapID, uint32 tileX, uint32 tileY)
     {
         std::string basePath = vmapPath;
@@ -58,6 +58,7 @@ namespace VMAP
 
         private:
             bool getIntersectionTime(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit = false, bool pCheckLOS = false) const;
+            uint32 getIntersectionTimes(const RayPacket& pPacket, float* pMaxDist, bool pStopAtFirstHit = false, bool pCheckLOS = false) const;
             // bool containsLoadedMapTile(unsigned int pTileIdent) const { return(iLoadedMapTiles.containsKey(pTileIdent)); }
         public:
             static std::string getTileFileName(uint32 mapID, uint32 tileX, uint32 tileY);
@@ -71,6 +72,9 @@ namespace VMAP
             bool isInLineOfSight(const G3D::Vector3& pos1, const G3D::Vector3& pos2) const;
             bool getObjectHitPos(const G3D::Vector3& pos1, const G3D::Vector3& pos2, G3D::Vector3& pResultHitPos, float pModifyDist) const;
             float getHeight(const G3D::Vector3& pPos, float maxSearchDist) const;
+            // batched versions of the above, the queries are traced RayPacket::Size at a time
+            void isInLineOfSight(const G3D::Vector3* pos1, const G3D::Vector3* pos2, bool* results, uint32 count) const;
+            void getHeight(const G3D::Vector3* pPos, const float* maxSearchDist, float* heights, uint32 count) const;
             bool getAreaInfo(G3D::Vector3& pos, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const;
             bool GetLocationInfo(const Vector3& pos, LocationInfo& info) const;
 
@@ -49,6 +49,46 @@ namespace VMAP
 #endif
             return false;
         }
+        return intersectModel(pRay, pMaxDist, pStopAtFirstHit, pCheckLOS);
+    }
+
+    uint32 ModelInstance::intersectRayPacket(const RayPacket& pPacket, uint32 pLanes, float* pMaxDist, bool pStopAtFirstHit, bool pCheckLOS) const
+    {
+        if (!iModel)
+            return 0;
+
+        // bounding box test of all lanes at once
+        float tMin[RayPacket::Size];
+        float tMax[RayPacket::Size];
+        for (uint32 i = 0; i < RayPacket::Size; ++i)
+        {
+            tMin[i] = 0.f;
+            tMax[i] = pMaxDist[i];
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float* org = pPacket.org[axis];
+            const float* invDir = pPacket.invDir[axis];
+            for (uint32 i = 0; i < RayPacket::Size; ++i)
+            {
+                float t1 = (iBound.low()[axis] - org[i]) * invDir[i];
+                float t2 = (iBound.high()[axis] - org[i]) * invDir[i];
+                tMin[i] = std::max(tMin[i], std::min(t1, t2));
+                tMax[i] = std::min(tMax[i], std::max(t1, t2));
+            }
+        }
+        pLanes &= RayPacket::activeLanes(tMin, tMax);
+
+        // the triangles of the model are still tested one ray at a time
+        uint32 hitLanes = 0;
+        for (uint32 i = 0; i < pPacket.count; ++i)
+            if ((pLanes & (1 << i)) && intersectModel(pPacket.rays[i], pMaxDist[i], pStopAtFirstHit, pCheckLOS))
+                hitLanes |= 1 << i;
+        return hitLanes;
+    }
+
+    bool ModelInstance::intersectModel(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit, bool pCheckLOS) const
+    {
         // child bounds are defined in object space:
         Vector3 p = iInvRot * (pRay.origin() - iPos) * iInvScale;
         Ray modRay(p, iInvRot * pRay.direction());
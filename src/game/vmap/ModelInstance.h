@@ -26,6 +26,8 @@
 
 #include "Platform/Define.h"
 
+struct RayPacket;
+
 namespace VMAP
 {
     class WorldModel;
@@ -68,10 +70,14 @@ namespace VMAP
             ModelInstance(const ModelSpawn& spawn, WorldModel* model);
             void setUnloaded() { iModel = nullptr; }
             bool intersectRay(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit, bool pCheckLOS = false) const;
+            // tests the lanes of pLanes against the model, pMaxDist has one entry per lane, returns the lanes which hit
+            uint32 intersectRayPacket(const RayPacket& pPacket, uint32 pLanes, float* pMaxDist, bool pStopAtFirstHit, bool pCheckLOS = false) const;
             void intersectPoint(const G3D::Vector3& p, AreaInfo& info) const;
             bool GetLocationInfo(const G3D::Vector3& p, LocationInfo& info) const;
             bool GetLiquidLevel(const G3D::Vector3& p, LocationInfo& info, float& liqHeight) const;
         protected:
+            bool intersectModel(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit, bool pCheckLOS) const;
+
             G3D::Matrix3 iInvRot;
             float iInvScale;
             WorldModel* iModel;
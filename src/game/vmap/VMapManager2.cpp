@@ -91,6 +91,7 @@ namespace VMAP
 
     bool VMapManager2::_loadMap(unsigned int pMapId, const std::string& basePath, uint32 tileX, uint32 tileY)
     {
+        boost::unique_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
         InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
         if (instanceTree == iInstanceMapTrees.end())
         {
@@ -107,6 +108,7 @@ namespace VMAP
 
     void VMapManager2::unloadMap(unsigned int pMapId)
     {
+        boost::unique_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
         InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
         if (instanceTree != iInstanceMapTrees.end())
         {
@@ -123,6 +125,7 @@ namespace VMAP
 
     void VMapManager2::unloadMap(unsigned int  pMapId, int x, int y)
     {
+        boost::unique_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
         InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
         if (instanceTree != iInstanceMapTrees.end())
         {
@@ -140,6 +143,7 @@ namespace VMAP
     bool VMapManager2::isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2)
     {
         if (!isLineOfSightCalcEnabled()) return true;
+        boost::shared_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
         bool result = true;
         InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
         if (instanceTree != iInstanceMapTrees.end())
@@ -166,6 +170,7 @@ namespace VMAP
         rz = z2;
         if (isLineOfSightCalcEnabled())
         {
+            boost::shared_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
             InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
             if (instanceTree != iInstanceMapTrees.end())
             {
@@ -192,6 +197,7 @@ namespace VMAP
         float height = VMAP_INVALID_HEIGHT_VALUE;           // no height
         if (isHeightCalcEnabled())
         {
+            boost::shared_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
             InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
             if (instanceTree != iInstanceMapTrees.end())
             {
@@ -208,9 +214,75 @@ namespace VMAP
 
     //=========================================================
 
+    void VMapManager2::isInLineOfSight(unsigned int pMapId, LineOfSightQuery* queries, uint32 count)
+    {
+        for (uint32 i = 0; i < count; ++i)
+            queries[i].result = true;
+
+        if (!isLineOfSightCalcEnabled())
+            return;
+        boost::shared_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        Vector3 pos1[RayPacket::Size];
+        Vector3 pos2[RayPacket::Size];
+        bool results[RayPacket::Size];
+        for (uint32 first = 0; first < count; first += RayPacket::Size)
+        {
+            uint32 num = count - first < RayPacket::Size ? count - first : RayPacket::Size;
+            for (uint32 i = 0; i < num; ++i)
+            {
+                LineOfSightQuery const& query = queries[first + i];
+                pos1[i] = convertPositionToInternalRep(query.x1, query.y1, query.z1);
+                pos2[i] = convertPositionToInternalRep(query.x2, query.y2, query.z2);
+            }
+            instanceTree->second->isInLineOfSight(pos1, pos2, results, num);
+            for (uint32 i = 0; i < num; ++i)
+                queries[first + i].result = results[i];
+        }
+    }
+
+    //=========================================================
+
+    void VMapManager2::getHeight(unsigned int pMapId, HeightQuery* queries, uint32 count)
+    {
+        for (uint32 i = 0; i < count; ++i)
+            queries[i].height = VMAP_INVALID_HEIGHT_VALUE;  // no height
+
+        if (!isHeightCalcEnabled())
+            return;
+        boost::shared_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        Vector3 pos[RayPacket::Size];
+        float maxSearchDist[RayPacket::Size];
+        float heights[RayPacket::Size];
+        for (uint32 first = 0; first < count; first += RayPacket::Size)
+        {
+            uint32 num = count - first < RayPacket::Size ? count - first : RayPacket::Size;
+            for (uint32 i = 0; i < num; ++i)
+            {
+                HeightQuery const& query = queries[first + i];
+                pos[i] = convertPositionToInternalRep(query.x, query.y, query.z);
+                maxSearchDist[i] = query.maxSearchDist;
+            }
+            instanceTree->second->getHeight(pos, maxSearchDist, heights, num);
+            for (uint32 i = 0; i < num; ++i)
+                if (heights[i] < G3D::inf())
+                    queries[first + i].height = heights[i];
+        }
+    }
+
+    //=========================================================
+
     bool VMapManager2::getAreaInfo(unsigned int pMapId, float x, float y, float& z, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const
     {
         bool result = false;
+        boost::shared_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
         InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(pMapId);
         if (instanceTree != iInstanceMapTrees.end())
         {
@@ -224,6 +296,7 @@ namespace VMAP
 
     bool VMapManager2::GetLiquidLevel(uint32 pMapId, float x, float y, float z, uint8 ReqLiquidType, float& level, float& floor, uint32& type) const
     {
+        boost::shared_lock<boost::shared_mutex> lock(iInstanceMapTreesLock);
         InstanceTreeMap::const_iterator instanceTree = iInstanceMapTrees.find(pMapId);
         if (instanceTree != iInstanceMapTrees.end())
         {
@@ -246,6 +319,7 @@ namespace VMAP
 
     WorldModel* VMapManager2::acquireModelInstance(const std::string& basepath, const std::string& filename)
     {
+        std::lock_guard<std::mutex> lock(iLoadedModelFilesLock);
         ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
         if (model == iLoadedModelFiles.end())
         {
@@ -266,6 +340,7 @@ namespace VMAP
 
     void VMapManager2::releaseModelInstance(const std::string& filename)
     {
+        std::lock_guard<std::mutex> lock(iLoadedModelFilesLock);
         ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
         if (model == iLoadedModelFiles.end())
         {
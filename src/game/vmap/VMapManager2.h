@@ -24,6 +24,9 @@
 #include <G3D/Vector3.h>
 
 #include <unordered_map>
+#include <mutex>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
 
 //===========================================================
 
@@ -69,6 +72,11 @@ namespace VMAP
             ModelFileMap iLoadedModelFiles;
             InstanceTreeMap iInstanceMapTrees;
 
+            // maps are updated by several threads: queries share the trees, loading and unloading tiles is exclusive
+            mutable boost::shared_mutex iInstanceMapTreesLock;
+            // models are also acquired by gameobjects outside of tile loads
+            std::mutex iLoadedModelFilesLock;
+
             bool _loadMap(uint32 pMapId, const std::string& basePath, uint32 tileX, uint32 tileY);
             /* void _unloadMap(uint32 pMapId, uint32 x, uint32 y); */
 
@@ -91,6 +99,8 @@ namespace VMAP
             */
             bool getObjectHitPos(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float& ry, float& rz, float pModifyDist) override;
             float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) override;
+            void isInLineOfSight(unsigned int pMapId, LineOfSightQuery* queries, uint32 count) override;
+            void getHeight(unsigned int pMapId, HeightQuery* queries, uint32 count) override;
 
             bool processCommand(char* /*pCommand*/) override { return false; }      // for debug and extensions
 
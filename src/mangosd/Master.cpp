@@ -215,8 +215,13 @@ int Master::Run()
     }
 
     {
+        // the mask has a bit for each of up to 64 processors, more than an int config value can hold
+        std::string const networkProcessors = sConfig.GetStringDefault("Network.UseProcessors", "0");
+        uint64 const networkAffinityMask = strtoull(networkProcessors.c_str(), nullptr, 0);
+
         //auto const listenIP = sConfig.GetStringDefault("BindIP", "0.0.0.0");
-        MaNGOS::Listener<WorldSocket> listener(sWorld.getConfig(CONFIG_UINT32_PORT_WORLD), 8);
+        MaNGOS::Listener<WorldSocket> listener(sWorld.getConfig(CONFIG_UINT32_PORT_WORLD), std::max(sConfig.GetIntDefault("Network.Threads", 8), 1),
+                                               networkAffinityMask);
 
         std::unique_ptr<MaNGOS::Listener<RASocket>> raListener;
         if (sConfig.GetBoolDefault("Ra.Enable", false))
@@ -324,15 +329,16 @@ bool Master::_StartDB()
     ///- Get world database info from configuration file
     std::string dbstring = sConfig.GetStringDefault("WorldDatabaseInfo");
     int nConnections = sConfig.GetIntDefault("WorldDatabaseConnections", 1);
+    int nAsyncConnections = sConfig.GetIntDefault("WorldDatabaseAsyncConnections", 1);
     if (dbstring.empty())
     {
         sLog.outError("Database not specified in configuration file");
         return false;
     }
-    sLog.outString("World Database total connections: %i", nConnections + 1);
+    sLog.outString("World Database total connections: %i", nConnections + nAsyncConnections);
 
     ///- Initialise the world database
-    if (!WorldDatabase.Initialize(dbstring.c_str(), nConnections))
+    if (!WorldDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to world database %s", dbstring.c_str());
         return false;
@@ -347,6 +353,7 @@ bool Master::_StartDB()
 
     dbstring = sConfig.GetStringDefault("CharacterDatabaseInfo");
     nConnections = sConfig.GetIntDefault("CharacterDatabaseConnections", 1);
+    nAsyncConnections = sConfig.GetIntDefault("CharacterDatabaseAsyncConnections", 1);
     if (dbstring.empty())
     {
         sLog.outError("Character Database not specified in configuration file");
@@ -355,10 +362,10 @@ bool Master::_StartDB()
         WorldDatabase.HaltDelayThread();
         return false;
     }
-    sLog.outString("Character Database total connections: %i", nConnections + 1);
+    sLog.outString("Character Database total connections: %i", nConnections + nAsyncConnections);
 
     ///- Initialise the Character database
-    if (!CharacterDatabase.Initialize(dbstring.c_str(), nConnections))
+    if (!CharacterDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to Character database %s", dbstring.c_str());
 
@@ -378,6 +385,7 @@ bool Master::_StartDB()
     ///- Get login database info from configuration file
     dbstring = sConfig.GetStringDefault("LoginDatabaseInfo");
     nConnections = sConfig.GetIntDefault("LoginDatabaseConnections", 1);
+    nAsyncConnections = sConfig.GetIntDefault("LoginDatabaseAsyncConnections", 1);
     if (dbstring.empty())
     {
         sLog.outError("Login database not specified in configuration file");
@@ -389,8 +397,8 @@ bool Master::_StartDB()
     }
 
     ///- Initialise the login database
-    sLog.outString("Login Database total connections: %i", nConnections + 1);
-    if (!LoginDatabase.Initialize(dbstring.c_str(), nConnections))
+    sLog.outString("Login Database total connections: %i", nConnections + nAsyncConnections);
+    if (!LoginDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to login database %s", dbstring.c_str());
 
@@ -29,6 +29,8 @@
 #include "AuthCodes.h"
 
 #include <openssl/md5.h>
+
+#include <functional>
 //#include "Util.h" -- for commented utf8ToUpperOnlyLatin
 
 extern DatabaseType LoginDatabase;
@@ -155,10 +157,49 @@ typedef struct AuthHandler
 
 /// Constructor - set the N and g values for SRP6
 AuthSocket::AuthSocket(boost::asio::io_service &service, std::function<void (Socket *)> closeHandler)
-    : Socket(service, closeHandler), _status(STATUS_CHALLENGE), _build(0), _accountSecurityLevel(SEC_PLAYER)
+    : Socket(service, closeHandler), _status(STATUS_CHALLENGE), _accountId(0), _build(0), _accountSecurityLevel(SEC_PLAYER)
+{
+}
+
+void AuthSocket::LookupQueue::Add(MaNGOS::IQueryCallback* callback)
+{
+    std::shared_ptr<MaNGOS::IQueryCallback> result(callback);
+    std::shared_ptr<AuthSocket> socket = std::move(m_socket);
+
+    boost::asio::post(socket->GetAsioSocket().get_executor(), [socket, result]()
+    {
+        result->Execute();
+
+        // continue with the input unless the result started the next lookup
+        if (!socket->m_lookupQueue.m_socket)
+            socket->ResumeRead();
+    });
+}
+
+bool AuthSocket::StartLookup(SqlQueryHolder* holder, void (AuthSocket::*method)(QueryResult*, SqlQueryHolder*))
+{
+    MANGOS_ASSERT(!m_lookupQueue.m_socket);
+
+    holder->SetOrderKey(GetLookupKey());
+    m_lookupQueue.m_socket = shared<AuthSocket>();
+    SuspendRead();
+
+    if (!holder->Execute(new MaNGOS::QueryCallback<AuthSocket, SqlQueryHolder*>(this, method, (QueryResult*)nullptr, holder), &LoginDatabase, &m_lookupQueue))
+    {
+        sLog.outError("[Auth] Login database lookup for account %s could not be started", _login.c_str());
+        m_lookupQueue.m_socket.reset();
+        delete holder;
+        return false;
+    }
+
+    return true;
+}
+
+uint32 AuthSocket::GetLookupKey() const
 {
-    N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
-    g.SetDword(7);
+    // key 0 would wait for the requests of all accounts
+    const uint32 key = uint32(std::hash<std::string>()(_safelogin));
+    return key ? key : 1;
 }
 
 /// Read the packet from the client
@@ -183,6 +224,13 @@ bool AuthSocket::ProcessIncomingData()
     // which presumably the client will never do, but lets support it anyway! \o/
     while (ReadLengthRemaining() > 0)
     {
+        // a handler waits for the login database, the remaining data is processed once the lookup is done
+        if (IsReadSuspended())
+        {
+            errno = EBADMSG;
+            return false;
+        }
+
         const eAuthCmd cmd = static_cast<eAuthCmd>(*InPeak());
         int i;
 
@@ -228,31 +276,15 @@ bool AuthSocket::ProcessIncomingData()
 /// Make the SRP6 calculation from hash in dB
 void AuthSocket::_SetVSFields(const std::string& rI)
 {
-    s.SetRand(s_BYTE_SIZE * 8);
-
-    BigNumber I;
-    I.SetHexStr(rI.c_str());
+    srp.CalculateVerifier(rI);
 
-    // In case of leading zeros in the rI hash, restore them
-    uint8 mDigest[SHA_DIGEST_LENGTH];
-    memset(mDigest, 0, SHA_DIGEST_LENGTH);
-    if (I.GetNumBytes() <= SHA_DIGEST_LENGTH)
-        memcpy(mDigest, I.AsByteArray(), I.GetNumBytes());
-
-    std::reverse(mDigest, mDigest + SHA_DIGEST_LENGTH);
-
-    Sha1Hash sha;
-    sha.UpdateData(s.AsByteArray(), s.GetNumBytes());
-    sha.UpdateData(mDigest, SHA_DIGEST_LENGTH);
-    sha.Finalize();
-    BigNumber x;
-    x.SetBinary(sha.GetDigest(), sha.GetLength());
-    v = g.ModExp(x, N);
     // No SQL injection (username escaped)
     const char* v_hex, *s_hex;
-    v_hex = v.AsHexStr();
-    s_hex = s.AsHexStr();
+    v_hex = srp.GetVerifier().AsHexStr();
+    s_hex = srp.GetSalt().AsHexStr();
+    LoginDatabase.BeginTransaction(GetLookupKey());
     LoginDatabase.PExecute("UPDATE account SET v = '%s', s = '%s' WHERE username = '%s'", v_hex, s_hex, _safelogin.c_str());
+    LoginDatabase.CommitTransaction();
     OPENSSL_free((void*)v_hex);
     OPENSSL_free((void*)s_hex);
 }
@@ -340,8 +372,6 @@ bool AuthSocket::_HandleLogonChallenge()
     EndianConvert(ch->timezone_bias);
     EndianConvert(ch->ip);
 
-    ByteBuffer pkt;
-
     _login = (const char*)ch->I;
     _build = ch->build;
 
@@ -353,155 +383,163 @@ bool AuthSocket::_HandleLogonChallenge()
     _safelogin = _login;
     LoginDatabase.escape_string(_safelogin);
 
-    pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
-    pkt << (uint8) 0x00;
+    _localizationName.resize(4);
+    for (int i = 0; i < 4; ++i)
+        _localizationName[i] = ch->country[4 - i - 1];
+
+    SqlQueryHolder* holder = new SqlQueryHolder();
+    holder->SetSize(3);
 
     ///- Verify that this IP is not in the ip_banned table
     // No SQL injection possible (paste the IP address as passed by the socket)
-    QueryResult* result = LoginDatabase.PQuery("SELECT unbandate FROM ip_banned WHERE "
-                          //    permanent                    still banned
-                          "(unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s'", m_address.c_str());
-    if (result)
+    holder->SetPQuery(0, "SELECT unbandate FROM ip_banned WHERE "
+                      //    permanent                    still banned
+                      "(unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s'", m_address.c_str());
+
+    ///- Get the account details from the account table
+    // No SQL injection (escaped user name)
+    holder->SetPQuery(1, "SELECT sha_pass_hash,id,locked,last_ip,gmlevel,v,s FROM account WHERE username = '%s'", _safelogin.c_str());
+
+    ///- Get an active ban of the account
+    holder->SetPQuery(2, "SELECT account_banned.bandate,account_banned.unbandate FROM account_banned JOIN account ON account.id = account_banned.id "
+                      "WHERE account.username = '%s' AND account_banned.active = 1 "
+                      "AND (account_banned.unbandate > UNIX_TIMESTAMP() OR account_banned.unbandate = account_banned.bandate)", _safelogin.c_str());
+
+    return StartLookup(holder, &AuthSocket::_OnLogonChallengeLookup);
+}
+
+/// Answer the logon challenge from the account lookup
+void AuthSocket::_OnLogonChallengeLookup(QueryResult* /*dummy*/, SqlQueryHolder* holder)
+{
+    std::unique_ptr<SqlQueryHolder> results(holder);
+
+    if (IsClosed())
+        return;
+
+    ByteBuffer pkt;
+    pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+    pkt << (uint8) 0x00;
+
+    std::unique_ptr<QueryResult> ipBanResult(holder->GetResult(0));
+    std::unique_ptr<QueryResult> result(holder->GetResult(1));
+    std::unique_ptr<QueryResult> banresult(holder->GetResult(2));
+
+    if (ipBanResult)
     {
         pkt << (uint8)WOW_FAIL_BANNED;
         BASIC_LOG("[AuthChallenge] Banned ip %s tries to login!", m_address.c_str());
-        delete result;
     }
-    else
+    else if (result)
     {
-        ///- Get the account details from the account table
-        // No SQL injection (escaped user name)
-
-        result = LoginDatabase.PQuery("SELECT sha_pass_hash,id,locked,last_ip,gmlevel,v,s FROM account WHERE username = '%s'", _safelogin.c_str());
-        if (result)
+        ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
+        bool locked = false;
+        if ((*result)[2].GetUInt8() == 1)                   // if ip is locked
         {
-            ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
-            bool locked = false;
-            if ((*result)[2].GetUInt8() == 1)               // if ip is locked
+            DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), (*result)[3].GetString());
+            DEBUG_LOG("[AuthChallenge] Player address is '%s'", m_address.c_str());
+            if (strcmp((*result)[3].GetString(), m_address.c_str()))
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), (*result)[3].GetString());
-                DEBUG_LOG("[AuthChallenge] Player address is '%s'", m_address.c_str());
-                if (strcmp((*result)[3].GetString(), m_address.c_str()))
-                {
-                    DEBUG_LOG("[AuthChallenge] Account IP differs");
-                    pkt << (uint8) WOW_FAIL_SUSPENDED;
-                    locked = true;
-                }
-                else
-                {
-                    DEBUG_LOG("[AuthChallenge] Account IP matches");
-                }
+                DEBUG_LOG("[AuthChallenge] Account IP differs");
+                pkt << (uint8) WOW_FAIL_SUSPENDED;
+                locked = true;
             }
             else
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+                DEBUG_LOG("[AuthChallenge] Account IP matches");
             }
+        }
+        else
+        {
+            DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+        }
 
-            if (!locked)
+        if (!locked)
+        {
+            ///- If the account is banned, reject the logon attempt
+            if (banresult)
             {
-                ///- If the account is banned, reject the logon attempt
-                QueryResult* banresult = LoginDatabase.PQuery("SELECT bandate,unbandate FROM account_banned WHERE "
-                                         "id = %u AND active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate)", (*result)[1].GetUInt32());
-                if (banresult)
+                if ((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
                 {
-                    if ((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
-                    {
-                        pkt << (uint8) WOW_FAIL_BANNED;
-                        BASIC_LOG("[AuthChallenge] Banned account %s tries to login!", _login.c_str());
-                    }
-                    else
-                    {
-                        pkt << (uint8) WOW_FAIL_SUSPENDED;
-                        BASIC_LOG("[AuthChallenge] Temporarily banned account %s tries to login!", _login.c_str());
-                    }
-
-                    delete banresult;
+                    pkt << (uint8) WOW_FAIL_BANNED;
+                    BASIC_LOG("[AuthChallenge] Banned account %s tries to login!", _login.c_str());
                 }
                 else
                 {
-                    ///- Get the password from the account table, upper it, and make the SRP6 calculation
-                    std::string rI = (*result)[0].GetCppString();
+                    pkt << (uint8) WOW_FAIL_SUSPENDED;
+                    BASIC_LOG("[AuthChallenge] Temporarily banned account %s tries to login!", _login.c_str());
+                }
+            }
+            else
+            {
+                ///- Get the password from the account table, upper it, and make the SRP6 calculation
+                std::string rI = (*result)[0].GetCppString();
+
+                ///- Don't calculate (v, s) if there are already some in the database
+                std::string databaseV = (*result)[5].GetCppString();
+                std::string databaseS = (*result)[6].GetCppString();
 
-                    ///- Don't calculate (v, s) if there are already some in the database
-                    std::string databaseV = (*result)[5].GetCppString();
-                    std::string databaseS = (*result)[6].GetCppString();
+                DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
 
-                    DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
+                if (!srp.SetVerifier(databaseV, databaseS))
+                    _SetVSFields(rI);
 
-                    // multiply with 2, bytes are stored as hexstring
-                    if (databaseV.size() != s_BYTE_SIZE * 2 || databaseS.size() != s_BYTE_SIZE * 2)
-                        _SetVSFields(rI);
-                    else
-                    {
-                        s.SetHexStr(databaseS.c_str());
-                        v.SetHexStr(databaseV.c_str());
-                    }
+                srp.CalculateHostPublicEphemeral();
 
-                    b.SetRand(19 * 8);
-                    BigNumber gmod = g.ModExp(b, N);
-                    B = ((v * 3) + gmod) % N;
+                BigNumber unk3;
+                unk3.SetRand(16 * 8);
 
-                    MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
+                ///- Fill the response packet with the result
+                pkt << uint8(WOW_SUCCESS);
 
-                    BigNumber unk3;
-                    unk3.SetRand(16 * 8);
+                // B may be calculated < 32B so we force minimal length to 32B
+                pkt.append(srp.GetHostPublicEphemeral().AsByteArray(32), 32);   // 32 bytes
+                pkt << uint8(1);
+                pkt.append(srp.GetGenerator().AsByteArray(), 1);
+                pkt << uint8(32);
+                pkt.append(srp.GetN().AsByteArray(32), 32);
+                pkt.append(srp.GetSalt().AsByteArray(), srp.GetSalt().GetNumBytes());   // 32 bytes
+                pkt.append(unk3.AsByteArray(16), 16);
+                uint8 securityFlags = 0;
+                pkt << uint8(securityFlags);                // security flags (0x0...0x04)
 
-                    ///- Fill the response packet with the result
-                    pkt << uint8(WOW_SUCCESS);
+                if (securityFlags & 0x01)                   // PIN input
+                {
+                    pkt << uint32(0);
+                    pkt << uint64(0) << uint64(0);          // 16 bytes hash?
+                }
 
-                    // B may be calculated < 32B so we force minimal length to 32B
-                    pkt.append(B.AsByteArray(32), 32);      // 32 bytes
+                if (securityFlags & 0x02)                   // Matrix input
+                {
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint64(0);
+                }
+
+                if (securityFlags & 0x04)                   // Security token input
+                {
                     pkt << uint8(1);
-                    pkt.append(g.AsByteArray(), 1);
-                    pkt << uint8(32);
-                    pkt.append(N.AsByteArray(32), 32);
-                    pkt.append(s.AsByteArray(), s.GetNumBytes());// 32 bytes
-                    pkt.append(unk3.AsByteArray(16), 16);
-                    uint8 securityFlags = 0;
-                    pkt << uint8(securityFlags);            // security flags (0x0...0x04)
-
-                    if (securityFlags & 0x01)               // PIN input
-                    {
-                        pkt << uint32(0);
-                        pkt << uint64(0) << uint64(0);      // 16 bytes hash?
-                    }
-
-                    if (securityFlags & 0x02)               // Matrix input
-                    {
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint64(0);
-                    }
-
-                    if (securityFlags & 0x04)               // Security token input
-                    {
-                        pkt << uint8(1);
-                    }
-
-                    uint8 secLevel = (*result)[4].GetUInt8();
-                    _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
-
-                    _localizationName.resize(4);
-                    for (int i = 0; i < 4; ++i)
-                        _localizationName[i] = ch->country[4 - i - 1];
-
-                    BASIC_LOG("[AuthChallenge] account %s is using '%c%c%c%c' locale (%u)", _login.c_str(), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName));
-
-                    ///- All good, await client's proof
-                    _status = STATUS_LOGON_PROOF;
                 }
+
+                _accountId = (*result)[1].GetUInt32();
+
+                uint8 secLevel = (*result)[4].GetUInt8();
+                _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
+
+                BASIC_LOG("[AuthChallenge] account %s is using '%s' locale (%u)", _login.c_str(), _localizationName.c_str(), GetLocaleByName(_localizationName));
+
+                ///- All good, await client's proof
+                _status = STATUS_LOGON_PROOF;
             }
-            delete result;
-        }
-        else                                                // no account
-        {
-            pkt << (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
         }
     }
+    else                                                    // no account
+    {
+        pkt << (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
+    }
+
     Write((const char *)pkt.contents(), pkt.size());
-    return true;
 }
 
 /// Logon Proof command handler
@@ -532,97 +570,27 @@ bool AuthSocket::_HandleLogonProof()
     /// </ul>
 
     ///- Continue the SRP6 calculation based on data received from the client
-    BigNumber A;
-
-    A.SetBinary(lp.A, 32);
-
-    // SRP safeguard: abort if A==0
-    if (A.isZero())
-        return false;
-
-    if ((A % N).isZero())
+    if (!srp.CalculateSessionKey(lp.A))
         return false;
 
-    Sha1Hash sha;
-    sha.UpdateBigNumbers(&A, &B, nullptr);
-    sha.Finalize();
-    BigNumber u;
-    u.SetBinary(sha.GetDigest(), 20);
-    BigNumber S = (A * (v.ModExp(u, N))).ModExp(b, N);
-
-    uint8 t[32];
-    uint8 t1[16];
-    uint8 vK[40];
-    memcpy(t, S.AsByteArray(32), 32);
-    for (int i = 0; i < 16; ++i)
-    {
-        t1[i] = t[i * 2];
-    }
-    sha.Initialize();
-    sha.UpdateData(t1, 16);
-    sha.Finalize();
-    for (int i = 0; i < 20; ++i)
-    {
-        vK[i * 2] = sha.GetDigest()[i];
-    }
-    for (int i = 0; i < 16; ++i)
-    {
-        t1[i] = t[i * 2 + 1];
-    }
-    sha.Initialize();
-    sha.UpdateData(t1, 16);
-    sha.Finalize();
-    for (int i = 0; i < 20; ++i)
-    {
-        vK[i * 2 + 1] = sha.GetDigest()[i];
-    }
-    K.SetBinary(vK, 40);
-
-    uint8 hash[20];
-
-    sha.Initialize();
-    sha.UpdateBigNumbers(&N, nullptr);
-    sha.Finalize();
-    memcpy(hash, sha.GetDigest(), 20);
-    sha.Initialize();
-    sha.UpdateBigNumbers(&g, nullptr);
-    sha.Finalize();
-    for (int i = 0; i < 20; ++i)
-    {
-        hash[i] ^= sha.GetDigest()[i];
-    }
-    BigNumber t3;
-    t3.SetBinary(hash, 20);
-
-    sha.Initialize();
-    sha.UpdateData(_login);
-    sha.Finalize();
-    uint8 t4[SHA_DIGEST_LENGTH];
-    memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
-
-    sha.Initialize();
-    sha.UpdateBigNumbers(&t3, nullptr);
-    sha.UpdateData(t4, SHA_DIGEST_LENGTH);
-    sha.UpdateBigNumbers(&s, &A, &B, &K, nullptr);
-    sha.Finalize();
-    BigNumber M;
-    M.SetBinary(sha.GetDigest(), 20);
-
     ///- Check if SRP6 results match (password is correct), else send an error
-    if (!memcmp(M.AsByteArray(), lp.M1, 20))
+    if (srp.Proof(_login, lp.M1))
     {
+        K = srp.GetSessionKey();
+
         BASIC_LOG("User '%s' successfully authenticated", _login.c_str());
 
         ///- Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
         // No SQL injection (escaped user name) and IP address as received by socket
         const char* K_hex = K.AsHexStr();
+        LoginDatabase.BeginTransaction(GetLookupKey());
         LoginDatabase.PExecute("UPDATE account SET sessionkey = '%s', last_ip = '%s', last_login = NOW(), locale = '%u', failed_logins = 0 WHERE username = '%s'", K_hex, m_address.c_str(), GetLocaleByName(_localizationName), _safelogin.c_str());
+        LoginDatabase.CommitTransaction();
         OPENSSL_free((void*)K_hex);
 
         ///- Finish SRP6 and send the final result to the client
-        sha.Initialize();
-        sha.UpdateBigNumbers(&A, &M, &K, nullptr);
-        sha.Finalize();
+        Sha1Hash sha;
+        srp.Finalize(sha);
 
         SendProof(sha);
 
@@ -648,43 +616,59 @@ bool AuthSocket::_HandleLogonProof()
         if (MaxWrongPassCount > 0)
         {
             // Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
+            LoginDatabase.BeginTransaction(GetLookupKey());
             LoginDatabase.PExecute("UPDATE account SET failed_logins = failed_logins + 1 WHERE username = '%s'", _safelogin.c_str());
+            LoginDatabase.CommitTransaction();
 
-            if (QueryResult* loginfail = LoginDatabase.PQuery("SELECT id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str()))
-            {
-                Field* fields = loginfail->Fetch();
-                uint32 failed_logins = fields[1].GetUInt32();
-
-                if (failed_logins >= MaxWrongPassCount)
-                {
-                    uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
-                    bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
-
-                    if (WrongPassBanType)
-                    {
-                        uint32 acc_id = fields[0].GetUInt32();
-                        LoginDatabase.PExecute("INSERT INTO account_banned VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1)",
-                                               acc_id, WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
-                                  _login.c_str(), WrongPassBanTime, failed_logins);
-                    }
-                    else
-                    {
-                        std::string current_ip = m_address;
-                        LoginDatabase.escape_string(current_ip);
-                        LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
-                                               current_ip.c_str(), WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
-                                  current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
-                    }
-                }
-                delete loginfail;
-            }
+            // executed after the update, the lookups of an account keep their order
+            SqlQueryHolder* holder = new SqlQueryHolder();
+            holder->SetSize(1);
+            holder->SetPQuery(0, "SELECT id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str());
+            return StartLookup(holder, &AuthSocket::_OnWrongPasswordLookup);
         }
     }
     return true;
 }
 
+/// Ban the account or IP once the failed logins reached the limit
+void AuthSocket::_OnWrongPasswordLookup(QueryResult* /*dummy*/, SqlQueryHolder* holder)
+{
+    std::unique_ptr<SqlQueryHolder> results(holder);
+    std::unique_ptr<QueryResult> loginfail(holder->GetResult(0));
+    if (!loginfail)
+        return;
+
+    Field* fields = loginfail->Fetch();
+    uint32 failed_logins = fields[1].GetUInt32();
+
+    uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
+    if (MaxWrongPassCount == 0 || failed_logins < MaxWrongPassCount)
+        return;
+
+    uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
+    bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
+
+    LoginDatabase.BeginTransaction(GetLookupKey());
+    if (WrongPassBanType)
+    {
+        uint32 acc_id = fields[0].GetUInt32();
+        LoginDatabase.PExecute("INSERT INTO account_banned VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1)",
+                               acc_id, WrongPassBanTime);
+        BASIC_LOG("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
+                  _login.c_str(), WrongPassBanTime, failed_logins);
+    }
+    else
+    {
+        std::string current_ip = m_address;
+        LoginDatabase.escape_string(current_ip);
+        LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
+                               current_ip.c_str(), WrongPassBanTime);
+        BASIC_LOG("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
+                  current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
+    }
+    LoginDatabase.CommitTransaction();
+}
+
 /// Reconnect Challenge command handler
 bool AuthSocket::_HandleReconnectChallenge()
 {
@@ -728,19 +712,33 @@ bool AuthSocket::_HandleReconnectChallenge()
     EndianConvert(ch->build);
     _build = ch->build;
 
-    QueryResult* result = LoginDatabase.PQuery("SELECT sessionkey FROM account WHERE username = '%s'", _safelogin.c_str());
+    SqlQueryHolder* holder = new SqlQueryHolder();
+    holder->SetSize(1);
+    holder->SetPQuery(0, "SELECT sessionkey,id FROM account WHERE username = '%s'", _safelogin.c_str());
+    return StartLookup(holder, &AuthSocket::_OnReconnectChallengeLookup);
+}
+
+/// Answer the reconnect challenge from the session key lookup
+void AuthSocket::_OnReconnectChallengeLookup(QueryResult* /*dummy*/, SqlQueryHolder* holder)
+{
+    std::unique_ptr<SqlQueryHolder> results(holder);
+
+    if (IsClosed())
+        return;
+
+    std::unique_ptr<QueryResult> result(holder->GetResult(0));
 
     // Stop if the account is not found
     if (!result)
     {
         sLog.outError("[ERROR] user %s tried to login and we cannot find his session key in the database.", _login.c_str());
         Close();
-        return false;
+        return;
     }
 
     Field* fields = result->Fetch();
     K.SetHexStr(fields[0].GetString());
-    delete result;
+    _accountId = fields[1].GetUInt32();
 
     ///- All good, await client's proof
     _status = STATUS_RECON_PROOF;
@@ -753,7 +751,6 @@ bool AuthSocket::_HandleReconnectChallenge()
     pkt.append(_reconnectProof.AsByteArray(16), 16);        // 16 bytes random
     pkt << (uint64) 0x00 << (uint64) 0x00;                  // 16 bytes zeros
     Write((const char *)pkt.contents(), pkt.size());
-    return true;
 }
 
 /// Reconnect Proof command handler
@@ -811,27 +808,59 @@ bool AuthSocket::_HandleRealmList()
 
     ReadSkip(5);
 
-    ///- Get the user id (else close the connection)
-    // No SQL injection (escaped user name)
-
-    QueryResult* result = LoginDatabase.PQuery("SELECT id,sha_pass_hash FROM account WHERE username = '%s'", _safelogin.c_str());
-    if (!result)
+    ///- The user id is known from the challenge (else close the connection)
+    if (!_accountId)
     {
         sLog.outError("[ERROR] user %s tried to login and we cannot find him in the database.", _login.c_str());
         Close();
         return false;
     }
 
-    uint32 id = (*result)[0].GetUInt32();
-    std::string rI = (*result)[1].GetCppString();
-    delete result;
-
     ///- Update realm list if need
     sRealmList.UpdateIfNeed();
 
+    ///- Characters of the account are counted again only once the cached counts expired
+    RealmList::CharacterCounts characterCounts;
+    if (sRealmList.GetCharacterCounts(_accountId, characterCounts))
+    {
+        SendRealmList(characterCounts);
+        return true;
+    }
+
+    SqlQueryHolder* holder = new SqlQueryHolder();
+    holder->SetSize(1);
+    holder->SetPQuery(0, "SELECT realmid,numchars FROM realmcharacters WHERE acctid = '%u'", _accountId);
+    return StartLookup(holder, &AuthSocket::_OnRealmListLookup);
+}
+
+/// Send the realm list with the looked up character counts
+void AuthSocket::_OnRealmListLookup(QueryResult* /*dummy*/, SqlQueryHolder* holder)
+{
+    std::unique_ptr<SqlQueryHolder> results(holder);
+    std::unique_ptr<QueryResult> result(holder->GetResult(0));
+
+    RealmList::CharacterCounts characterCounts;
+    if (result)
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            characterCounts[fields[0].GetUInt32()] = fields[1].GetUInt8();
+        }
+        while (result->NextRow());
+    }
+
+    sRealmList.SetCharacterCounts(_accountId, characterCounts);
+
+    if (!IsClosed())
+        SendRealmList(characterCounts);
+}
+
+void AuthSocket::SendRealmList(RealmList::CharacterCounts const& characterCounts)
+{
     ///- Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
     ByteBuffer pkt;
-    LoadRealmlist(pkt, id);
+    LoadRealmlist(pkt, characterCounts);
 
     ByteBuffer hdr;
     hdr << (uint8) CMD_REALM_LIST;
@@ -839,11 +868,9 @@ bool AuthSocket::_HandleRealmList()
     hdr.append(pkt);
 
     Write((const char *)hdr.contents(), hdr.size());
-
-    return true;
 }
 
-void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
+void AuthSocket::LoadRealmlist(ByteBuffer& pkt, RealmList::CharacterCounts const& characterCounts)
 {
     switch (_build)
     {
@@ -856,18 +883,8 @@ void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
 
             for (RealmList::RealmMap::const_iterator  i = sRealmList.begin(); i != sRealmList.end(); ++i)
             {
-                uint8 AmountOfCharacters;
-
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult* result = LoginDatabase.PQuery("SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", i->second.m_ID, acctid);
-                if (result)
-                {
-                    Field* fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    AmountOfCharacters = 0;
+                RealmList::CharacterCounts::const_iterator count = characterCounts.find(i->second.m_ID);
+                uint8 AmountOfCharacters = count != characterCounts.end() ? count->second : 0;
 
                 bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), _build) != i->second.realmbuilds.end();
 
@@ -917,18 +934,8 @@ void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
 
             for (RealmList::RealmMap::const_iterator  i = sRealmList.begin(); i != sRealmList.end(); ++i)
             {
-                uint8 AmountOfCharacters;
-
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult* result = LoginDatabase.PQuery("SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", i->second.m_ID, acctid);
-                if (result)
-                {
-                    Field* fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    AmountOfCharacters = 0;
+                RealmList::CharacterCounts::const_iterator count = characterCounts.find(i->second.m_ID);
+                uint8 AmountOfCharacters = count != characterCounts.end() ? count->second : 0;
 
                 bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), _build) != i->second.realmbuilds.end();
 
@@ -26,7 +26,10 @@
 #include "Common.h"
 #include "Auth/BigNumber.h"
 #include "Auth/Sha1.h"
+#include "Auth/SRP6.h"
 #include "ByteBuffer.h"
+#include "Database/SqlOperations.h"
+#include "RealmList.h"
 
 #include "Network/Socket.hpp"
 
@@ -37,12 +40,10 @@
 class AuthSocket : public MaNGOS::Socket
 {
     public:
-        const static int s_BYTE_SIZE = 32;
-
         AuthSocket(boost::asio::io_service &service, std::function<void (Socket *)> closeHandler);
 
         void SendProof(Sha1Hash sha);
-        void LoadRealmlist(ByteBuffer& pkt, uint32 acctid);
+        void LoadRealmlist(ByteBuffer& pkt, RealmList::CharacterCounts const& characterCounts);
 
         bool _HandleLogonChallenge();
         bool _HandleLogonProof();
@@ -57,7 +58,28 @@ class AuthSocket : public MaNGOS::Socket
 
         void _SetVSFields(const std::string& rI);
 
+        // results of the login database lookups, called on the network thread of the socket
+        void _OnLogonChallengeLookup(QueryResult* dummy, SqlQueryHolder* holder);
+        void _OnWrongPasswordLookup(QueryResult* dummy, SqlQueryHolder* holder);
+        void _OnReconnectChallengeLookup(QueryResult* dummy, SqlQueryHolder* holder);
+        void _OnRealmListLookup(QueryResult* dummy, SqlQueryHolder* holder);
+
     private:
+        // hands the results of login database lookups back to the network thread of the socket
+        class LookupQueue : public SqlResultQueue
+        {
+            public:
+                void Add(MaNGOS::IQueryCallback* callback) override;
+
+                std::shared_ptr<AuthSocket> m_socket;       // set while a lookup runs, the socket may be closed meanwhile
+        };
+
+        // runs the queries of holder on a database delay thread, the socket reads nothing more until method got the results
+        bool StartLookup(SqlQueryHolder* holder, void (AuthSocket::*method)(QueryResult*, SqlQueryHolder*));
+        // requests of the same account are kept in order, those of different accounts may run in parallel
+        uint32 GetLookupKey() const;
+        void SendRealmList(RealmList::CharacterCounts const& characterCounts);
+
         enum eStatus
         {
             STATUS_CHALLENGE,
@@ -68,8 +90,7 @@ class AuthSocket : public MaNGOS::Socket
             STATUS_CLOSED
         };
 
-        BigNumber N, s, g, v;
-        BigNumber b, B;
+        SRP6 srp;
         BigNumber K;
         BigNumber _reconnectProof;
 
@@ -77,6 +98,7 @@ class AuthSocket : public MaNGOS::Socket
 
         std::string _login;
         std::string _safelogin;
+        uint32 _accountId;
 
         // Since GetLocaleByName() is _NOT_ bijective, we have to store the locale as a string. Otherwise we can't differ
         // between enUS and enGB, which is important for the patch system
@@ -84,6 +106,8 @@ class AuthSocket : public MaNGOS::Socket
         uint16 _build;
         AccountTypes _accountSecurityLevel;
 
+        LookupQueue m_lookupQueue;
+
         virtual bool ProcessIncomingData() override;
 };
 #endif
@@ -0,0 +1,232 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** \file
+    \ingroup realmd
+*/
+
+#include "LoginBenchmark.h"
+#include "Auth/SRP6.h"
+#include "Log.h"
+
+#include <openssl/crypto.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const uint32 BenchmarkAccounts = 64;
+
+    /// Account as the server finds it in the account table, with what only the client knows
+    struct BenchmarkAccount
+    {
+        std::string login;
+        BigNumber x;                                        // private key of the password
+        std::string verifierHex;
+        std::string saltHex;
+    };
+
+    std::string TakeHexStr(const char* hex)
+    {
+        std::string result(hex);
+        OPENSSL_free((void*)hex);
+        return result;
+    }
+
+    void CreateAccount(uint32 index, BenchmarkAccount& account)
+    {
+        char login[32];
+        snprintf(login, sizeof(login), "BENCHMARK%u", index);
+        account.login = login;
+
+        Sha1Hash passwordHash;
+        passwordHash.UpdateData(account.login + ":PASSWORD");
+        passwordHash.Finalize();
+
+        SRP6 srp;
+        BigNumber s;
+        do
+        {
+            s.SetRand(SRP6::s_BYTE_SIZE * 8);
+
+            Sha1Hash sha;
+            sha.UpdateData(s.AsByteArray(), s.GetNumBytes());
+            sha.UpdateData(passwordHash.GetDigest(), Sha1Hash::GetLength());
+            sha.Finalize();
+            account.x.SetBinary(sha.GetDigest(), sha.GetLength());
+
+            // calculated without the precomputed powers of g, so the benchmark also checks them
+            account.verifierHex = TakeHexStr(srp.GetGenerator().ModExp(account.x, srp.GetN()).AsHexStr());
+            account.saltHex = TakeHexStr(s.AsHexStr());
+        }
+        while (account.verifierHex.size() != SRP6::s_BYTE_SIZE * 2);
+    }
+
+    /// Client side of a login: the public ephemeral A and the proof M1 for the challenge of srp
+    void CalculateClientProof(BenchmarkAccount& account, SRP6& srp, uint8* clientA, uint8* clientM1, BigNumber& clientK)
+    {
+        BigNumber& N = srp.GetN();
+        BigNumber& g = srp.GetGenerator();
+        BigNumber& B = srp.GetHostPublicEphemeral();
+
+        // the server hashes A without leading zeros, which a real client does not do
+        BigNumber a, A;
+        do
+        {
+            a.SetRand(19 * 8);
+            A = g.ModExp(a, N);
+        }
+        while (A.GetNumBytes() < 32);
+        memcpy(clientA, A.AsByteArray(32), 32);
+
+        Sha1Hash sha;
+        sha.UpdateBigNumbers(&A, &B, nullptr);
+        sha.Finalize();
+        BigNumber u;
+        u.SetBinary(sha.GetDigest(), 20);
+
+        // S = (B - 3 * g^x)^(a + u * x)
+        BigNumber base = ((B + N) - (g.ModExp(account.x, N) * 3) % N) % N;
+        BigNumber S = base.ModExp(a + u * account.x, N);
+        clientK = SRP6::InterleaveHash(S);
+
+        uint8 hash[20];
+        sha.Initialize();
+        sha.UpdateBigNumbers(&N, nullptr);
+        sha.Finalize();
+        memcpy(hash, sha.GetDigest(), 20);
+        sha.Initialize();
+        sha.UpdateBigNumbers(&g, nullptr);
+        sha.Finalize();
+        for (int i = 0; i < 20; ++i)
+            hash[i] ^= sha.GetDigest()[i];
+        BigNumber t3;
+        t3.SetBinary(hash, 20);
+
+        sha.Initialize();
+        sha.UpdateData(account.login);
+        sha.Finalize();
+        uint8 t4[SHA_DIGEST_LENGTH];
+        memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+        BigNumber& s = srp.GetSalt();
+        sha.Initialize();
+        sha.UpdateBigNumbers(&t3, nullptr);
+        sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+        sha.UpdateBigNumbers(&s, &A, &B, &clientK, nullptr);
+        sha.Finalize();
+        BigNumber M;
+        M.SetBinary(sha.GetDigest(), 20);
+        memcpy(clientM1, M.AsByteArray(20), 20);
+    }
+
+    uint64 MicrosecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int RunLoginBenchmark(uint32 logins, uint32 threads)
+{
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    sLog.outString("Login benchmark: %u logins on %u threads", logins, threads);
+
+    std::vector<BenchmarkAccount> accounts(BenchmarkAccounts);
+    for (uint32 i = 0; i < BenchmarkAccounts; ++i)
+        CreateAccount(i, accounts[i]);
+
+    std::atomic<uint32> nextLogin(0);
+    std::atomic<uint32> failedLogins(0);
+    std::atomic<uint64> serverTime(0);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (uint32 i = 0; i < threads; ++i)
+    {
+        workers.emplace_back([&]()
+        {
+            uint8 clientA[32];
+            uint8 clientM1[20];
+            BigNumber clientK;
+            uint64 threadServerTime = 0;
+
+            for (uint32 login = nextLogin++; login < logins; login = nextLogin++)
+            {
+                BenchmarkAccount& account = accounts[login % BenchmarkAccounts];
+                SRP6 srp;
+
+                // logon challenge
+                std::chrono::steady_clock::time_point serverStart = std::chrono::steady_clock::now();
+                srp.SetVerifier(account.verifierHex, account.saltHex);
+                srp.CalculateHostPublicEphemeral();
+                threadServerTime += MicrosecondsSince(serverStart);
+
+                CalculateClientProof(account, srp, clientA, clientM1, clientK);
+
+                // logon proof
+                serverStart = std::chrono::steady_clock::now();
+                bool success = srp.CalculateSessionKey(clientA) && srp.Proof(account.login, clientM1);
+                Sha1Hash serverProof;
+                if (success)
+                    srp.Finalize(serverProof);
+                threadServerTime += MicrosecondsSince(serverStart);
+
+                if (!success || memcmp(srp.GetSessionKey().AsByteArray(40), clientK.AsByteArray(40), 40))
+                    ++failedLogins;
+            }
+
+            serverTime += threadServerTime;
+        });
+    }
+
+    for (std::thread& worker : workers)
+        worker.join();
+
+    const uint64 wallTime = std::max<uint64>(MicrosecondsSince(start), 1);
+    const double serverTimePerLogin = logins ? double(serverTime) / logins : 0.0;
+
+    sLog.outString("Finished in %.3f s (with the client side), %u failed logins", wallTime / 1000000.0, uint32(failedLogins));
+    sLog.outString("Server time per login: %.1f us, %.0f logins per second per core", serverTimePerLogin,
+                   serverTimePerLogin > 0.0 ? 1000000.0 / serverTimePerLogin : 0.0);
+
+    // the exponentiation every challenge does, with and without the precomputed powers of g
+    SRP6 srp;
+    BigNumber b;
+    b.SetRand(19 * 8);
+
+    const uint32 exponentiations = 1000;
+    std::chrono::steady_clock::time_point exponentiationStart = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < exponentiations; ++i)
+        SRP6::GetExponentiation().ModExp(b);
+    const uint64 fixedBaseTime = MicrosecondsSince(exponentiationStart);
+
+    exponentiationStart = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < exponentiations; ++i)
+        srp.GetGenerator().ModExp(b, srp.GetN());
+    const uint64 plainTime = MicrosecondsSince(exponentiationStart);
+
+    sLog.outString("g^b mod N: %.2f us with precomputed powers, %.2f us without", double(fixedBaseTime) / exponentiations, double(plainTime) / exponentiations);
+
+    return failedLogins ? 1 : 0;
+}
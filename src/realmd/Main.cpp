@@ -27,6 +27,7 @@
 #include "Config/Config.h"
 #include "Log.h"
 #include "AuthSocket.h"
+#include "LoginBenchmark.h"
 #include "SystemConfig.h"
 #include "revision.h"
 #include "revision_sql.h"
@@ -74,6 +75,8 @@ void usage(const char* prog)
     sLog.outString("Usage: \n %s [<options>]\n"
                    "    -v, --version            print version and exist\n\r"
                    "    -c config_file           use config_file as configuration file\n\r"
+                   "    --benchmark logins       time logins synthetic SRP6 logins and exit\n\r"
+                   "    --benchmark-threads n    threads of the benchmark (default: one per core)\n\r"
 #ifdef _WIN32
                    "    Running as service functions:\n\r"
                    "    -s run                   run as service\n\r"
@@ -91,11 +94,14 @@ void usage(const char* prog)
 int main(int argc, char *argv[])
 {
     std::string configFile, serviceParameter;
+    uint32 benchmarkLogins, benchmarkThreads;
 
     boost::program_options::options_description desc("Allowed options");
     desc.add_options()
         ("config,c", boost::program_options::value<std::string>(&configFile)->default_value(_REALMD_CONFIG), "configuration file")
         ("version,v", "print version and exit")
+        ("benchmark", boost::program_options::value<uint32>(&benchmarkLogins), "time <logins> synthetic SRP6 logins and exit")
+        ("benchmark-threads", boost::program_options::value<uint32>(&benchmarkThreads)->default_value(0), "threads of the benchmark, 0 for one per core")
 #ifdef _WIN32
         ("s", boost::program_options::value<std::string>(&serviceParameter), "<run, install, uninstall> service");
 #else
@@ -117,6 +123,10 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    // needs neither configuration nor database
+    if (vm.count("benchmark"))
+        return RunLoginBenchmark(benchmarkLogins, benchmarkThreads);
+
 #ifdef _WIN32                                                // windows service command need execute before config read
     if (vm.count("s"))
     {
@@ -218,7 +228,7 @@ int main(int argc, char *argv[])
     }
 
     ///- Get the list of realms for the server
-    sRealmList.Initialize(sConfig.GetIntDefault("RealmsStateUpdateDelay", 20));
+    sRealmList.Initialize(sConfig.GetIntDefault("RealmsStateUpdateDelay", 20), sConfig.GetIntDefault("RealmsCharacterCountCacheTime", 10));
     if (sRealmList.size() == 0)
     {
         sLog.outError("No valid realms specified.");
@@ -352,9 +362,12 @@ bool StartDB()
         return false;
     }
 
-    sLog.outString("Login Database total connections: %i", 1 + 1);
+    int nConnections = sConfig.GetIntDefault("LoginDatabaseConnections", 1);
+    int nAsyncConnections = sConfig.GetIntDefault("LoginDatabaseAsyncConnections", 4);
+    sLog.outString("Login Database total connections: %i", nConnections + nAsyncConnections);
 
-    if (!LoginDatabase.Initialize(dbstring.c_str()))
+    // the lookups of logins run on the async connections
+    if (!LoginDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to database");
         return false;
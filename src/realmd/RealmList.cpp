@@ -64,7 +64,8 @@ RealmBuildInfo const* FindBuildInfo(uint16 _build)
     return nullptr;
 }
 
-RealmList::RealmList() : m_UpdateInterval(0), m_NextUpdateTime(time(nullptr))
+RealmList::RealmList() : m_UpdateInterval(0), m_NextUpdateTime(time(nullptr)),
+    m_characterCountCacheTime(0), m_NextCharacterCountPurgeTime(time(nullptr))
 {
 }
 
@@ -75,9 +76,10 @@ RealmList& sRealmList
 }
 
 /// Load the realm list from the database
-void RealmList::Initialize(uint32 updateInterval)
+void RealmList::Initialize(uint32 updateInterval, uint32 characterCountCacheTime)
 {
     m_UpdateInterval = updateInterval;
+    m_characterCountCacheTime = characterCountCacheTime;
 
     ///- Get the content of the realmlist table in the database
     UpdateRealms(true);
@@ -138,6 +140,47 @@ void RealmList::UpdateIfNeed()
     UpdateRealms(false);
 }
 
+bool RealmList::GetCharacterCounts(uint32 accountId, CharacterCounts& counts)
+{
+    std::lock_guard<std::mutex> guard(m_characterCountLock);
+
+    auto const itr = m_characterCounts.find(accountId);
+    if (itr == m_characterCounts.end() || itr->second.expireTime <= time(nullptr))
+        return false;
+
+    counts = itr->second.counts;
+    return true;
+}
+
+void RealmList::SetCharacterCounts(uint32 accountId, CharacterCounts const& counts)
+{
+    // maybe disabled
+    if (!m_characterCountCacheTime)
+        return;
+
+    const time_t now = time(nullptr);
+
+    std::lock_guard<std::mutex> guard(m_characterCountLock);
+
+    // drop the counts of accounts which did not ask for the realm list again
+    if (m_NextCharacterCountPurgeTime <= now)
+    {
+        m_NextCharacterCountPurgeTime = now + m_characterCountCacheTime;
+
+        for (auto itr = m_characterCounts.begin(); itr != m_characterCounts.end();)
+        {
+            if (itr->second.expireTime <= now)
+                itr = m_characterCounts.erase(itr);
+            else
+                ++itr;
+        }
+    }
+
+    CachedCharacterCounts& cached = m_characterCounts[accountId];
+    cached.expireTime = now + m_characterCountCacheTime;
+    cached.counts = counts;
+}
+
 void RealmList::UpdateRealms(bool init)
 {
     DETAIL_LOG("Updating Realm List...");
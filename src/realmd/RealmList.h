@@ -25,6 +25,9 @@
 
 #include "Common.h"
 
+#include <mutex>
+#include <unordered_map>
+
 struct RealmBuildInfo
 {
     int build;
@@ -57,16 +60,21 @@ class RealmList
 {
     public:
         typedef std::map<std::string, Realm> RealmMap;
+        typedef std::map<uint32, uint8> CharacterCounts;    // realm id -> characters of an account
 
         static RealmList& Instance();
 
         RealmList();
         ~RealmList() {}
 
-        void Initialize(uint32 updateInterval);
+        void Initialize(uint32 updateInterval, uint32 characterCountCacheTime);
 
         void UpdateIfNeed();
 
+        // characters of the account on each realm, false if they are not cached or the cache time passed
+        bool GetCharacterCounts(uint32 accountId, CharacterCounts& counts);
+        void SetCharacterCounts(uint32 accountId, CharacterCounts const& counts);
+
         RealmMap::const_iterator begin() const { return m_realms.begin(); }
         RealmMap::const_iterator end() const { return m_realms.end(); }
         uint32 size() const { return m_realms.size(); }
@@ -77,6 +85,17 @@ class RealmList
         RealmMap m_realms;                                  ///< Internal map of realms
         uint32   m_UpdateInterval;
         time_t   m_NextUpdateTime;
+
+        struct CachedCharacterCounts
+        {
+            time_t expireTime;
+            CharacterCounts counts;
+        };
+
+        std::mutex m_characterCountLock;
+        std::unordered_map<uint32, CachedCharacterCounts> m_characterCounts;
+        uint32   m_characterCountCacheTime;
+        time_t   m_NextCharacterCountPurgeTime;
 };
 
 #define sRealmList RealmList::Instance()
@@ -20,6 +20,28 @@
 #include <openssl/bn.h>
 #include <algorithm>
 
+namespace
+{
+    // scratch space of the calculations, kept per thread instead of allocated for every operation
+    class ThreadContext
+    {
+        public:
+            ThreadContext() : m_ctx(BN_CTX_new()) {}
+            ~ThreadContext() { BN_CTX_free(m_ctx); }
+
+            BN_CTX* Get() const { return m_ctx; }
+
+        private:
+            BN_CTX* const m_ctx;
+    };
+
+    BN_CTX* GetContext()
+    {
+        thread_local ThreadContext context;
+        return context.Get();
+    }
+}
+
 BigNumber::BigNumber()
 {
     _bn = BN_new();
@@ -95,33 +117,24 @@ BigNumber BigNumber::operator-=(const BigNumber& bn)
 
 BigNumber BigNumber::operator*=(const BigNumber& bn)
 {
-    BN_CTX* bnctx;
-
-    bnctx = BN_CTX_new();
+    BN_CTX* bnctx = GetContext();
     BN_mul(_bn, _bn, bn._bn, bnctx);
-    BN_CTX_free(bnctx);
 
     return *this;
 }
 
 BigNumber BigNumber::operator/=(const BigNumber& bn)
 {
-    BN_CTX* bnctx;
-
-    bnctx = BN_CTX_new();
+    BN_CTX* bnctx = GetContext();
     BN_div(_bn, nullptr, _bn, bn._bn, bnctx);
-    BN_CTX_free(bnctx);
 
     return *this;
 }
 
 BigNumber BigNumber::operator%=(const BigNumber& bn)
 {
-    BN_CTX* bnctx;
-
-    bnctx = BN_CTX_new();
+    BN_CTX* bnctx = GetContext();
     BN_mod(_bn, _bn, bn._bn, bnctx);
-    BN_CTX_free(bnctx);
 
     return *this;
 }
@@ -129,11 +142,8 @@ BigNumber BigNumber::operator%=(const BigNumber& bn)
 BigNumber BigNumber::Exp(const BigNumber& bn)
 {
     BigNumber ret;
-    BN_CTX* bnctx;
-
-    bnctx = BN_CTX_new();
+    BN_CTX* bnctx = GetContext();
     BN_exp(ret._bn, _bn, bn._bn, bnctx);
-    BN_CTX_free(bnctx);
 
     return ret;
 }
@@ -141,11 +151,8 @@ BigNumber BigNumber::Exp(const BigNumber& bn)
 BigNumber BigNumber::ModExp(const BigNumber& bn1, const BigNumber& bn2)
 {
     BigNumber ret;
-    BN_CTX* bnctx;
-
-    bnctx = BN_CTX_new();
+    BN_CTX* bnctx = GetContext();
     BN_mod_exp(ret._bn, _bn, bn1._bn, bn2._bn, bnctx);
-    BN_CTX_free(bnctx);
 
     return ret;
 }
@@ -192,3 +199,77 @@ const char* BigNumber::AsDecStr() const
 {
     return BN_bn2dec(_bn);
 }
+
+FixedBaseModExp::FixedBaseModExp(const BigNumber& base, const BigNumber& modulus, int maxExponentBits)
+    : m_base(base), m_modulus(modulus), m_windows((maxExponentBits + WindowBits - 1) / WindowBits),
+      m_mont(BN_MONT_CTX_new()), m_one(BN_new())
+{
+    BN_CTX* bnctx = GetContext();
+    BN_MONT_CTX_set(m_mont, m_modulus._bn, bnctx);
+    BN_to_montgomery(m_one, BN_value_one(), m_mont, bnctx);
+
+    // power is base^(16^window), the digits of a window are its multiples
+    BIGNUM* power = BN_new();
+    BN_nnmod(power, m_base._bn, m_modulus._bn, bnctx);
+    BN_to_montgomery(power, power, m_mont, bnctx);
+
+    m_powers.reserve(m_windows * WindowDigits);
+    for (int window = 0; window < m_windows; ++window)
+    {
+        m_powers.push_back(BN_dup(power));
+        for (int digit = 2; digit <= WindowDigits; ++digit)
+        {
+            BIGNUM* entry = BN_new();
+            BN_mod_mul_montgomery(entry, m_powers.back(), power, m_mont, bnctx);
+            m_powers.push_back(entry);
+        }
+
+        BN_mod_mul_montgomery(power, m_powers.back(), power, m_mont, bnctx);
+    }
+
+    BN_free(power);
+}
+
+FixedBaseModExp::~FixedBaseModExp()
+{
+    for (BIGNUM* entry : m_powers)
+        BN_free(entry);
+
+    BN_free(m_one);
+    BN_MONT_CTX_free(m_mont);
+}
+
+BigNumber FixedBaseModExp::ModExp(const BigNumber& exponent) const
+{
+    BigNumber ret;
+    BN_CTX* bnctx = GetContext();
+
+    const int bits = BN_num_bits(exponent._bn);
+    if (BN_is_negative(exponent._bn) || bits > m_windows * WindowBits)
+    {
+        BN_mod_exp_mont(ret._bn, m_base._bn, exponent._bn, m_modulus._bn, bnctx, m_mont);
+        return ret;
+    }
+
+    BN_copy(ret._bn, m_one);
+    for (int window = 0; window * WindowBits < bits; ++window)
+    {
+        int digit = 0;
+        for (int i = 0; i < WindowBits; ++i)
+            if (BN_is_bit_set(exponent._bn, window * WindowBits + i))
+                digit |= 1 << i;
+
+        if (digit)
+            BN_mod_mul_montgomery(ret._bn, ret._bn, m_powers[window * WindowDigits + digit - 1], m_mont, bnctx);
+    }
+
+    BN_from_montgomery(ret._bn, ret._bn, m_mont, bnctx);
+    return ret;
+}
+
+BigNumber FixedBaseModExp::ModExp(const BigNumber& other, const BigNumber& exponent) const
+{
+    BigNumber ret;
+    BN_mod_exp_mont(ret._bn, other._bn, exponent._bn, m_modulus._bn, GetContext(), m_mont);
+    return ret;
+}
@@ -21,10 +21,15 @@
 
 #include "Common.h"
 
+#include <vector>
+
 struct bignum_st;
+struct bn_mont_ctx_st;
 
 class BigNumber
 {
+        friend class FixedBaseModExp;
+
     public:
         BigNumber();
         BigNumber(const BigNumber& bn);
@@ -90,4 +95,34 @@ class BigNumber
         struct bignum_st* _bn;
         uint8* _array;
 };
+
+/// Exponentiation of one base modulo one odd modulus, as SRP6 does for g^x mod N at every login.
+/// The powers base^(d * 16^i) are kept in Montgomery form, so an exponentiation takes one multiplication
+/// per 4 exponent bits instead of a squaring per bit. Read only after construction, may be shared by threads.
+class FixedBaseModExp
+{
+    public:
+        FixedBaseModExp(const BigNumber& base, const BigNumber& modulus, int maxExponentBits);
+        ~FixedBaseModExp();
+
+        FixedBaseModExp(const FixedBaseModExp&) = delete;
+        FixedBaseModExp& operator=(const FixedBaseModExp&) = delete;
+
+        // base^exponent % modulus, longer exponents than maxExponentBits fall back to a plain exponentiation
+        BigNumber ModExp(const BigNumber& exponent) const;
+        // other^exponent % modulus, still saves setting up the Montgomery context of the modulus
+        BigNumber ModExp(const BigNumber& other, const BigNumber& exponent) const;
+
+    private:
+        static const int WindowBits = 4;
+        static const int WindowDigits = (1 << WindowBits) - 1;
+
+        BigNumber m_base;
+        BigNumber m_modulus;
+        int m_windows;
+
+        struct bn_mont_ctx_st* m_mont;
+        struct bignum_st* m_one;                            // 1 in Montgomery form
+        std::vector<struct bignum_st*> m_powers;            // base^(digit << (window * WindowBits)) for digits 1..WindowDigits
+};
 #endif
@@ -0,0 +1,198 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Auth/SRP6.h"
+
+#include <memory>
+
+namespace
+{
+    // the group of all logins, g is only raised to random b (19 bytes) and password hashes x (20 bytes)
+    struct SRP6Group
+    {
+        BigNumber N, g;
+        std::unique_ptr<FixedBaseModExp> exponentiation;
+
+        SRP6Group()
+        {
+            N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
+            g.SetDword(7);
+            exponentiation.reset(new FixedBaseModExp(g, N, SHA_DIGEST_LENGTH * 8));
+        }
+    };
+
+    SRP6Group const& GetGroup()
+    {
+        static SRP6Group group;
+        return group;
+    }
+}
+
+FixedBaseModExp const& SRP6::GetExponentiation()
+{
+    return *GetGroup().exponentiation;
+}
+
+SRP6::SRP6() : N(GetGroup().N), g(GetGroup().g)
+{
+}
+
+/// Make the SRP6 calculation from hash in dB
+void SRP6::CalculateVerifier(const std::string& rI)
+{
+    s.SetRand(s_BYTE_SIZE * 8);
+
+    BigNumber I;
+    I.SetHexStr(rI.c_str());
+
+    // In case of leading zeros in the rI hash, restore them
+    uint8 mDigest[SHA_DIGEST_LENGTH];
+    memset(mDigest, 0, SHA_DIGEST_LENGTH);
+    if (I.GetNumBytes() <= SHA_DIGEST_LENGTH)
+        memcpy(mDigest, I.AsByteArray(), I.GetNumBytes());
+
+    std::reverse(mDigest, mDigest + SHA_DIGEST_LENGTH);
+
+    Sha1Hash sha;
+    sha.UpdateData(s.AsByteArray(), s.GetNumBytes());
+    sha.UpdateData(mDigest, SHA_DIGEST_LENGTH);
+    sha.Finalize();
+    BigNumber x;
+    x.SetBinary(sha.GetDigest(), sha.GetLength());
+    v = GetExponentiation().ModExp(x);
+}
+
+bool SRP6::SetVerifier(const std::string& verifierHex, const std::string& saltHex)
+{
+    // multiply with 2, bytes are stored as hexstring
+    if (verifierHex.size() != s_BYTE_SIZE * 2 || saltHex.size() != s_BYTE_SIZE * 2)
+        return false;
+
+    s.SetHexStr(saltHex.c_str());
+    v.SetHexStr(verifierHex.c_str());
+    return true;
+}
+
+void SRP6::CalculateHostPublicEphemeral()
+{
+    b.SetRand(19 * 8);
+    BigNumber gmod = GetExponentiation().ModExp(b);
+    B = ((v * 3) + gmod) % N;
+
+    MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
+}
+
+bool SRP6::CalculateSessionKey(const uint8* clientA)
+{
+    A.SetBinary(clientA, 32);
+
+    // SRP safeguard: abort if A==0
+    if (A.isZero())
+        return false;
+
+    if ((A % N).isZero())
+        return false;
+
+    Sha1Hash sha;
+    sha.UpdateBigNumbers(&A, &B, nullptr);
+    sha.Finalize();
+    BigNumber u;
+    u.SetBinary(sha.GetDigest(), 20);
+
+    FixedBaseModExp const& exponentiation = GetExponentiation();
+    BigNumber S = exponentiation.ModExp(A * exponentiation.ModExp(v, u), b);
+
+    K = InterleaveHash(S);
+    return true;
+}
+
+BigNumber SRP6::InterleaveHash(BigNumber& S)
+{
+    uint8 t[32];
+    uint8 t1[16];
+    uint8 vK[40];
+    memcpy(t, S.AsByteArray(32), 32);
+    for (int i = 0; i < 16; ++i)
+    {
+        t1[i] = t[i * 2];
+    }
+    Sha1Hash sha;
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+    {
+        vK[i * 2] = sha.GetDigest()[i];
+    }
+    for (int i = 0; i < 16; ++i)
+    {
+        t1[i] = t[i * 2 + 1];
+    }
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+    {
+        vK[i * 2 + 1] = sha.GetDigest()[i];
+    }
+
+    BigNumber key;
+    key.SetBinary(vK, 40);
+    return key;
+}
+
+bool SRP6::Proof(const std::string& login, const uint8* clientM1)
+{
+    uint8 hash[20];
+
+    Sha1Hash sha;
+    sha.UpdateBigNumbers(&N, nullptr);
+    sha.Finalize();
+    memcpy(hash, sha.GetDigest(), 20);
+    sha.Initialize();
+    sha.UpdateBigNumbers(&g, nullptr);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+    {
+        hash[i] ^= sha.GetDigest()[i];
+    }
+    BigNumber t3;
+    t3.SetBinary(hash, 20);
+
+    sha.Initialize();
+    sha.UpdateData(login);
+    sha.Finalize();
+    uint8 t4[SHA_DIGEST_LENGTH];
+    memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&t3, nullptr);
+    sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+    sha.UpdateBigNumbers(&s, &A, &B, &K, nullptr);
+    sha.Finalize();
+    M.SetBinary(sha.GetDigest(), 20);
+
+    // M may have less than 20 significant bytes
+    return !memcmp(M.AsByteArray(20), clientM1, 20);
+}
+
+void SRP6::Finalize(Sha1Hash& sha)
+{
+    sha.Initialize();
+    sha.UpdateBigNumbers(&A, &M, &K, nullptr);
+    sha.Finalize();
+}
@@ -0,0 +1,67 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUTH_SRP6_H
+#define _AUTH_SRP6_H
+
+#include "Common.h"
+#include "Auth/BigNumber.h"
+#include "Auth/Sha1.h"
+
+/// Server side of the SRP6 login of realmd
+class SRP6
+{
+    public:
+        const static int s_BYTE_SIZE = 32;
+
+        SRP6();
+
+        // new random salt and its verifier for rI, the hex string of SHA1(USERNAME:PASSWORD)
+        void CalculateVerifier(const std::string& rI);
+        // verifier and salt as stored in the account table, false if they do not have the expected size
+        bool SetVerifier(const std::string& verifierHex, const std::string& saltHex);
+
+        // random b and B = 3v + g^b, sent with the logon challenge
+        void CalculateHostPublicEphemeral();
+        // session key from the public ephemeral A of the client, false if A is not acceptable
+        bool CalculateSessionKey(const uint8* clientA);
+        // checks the proof M1 of the client, the session key must be calculated
+        bool Proof(const std::string& login, const uint8* clientM1);
+        // proof of the server, sent back once the client proof matched
+        void Finalize(Sha1Hash& sha);
+
+        BigNumber& GetN() { return N; }
+        BigNumber& GetGenerator() { return g; }
+        BigNumber& GetSalt() { return s; }
+        BigNumber& GetVerifier() { return v; }
+        BigNumber& GetHostPublicEphemeral() { return B; }
+        BigNumber& GetSessionKey() { return K; }
+
+        // session key from the shared secret S, the same calculation on client and server side
+        static BigNumber InterleaveHash(BigNumber& S);
+
+        // exponentiations modulo N, with precomputed powers of g
+        static FixedBaseModExp const& GetExponentiation();
+
+    private:
+        BigNumber N, g;
+        BigNumber s, v;
+        BigNumber b, B;
+        BigNumber A, K, M;
+};
+#endif
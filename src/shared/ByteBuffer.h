@@ -21,6 +21,7 @@
 
 #include "Common.h"
 #include "Utilities/ByteConverter.h"
+#include "ByteBufferPool.h"
 
 class ByteBufferException
 {
@@ -50,20 +51,61 @@ class ByteBuffer
     public:
         const static size_t DEFAULT_SIZE = 0x1000;
 
-        // constructor
+        // constructor, the storage is taken from MaNGOS::ByteBufferPool
         ByteBuffer(): _rpos(0), _wpos(0)
         {
-            _storage.reserve(DEFAULT_SIZE);
+            MaNGOS::ByteBufferPool::Acquire(_storage, DEFAULT_SIZE);
         }
 
         // constructor
         ByteBuffer(size_t res): _rpos(0), _wpos(0)
         {
-            _storage.reserve(res);
+            MaNGOS::ByteBufferPool::Acquire(_storage, res);
         }
 
         // copy constructor
-        ByteBuffer(const ByteBuffer& buf): _rpos(buf._rpos), _wpos(buf._wpos), _storage(buf._storage) { }
+        ByteBuffer(const ByteBuffer& buf): _rpos(buf._rpos), _wpos(buf._wpos)
+        {
+            MaNGOS::ByteBufferPool::Acquire(_storage, buf.size());
+            _storage = buf._storage;
+        }
+
+        // move constructor, takes over the storage without copying it
+        ByteBuffer(ByteBuffer&& buf): _rpos(buf._rpos), _wpos(buf._wpos), _storage(std::move(buf._storage))
+        {
+            buf._rpos = buf._wpos = 0;
+        }
+
+        ~ByteBuffer()
+        {
+            MaNGOS::ByteBufferPool::Release(_storage);
+        }
+
+        ByteBuffer& operator=(const ByteBuffer& buf)
+        {
+            if (this != &buf)
+            {
+                _rpos = buf._rpos;
+                _wpos = buf._wpos;
+                if (buf.size() > _storage.capacity())
+                {
+                    _storage.clear();
+                    MaNGOS::ByteBufferPool::Grow(_storage, buf.size());
+                }
+                _storage = buf._storage;
+            }
+            return *this;
+        }
+
+        ByteBuffer& operator=(ByteBuffer&& buf)
+        {
+            _rpos = buf._rpos;
+            _wpos = buf._wpos;
+            MaNGOS::ByteBufferPool::Release(_storage);
+            _storage = std::move(buf._storage);
+            buf._rpos = buf._wpos = 0;
+            return *this;
+        }
 
         void clear()
         {
@@ -322,6 +364,7 @@ class ByteBuffer
 
         void resize(size_t newsize)
         {
+            MaNGOS::ByteBufferPool::Grow(_storage, newsize);
             _storage.resize(newsize);
             _rpos = 0;
             _wpos = size();
@@ -330,7 +373,7 @@ class ByteBuffer
         void reserve(size_t ressize)
         {
             if (ressize > size())
-                _storage.reserve(ressize);
+                MaNGOS::ByteBufferPool::Grow(_storage, ressize);
         }
 
         void append(const std::string& str)
@@ -356,7 +399,11 @@ class ByteBuffer
             MANGOS_ASSERT(size() < 10000000);
 
             if (_storage.size() < _wpos + cnt)
+            {
+                if (_storage.capacity() < _wpos + cnt)
+                    MaNGOS::ByteBufferPool::Grow(_storage, std::max(_wpos + cnt, 2 * _storage.capacity()));
                 _storage.resize(_wpos + cnt);
+            }
             memcpy(&_storage[_wpos], src, cnt);
             _wpos += cnt;
         }
@@ -0,0 +1,134 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ByteBufferPool.h"
+#include "SizeClassPool.h"
+
+namespace MaNGOS
+{
+    namespace ByteBufferPool
+    {
+        namespace
+        {
+            struct BufferTraits
+            {
+                typedef std::vector<uint8> Item;
+
+                static const uint32 ClassCount = ByteBufferPool::ClassCount;
+                static const uint32 DefaultThreadCache = 64;
+                static const size_t DefaultMaxSharedBytes = 16 * 1024 * 1024;
+
+                static size_t GetBytes(Item const& buffer, uint32 /*sizeClass*/) { return buffer.capacity(); }
+            };
+
+            typedef SizeClassPool<BufferTraits> BufferPool;
+
+            // smallest class holding size bytes, size must not exceed MaxClassSize
+            uint32 GetAcquireClass(size_t size)
+            {
+                uint32 sizeClass = 0;
+                while ((MinClassSize << sizeClass) < size)
+                    ++sizeClass;
+                return sizeClass;
+            }
+
+            // largest class a buffer of the given capacity can serve, ClassCount for buffers not worth keeping
+            uint32 GetReleaseClass(size_t capacity)
+            {
+                if (capacity < MinClassSize || capacity > 2 * MaxClassSize)
+                    return ClassCount;
+
+                uint32 sizeClass = 0;
+                while (sizeClass + 1 < ClassCount && (MinClassSize << (sizeClass + 1)) <= capacity)
+                    ++sizeClass;
+                return sizeClass;
+            }
+        }
+
+        void Configure(uint32 threadCache, size_t maxSharedBytes)
+        {
+            BufferPool::Configure(threadCache, maxSharedBytes);
+        }
+
+        void Acquire(std::vector<uint8>& storage, size_t size)
+        {
+            if (!size)
+                return;
+
+            if (size > MaxClassSize)
+            {
+                BufferPool::CountUnpooled();
+                storage.reserve(size);
+                return;
+            }
+
+            // allocate the full class size so the buffer goes back into the class it came from
+            const uint32 sizeClass = GetAcquireClass(size);
+            if (!BufferPool::Take(sizeClass, storage))
+                storage.reserve(MinClassSize << sizeClass);
+        }
+
+        void Grow(std::vector<uint8>& storage, size_t size)
+        {
+            if (size <= storage.capacity())
+                return;
+
+            std::vector<uint8> grown;
+            Acquire(grown, size);
+            grown.assign(storage.begin(), storage.end());
+            Release(storage);
+            storage.swap(grown);
+        }
+
+        void Release(std::vector<uint8>& storage)
+        {
+            if (!storage.capacity())
+                return;
+
+            const uint32 sizeClass = GetReleaseClass(storage.capacity());
+            if (sizeClass == ClassCount)
+            {
+                std::vector<uint8>().swap(storage);
+                return;
+            }
+
+            storage.clear();
+            BufferPool::Give(sizeClass, storage);
+        }
+
+        void GetSnapshot(Snapshot& snapshot)
+        {
+            BufferPool::Totals totals;
+            BufferPool::GetTotals(totals);
+
+            for (uint32 i = 0; i < ClassCount; ++i)
+            {
+                BufferPool::ClassTotals const& total = totals.classes[i];
+                ClassSnapshot& result = snapshot.classes[i];
+                result.size = MinClassSize << i;
+                result.hits = total.hits;
+                result.misses = total.misses;
+                result.released = total.released;
+                result.discarded = total.discarded;
+                result.retained = total.retained > 0 ? uint64(total.retained) : 0;
+            }
+            snapshot.unpooled = totals.unpooled;
+            snapshot.sharedBytes = BufferPool::GetSharedBytes();
+        }
+    }
+}
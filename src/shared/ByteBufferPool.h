@@ -0,0 +1,74 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_BYTEBUFFERPOOL_H
+#define MANGOS_BYTEBUFFERPOOL_H
+
+#include "Platform/Define.h"
+
+#include <vector>
+
+namespace MaNGOS
+{
+    /**
+     * Recycles the storage of ByteBuffer and WorldPacket.
+     *
+     * Buffers are kept in power of two size classes. Every thread caches a few buffers of each class
+     * and exchanges them in batches with a shared depot, so a buffer allocated by a network thread and
+     * freed by the world thread (or the other way round) is reused instead of returned to the heap.
+     */
+    namespace ByteBufferPool
+    {
+        static const uint32 ClassCount = 11;
+        static const size_t MinClassSize = 64;
+        static const size_t MaxClassSize = MinClassSize << (ClassCount - 1);
+
+        // threadCache buffers per size class and thread, 0 disables the pool; maxSharedBytes limits the shared depot
+        void Configure(uint32 threadCache, size_t maxSharedBytes);
+
+        // gives storage (which must be empty and unallocated) a capacity of at least size
+        void Acquire(std::vector<uint8>& storage, size_t size);
+
+        // grows storage to at least size keeping its content, the old buffer is returned to the pool
+        void Grow(std::vector<uint8>& storage, size_t size);
+
+        // takes the buffer of storage into the pool, storage is left without allocation
+        void Release(std::vector<uint8>& storage);
+
+        struct ClassSnapshot
+        {
+            size_t size;
+            uint64 hits;                                    // acquisitions served from the pool
+            uint64 misses;                                  // acquisitions allocated from the heap
+            uint64 released;                                // buffers taken back
+            uint64 discarded;                               // buffers freed because the pool was full
+            uint64 retained;                                // buffers currently held by thread caches and depot
+        };
+
+        struct Snapshot
+        {
+            ClassSnapshot classes[ClassCount];
+            uint64 unpooled;                                // acquisitions outside the size classes or with the pool disabled
+            uint64 sharedBytes;                             // bytes held by the shared depot
+        };
+
+        void GetSnapshot(Snapshot& snapshot);
+    }
+}
+
+#endif
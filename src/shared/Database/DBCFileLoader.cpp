@@ -21,69 +21,54 @@
 #include <string.h>
 
 #include "DBCFileLoader.h"
+#include "MappedFile.h"
+
+#define DBC_HEADER_SIZE 20                                  // signature, record count, field count, record size, string size
 
 DBCFileLoader::DBCFileLoader()
 {
+    file = nullptr;
     data = nullptr;
+    stringTable = nullptr;
     fieldsOffset = nullptr;
 }
 
 bool DBCFileLoader::Load(const char* filename, const char* fmt)
 {
-    uint32 header;
-    delete[] data;
-
-    FILE* f = fopen(filename, "rb");
-    if (!f)
-        return false;
-
-    if (fread(&header, 4, 1, f) != 1)                       // Number of records
-    {
-        fclose(f);
-        return false;
-    }
-
-
-    EndianConvert(header);
-
-    if (header != 0x43424457)                               //'WDBC'
-    {
-        fclose(f);
-        return false;
-    }
+    Unload();
 
-    if (fread(&recordCount, 4, 1, f) != 1)                  // Number of records
+    // copy-on-write, so pages of the file stay shared with every other process mapping it until written
+    file = new MaNGOS::MappedFile();
+    if (!file->Open(filename, true) || file->GetSize() < DBC_HEADER_SIZE)
     {
-        fclose(f);
+        Unload();
         return false;
     }
 
-    EndianConvert(recordCount);
-
-    if (fread(&fieldCount, 4, 1, f) != 1)                   // Number of fields
-    {
-        fclose(f);
-        return false;
-    }
+    uint8* fileData = file->GetWritableData();
 
-    EndianConvert(fieldCount);
+    uint32 header[DBC_HEADER_SIZE / 4];
+    memcpy(header, fileData, DBC_HEADER_SIZE);
+    for (uint32 i = 0; i < DBC_HEADER_SIZE / 4; ++i)
+        EndianConvert(header[i]);
 
-    if (fread(&recordSize, 4, 1, f) != 1)                   // Size of a record
+    if (header[0] != 0x43424457)                            //'WDBC'
     {
-        fclose(f);
+        Unload();
         return false;
     }
 
-    EndianConvert(recordSize);
+    recordCount = header[1];
+    fieldCount = header[2];
+    recordSize = header[3];
+    stringSize = header[4];
 
-    if (fread(&stringSize, 4, 1, f) != 1)                   // String size
+    if (file->GetSize() - DBC_HEADER_SIZE < uint64(recordSize) * recordCount + stringSize)
     {
-        fclose(f);
+        Unload();
         return false;
     }
 
-    EndianConvert(stringSize);
-
     fieldsOffset = new uint32[fieldCount];
     fieldsOffset[0] = 0;
     for (uint32 i = 1; i < fieldCount; ++i)
@@ -95,23 +80,31 @@ bool DBCFileLoader::Load(const char* filename, const char* fmt)
             fieldsOffset[i] += 4;
     }
 
-    data = new unsigned char[recordSize * recordCount + stringSize];
+    data = fileData + DBC_HEADER_SIZE;
     stringTable = data + recordSize * recordCount;
-
-    if (fread(data, recordSize * recordCount + stringSize, 1, f) != 1)
-    {
-        fclose(f);
-        return false;
-    }
-
-    fclose(f);
     return true;
 }
 
 DBCFileLoader::~DBCFileLoader()
 {
-    delete[] data;
+    Unload();
+}
+
+void DBCFileLoader::Unload()
+{
+    delete file;
+    file = nullptr;
+    data = nullptr;
+    stringTable = nullptr;
     delete[] fieldsOffset;
+    fieldsOffset = nullptr;
+}
+
+MaNGOS::MappedFile* DBCFileLoader::ReleaseFile()
+{
+    MaNGOS::MappedFile* released = file;
+    file = nullptr;
+    return released;
 }
 
 DBCFileLoader::Record DBCFileLoader::getRecord(size_t id)
@@ -120,6 +113,24 @@ DBCFileLoader::Record DBCFileLoader::getRecord(size_t id)
     return Record(*this, data + id * recordSize);
 }
 
+bool DBCFileLoader::CanUseRecordsInPlace(const char* format) const
+{
+#if MANGOS_ENDIAN == MANGOS_BIGENDIAN
+    (void)format;
+    return false;
+#else
+    if (!data || strlen(format) != fieldCount || recordSize != fieldCount * sizeof(uint32))
+        return false;
+
+    // only 4 byte values kept as they are, strings are pointers in memory and skipped fields leave gaps
+    for (uint32 x = 0; format[x]; ++x)
+        if (format[x] != FT_INT && format[x] != FT_FLOAT && format[x] != FT_IND)
+            return false;
+
+    return true;
+#endif
+}
+
 uint32 DBCFileLoader::GetFormatRecordSize(const char* format, int32* index_pos)
 {
     uint32 recordsize = 0;
@@ -208,6 +219,15 @@ char* DBCFileLoader::AutoProduceData(const char* format, uint32& records, char**
         indexTable = new ptr[recordCount];
     }
 
+    if (CanUseRecordsInPlace(format))
+    {
+        char* dataTable = reinterpret_cast<char*>(data);
+        for (uint32 y = 0; y < recordCount; ++y)
+            indexTable[i >= 0 ? getRecord(y).getUInt(i) : y] = &dataTable[y * recordsize];
+
+        return dataTable;
+    }
+
     char* dataTable = new char[recordCount * recordsize];
 
     uint32 offset = 0;
@@ -259,13 +279,10 @@ char* DBCFileLoader::AutoProduceData(const char* format, uint32& records, char**
     return dataTable;
 }
 
-char* DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
+bool DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
 {
     if (strlen(format) != fieldCount)
-        return nullptr;
-
-    char* stringPool = new char[stringSize];
-    memcpy(stringPool, stringTable, stringSize);
+        return false;
 
     uint32 offset = 0;
 
@@ -290,10 +307,7 @@ char* DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
                     // fill only not filled entries
                     char** slot = (char**)(&dataTable[offset]);
                     if (!*slot || !** slot)
-                    {
-                        const char* st = getRecord(y).getString(x);
-                        *slot = stringPool + (st - (const char*)stringTable);
-                    }
+                        *slot = const_cast<char*>(getRecord(y).getString(x));
                     offset += sizeof(char*);
                     break;
                 }
@@ -311,5 +325,5 @@ char* DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
         }
     }
 
-    return stringPool;
+    return true;
 }
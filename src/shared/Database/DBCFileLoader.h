@@ -22,6 +22,11 @@
 #include "Utilities/ByteConverter.h"
 #include <cassert>
 
+namespace MaNGOS
+{
+    class MappedFile;
+}
+
 enum FieldFormat
 {
     FT_NA = 'x',                                            // ignore/ default, 4 byte size, in Source String means field is ignored, in Dest String means field is filled with default value
@@ -93,10 +98,18 @@ class DBCFileLoader
         uint32 GetCols() const { return fieldCount; }
         uint32 GetOffset(size_t id) const { return (fieldsOffset != nullptr && id < fieldCount) ? fieldsOffset[id] : 0; }
         bool IsLoaded() const { return data != nullptr; }
+        // true if the records of the file already have the layout of fmt, AutoProduceData then returns them in place
+        bool CanUseRecordsInPlace(const char* fmt) const;
         char* AutoProduceData(const char* fmt, uint32& count, char**& indexTable);
-        char* AutoProduceStrings(const char* fmt, char* dataTable);
+        // string fields of dataTable are pointed into the string table of the file
+        bool AutoProduceStrings(const char* fmt, char* dataTable);
+        // hands the file mapping over to the caller, which must keep it as long as produced data and strings are used
+        MaNGOS::MappedFile* ReleaseFile();
         static uint32 GetFormatRecordSize(const char* format, int32* index_pos = nullptr);
     private:
+        void Unload();
+
+        MaNGOS::MappedFile* file;
 
         uint32 recordSize;
         uint32 recordCount;
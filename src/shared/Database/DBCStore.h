@@ -20,13 +20,22 @@
 #define DBCSTORE_H
 
 #include "DBCFileLoader.h"
+#include "MappedFile.h"
 
+#include <list>
+
+/*
+  Records and strings are used from the mapped dbc files where possible: strings always point into
+  the string table of the file, and records whose format is only 4 byte values are used in place.
+  Other records are copied into m_dataTable. The mappings are copy-on-write and stay open as long
+  as the store is loaded, so untouched pages are shared between all processes using the same files.
+*/
 template<class T>
 class DBCStorage
 {
-        typedef std::list<char*> StringPoolList;
+        typedef std::list<MaNGOS::MappedFile*> MappedFileList;
     public:
-        explicit DBCStorage(const char* f) : nCount(0), fieldCount(0), fmt(f), indexTable(nullptr), m_dataTable(nullptr) { }
+        explicit DBCStorage(const char* f) : nCount(0), fieldCount(0), fmt(f), indexTable(nullptr), m_dataTable(nullptr), m_dataInPlace(false) { }
         ~DBCStorage() { Clear(); }
 
         T const* LookupEntry(uint32 id) const { return (id >= nCount) ? nullptr : indexTable[id]; }
@@ -44,13 +53,17 @@ class DBCStorage
             fieldCount = dbc.GetCols();
 
             // load raw non-string data
+            m_dataInPlace = dbc.CanUseRecordsInPlace(fmt);
             m_dataTable = (T*)dbc.AutoProduceData(fmt, nCount, (char**&)indexTable);
 
-            // load strings from dbc data
-            m_stringPoolList.push_back(dbc.AutoProduceStrings(fmt, (char*)m_dataTable));
-
             // error in dbc file at loading if nullptr
-            return indexTable != nullptr;
+            if (!indexTable)
+                return false;
+
+            // load strings from dbc data
+            dbc.AutoProduceStrings(fmt, (char*)m_dataTable);
+            m_fileList.push_back(dbc.ReleaseFile());
+            return true;
         }
 
         bool LoadStringsFrom(char const* fn)
@@ -65,8 +78,10 @@ class DBCStorage
                 return false;
 
             // load strings from another locale dbc data
-            m_stringPoolList.push_back(dbc.AutoProduceStrings(fmt, (char*)m_dataTable));
+            if (!dbc.AutoProduceStrings(fmt, (char*)m_dataTable))
+                return false;
 
+            m_fileList.push_back(dbc.ReleaseFile());
             return true;
         }
 
@@ -77,13 +92,15 @@ class DBCStorage
 
             delete[]((char*)indexTable);
             indexTable = nullptr;
-            delete[]((char*)m_dataTable);
+            if (!m_dataInPlace)
+                delete[]((char*)m_dataTable);
             m_dataTable = nullptr;
+            m_dataInPlace = false;
 
-            while (!m_stringPoolList.empty())
+            while (!m_fileList.empty())
             {
-                delete[] m_stringPoolList.front();
-                m_stringPoolList.pop_front();
+                delete m_fileList.front();
+                m_fileList.pop_front();
             }
             nCount = 0;
         }
@@ -97,7 +114,8 @@ class DBCStorage
         char const* fmt;
         T** indexTable;
         T* m_dataTable;
-        StringPoolList m_stringPoolList;
+        bool m_dataInPlace;                                 // m_dataTable points into the first mapped file
+        MappedFileList m_fileList;
 };
 
 #endif
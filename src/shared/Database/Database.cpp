@@ -44,6 +44,12 @@ void SqlConnection::FreePreparedStatements()
         delete m_holder[i];
 
     m_holder.clear();
+
+    for (BatchStmtHolder::iterator itr = m_batchHolder.begin(); itr != m_batchHolder.end(); ++itr)
+        for (size_t i = 0; i < itr->second.stmts.size(); ++i)
+            delete itr->second.stmts[i];
+
+    m_batchHolder.clear();
 }
 
 SqlPreparedStatement* SqlConnection::GetStmt(uint32 nIndex)
@@ -91,13 +97,160 @@ bool SqlConnection::ExecuteStmt(int nIndex, const SqlStmtParameters& id)
     return pStmt->execute();
 }
 
+// case insensitive compare of the keyword at pos
+static bool MatchKeyword(const std::string& fmt, size_t pos, const char* keyword)
+{
+    const size_t length = strlen(keyword);
+    if (fmt.length() < pos + length)
+        return false;
+
+    for (size_t i = 0; i < length; ++i)
+        if (toupper(fmt[pos + i]) != keyword[i])
+            return false;
+
+    return true;
+}
+
+SqlConnection::BatchStmts& SqlConnection::GetBatchStmts(int nIndex)
+{
+    BatchStmtHolder::iterator itr = m_batchHolder.find(nIndex);
+    if (itr != m_batchHolder.end())
+        return itr->second;
+
+    BatchStmts& batch = m_batchHolder[nIndex];
+
+    // split "INSERT INTO t (a, b) VALUES (?, ?) [tail]" around the tuple
+    std::string fmt = m_db.GetStmtString(nIndex);
+    size_t pos = fmt.find_first_not_of(" \t\r\n");
+    if (pos == std::string::npos || (!MatchKeyword(fmt, pos, "INSERT") && !MatchKeyword(fmt, pos, "REPLACE")))
+        return batch;
+
+    size_t valuesPos = std::string::npos;
+    for (size_t i = pos; i < fmt.length(); ++i)
+    {
+        if (MatchKeyword(fmt, i, "VALUES") && (i == 0 || !isalnum(fmt[i - 1])))
+        {
+            valuesPos = i;
+            break;
+        }
+    }
+
+    if (valuesPos == std::string::npos)
+        return batch;
+
+    const size_t tupleStart = fmt.find('(', valuesPos);
+    if (tupleStart == std::string::npos || fmt.find_first_not_of(" \t\r\n", valuesPos + 6) != tupleStart)
+        return batch;
+
+    int depth = 0;
+    bool quoted = false;
+    size_t tupleEnd = std::string::npos;
+    for (size_t i = tupleStart; i < fmt.length() && tupleEnd == std::string::npos; ++i)
+    {
+        if (fmt[i] == '\'')
+            quoted = !quoted;
+        else if (!quoted && fmt[i] == '(')
+            ++depth;
+        else if (!quoted && fmt[i] == ')' && --depth == 0)
+            tupleEnd = i;
+    }
+
+    if (tupleEnd == std::string::npos)
+        return batch;
+
+    batch.head = fmt.substr(0, tupleStart);
+    batch.tuple = fmt.substr(tupleStart, tupleEnd + 1 - tupleStart);
+    batch.tail = fmt.substr(tupleEnd + 1);
+
+    // all placeholders have to be repeated with the tuple
+    batch.batchable = batch.head.find('?') == std::string::npos && batch.tail.find('?') == std::string::npos;
+    return batch;
+}
+
+SqlPreparedStatement* SqlConnection::GetBatchStmt(BatchStmts& batch, uint32 shift)
+{
+    if (batch.stmts.size() <= shift)
+        batch.stmts.resize(shift + 1, nullptr);
+
+    if (!batch.stmts[shift])
+    {
+        std::string fmt = batch.head;
+        for (uint32 i = 0; i < (1u << shift); ++i)
+        {
+            if (i)
+                fmt += ", ";
+            fmt += batch.tuple;
+        }
+        fmt += batch.tail;
+
+        SqlPreparedStatement* pStmt = CreateStatement(fmt);
+        if (!pStmt->prepare())
+        {
+            delete pStmt;
+            return nullptr;
+        }
+
+        batch.stmts[shift] = pStmt;
+    }
+
+    return batch.stmts[shift];
+}
+
+bool SqlConnection::CanBatchStmt(int nIndex)
+{
+    return nIndex != -1 && m_db.GetMaxBatchRows() > 1 && GetBatchStmts(nIndex).batchable;
+}
+
+bool SqlConnection::ExecuteStmtBatch(int nIndex, SqlStmtParameters const* const* rows, uint32 count, uint32& roundTrips)
+{
+    BatchStmts& batch = GetBatchStmts(nIndex);
+    const uint32 maxRows = m_db.GetMaxBatchRows();
+
+    while (count)
+    {
+        // largest power of two not above the remaining rows, so few multi-row variants are prepared
+        uint32 shift = 0;
+        while ((2u << shift) <= count && (2u << shift) <= maxRows)
+            ++shift;
+
+        ++roundTrips;
+
+        const uint32 chunk = 1u << shift;
+        if (chunk == 1)
+        {
+            if (!ExecuteStmt(nIndex, **rows))
+                return false;
+        }
+        else
+        {
+            SqlPreparedStatement* pStmt = GetBatchStmt(batch, shift);
+            if (!pStmt)
+                return false;
+
+            SqlStmtParameters params(chunk * rows[0]->boundParams());
+            for (uint32 i = 0; i < chunk; ++i)
+                for (auto const& param : rows[i]->params())
+                    params.addParam(param);
+
+            pStmt->bind(params);
+            if (!pStmt->execute())
+                return false;
+        }
+
+        rows += chunk;
+        count -= chunk;
+    }
+
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 Database::~Database()
 {
     StopServer();
 }
 
-bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char* infoString, int nConns /*= 1*/, int nAsyncConns /*= 1*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -111,6 +264,9 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
 
     m_pingIntervallms = sConfig.GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000);
 
+    // consecutive inserts of a transaction are sent as multi-row statements of up to this many rows
+    m_maxBatchRows = std::max(1, std::min(sConfig.GetIntDefault("DatabaseBatchRows", 32), 256));
+
     // create DB connections
 
     // setup connection pool size
@@ -134,10 +290,20 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
         m_pQueryConnections.push_back(pConn);
     }
 
-    // create and initialize connection for async requests
-    m_pAsyncConn = CreateConnection();
-    if (!m_pAsyncConn->Initialize(infoString))
-        return false;
+    // create and initialize connections for async requests
+    nAsyncConns = std::max(MIN_CONNECTION_POOL_SIZE, std::min(nAsyncConns, MAX_CONNECTION_POOL_SIZE));
+    for (int i = 0; i < nAsyncConns; ++i)
+    {
+        SqlConnection* pConn = CreateConnection();
+        if (!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_pAsyncConnections.push_back(pConn);
+    }
+    m_pAsyncConn = m_pAsyncConnections[0];
 
     m_pResultQueue = new SqlResultQueue;
 
@@ -150,10 +316,12 @@ void Database::StopServer()
     HaltDelayThread();
 
     delete m_pResultQueue;
-    delete m_pAsyncConn;
+    for (size_t i = 0; i < m_pAsyncConnections.size(); ++i)
+        delete m_pAsyncConnections[i];
 
     m_pResultQueue = nullptr;
     m_pAsyncConn = nullptr;
+    m_pAsyncConnections.clear();
 
     for (size_t i = 0; i < m_pQueryConnections.size(); ++i)
         delete m_pQueryConnections[i];
@@ -161,30 +329,80 @@ void Database::StopServer()
     m_pQueryConnections.clear();
 }
 
-SqlDelayThread* Database::CreateDelayThread()
+SqlDelayThread* Database::CreateDelayThread(SqlConnection* conn, bool pingDatabase)
 {
-    assert(m_pAsyncConn);
-    return new SqlDelayThread(this, m_pAsyncConn);
+    assert(conn);
+    return new SqlDelayThread(this, conn, pingDatabase);
 }
 
 void Database::InitDelayThread()
 {
-    assert(!m_delayThread);
+    assert(m_delayThreads.empty());
 
-    // New delay thread for delay execute
-    m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
-    m_delayThread = new MaNGOS::Thread(m_threadBody);
+    // New delay thread for delay execute, one per async connection
+    for (size_t i = 0; i < m_pAsyncConnections.size(); ++i)
+    {
+        m_threadBodies.push_back(CreateDelayThread(m_pAsyncConnections[i], i == 0));  // will deleted at thread delete
+        m_delayThreads.push_back(new MaNGOS::Thread(m_threadBodies.back()));
+    }
 }
 
 void Database::HaltDelayThread()
 {
-    if (!m_threadBody || !m_delayThread) return;
+    if (m_delayThreads.empty()) return;
+
+    for (size_t i = 0; i < m_threadBodies.size(); ++i)
+        m_threadBodies[i]->Stop();                          // Stop event
+    for (size_t i = 0; i < m_delayThreads.size(); ++i)
+        m_delayThreads[i]->wait();                          // Wait for flush to DB
+
+    // requests queued during the stop, barriers need all delay queues to be processed side by side
+    bool processed = true;
+    while (processed)
+    {
+        processed = false;
+        for (size_t i = 0; i < m_threadBodies.size(); ++i)
+            processed |= m_threadBodies[i]->ProcessPendingRequests();
+    }
+
+    for (size_t i = 0; i < m_delayThreads.size(); ++i)
+        delete m_delayThreads[i];                           // This also deletes the thread body
+
+    m_delayThreads.clear();
+    m_threadBodies.clear();
+    m_openBarrier.reset();
+}
+
+bool Database::DelayOperation(SqlOperation* sql, uint32 orderKey)
+{
+    if (m_threadBodies.empty())
+    {
+        delete sql;
+        return false;
+    }
+
+    // a single delay thread keeps everything in order anyway
+    if (m_threadBodies.size() == 1)
+        return m_threadBodies[0]->Delay(sql);
+
+    std::lock_guard<std::mutex> guard(m_barrierLock);
+
+    if (orderKey)
+    {
+        m_openBarrier.reset();
+        return m_threadBodies[orderKey % m_threadBodies.size()]->Delay(sql);
+    }
+
+    // consecutive unkeyed requests share one barrier as long as it has not started
+    if (m_openBarrier && m_openBarrier->Add(sql))
+        return true;
 
-    m_threadBody->Stop();                                   // Stop event
-    m_delayThread->wait();                                  // Wait for flush to DB
-    delete m_delayThread;                                   // This also deletes m_threadBody
-    m_delayThread = nullptr;
-    m_threadBody = nullptr;
+    m_openBarrier = std::make_shared<SqlBarrier>(m_threadBodies.size());
+    m_openBarrier->Add(sql);
+    for (size_t i = 0; i < m_threadBodies.size(); ++i)
+        m_threadBodies[i]->Delay(new SqlBarrierEntry(m_openBarrier, i == 0));
+
+    return true;
 }
 
 void Database::ThreadStart()
@@ -229,8 +447,9 @@ void Database::Ping()
 {
     const char* sql = "SELECT 1";
 
+    for (size_t i = 0; i < m_pAsyncConnections.size(); ++i)
     {
-        SqlConnection::Lock guard(m_pAsyncConn);
+        SqlConnection::Lock guard(m_pAsyncConnections[i]);
         delete guard->Query(sql);
     }
 
@@ -341,7 +560,7 @@ bool Database::Execute(const char* sql)
             return DirectExecute(sql);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPlainRequest(sql));
+        DelayOperation(new SqlPlainRequest(sql));
     }
 
     return true;
@@ -387,7 +606,7 @@ bool Database::DirectPExecute(const char* format, ...)
     return DirectExecute(szQuery);
 }
 
-bool Database::BeginTransaction()
+bool Database::BeginTransaction(uint32 orderKey, SqlTransactionStatistics* statistics)
 {
     if (!m_pAsyncConn)
         return false;
@@ -395,7 +614,7 @@ bool Database::BeginTransaction()
     MANGOS_ASSERT(!m_currentTransaction.get());   // if we will get a nested transaction request - we MUST fix code!!!
 
     if (!m_currentTransaction.get())
-        m_currentTransaction.reset(new SqlTransaction);
+        m_currentTransaction.reset(new SqlTransaction(orderKey, statistics));
 
     return !!m_currentTransaction.get();
 }
@@ -410,8 +629,8 @@ bool Database::CommitTransaction()
         return CommitTransactionDirect();
 
     // add SqlTransaction to the async queue
-    m_threadBody->Delay(m_currentTransaction.release());
-    return true;
+    SqlTransaction* pTrans = m_currentTransaction.release();
+    return DelayOperation(pTrans, pTrans->GetOrderKey());
 }
 
 bool Database::CommitTransactionDirect()
@@ -565,7 +784,7 @@ bool Database::ExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params)
             return DirectExecuteStmt(id, params);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPreparedRequest(id.ID(), params));
+        DelayOperation(new SqlPreparedRequest(id.ID(), params));
     }
 
     return true;
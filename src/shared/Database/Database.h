@@ -27,6 +27,8 @@
 
 #include <boost/thread/tss.hpp>
 #include <atomic>
+#include <memory>
+#include <mutex>
 
 class SqlTransaction;
 class SqlResultQueue;
@@ -64,6 +66,11 @@ class SqlConnection
         // methods to work with prepared statements
         bool ExecuteStmt(int nIndex, const SqlStmtParameters& id);
 
+        // true for INSERT and REPLACE statements with a single VALUES tuple, which can take several rows at once
+        bool CanBatchStmt(int nIndex);
+        // executes the rows of a batchable statement with multi-row statements, counts the statements sent
+        bool ExecuteStmtBatch(int nIndex, SqlStmtParameters const* const* rows, uint32 count, uint32& roundTrips);
+
         // SqlConnection object lock
         class Lock
         {
@@ -97,6 +104,24 @@ class SqlConnection
 
         typedef std::vector<SqlPreparedStatement* > StmtHolder;
         StmtHolder m_holder;
+
+        // multi-row variants of a statement, for 2, 4, 8, ... rows
+        struct BatchStmts
+        {
+            BatchStmts() : batchable(false) {}
+
+            bool batchable;
+            std::string head;                               // everything up to the VALUES tuple
+            std::string tuple;                              // the parenthesized tuple with the placeholders
+            std::string tail;                               // everything after it, without placeholders
+            std::vector<SqlPreparedStatement*> stmts;       // indexed by log2 of the row count
+        };
+
+        typedef std::unordered_map<int, BatchStmts> BatchStmtHolder;
+        BatchStmtHolder m_batchHolder;
+
+        BatchStmts& GetBatchStmts(int nIndex);
+        SqlPreparedStatement* GetBatchStmt(BatchStmts& batch, uint32 shift);
 };
 
 class Database
@@ -104,10 +129,11 @@ class Database
     public:
         virtual ~Database();
 
-        virtual bool Initialize(const char* infoString, int nConns = 1);
-        // start worker thread for async DB request execution
+        // nConns connections for sync queries, nAsyncConns connections each with its own delay thread for async requests
+        virtual bool Initialize(const char* infoString, int nConns = 1, int nAsyncConns = 1);
+        // start worker threads for async DB request execution
         virtual void InitDelayThread();
-        // stop worker thread
+        // stop worker threads, requests queued so far are executed first
         virtual void HaltDelayThread();
 
         /// Synchronous DB queries
@@ -183,7 +209,13 @@ class Database
         // Writes SQL commands to a LOG file (see mangosd.conf "LogSQL")
         bool PExecuteLog(const char* format, ...) ATTR_PRINTF(2, 3);
 
-        bool BeginTransaction();
+        // Async requests are spread over the delay threads by order key. Requests with the same key are executed
+        // in queue order, requests with different keys may run in parallel. Requests without key (0) are ordered
+        // against everything: they wait for all requests queued before them and all later requests wait for them.
+        // Only give a key to work which does not touch rows other keyed work can touch, e.g. the guid of a character
+        // for the save of its own data.
+        // The statistics of the transaction are also added to the given ones, if any.
+        bool BeginTransaction(uint32 orderKey = 0, SqlTransactionStatistics* statistics = nullptr);
         bool CommitTransaction();
         bool RollbackTransaction();
         // for sync transaction execution
@@ -201,6 +233,11 @@ class Database
         // escape string generation
         void escape_string(std::string& str);
 
+        // most rows put into one multi-row statement when executing transactions
+        uint32 GetMaxBatchRows() const { return m_maxBatchRows; }
+        SqlTransactionStatistics const& GetTransactionStatistics() const { return m_transactionStatistics; }
+        SqlTransactionStatistics& GetTransactionStatistics() { return m_transactionStatistics; }
+
         // must be called before first query in thread (one time for thread using one from existing Database objects)
         virtual void ThreadStart();
         // must be called before finish thread run (one time for thread using one from existing Database objects)
@@ -223,8 +260,8 @@ class Database
     protected:
         Database() :
             m_nQueryConnPoolSize(1), m_pAsyncConn(nullptr), m_pResultQueue(nullptr),
-            m_threadBody(nullptr), m_delayThread(nullptr), m_bAllowAsyncTransactions(false),
-            m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
+            m_bAllowAsyncTransactions(false),
+            m_iStmtIndex(-1), m_maxBatchRows(1), m_logSQL(false), m_pingIntervallms(0)
         {
             m_nQueryCounter = -1;
         }
@@ -234,7 +271,11 @@ class Database
         // factory method to create SqlConnection objects
         virtual SqlConnection* CreateConnection() = 0;
         // factory method to create SqlDelayThread objects
-        virtual SqlDelayThread* CreateDelayThread();
+        virtual SqlDelayThread* CreateDelayThread(SqlConnection* conn, bool pingDatabase);
+
+        friend class SqlQueryHolder;
+        // queue an async request on the delay thread of the order key, or as barrier on all of them without key
+        bool DelayOperation(SqlOperation* sql, uint32 orderKey = 0);
 
         // per-thread based storage for SqlTransaction object initialization - no locking is required
         boost::thread_specific_ptr<SqlTransaction> m_currentTransaction;
@@ -243,7 +284,7 @@ class Database
 
         // round-robin connection selection
         SqlConnection* getQueryConnection();
-        // for now return one single connection for async requests
+        // connection of the first delay thread, used for synchronous transactions
         SqlConnection* getAsyncConnection() const { return m_pAsyncConn; }
 
         friend class SqlStatement;
@@ -260,12 +301,16 @@ class Database
         typedef std::vector< SqlConnection* > SqlConnectionContainer;
         SqlConnectionContainer m_pQueryConnections;
 
-        // only one single DB connection for transactions
+        // one connection per delay thread, the first one also serves direct transactions
+        SqlConnectionContainer m_pAsyncConnections;
         SqlConnection* m_pAsyncConn;
 
         SqlResultQueue*     m_pResultQueue;                 ///< Transaction queues from diff. threads
-        SqlDelayThread*     m_threadBody;                   ///< Pointer to delay sql executer (owned by m_delayThread)
-        MaNGOS::Thread*     m_delayThread;                  ///< Pointer to executer thread
+        std::vector<SqlDelayThread*> m_threadBodies;        ///< Delay sql executers (owned by m_delayThreads)
+        std::vector<MaNGOS::Thread*> m_delayThreads;        ///< Executer threads
+
+        std::mutex m_barrierLock;                           ///< Guards m_openBarrier and the order of barrier entries in the delay queues
+        std::shared_ptr<SqlBarrier> m_openBarrier;          ///< Last queued barrier, unkeyed requests join it until a keyed one is queued
 
         bool m_bAllowAsyncTransactions;                     ///< flag which specifies if async transactions are enabled
 
@@ -280,6 +325,9 @@ class Database
 
         int m_iStmtIndex;
 
+        uint32 m_maxBatchRows;
+        SqlTransactionStatistics m_transactionStatistics;
+
     private:
 
         bool m_logSQL;
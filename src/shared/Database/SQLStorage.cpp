@@ -17,6 +17,7 @@
  */
 
 #include "SQLStorage.h"
+#include "MappedFile.h"
 
 // -----------------------------------  SQLStorageBase  ---------------------------------------- //
 
@@ -30,7 +31,8 @@ SQLStorageBase::SQLStorageBase() :
     m_recordCount(0),
     m_maxEntry(0),
     m_recordSize(0),
-    m_data(nullptr)
+    m_data(nullptr),
+    m_snapshotFile(nullptr)
 {}
 
 void SQLStorageBase::Initialize(const char* tableName, const char* entry_field, const char* src_format, const char* dst_format)
@@ -65,12 +67,39 @@ void SQLStorageBase::prepareToLoad(uint32 maxEntry, uint32 recordCount, uint32 r
     m_recordCount = 0;
 }
 
+void SQLStorageBase::ReleaseFieldValue(char const* value)
+{
+    if (!m_snapshotFile)
+        delete[] value;
+}
+
+void SQLStorageBase::AdoptFieldValue(char* value)
+{
+    // records loaded from the database free all their string fields, whatever they point to by now
+    if (m_snapshotFile && value)
+        m_adoptedValues.push_back(value);
+}
+
 // Function to delete the data
 void SQLStorageBase::Free()
 {
     if (!m_data)
         return;
 
+    // records and strings are part of the mapping
+    if (m_snapshotFile)
+    {
+        for (std::vector<char*>::const_iterator itr = m_adoptedValues.begin(); itr != m_adoptedValues.end(); ++itr)
+            delete[] *itr;
+        m_adoptedValues.clear();
+
+        delete m_snapshotFile;
+        m_snapshotFile = nullptr;
+        m_data = nullptr;
+        m_recordCount = 0;
+        return;
+    }
+
     uint32 offset = 0;
     for (uint32 x = 0; x < m_dstFieldCount; ++x)
     {
@@ -22,10 +22,19 @@
 #include "Common.h"
 #include "Database/DatabaseEnv.h"
 #include "DBCFileLoader.h"
+#include "SQLStorageSnapshot.h"
+
+#include <vector>
+
+namespace MaNGOS
+{
+    class MappedFile;
+}
 
 class SQLStorageBase
 {
         template<class DerivedLoader, class StorageClass> friend class SQLStorageLoaderBase;
+        friend class SQLStorageSnapshot;
 
     public:
         char const* GetTableName() const { return m_tableName; }
@@ -39,6 +48,11 @@ class SQLStorageBase
         uint32 GetMaxEntry() const { return m_maxEntry; };
         uint32 GetRecordCount() const { return m_recordCount; };
 
+        // for fixers replacing a string field of a loaded record by data of their own, allocated with new[]:
+        // the old value is freed unless it belongs to a snapshot, the new one is freed together with the records
+        void ReleaseFieldValue(char const* value);
+        void AdoptFieldValue(char* value);
+
         template<typename T>
         class SQLSIterator
         {
@@ -96,6 +110,8 @@ class SQLStorageBase
 
         // Data Storage
         char* m_data;
+        MaNGOS::MappedFile* m_snapshotFile;                 // set if m_data and the strings belong to a mapped snapshot
+        std::vector<char*> m_adoptedValues;                 // field values replaced in snapshot records, the mapping does not free them
 };
 
 class SQLStorage : public SQLStorageBase
@@ -269,6 +285,9 @@ class SQLStorageLoaderBase
         void convert_from_str(uint32 field_pos, char* src, D& dst);
         void convert_str_to_str(uint32 field_pos, char* src, char*& dst);
 
+        // hash of everything besides the table the converted values depend on, snapshots are only used for the same context
+        uint32 GetSnapshotContext() const { return 0; }
+
     private:
         template<class V>
         void storeValue(V value, StorageClass& store, char* record, uint32 field_pos, uint32& offset);
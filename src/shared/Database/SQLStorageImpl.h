@@ -189,6 +189,12 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeValue(char const* v
 template<class DerivedLoader, class StorageClass>
 void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store, bool error_at_empty /*= true*/)
 {
+    DerivedLoader* subclass = (static_cast<DerivedLoader*>(this));
+    uint32 snapshotContext = subclass->GetSnapshotContext();
+    uint64 tableChecksum = SQLStorageSnapshot::GetTableChecksum(store.GetTableName());
+    if (tableChecksum && SQLStorageSnapshot::Load(store, tableChecksum, snapshotContext))
+        return;
+
     Field* fields = nullptr;
     QueryResult* result  = WorldDatabase.PQuery("SELECT MAX(%s) FROM %s", store.EntryFieldName(), store.GetTableName());
     if (!result)
@@ -272,12 +278,20 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
     // Prepare data storage and lookup storage
     store.prepareToLoad(maxRecordId, recordCount, recordsize);
 
+    // keys of the records in load order for the snapshot
+    std::vector<uint32> keys;
+    if (tableChecksum)
+        keys.reserve(recordCount);
+
     BarGoLink bar(recordCount);
     do
     {
         fields = result->Fetch();
         bar.step();
 
+        if (tableChecksum)
+            keys.push_back(fields[0].GetUInt32());
+
         char* record = store.createRecord(fields[0].GetUInt32());
         offset = 0;
 
@@ -329,6 +343,9 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
     while (result->NextRow());
 
     delete result;
+
+    if (tableChecksum)
+        SQLStorageSnapshot::Save(store, keys, tableChecksum, snapshotContext);
 }
 
 #endif
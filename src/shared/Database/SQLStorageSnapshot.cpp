@@ -0,0 +1,548 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "SQLStorageSnapshot.h"
+#include "SQLStorage.h"
+#include "QueryResult.h"
+#include "MappedFile.h"
+#include "Log.h"
+#include "revision_sql.h"
+
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#define SNAPSHOT_MAGIC          0x5153534D                  // "MSSQ" read as little endian, differs for other byte orders
+#define RESULT_SNAPSHOT_MAGIC   0x5253534D                  // "MSSR"
+#define SNAPSHOT_VERSION        1                           // increase at any change of the file layout
+#define SNAPSHOT_NULL_STRING    size_t(-1)
+#define RESULT_SNAPSHOT_NULL    uint32(-1)
+#define SNAPSHOT_HASH_BASIS     14695981039346656037ull
+
+namespace
+{
+    // file layout: header, keys (padded to 8 bytes), records, strings
+    struct SnapshotHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint32 pointerSize;
+        uint32 formatHash;                                  // destination format and database revision
+        uint32 context;
+        uint32 recordSize;
+        uint32 recordCount;
+        uint32 maxEntry;
+        uint64 tableChecksum;
+        uint64 stringsSize;
+        uint64 dataHash;                                    // everything behind the header
+    };
+
+    // result file layout: header, field types (padded to 8 bytes), value offsets (row by row), strings
+    struct ResultSnapshotHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint32 queryHash;                                   // query and database revision
+        uint32 fieldCount;
+        uint64 rowCount;
+        uint64 tableChecksum;
+        uint64 stringsSize;
+        uint64 dataHash;                                    // everything behind the header
+    };
+
+    // FNV-1a
+    uint64 HashData(uint64 hash, void const* data, size_t size)
+    {
+        uint8 const* bytes = static_cast<uint8 const*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    uint32 GetFormatHash(char const* format)
+    {
+        uint64 hash = SNAPSHOT_HASH_BASIS;
+        hash = HashData(hash, format, strlen(format) + 1);
+        hash = HashData(hash, REVISION_DB_MANGOS, sizeof(REVISION_DB_MANGOS));
+        return uint32(hash ^ (hash >> 32));
+    }
+
+    size_t GetKeysSize(uint32 recordCount)
+    {
+        return (recordCount * sizeof(uint32) + 7) & ~size_t(7);
+    }
+
+    size_t GetFieldTypesSize(uint32 fieldCount)
+    {
+        return (fieldCount + 7) & ~size_t(7);
+    }
+
+    // written to a temporary file first, so a crash while writing never leaves a half written snapshot behind
+    void WriteSnapshotFile(std::string const& fileName, std::vector<std::pair<void const*, size_t>> const& parts)
+    {
+        std::string tempFileName = fileName + ".tmp";
+
+        FILE* file = fopen(tempFileName.c_str(), "wb");
+        if (!file)
+        {
+            sLog.outError("Can't create snapshot file %s", tempFileName.c_str());
+            return;
+        }
+
+        bool written = true;
+        for (std::vector<std::pair<void const*, size_t>>::const_iterator itr = parts.begin(); itr != parts.end() && written; ++itr)
+            written = !itr->second || fwrite(itr->first, itr->second, 1, file) == 1;
+        written = fclose(file) == 0 && written;
+
+        remove(fileName.c_str());                           // rename does not replace existing files everywhere
+        if (!written || rename(tempFileName.c_str(), fileName.c_str()) != 0)
+        {
+            sLog.outError("Can't write snapshot file %s", fileName.c_str());
+            remove(tempFileName.c_str());
+        }
+    }
+
+    // plays back the rows of a result snapshot, the field values point right into the snapshot data
+    class SnapshotQueryResult : public QueryResult
+    {
+        public:
+            // the data is either mapped by file or held by image
+            SnapshotQueryResult(MaNGOS::MappedFile* file, std::vector<uint8>& image) : QueryResult(0, 0), m_file(file), m_nextRow(0)
+            {
+                m_image.swap(image);
+                uint8 const* data = m_file ? m_file->GetData() : m_image.data();
+
+                ResultSnapshotHeader header;
+                memcpy(&header, data, sizeof(ResultSnapshotHeader));
+                mRowCount = header.rowCount;
+                mFieldCount = header.fieldCount;
+
+                uint8 const* types = data + sizeof(ResultSnapshotHeader);
+                m_offsets = reinterpret_cast<uint32 const*>(types + GetFieldTypesSize(mFieldCount));
+                m_strings = reinterpret_cast<char const*>(m_offsets + mRowCount * mFieldCount);
+
+                mCurrentRow = new Field[mFieldCount];
+                for (uint32 i = 0; i < mFieldCount; ++i)
+                    mCurrentRow[i].SetType(Field::DataTypes(types[i]));
+
+                NextRow();
+            }
+
+            ~SnapshotQueryResult()
+            {
+                delete[] mCurrentRow;
+                delete m_file;
+            }
+
+            bool NextRow() override
+            {
+                if (m_nextRow >= mRowCount)
+                    return false;
+
+                uint32 const* offsets = m_offsets + m_nextRow * mFieldCount;
+                for (uint32 i = 0; i < mFieldCount; ++i)
+                    mCurrentRow[i].SetValue(offsets[i] == RESULT_SNAPSHOT_NULL ? nullptr : m_strings + offsets[i]);
+
+                ++m_nextRow;
+                return true;
+            }
+
+        private:
+            MaNGOS::MappedFile* m_file;
+            std::vector<uint8> m_image;
+            uint32 const* m_offsets;
+            char const* m_strings;
+            uint64 m_nextRow;
+    };
+
+    // fills the offsets of the pointer fields of a record in format and returns the record size
+    uint32 GetPointerFieldOffsets(char const* format, std::vector<uint32>& offsets)
+    {
+        uint32 offset = 0;
+        for (char const* itr = format; *itr; ++itr)
+        {
+            switch (*itr)
+            {
+                case FT_LOGIC:
+                    offset += sizeof(bool);   break;
+                case FT_BYTE:
+                case FT_NA_BYTE:
+                    offset += sizeof(char);   break;
+                case FT_INT:
+                case FT_NA:
+                    offset += sizeof(uint32); break;
+                case FT_FLOAT:
+                case FT_NA_FLOAT:
+                    offset += sizeof(float);  break;
+                case FT_STRING:
+                case FT_NA_POINTER:
+                    offsets.push_back(offset);
+                    offset += sizeof(char*);  break;
+                case FT_64BITINT:
+                    offset += sizeof(uint64); break;
+                default:
+                    assert(false && "unknown format character");
+                    break;
+            }
+        }
+        return offset;
+    }
+}
+
+std::string SQLStorageSnapshot::m_directory;
+
+void SQLStorageSnapshot::SetDirectory(std::string const& directory)
+{
+    m_directory = directory;
+
+    // normalize dir path to path/ or path\ form
+    if (!m_directory.empty() && m_directory.at(m_directory.length() - 1) != '/' && m_directory.at(m_directory.length() - 1) != '\\')
+        m_directory.append("/");
+}
+
+std::string SQLStorageSnapshot::GetFileName(char const* tableName)
+{
+    return m_directory + tableName + ".snapshot";
+}
+
+uint64 SQLStorageSnapshot::GetTableChecksum(char const* tableNames)
+{
+#ifdef DO_POSTGRESQL
+    return 0;
+#else
+    if (!IsEnabled())
+        return 0;
+
+    QueryResult* result = WorldDatabase.PQuery("CHECKSUM TABLE %s", tableNames);
+    if (!result)
+        return 0;
+
+    // one row per table, a missing table has no checksum
+    uint64 checksum = SNAPSHOT_HASH_BASIS;
+    do
+    {
+        uint64 tableChecksum = (*result)[1].GetUInt64();
+        if (!tableChecksum)
+        {
+            checksum = 0;
+            break;
+        }
+        checksum = HashData(checksum, &tableChecksum, sizeof(tableChecksum));
+    }
+    while (result->NextRow());
+
+    delete result;
+    return checksum;
+#endif
+}
+
+QueryResult* SQLStorageSnapshot::Query(char const* name, char const* tableNames, char const* sql)
+{
+    uint64 tableChecksum = GetTableChecksum(tableNames);
+    if (!tableChecksum)
+        return WorldDatabase.Query(sql);
+
+    std::string fileName = m_directory + name + ".result.snapshot";
+    uint32 queryHash = GetFormatHash(sql);
+
+    MaNGOS::MappedFile* file = new MaNGOS::MappedFile;
+    if (file->Open(fileName.c_str()))
+    {
+        ResultSnapshotHeader header;
+        char const* reason = nullptr;
+        if (file->GetSize() < sizeof(ResultSnapshotHeader))
+            reason = "file too small";
+        else
+        {
+            memcpy(&header, file->GetData(), sizeof(ResultSnapshotHeader));
+
+            uint64 valueCount = header.rowCount * header.fieldCount;
+            if (header.magic != RESULT_SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION)
+                reason = "written by another build";
+            else if (header.queryHash != queryHash)
+                reason = "query or database revision changed";
+            else if (header.tableChecksum != tableChecksum)
+                reason = "tables changed";
+            else if (file->GetSize() != sizeof(ResultSnapshotHeader) + GetFieldTypesSize(header.fieldCount) + valueCount * sizeof(uint32) + header.stringsSize)
+                reason = "wrong file size";
+            else if (header.dataHash != HashData(SNAPSHOT_HASH_BASIS, file->GetData() + sizeof(ResultSnapshotHeader), file->GetSize() - sizeof(ResultSnapshotHeader)))
+                reason = "checksum mismatch";
+            else if (header.stringsSize && file->GetData()[file->GetSize() - 1] != 0)
+                reason = "unterminated string";
+            else
+            {
+                uint8 const* offsets = file->GetData() + sizeof(ResultSnapshotHeader) + GetFieldTypesSize(header.fieldCount);
+                for (uint64 i = 0; i < valueCount; ++i)
+                {
+                    uint32 offset;
+                    memcpy(&offset, offsets + i * sizeof(uint32), sizeof(uint32));
+                    if (offset != RESULT_SNAPSHOT_NULL && offset >= header.stringsSize)
+                    {
+                        reason = "string outside of the file";
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (!reason)
+        {
+            sLog.outString("Loaded " UI64FMTD " rows of %s from snapshot", header.rowCount, name);
+
+            // an empty result is no result, as for the database
+            if (!header.rowCount)
+            {
+                delete file;
+                return nullptr;
+            }
+
+            std::vector<uint8> noImage;
+            return new SnapshotQueryResult(file, noImage);
+        }
+
+        DETAIL_LOG("Snapshot %s not used: %s", fileName.c_str(), reason);
+    }
+    delete file;
+
+    QueryResult* result = WorldDatabase.Query(sql);
+    if (!result)
+        return nullptr;
+
+    uint32 fieldCount = result->GetFieldCount();
+    uint64 rowCount = 0;
+
+    std::vector<uint8> types(GetFieldTypesSize(fieldCount), 0);
+    for (uint32 i = 0; i < fieldCount; ++i)
+        types[i] = uint8(result->Fetch()[i].GetType());
+
+    // values are stored once each, the rows get their offsets
+    std::vector<uint32> offsets;
+    offsets.reserve(result->GetRowCount() * fieldCount);
+    std::string strings;
+    std::unordered_map<std::string, uint32> stringOffsets;
+    do
+    {
+        Field* fields = result->Fetch();
+        for (uint32 i = 0; i < fieldCount; ++i)
+        {
+            char const* value = fields[i].GetString();
+            uint32 offset = RESULT_SNAPSHOT_NULL;
+            if (value)
+            {
+                std::pair<std::unordered_map<std::string, uint32>::iterator, bool> inserted = stringOffsets.insert(std::make_pair(std::string(value), uint32(strings.size())));
+                if (inserted.second)
+                    strings.append(value, strlen(value) + 1);
+                offset = inserted.first->second;
+            }
+            offsets.push_back(offset);
+        }
+        ++rowCount;
+    }
+    while (result->NextRow());
+
+    delete result;
+
+    if (strings.size() >= RESULT_SNAPSHOT_NULL)
+    {
+        sLog.outError("Result of %s too large for a snapshot", name);
+        return WorldDatabase.Query(sql);
+    }
+
+    ResultSnapshotHeader header;
+    header.magic = RESULT_SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.queryHash = queryHash;
+    header.fieldCount = fieldCount;
+    header.rowCount = rowCount;
+    header.tableChecksum = tableChecksum;
+    header.stringsSize = strings.size();
+
+    // the result is played back from the image just written, the database result is already consumed
+    std::vector<uint8> image(sizeof(ResultSnapshotHeader) + types.size() + offsets.size() * sizeof(uint32) + strings.size());
+    uint8* data = image.data() + sizeof(ResultSnapshotHeader);
+    memcpy(data, types.data(), types.size());
+    data += types.size();
+    if (!offsets.empty())
+        memcpy(data, offsets.data(), offsets.size() * sizeof(uint32));
+    data += offsets.size() * sizeof(uint32);
+    if (!strings.empty())
+        memcpy(data, strings.data(), strings.size());
+
+    header.dataHash = HashData(SNAPSHOT_HASH_BASIS, image.data() + sizeof(ResultSnapshotHeader), image.size() - sizeof(ResultSnapshotHeader));
+    memcpy(image.data(), &header, sizeof(ResultSnapshotHeader));
+
+    std::vector<std::pair<void const*, size_t>> parts;
+    parts.push_back(std::make_pair(static_cast<void const*>(image.data()), image.size()));
+    WriteSnapshotFile(fileName, parts);
+
+    return new SnapshotQueryResult(nullptr, image);
+}
+
+bool SQLStorageSnapshot::Load(SQLStorageBase& storage, uint64 tableChecksum, uint32 context)
+{
+    std::string fileName = GetFileName(storage.GetTableName());
+
+    MaNGOS::MappedFile* file = new MaNGOS::MappedFile;
+    if (!file->Open(fileName.c_str(), true))
+    {
+        delete file;
+        return false;
+    }
+
+    std::vector<uint32> pointerOffsets;
+    uint32 recordSize = GetPointerFieldOffsets(storage.GetDstFormat(), pointerOffsets);
+
+    SnapshotHeader header;
+    char const* reason = nullptr;
+    if (file->GetSize() < sizeof(SnapshotHeader))
+        reason = "file too small";
+    else
+    {
+        memcpy(&header, file->GetData(), sizeof(SnapshotHeader));
+
+        if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || header.pointerSize != sizeof(char*))
+            reason = "written by another build";
+        else if (header.formatHash != GetFormatHash(storage.GetDstFormat()) || header.recordSize != recordSize)
+            reason = "record format or database revision changed";
+        else if (header.tableChecksum != tableChecksum)
+            reason = "table changed";
+        else if (header.context != context)
+            reason = "loader context changed";
+        else if (file->GetSize() != sizeof(SnapshotHeader) + GetKeysSize(header.recordCount) + uint64(header.recordCount) * recordSize + header.stringsSize)
+            reason = "wrong file size";
+        else if (header.dataHash != HashData(SNAPSHOT_HASH_BASIS, file->GetData() + sizeof(SnapshotHeader), file->GetSize() - sizeof(SnapshotHeader)))
+            reason = "checksum mismatch";
+        else if (header.stringsSize && file->GetData()[file->GetSize() - 1] != 0)
+            reason = "unterminated string";
+    }
+
+    uint8* keys = nullptr;
+    uint8* records = nullptr;
+    if (!reason)
+    {
+        keys = file->GetWritableData() + sizeof(SnapshotHeader);
+        records = keys + GetKeysSize(header.recordCount);
+        char* strings = reinterpret_cast<char*>(records + uint64(header.recordCount) * recordSize);
+
+        // turn the string offsets back into pointers into the mapping
+        for (uint32 i = 0; i < header.recordCount && !reason; ++i)
+        {
+            for (std::vector<uint32>::const_iterator itr = pointerOffsets.begin(); itr != pointerOffsets.end(); ++itr)
+            {
+                uint8* field = records + uint64(i) * recordSize + *itr;
+
+                size_t stringOffset;
+                memcpy(&stringOffset, field, sizeof(size_t));
+                if (stringOffset != SNAPSHOT_NULL_STRING && stringOffset >= header.stringsSize)
+                {
+                    reason = "string outside of the file";
+                    break;
+                }
+
+                char* value = stringOffset == SNAPSHOT_NULL_STRING ? nullptr : strings + stringOffset;
+                memcpy(field, &value, sizeof(char*));
+            }
+        }
+    }
+
+    if (reason)
+    {
+        DETAIL_LOG("Snapshot %s not used: %s", fileName.c_str(), reason);
+        delete file;
+        return false;
+    }
+
+    storage.prepareToLoad(header.maxEntry, 0, recordSize);
+    delete[] storage.m_data;
+    storage.m_data = reinterpret_cast<char*>(records);
+    storage.m_snapshotFile = file;
+
+    for (uint32 i = 0; i < header.recordCount; ++i)
+    {
+        uint32 key;
+        memcpy(&key, keys + i * sizeof(uint32), sizeof(uint32));
+        storage.createRecord(key);
+    }
+
+    sLog.outString("Loaded %u records of `%s` from snapshot", header.recordCount, storage.GetTableName());
+    return true;
+}
+
+void SQLStorageSnapshot::Save(SQLStorageBase const& storage, std::vector<uint32> const& keys, uint64 tableChecksum, uint32 context)
+{
+    std::vector<uint32> pointerOffsets;
+    uint32 recordSize = GetPointerFieldOffsets(storage.GetDstFormat(), pointerOffsets);
+    MANGOS_ASSERT(recordSize == storage.GetRecordSize() && keys.size() == storage.GetRecordCount());
+
+    uint32 recordCount = storage.GetRecordCount();
+    std::vector<uint8> records(storage.m_data, storage.m_data + uint64(recordCount) * recordSize);
+
+    // strings are stored once each, the records get their offsets
+    std::string strings;
+    std::unordered_map<std::string, size_t> stringOffsets;
+    for (uint32 i = 0; i < recordCount; ++i)
+    {
+        for (std::vector<uint32>::const_iterator itr = pointerOffsets.begin(); itr != pointerOffsets.end(); ++itr)
+        {
+            uint8* field = &records[uint64(i) * recordSize + *itr];
+
+            char const* value;
+            memcpy(&value, field, sizeof(char*));
+
+            size_t stringOffset = SNAPSHOT_NULL_STRING;
+            if (value)
+            {
+                std::pair<std::unordered_map<std::string, size_t>::iterator, bool> inserted = stringOffsets.insert(std::make_pair(std::string(value), strings.size()));
+                if (inserted.second)
+                    strings.append(value, strlen(value) + 1);
+                stringOffset = inserted.first->second;
+            }
+
+            memcpy(field, &stringOffset, sizeof(size_t));
+        }
+    }
+
+    std::vector<uint8> keyData(GetKeysSize(recordCount), 0);
+    if (recordCount)
+        memcpy(&keyData[0], &keys[0], recordCount * sizeof(uint32));
+
+    SnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.pointerSize = sizeof(char*);
+    header.formatHash = GetFormatHash(storage.GetDstFormat());
+    header.context = context;
+    header.recordSize = recordSize;
+    header.recordCount = recordCount;
+    header.maxEntry = storage.GetMaxEntry();
+    header.tableChecksum = tableChecksum;
+    header.stringsSize = strings.size();
+
+    uint64 hash = SNAPSHOT_HASH_BASIS;
+    hash = HashData(hash, keyData.data(), keyData.size());
+    hash = HashData(hash, records.data(), records.size());
+    hash = HashData(hash, strings.data(), strings.size());
+    header.dataHash = hash;
+
+    std::vector<std::pair<void const*, size_t>> parts;
+    parts.push_back(std::make_pair(static_cast<void const*>(&header), sizeof(header)));
+    parts.push_back(std::make_pair(static_cast<void const*>(keyData.data()), keyData.size()));
+    parts.push_back(std::make_pair(static_cast<void const*>(records.data()), records.size()));
+    parts.push_back(std::make_pair(static_cast<void const*>(strings.data()), strings.size()));
+    WriteSnapshotFile(GetFileName(storage.GetTableName()), parts);
+}
@@ -0,0 +1,70 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SQLSTORAGE_SNAPSHOT_H
+#define SQLSTORAGE_SNAPSHOT_H
+
+#include "Common.h"
+
+#include <string>
+#include <vector>
+
+class SQLStorageBase;
+class QueryResult;
+
+/**
+ * Binary snapshots of the SQL storages.
+ *
+ * Right after a table was read from the world database its records are written to
+ * <SnapshotDir><table>.snapshot, together with the key of every record, the strings and the
+ * checksum of the table. The next load maps the snapshot instead of querying the table as long
+ * as the table checksum, the database revision, the record format and the loader context are
+ * the ones the snapshot was written for. A missing, outdated or broken snapshot just means the
+ * table is read from the database again and a new snapshot is written.
+ *
+ * The snapshot holds the records as the loader produced them, the checks and fixes ObjectMgr
+ * does on the loaded records still run after every load.
+ *
+ * Loaders building their own containers (creature and gameobject spawns, quests, loot) use Query
+ * instead: the rows of their query are kept in <SnapshotDir><name>.result.snapshot and played
+ * back from the mapping while the tables read by the query are unchanged.
+ */
+class SQLStorageSnapshot
+{
+    public:
+        // empty directory disables the snapshots
+        static void SetDirectory(std::string const& directory);
+        static bool IsEnabled() { return !m_directory.empty(); }
+
+        // checksum of the tables (comma separated) in the world database, 0 if snapshots are disabled or not supported
+        static uint64 GetTableChecksum(char const* tableNames);
+
+        // context is a hash of everything outside of the table the loaded values depend on
+        static bool Load(SQLStorageBase& storage, uint64 tableChecksum, uint32 context);
+        static void Save(SQLStorageBase const& storage, std::vector<uint32> const& keys, uint64 tableChecksum, uint32 context);
+
+        // result of sql on the world database, read from the snapshot <name> while the tables read by sql are unchanged
+        static QueryResult* Query(char const* name, char const* tableNames, char const* sql);
+
+    private:
+        static std::string GetFileName(char const* tableName);
+
+        static std::string m_directory;
+};
+
+#endif
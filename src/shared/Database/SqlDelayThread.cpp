@@ -20,14 +20,77 @@
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+bool SqlBarrier::Add(SqlOperation* sql)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_started)
+        return false;
+
+    m_operations.push_back(std::unique_ptr<SqlOperation>(sql));
+    return true;
+}
+
+void SqlBarrier::Pass(SqlConnection* conn, bool executor)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    --m_waiting;
+
+    if (executor)
+    {
+        m_condition.wait(lock, [this] { return m_waiting == 0; });
+        Run(lock, conn);
+    }
+    else
+    {
+        if (!m_waiting)
+            m_condition.notify_all();
+        m_condition.wait(lock, [this] { return m_done; });
+    }
+}
+
+bool SqlBarrier::TryPass(SqlConnection* conn, bool executor, bool& arrived)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!arrived)
+    {
+        arrived = true;
+        --m_waiting;
+    }
+
+    if (!executor)
+        return m_done;
+
+    if (m_waiting)
+        return false;
+
+    Run(lock, conn);
+    return true;
+}
+
+void SqlBarrier::Run(std::unique_lock<std::mutex>& lock, SqlConnection* conn)
+{
+    m_started = true;
+    std::vector<std::unique_ptr<SqlOperation>> operations;
+    operations.swap(m_operations);
+    lock.unlock();
+
+    for (auto const& sql : operations)
+        sql->Execute(conn);
+
+    lock.lock();
+    m_done = true;
+    m_condition.notify_all();
+}
+
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase) : m_dbEngine(db), m_dbConnection(conn),
+    m_pingDatabase(pingDatabase), m_running(true)
 {
 }
 
 SqlDelayThread::~SqlDelayThread()
 {
     // process all requests which might have been queued while thread was stopping
-    ProcessRequests();
+    ProcessPendingRequests();
 }
 
 void SqlDelayThread::run()
@@ -52,10 +115,14 @@ void SqlDelayThread::run()
         if ((loopCounter++) >= pingEveryLoop)
         {
             loopCounter = 0;
-            m_dbEngine->Ping();
+            if (m_pingDatabase)
+                m_dbEngine->Ping();
         }
     }
 
+    // requests queued before the stop may contain barriers the other delay threads are waiting at
+    ProcessRequests();
+
 #ifndef DO_POSTGRESQL
     mysql_thread_end();
 #endif
@@ -84,3 +151,32 @@ void SqlDelayThread::ProcessRequests()
         s->Execute(m_dbConnection);
     }
 }
+
+bool SqlDelayThread::ProcessPendingRequests()
+{
+    bool processed = false;
+
+    for (;;)
+    {
+        SqlOperation* sql;
+        {
+            std::lock_guard<std::mutex> guard(m_queueMutex);
+            if (m_sqlQueue.empty())
+                return processed;
+            sql = m_sqlQueue.front().get();
+        }
+
+        // the thread has ended, so nothing else removes the front entry meanwhile
+        if (SqlBarrierEntry* barrier = dynamic_cast<SqlBarrierEntry*>(sql))
+        {
+            if (!barrier->TryExecute(m_dbConnection))
+                return processed;
+        }
+        else
+            sql->Execute(m_dbConnection);
+
+        std::lock_guard<std::mutex> guard(m_queueMutex);
+        m_sqlQueue.pop();
+        processed = true;
+    }
+}
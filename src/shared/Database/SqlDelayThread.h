@@ -22,14 +22,57 @@
 #include "Threading.h"
 #include "SqlOperations.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <queue>
 #include <memory>
+#include <vector>
 
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+/// Operations which have to wait for everything queued before them in all delay threads of a database.
+/// Every delay thread gets an entry for the barrier, the first one executes the operations once all arrived
+class SqlBarrier
+{
+    public:
+        explicit SqlBarrier(uint32 threads) : m_waiting(threads), m_started(false), m_done(false) {}
+
+        /// Add an operation, fails once the barrier started executing
+        bool Add(SqlOperation* sql);
+
+        /// Wait for the other delay threads and execute or wait for the operations
+        void Pass(SqlConnection* conn, bool executor);
+        /// Non blocking variant used when the delay threads are gone, returns false while other delay threads did not arrive
+        bool TryPass(SqlConnection* conn, bool executor, bool& arrived);
+
+    private:
+        void Run(std::unique_lock<std::mutex>& lock, SqlConnection* conn);
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        uint32 m_waiting;                                   ///< delay threads which have not reached the barrier yet
+        bool m_started;
+        bool m_done;
+        std::vector<std::unique_ptr<SqlOperation>> m_operations;
+};
+
+class SqlBarrierEntry : public SqlOperation
+{
+    public:
+        SqlBarrierEntry(std::shared_ptr<SqlBarrier> barrier, bool executor) : m_barrier(std::move(barrier)), m_executor(executor), m_arrived(false) {}
+
+        bool Execute(SqlConnection* conn) override { m_barrier->Pass(conn, m_executor); return true; }
+        bool TryExecute(SqlConnection* conn) { return m_barrier->TryPass(conn, m_executor, m_arrived); }
+
+    private:
+        std::shared_ptr<SqlBarrier> m_barrier;
+        const bool m_executor;
+        bool m_arrived;
+};
+
 class SqlDelayThread : public MaNGOS::Runnable
 {
     private:
@@ -37,13 +80,14 @@ class SqlDelayThread : public MaNGOS::Runnable
         std::queue<std::unique_ptr<SqlOperation>> m_sqlQueue;   ///< Queue of SQL statements
         Database* m_dbEngine;                                   ///< Pointer to used Database engine
         SqlConnection* m_dbConnection;                          ///< Pointer to DB connection
-        volatile bool m_running;
+        const bool m_pingDatabase;                              ///< Only one delay thread of a database keeps its connections alive
+        std::atomic<bool> m_running;
 
         // process all enqueued requests
         void ProcessRequests();
 
     public:
-        SqlDelayThread(Database* db, SqlConnection* conn);
+        SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase = true);
         ~SqlDelayThread();
 
         ///< Put sql statement to delay queue
@@ -54,6 +98,9 @@ class SqlDelayThread : public MaNGOS::Runnable
             return true;
         }
 
+        ///< Execute requests left after the thread ended in the calling thread, stops at barriers other delay threads did not reach yet
+        bool ProcessPendingRequests();
+
         virtual void Stop();                                ///< Stop event
         virtual void run();                                 ///< Main Thread loop
 };
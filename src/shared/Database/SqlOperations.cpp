@@ -21,6 +21,7 @@
 #include "DatabaseEnv.h"
 #include "DatabaseImpl.h"
 
+#include <chrono>
 #include <cstdarg>
 
 #define LOCK_DB_CONN(conn) SqlConnection::Lock guard(conn)
@@ -48,23 +49,65 @@ bool SqlTransaction::Execute(SqlConnection* conn)
     if (m_queue.empty())
         return true;
 
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
     LOCK_DB_CONN(conn);
 
     conn->BeginTransaction();
 
-    const int nItems = m_queue.size();
-    for (int i = 0; i < nItems; ++i)
+    uint32 roundTrips = 2;                                  // begin and commit
+    std::vector<SqlStmtParameters const*> batchRows;
+
+    const size_t nItems = m_queue.size();
+    for (size_t i = 0; i < nItems;)
     {
         SqlOperation* pStmt = m_queue[i];
+        bool result;
+
+        // consecutive executions of the same insert statement are sent as multi-row statements
+        SqlPreparedRequest const* request = dynamic_cast<SqlPreparedRequest const*>(pStmt);
+        size_t batchEnd = i + 1;
+        if (request && conn->CanBatchStmt(request->GetIndex()))
+        {
+            for (; batchEnd < nItems; ++batchEnd)
+            {
+                SqlPreparedRequest const* next = dynamic_cast<SqlPreparedRequest const*>(m_queue[batchEnd]);
+                if (!next || next->GetIndex() != request->GetIndex())
+                    break;
+            }
+        }
+
+        if (batchEnd > i + 1)
+        {
+            batchRows.clear();
+            for (size_t j = i; j < batchEnd; ++j)
+                batchRows.push_back(static_cast<SqlPreparedRequest const*>(m_queue[j])->GetParameters());
 
-        if (!pStmt->Execute(conn))
+            result = conn->ExecuteStmtBatch(request->GetIndex(), &batchRows[0], batchRows.size(), roundTrips);
+        }
+        else
+        {
+            result = pStmt->Execute(conn);
+            ++roundTrips;
+        }
+
+        if (!result)
         {
             conn->RollbackTransaction();
             return false;
         }
+
+        i = batchEnd;
     }
 
-    return conn->CommitTransaction();
+    const bool result = conn->CommitTransaction();
+
+    const uint64 executeTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+    conn->DB().GetTransactionStatistics().Add(nItems, roundTrips, executeTime);
+    if (m_statistics)
+        m_statistics->Add(nItems, roundTrips, executeTime);
+
+    return result;
 }
 
 SqlPreparedRequest::SqlPreparedRequest(int nIndex, SqlStmtParameters* arg) : m_nIndex(nIndex), m_param(arg)
@@ -117,16 +160,15 @@ void SqlResultQueue::Add(MaNGOS::IQueryCallback *callback)
     m_queue.push(std::unique_ptr<MaNGOS::IQueryCallback>(callback));
 }
 
-bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue)
+bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback* callback, Database* db, SqlResultQueue* queue)
 {
-    if (!callback || !thread || !queue)
+    if (!callback || !db || !queue)
         return false;
 
     /// delay the execution of the queries, sync them with the delay thread
     /// which will in turn resync on execution (via the queue) and call back
     SqlQueryHolderEx* holderEx = new SqlQueryHolderEx(this, callback, queue);
-    thread->Delay(holderEx);
-    return true;
+    return db->DelayOperation(holderEx, m_orderKey);
 }
 
 bool SqlQueryHolder::SetQuery(size_t index, const char* sql)
@@ -22,6 +22,7 @@
 #include "Common.h"
 #include "Utilities/Callback.h"
 
+#include <atomic>
 #include <queue>
 #include <vector>
 #include <mutex>
@@ -44,6 +45,25 @@ class SqlOperation
 
 /// ---- ASYNC STATEMENTS / TRANSACTIONS ----
 
+/// Counters of executed transactions
+struct SqlTransactionStatistics
+{
+    SqlTransactionStatistics() : transactions(0), statements(0), roundTrips(0), executeTime(0) {}
+
+    void Add(uint32 statementCount, uint32 roundTripCount, uint64 microseconds)
+    {
+        ++transactions;
+        statements += statementCount;
+        roundTrips += roundTripCount;
+        executeTime += microseconds;
+    }
+
+    std::atomic<uint64> transactions;
+    std::atomic<uint64> statements;                         ///< statements queued into the transactions
+    std::atomic<uint64> roundTrips;                         ///< statements sent to the database after batching, with begin and commit
+    std::atomic<uint64> executeTime;                        ///< microseconds from begin to commit
+};
+
 class SqlPlainRequest : public SqlOperation
 {
     private:
@@ -58,12 +78,15 @@ class SqlTransaction : public SqlOperation
 {
     private:
         std::vector<SqlOperation* > m_queue;
+        const uint32 m_orderKey;
+        SqlTransactionStatistics* const m_statistics;
 
     public:
-        SqlTransaction() {}
+        explicit SqlTransaction(uint32 orderKey = 0, SqlTransactionStatistics* statistics = nullptr) : m_orderKey(orderKey), m_statistics(statistics) {}
         ~SqlTransaction();
 
         void DelayExecute(SqlOperation* sql) { m_queue.push_back(sql); }
+        uint32 GetOrderKey() const { return m_orderKey; }
 
         bool Execute(SqlConnection* conn) override;
 };
@@ -74,6 +97,9 @@ class SqlPreparedRequest : public SqlOperation
         SqlPreparedRequest(int nIndex, SqlStmtParameters* arg);
         ~SqlPreparedRequest();
 
+        int GetIndex() const { return m_nIndex; }
+        SqlStmtParameters const* GetParameters() const { return m_param; }
+
         bool Execute(SqlConnection* conn) override;
 
     private:
@@ -95,8 +121,11 @@ class SqlResultQueue
         std::queue<std::unique_ptr<MaNGOS::IQueryCallback>> m_queue;
 
     public:
+        virtual ~SqlResultQueue() {}
+
         void Update();
-        void Add(MaNGOS::IQueryCallback *);
+        // called by the delay thread, a derived queue may hand the callback to its thread by other means than Update()
+        virtual void Add(MaNGOS::IQueryCallback *);
 };
 
 class SqlQuery : public SqlOperation
@@ -122,15 +151,18 @@ class SqlQueryHolder
     private:
         typedef std::pair<const char*, QueryResult*> SqlResultPair;
         std::vector<SqlResultPair> m_queries;
+        uint32 m_orderKey;
     public:
-        SqlQueryHolder() {}
+        SqlQueryHolder() : m_orderKey(0) {}
         ~SqlQueryHolder();
         bool SetQuery(size_t index, const char* sql);
         bool SetPQuery(size_t index, const char* format, ...) ATTR_PRINTF(3, 4);
         void SetSize(size_t size);
         QueryResult* GetResult(size_t index);
         void SetResult(size_t index, QueryResult* result);
-        bool Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue);
+        // see Database::BeginTransaction, a holder without key waits for all earlier async requests
+        void SetOrderKey(uint32 orderKey) { m_orderKey = orderKey; }
+        bool Execute(MaNGOS::IQueryCallback* callback, Database* db, SqlResultQueue* queue);
 };
 
 class SqlQueryHolderEx : public SqlOperation
@@ -0,0 +1,146 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MPSCQUEUE_H
+#define MANGOS_MPSCQUEUE_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace MaNGOS
+{
+    /**
+     * Bounded lock-free queue for any number of producers and a single consumer.
+     *
+     * Every slot carries a sequence number telling whether it is free for the producer
+     * claiming that position or filled for the consumer, so neither side ever waits on a lock.
+     * Only one thread may consume at a time.
+     */
+    template <typename T>
+    class MPSCQueue
+    {
+        public:
+            // the capacity is rounded up to the next power of two
+            explicit MPSCQueue(size_t capacity) : m_mask(RoundUpCapacity(capacity) - 1), m_cells(new Cell[m_mask + 1]),
+                m_enqueuePos(0), m_dequeuePos(0)
+            {
+                for (size_t i = 0; i <= m_mask; ++i)
+                    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            MPSCQueue(MPSCQueue const&) = delete;
+            MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+            // returns false and leaves value untouched if the queue is full
+            bool Push(T&& value)
+            {
+                Cell* cell;
+                size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+                for (;;)
+                {
+                    cell = &m_cells[pos & m_mask];
+                    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                    const ptrdiff_t diff = ptrdiff_t(sequence) - ptrdiff_t(pos);
+
+                    if (diff == 0)
+                    {
+                        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (diff < 0)
+                        return false;
+                    else
+                        pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+
+                cell->data = std::move(value);
+                cell->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            // consumer only
+            bool Pop(T& value)
+            {
+                const size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+                Cell& cell = m_cells[pos & m_mask];
+
+                if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+                    return false;
+
+                value = std::move(cell.data);
+                cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+                return true;
+            }
+
+            // consumer only, moves at most maxCount elements to the end of out and returns their number
+            size_t PopBatch(std::vector<T>& out, size_t maxCount)
+            {
+                size_t count = 0;
+                T value;
+
+                while (count < maxCount && Pop(value))
+                {
+                    out.push_back(std::move(value));
+                    ++count;
+                }
+
+                return count;
+            }
+
+            // approximate while producers are active
+            size_t Size() const
+            {
+                const size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+                const size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+                return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+            }
+
+            bool Empty() const { return Size() == 0; }
+            size_t Capacity() const { return m_mask + 1; }
+
+        private:
+            struct Cell
+            {
+                std::atomic<size_t> sequence;
+                T data;
+            };
+
+            static size_t RoundUpCapacity(size_t capacity)
+            {
+                size_t result = 2;
+                while (result < capacity)
+                    result <<= 1;
+                return result;
+            }
+
+            const size_t m_mask;
+            std::unique_ptr<Cell[]> m_cells;
+
+            // producers and consumer work on different cache lines
+            alignas(64) std::atomic<size_t> m_enqueuePos;
+            alignas(64) std::atomic<size_t> m_dequeuePos;
+    };
+}
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MaNGOS
+{
+    bool MappedFile::Open(char const* filename, bool copyOnWrite)
+    {
+        Close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+
+        // the view keeps the mapping object alive
+        void* data = MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!data)
+            return false;
+
+        m_size = size_t(size.QuadPart);
+#else
+        int fd = open(filename, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        // the mapping stays valid after the descriptor is closed
+        void* data = copyOnWrite ?
+                     mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) :
+                     mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        m_size = size_t(st.st_size);
+#endif
+
+        m_data = static_cast<uint8 const*>(data);
+        m_copyOnWrite = copyOnWrite;
+        return true;
+    }
+
+    void MappedFile::Prefetch() const
+    {
+        // 4k is the smallest page size of all supported platforms
+        uint8 sum = 0;
+        for (size_t offset = 0; offset < m_size; offset += 4096)
+            sum += m_data[offset];
+
+        // keep the reads from being optimized away
+        volatile uint8 sink = sum;
+        (void)sink;
+    }
+
+    void MappedFile::Close()
+    {
+        if (!m_data)
+            return;
+
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap(const_cast<uint8*>(m_data), m_size);
+#endif
+
+        m_data = nullptr;
+        m_size = 0;
+        m_copyOnWrite = false;
+    }
+}
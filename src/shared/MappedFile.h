@@ -0,0 +1,70 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MAPPEDFILE_H
+#define MANGOS_MAPPEDFILE_H
+
+#include "Platform/Define.h"
+
+#include <cstddef>
+
+namespace MaNGOS
+{
+    /**
+     * Read-only memory mapping of a whole file.
+     *
+     * Pages are only read from disk when they are first touched and belong to the page cache,
+     * so every mapping of the same file (even from several processes) shares one copy in memory.
+     * A copy-on-write mapping may also be written to, only the pages written get a private copy.
+     */
+    class MappedFile
+    {
+        public:
+            MappedFile() : m_data(nullptr), m_size(0), m_copyOnWrite(false) {}
+            ~MappedFile() { Close(); }
+
+            MappedFile(MappedFile const&) = delete;
+            MappedFile& operator=(MappedFile const&) = delete;
+
+            // maps filename, returns false if the file does not exist, is empty or cannot be mapped
+            bool Open(char const* filename, bool copyOnWrite = false);
+            void Close();
+
+            bool IsOpen() const { return m_data != nullptr; }
+            uint8 const* GetData() const { return m_data; }
+            uint8* GetWritableData() const { return m_copyOnWrite ? const_cast<uint8*>(m_data) : nullptr; }
+            size_t GetSize() const { return m_size; }
+
+            // touches every page once, so later reads of the mapping do not have to wait for the disk
+            void Prefetch() const;
+
+            // true if [ptr, ptr + size) lies inside the mapping
+            bool Contains(void const* ptr, size_t size = 1) const
+            {
+                uint8 const* p = static_cast<uint8 const*>(ptr);
+                return m_data && p >= m_data && size <= m_size && p <= m_data + (m_size - size);
+            }
+
+        private:
+            uint8 const* m_data;
+            size_t m_size;
+            bool m_copyOnWrite;
+    };
+}
+
+#endif
@@ -23,6 +23,8 @@
 
 #include <boost/asio.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -42,40 +44,63 @@ namespace MaNGOS
             // the time in milliseconds to sleep a worker thread at the end of each tick
             const int SleepInterval = 100;
 
-            NetworkThread<SocketType> *SelectWorker() const
+            // picks the thread with the lowest measured load. the socket count is weighted with the average
+            // cost of a socket so that idle threads and equally loaded threads are balanced by connection count
+            NetworkThread<SocketType> *SelectWorker()
             {
-                int minIndex = 0;
-                size_t minSize = m_workerThreads[minIndex]->Size();
+                uint64 totalLoad = 0;
+                size_t totalSockets = 0;
 
-                for (size_t i = 1; i < m_workerThreads.size(); ++i)
+                for (auto const& worker : m_workerThreads)
                 {
-                    const size_t size = m_workerThreads[i]->Size();
+                    totalLoad += worker->GetStatistics().UpdateLoad();
+                    totalSockets += worker->Size();
+                }
+
+                const uint64 socketCost = std::max<uint64>(totalSockets ? totalLoad / totalSockets : 0, 1);
+
+                size_t minIndex = 0;
+                uint64 minScore = std::numeric_limits<uint64>::max();
+
+                for (size_t i = 0; i < m_workerThreads.size(); ++i)
+                {
+                    const uint64 score = m_workerThreads[i]->GetStatistics().GetLoad() + socketCost * m_workerThreads[i]->Size();
 
-                    if (size < minSize)
+                    if (score < minScore)
                     {
-                        minSize = size;
+                        minScore = score;
                         minIndex = i;
                     }
                 }
 
                 return m_workerThreads[minIndex].get();
             }
-            
+
             void BeginAccept();
             void OnAccept(NetworkThread<SocketType> *worker, std::shared_ptr<SocketType> const& socket, const boost::system::error_code &ec);
 
         public:
-            Listener(int port, int workerThreads);
+            // affinityMask selects the processors the worker threads are pinned to, one bit per processor, 0 to disable
+            Listener(int port, int workerThreads, uint64 affinityMask = 0);
             ~Listener();
     };
 
     template <typename SocketType>
-    Listener<SocketType>::Listener(int port, int workerThreads)
+    Listener<SocketType>::Listener(int port, int workerThreads, uint64 affinityMask)
         : m_service(new boost::asio::io_service()), m_acceptor(new boost::asio::ip::tcp::acceptor(*m_service, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port)))
     {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < 64; ++cpu)
+            if (affinityMask & (uint64(1) << cpu))
+                cpus.push_back(cpu);
+
         m_workerThreads.reserve(workerThreads);
         for (auto i = 0; i < workerThreads; ++i)
-            m_workerThreads.push_back(std::unique_ptr<NetworkThread<SocketType>>(new NetworkThread<SocketType>));
+        {
+            // threads are spread round-robin over the selected processors
+            const int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+            m_workerThreads.push_back(std::unique_ptr<NetworkThread<SocketType>>(new NetworkThread<SocketType>(port, i, cpu)));
+        }
 
         BeginAccept();
 
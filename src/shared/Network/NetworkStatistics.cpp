@@ -0,0 +1,139 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "NetworkStatistics.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+
+namespace MaNGOS
+{
+namespace
+{
+    std::mutex s_registryLock;
+    std::vector<NetworkThreadStatistics const*> s_registry;
+}
+
+const uint64 LatencyHistogram::BucketLimits[LatencyHistogram::BucketCount] =
+{
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, std::numeric_limits<uint64>::max()
+};
+
+LatencyHistogram::Snapshot::Snapshot() : samples(0), total(0), max(0)
+{
+    for (uint32 i = 0; i < BucketCount; ++i)
+        buckets[i] = 0;
+}
+
+LatencyHistogram::LatencyHistogram() : m_samples(0), m_total(0), m_max(0)
+{
+    for (uint32 i = 0; i < BucketCount; ++i)
+        m_buckets[i] = 0;
+}
+
+void LatencyHistogram::AddSample(uint64 microseconds)
+{
+    uint32 bucket = 0;
+    while (microseconds > BucketLimits[bucket])
+        ++bucket;
+
+    ++m_buckets[bucket];
+    ++m_samples;
+    m_total += microseconds;
+
+    // only the owning network thread adds samples, so a plain compare and store is enough
+    if (microseconds > m_max)
+        m_max = microseconds;
+}
+
+void LatencyHistogram::AddTo(Snapshot& snapshot) const
+{
+    for (uint32 i = 0; i < BucketCount; ++i)
+        snapshot.buckets[i] += m_buckets[i];
+
+    snapshot.samples += m_samples;
+    snapshot.total += m_total;
+    snapshot.max = std::max<uint64>(snapshot.max, m_max);
+}
+
+NetworkThreadStatistics::NetworkThreadStatistics(int port, uint32 index)
+    : m_port(port), m_index(index), m_bytesReceived(0), m_bytesSent(0), m_packetsReceived(0), m_packetsSent(0),
+      m_busyTime(0), m_socketCount(0), m_lastBusyTime(0), m_lastSampleTime(std::chrono::steady_clock::now()), m_load(0)
+{
+    std::lock_guard<std::mutex> guard(s_registryLock);
+    s_registry.push_back(this);
+}
+
+NetworkThreadStatistics::~NetworkThreadStatistics()
+{
+    std::lock_guard<std::mutex> guard(s_registryLock);
+    s_registry.erase(std::remove(s_registry.begin(), s_registry.end(), this), s_registry.end());
+}
+
+uint32 NetworkThreadStatistics::UpdateLoad()
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const uint64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastSampleTime).count();
+
+    if (elapsed < 1000000)
+        return m_load;
+
+    const uint64 busyTime = m_busyTime;
+    const uint32 rate = uint32((busyTime - m_lastBusyTime) * 1000000 / elapsed);
+
+    // weight the new sample with 1/4 so a single burst does not flip the balancing
+    m_load = (m_load * 3 + rate) / 4;
+    m_lastBusyTime = busyTime;
+    m_lastSampleTime = now;
+
+    return m_load;
+}
+
+namespace NetworkStatistics
+{
+    void GetSnapshots(std::vector<Snapshot>& snapshots)
+    {
+        std::lock_guard<std::mutex> guard(s_registryLock);
+
+        snapshots.reserve(snapshots.size() + s_registry.size());
+        for (auto stats : s_registry)
+        {
+            Snapshot snapshot;
+            snapshot.port = stats->GetPort();
+            snapshot.index = stats->GetIndex();
+            snapshot.sockets = stats->GetSocketCount();
+            snapshot.load = stats->GetLoad();
+            snapshot.bytesReceived = stats->GetBytesReceived();
+            snapshot.bytesSent = stats->GetBytesSent();
+            snapshot.packetsReceived = stats->GetPacketsReceived();
+            snapshot.packetsSent = stats->GetPacketsSent();
+            snapshot.busyTime = stats->GetBusyTime();
+            snapshots.push_back(snapshot);
+        }
+    }
+
+    void GetSendLatency(LatencyHistogram::Snapshot& snapshot)
+    {
+        std::lock_guard<std::mutex> guard(s_registryLock);
+
+        for (auto stats : s_registry)
+            stats->GetSendLatency().AddTo(snapshot);
+    }
+}
+}
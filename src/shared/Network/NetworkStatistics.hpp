@@ -0,0 +1,140 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __NETWORK_STATISTICS_HPP_
+#define __NETWORK_STATISTICS_HPP_
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace MaNGOS
+{
+    // distribution of the time between queueing a packet and the completion of the write that sent it
+    class LatencyHistogram
+    {
+        public:
+            static const uint32 BucketCount = 10;
+
+            // plain copy of one or more histograms, used for reporting
+            struct Snapshot
+            {
+                Snapshot();
+
+                uint64 GetAverageLatency() const { return samples ? total / samples : 0; }
+
+                uint64 buckets[BucketCount];
+                uint64 samples;
+                uint64 total;
+                uint64 max;
+            };
+
+            LatencyHistogram();
+
+            void AddSample(uint64 microseconds);
+
+            // adds the current counters to the snapshot
+            void AddTo(Snapshot& snapshot) const;
+
+            // upper bound of the bucket in microseconds, the last bucket is unbounded
+            static uint64 GetBucketLimit(uint32 bucket) { return BucketLimits[bucket]; }
+
+        private:
+            static const uint64 BucketLimits[BucketCount];
+
+            std::atomic<uint64> m_buckets[BucketCount];
+            std::atomic<uint64> m_samples;
+            std::atomic<uint64> m_total;
+            std::atomic<uint64> m_max;
+    };
+
+    // traffic counters of a single network thread, written by the sockets owned by that thread
+    class NetworkThreadStatistics
+    {
+        private:
+            const int m_port;
+            const uint32 m_index;
+
+            std::atomic<uint64> m_bytesReceived;
+            std::atomic<uint64> m_bytesSent;
+            std::atomic<uint64> m_packetsReceived;
+            std::atomic<uint64> m_packetsSent;
+            std::atomic<uint64> m_busyTime;                 // microseconds spent in socket handlers
+            std::atomic<uint32> m_socketCount;
+
+            // smoothed busy microseconds per second, only resampled by the listener thread
+            uint64 m_lastBusyTime;
+            std::chrono::steady_clock::time_point m_lastSampleTime;
+            std::atomic<uint32> m_load;
+
+            LatencyHistogram m_sendLatency;
+
+        public:
+            NetworkThreadStatistics(int port, uint32 index);
+            ~NetworkThreadStatistics();
+
+            void AddReceived(size_t bytes) { m_bytesReceived += bytes; }
+            void AddSent(size_t bytes) { m_bytesSent += bytes; }
+            void AddPacketReceived() { ++m_packetsReceived; }
+            void AddPacketSent() { ++m_packetsSent; }
+            void AddBusyTime(uint64 microseconds) { m_busyTime += microseconds; }
+            void SetSocketCount(uint32 count) { m_socketCount = count; }
+
+            int GetPort() const { return m_port; }
+            uint32 GetIndex() const { return m_index; }
+            uint64 GetBytesReceived() const { return m_bytesReceived; }
+            uint64 GetBytesSent() const { return m_bytesSent; }
+            uint64 GetPacketsReceived() const { return m_packetsReceived; }
+            uint64 GetPacketsSent() const { return m_packetsSent; }
+            uint64 GetBusyTime() const { return m_busyTime; }
+            uint32 GetSocketCount() const { return m_socketCount; }
+            uint32 GetLoad() const { return m_load; }
+
+            LatencyHistogram& GetSendLatency() { return m_sendLatency; }
+            LatencyHistogram const& GetSendLatency() const { return m_sendLatency; }
+
+            // resample the busy time, at most once per second
+            uint32 UpdateLoad();
+    };
+
+    // all network threads of the process, used for reporting
+    namespace NetworkStatistics
+    {
+        struct Snapshot
+        {
+            int port;
+            uint32 index;
+            uint32 sockets;
+            uint32 load;
+            uint64 bytesReceived;
+            uint64 bytesSent;
+            uint64 packetsReceived;
+            uint64 packetsSent;
+            uint64 busyTime;
+        };
+
+        void GetSnapshots(std::vector<Snapshot>& snapshots);
+
+        // send latency of all network threads added together
+        void GetSendLatency(LatencyHistogram::Snapshot& snapshot);
+    }
+}
+
+#endif /* !__NETWORK_STATISTICS_HPP_ */
@@ -20,6 +20,8 @@
 #define __NETWORK_THREAD_HPP_
 
 #include "Socket.hpp"
+#include "NetworkStatistics.hpp"
+#include "Threading.h"
 
 #include <boost/asio.hpp>
 
@@ -33,6 +35,9 @@ namespace MaNGOS
     class NetworkThread
     {
         private:
+            // declared first so the counters outlive any handler still referencing them through a socket
+            NetworkThreadStatistics m_statistics;
+
             boost::asio::io_service m_service;
 
             std::mutex m_socketLock;
@@ -44,7 +49,16 @@ namespace MaNGOS
             std::thread m_serviceThread;
 
         public:
-            NetworkThread() : m_work(new boost::asio::io_service::work(m_service)), m_serviceThread([this] { boost::system::error_code ec; this->m_service.run(ec); })
+            // cpu < 0 leaves the thread to the scheduler, otherwise it is pinned to that core
+            NetworkThread(int port, uint32 index, int cpu) : m_statistics(port, index), m_work(new boost::asio::io_service::work(m_service)),
+                m_serviceThread([this, cpu]
+                {
+                    if (cpu >= 0)
+                        Thread::setCurrentAffinity(cpu);
+
+                    boost::system::error_code ec;
+                    this->m_service.run(ec);
+                })
             {
                 m_serviceThread.detach();
             }
@@ -67,12 +81,15 @@ namespace MaNGOS
 
             size_t Size() const { return m_sockets.size(); }
 
+            NetworkThreadStatistics& GetStatistics() { return m_statistics; }
+
             std::shared_ptr<SocketType> CreateSocket();
 
             void RemoveSocket(Socket *socket)
             {
                 std::lock_guard<std::mutex> guard(m_socketLock);
                 m_sockets.erase(socket->shared<SocketType>());
+                m_statistics.SetSocketCount(m_sockets.size());
             }
     };
 
@@ -85,6 +102,9 @@ namespace MaNGOS
 
         MANGOS_ASSERT(i.second);
 
+        (*i.first)->SetStatistics(&m_statistics);
+        m_statistics.SetSocketCount(m_sockets.size());
+
         return *i.first;
     }
 }
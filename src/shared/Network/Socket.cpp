@@ -23,6 +23,7 @@
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <chrono>
 #include <string>
 #include <memory>
 #include <vector>
@@ -32,8 +33,29 @@
 namespace MaNGOS
 {
 Socket::Socket(boost::asio::io_service &service, std::function<void (Socket *)> closeHandler)
-    : m_writeState(WriteState::Idle), m_readState(ReadState::Idle), m_socket(service),
-      m_closeHandler(closeHandler), m_outBufferFlushTimer(service), m_address("0.0.0.0") {}
+    : m_writeState(WriteState::Idle), m_readState(ReadState::Idle), m_readSuspended(false), m_socket(service),
+      m_closeHandler(closeHandler), m_outBufferFlushTimer(service), m_statistics(nullptr), m_address("0.0.0.0") {}
+
+namespace
+{
+    // adds the time spent in a socket handler to the busy time of its network thread
+    class BusyTimeTracker
+    {
+        private:
+            NetworkThreadStatistics* const m_statistics;
+            const std::chrono::steady_clock::time_point m_start;
+
+        public:
+            explicit BusyTimeTracker(NetworkThreadStatistics* statistics)
+                : m_statistics(statistics), m_start(statistics ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+
+            ~BusyTimeTracker()
+            {
+                if (m_statistics)
+                    m_statistics->AddBusyTime(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count());
+            }
+    };
+}
 
 bool Socket::Open()
 {
@@ -48,8 +70,6 @@ bool Socket::Open()
         return false;
     }
 
-    m_outBuffer.reset(new PacketBuffer);
-    m_secondaryOutBuffer.reset(new PacketBuffer);
     m_inBuffer.reset(new PacketBuffer);
 
     StartAsyncRead();
@@ -86,6 +106,8 @@ void Socket::StartAsyncRead()
 
 void Socket::OnRead(const boost::system::error_code &error, size_t length)
 {
+    BusyTimeTracker busyTime(m_statistics);
+
     if (error)
     {
         m_readState = ReadState::Idle;
@@ -101,6 +123,9 @@ void Socket::OnRead(const boost::system::error_code &error, size_t length)
 
     m_inBuffer->m_writePosition += length;
 
+    if (m_statistics)
+        m_statistics->AddReceived(length);
+
     const size_t available = m_socket.available();
 
     // if there is still data to read, increase the buffer size and do so (if necessary)
@@ -111,6 +136,11 @@ void Socket::OnRead(const boost::system::error_code &error, size_t length)
         return;
     }
 
+    ProcessInBuffer();
+}
+
+void Socket::ProcessInBuffer()
+{
     // we must repeat this in case we have read in multiple messages from the client
     while (m_inBuffer->m_readPosition < m_inBuffer->m_writePosition)
     {
@@ -127,21 +157,53 @@ void Socket::OnRead(const boost::system::error_code &error, size_t length)
                 m_inBuffer->m_readPosition = 0;
                 m_inBuffer->m_writePosition = bytesRemaining;
 
-                StartAsyncRead();
+                ContinueRead();
             }
             else if (!IsClosed())
                 Close();
 
             return;
         }
+
+        if (m_statistics)
+            m_statistics->AddPacketReceived();
     }
 
     // at this point, the packet has been read and successfully processed.  reset the buffer.
     m_inBuffer->m_writePosition = m_inBuffer->m_readPosition = 0;
 
+    ContinueRead();
+}
+
+void Socket::ContinueRead()
+{
+    if (m_readSuspended)
+    {
+        m_readState = ReadState::Idle;
+        return;
+    }
+
     StartAsyncRead();
 }
 
+void Socket::ResumeRead()
+{
+    if (!m_readSuspended.exchange(false))
+        return;
+
+    // the read state is only touched by the network thread, so check there whether the read loop has already stopped.
+    // data received before reading was suspended may still wait in the buffer
+    std::shared_ptr<Socket> ptr = shared<Socket>();
+    boost::asio::post(m_socket.get_executor(), [ptr]()
+    {
+        if (ptr->m_readState == ReadState::Idle && !ptr->IsClosed())
+        {
+            BusyTimeTracker busyTime(ptr->m_statistics);
+            ptr->ProcessInBuffer();
+        }
+    });
+}
+
 void Socket::OnError(const boost::system::error_code &error)
 {
     // skip logging this code because it happens whenever anyone disconnects.  reduces spam.
@@ -162,12 +224,31 @@ bool Socket::Read(char *buffer, int length)
     return true;
 }
 
-void Socket::Write(const char *header, int headerSize, const char* content, int contentSize)
+// note that this function assumes that the socket mutex is locked
+PacketBuffer* Socket::GetCoalescingOutBuffer()
+{
+    // append to the last queued segment as long as it is one of our own buffers
+    if (!m_outQueue.empty() && m_outQueue.back().buffer)
+        return m_outQueue.back().buffer.get();
+
+    OutSegment segment;
+    if (m_freeOutBuffers.empty())
+        segment.buffer.reset(new PacketBuffer);
+    else
+    {
+        segment.buffer = std::move(m_freeOutBuffers.back());
+        m_freeOutBuffers.pop_back();
+    }
+
+    m_outQueue.push_back(std::move(segment));
+    return m_outQueue.back().buffer.get();
+}
+
+void Socket::Write(const char *header, int headerSize, const char* content, int contentSize, uint32 maxDelay)
 {
     std::lock_guard<std::mutex> guard(m_mutex);
 
-    // get the correct buffer depending on the current writing state
-    PacketBuffer* outBuffer = m_writeState == WriteState::Sending ? m_secondaryOutBuffer.get() : m_outBuffer.get();
+    PacketBuffer* outBuffer = GetCoalescingOutBuffer();
 
     // write the header
     outBuffer->Write(header, headerSize);
@@ -175,31 +256,63 @@ void Socket::Write(const char *header, int headerSize, const char* content, int
     // write the content
     outBuffer->Write(content, contentSize);
 
-    // flush data if need
-    if (m_writeState == WriteState::Idle)
-        StartWriteFlushTimer();
+    OnWriteQueued(maxDelay);
 }
 
-void Socket::Write(const char *buffer, int length)
+void Socket::Write(const char *header, int headerSize, std::shared_ptr<const ByteBuffer> const& payload, uint32 maxDelay)
 {
     std::lock_guard<std::mutex> guard(m_mutex);
 
-    // get the correct buffer depending on the current writing state
-    PacketBuffer* outBuffer = m_writeState == WriteState::Sending ? m_secondaryOutBuffer.get() : m_outBuffer.get();
+    // write the header
+    GetCoalescingOutBuffer()->Write(header, headerSize);
+
+    // queue the content by reference, following writes start a new coalescing buffer
+    OutSegment segment;
+    segment.payload = payload;
+    m_outQueue.push_back(std::move(segment));
+
+    OnWriteQueued(maxDelay);
+}
+
+void Socket::Write(const char *buffer, int length, uint32 maxDelay)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
 
     // write the header
-    outBuffer->Write(buffer, length);
+    GetCoalescingOutBuffer()->Write(buffer, length);
 
-    // flush data if need
-    if (m_writeState == WriteState::Idle)
-        StartWriteFlushTimer();
+    OnWriteQueued(maxDelay);
 }
 
 // note that this function assumes that the socket mutex is locked
-void Socket::StartWriteFlushTimer()
+void Socket::OnWriteQueued(uint32 maxDelay)
 {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    m_queuedTimes.push_back(now);
+
+    if (m_statistics)
+        m_statistics->AddPacketSent();
+
+    // the running send picks up everything queued meanwhile once it completes
+    if (m_writeState == WriteState::Sending)
+        return;
+
+    // a socket which did not send anything for maxDelay is idle and flushes at once,
+    // under sustained traffic writes are held back so there is at most one send per maxDelay
+    const std::chrono::milliseconds window(maxDelay);
+    const std::chrono::steady_clock::time_point deadline = now - m_lastFlushTime >= window ? now : m_lastFlushTime + window;
+
     if (m_writeState == WriteState::Buffering)
+    {
+        // a more urgent write takes everything buffered so far with it
+        if (deadline < m_flushDeadline)
+        {
+            m_flushDeadline = now;
+            ForceFlushOut();
+        }
         return;
+    }
 
     // if the socket is closed, silently fail
     if (IsClosed())
@@ -209,9 +322,10 @@ void Socket::StartWriteFlushTimer()
     }
 
     m_writeState = WriteState::Buffering;
+    m_flushDeadline = deadline;
 
     std::shared_ptr<Socket> ptr = shared<Socket>();
-    m_outBufferFlushTimer.expires_from_now(boost::posix_time::milliseconds(BufferTimeout));
+    m_outBufferFlushTimer.expires_from_now(boost::posix_time::microseconds(std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count()));
     m_outBufferFlushTimer.async_wait([ptr](const boost::system::error_code &error) { ptr->FlushOut(); });
 }
 
@@ -228,11 +342,37 @@ void Socket::FlushOut()
 
     assert(m_writeState == WriteState::Buffering);
 
-    // at this point we are guarunteed that there is data to send in the primary buffer.  send it.
+    // at this point we are guarunteed that there is data to send in the queue.  send it.
     m_writeState = WriteState::Sending;
 
+    StartAsyncWrite();
+}
+
+// note that this function assumes that the socket mutex is locked
+void Socket::StartAsyncWrite()
+{
+    assert(m_sendingSegments.empty() && m_sendingQueuedTimes.empty() && !m_outQueue.empty());
+
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(m_outQueue.size());
+
+    // move everything queued so far in flight and hand it to asio as one gather list
+    for (auto& segment : m_outQueue)
+    {
+        if (segment.buffer)
+            buffers.push_back(boost::asio::buffer(&segment.buffer->m_buffer[0], segment.buffer->m_writePosition));
+        else
+            buffers.push_back(boost::asio::buffer(segment.payload->contents(), segment.payload->size()));
+
+        m_sendingSegments.push_back(std::move(segment));
+    }
+    m_outQueue.clear();
+
+    m_sendingQueuedTimes.swap(m_queuedTimes);
+    m_lastFlushTime = std::chrono::steady_clock::now();
+
     std::shared_ptr<Socket> ptr = shared<Socket>();
-    m_socket.async_write_some(boost::asio::buffer(m_outBuffer->m_buffer, m_outBuffer->m_writePosition),
+    boost::asio::async_write(m_socket, buffers,
         make_custom_alloc_handler(m_allocator,
             [ptr](const boost::system::error_code &error, size_t length) { ptr->OnWriteComplete(error, length); }));
 }
@@ -247,6 +387,8 @@ void Socket::ForceFlushOut()
 
 void Socket::OnWriteComplete(const boost::system::error_code &error, size_t length)
 {
+    BusyTimeTracker busyTime(m_statistics);
+
     // we must check this before locking the mutex because the connection will be closed,
     // which leads to a locked mutex being destroyed.  not good!
     if (error)
@@ -264,37 +406,35 @@ void Socket::OnWriteComplete(const boost::system::error_code &error, size_t leng
     std::lock_guard<std::mutex> guard(m_mutex);
 
     assert(m_writeState == WriteState::Sending);
-    assert(length <= m_outBuffer->m_writePosition);
 
-    // if there is data left to write, move it to the start of the buffer
-    if (length < m_outBuffer->m_writePosition)
-    {
-        std::copy(&m_outBuffer->m_buffer[length], &m_outBuffer->m_buffer[m_outBuffer->m_writePosition], m_outBuffer->m_buffer.begin());
-        m_outBuffer->m_writePosition -= length;
-    }
-    // if not, reset the write pointer
-    else
-        m_outBuffer->m_writePosition = 0;
+    if (m_statistics)
+        m_statistics->AddSent(length);
 
-    // if there is data in the secondary buffer, append it to the primary buffer
-    if (m_secondaryOutBuffer->m_writePosition > 0)
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (auto const& queued : m_sendingQueuedTimes)
     {
-        // do we have enough space? if not, resize
-        if (m_outBuffer->m_buffer.size() < (m_outBuffer->m_writePosition + m_secondaryOutBuffer->m_writePosition))
-            m_outBuffer->m_buffer.resize(m_outBuffer->m_writePosition + m_secondaryOutBuffer->m_writePosition);
+        const uint64 latency = std::chrono::duration_cast<std::chrono::microseconds>(now - queued).count();
 
-        std::copy(&m_secondaryOutBuffer->m_buffer[0], &m_secondaryOutBuffer->m_buffer[m_secondaryOutBuffer->m_writePosition], &m_outBuffer->m_buffer[m_outBuffer->m_writePosition]);
+        m_sendLatency.AddSample(latency);
+        if (m_statistics)
+            m_statistics->GetSendLatency().AddSample(latency);
+    }
+    m_sendingQueuedTimes.clear();
 
-        m_outBuffer->m_writePosition += m_secondaryOutBuffer->m_writePosition;
-        m_secondaryOutBuffer->m_writePosition = 0;
+    // async_write only completes without error once the whole gather list is sent, keep a few buffers for reuse
+    for (auto& segment : m_sendingSegments)
+    {
+        if (segment.buffer && m_freeOutBuffers.size() < MaxFreeOutBuffers)
+        {
+            segment.buffer->m_writePosition = 0;
+            m_freeOutBuffers.push_back(std::move(segment.buffer));
+        }
     }
+    m_sendingSegments.clear();
 
-    std::shared_ptr<Socket> ptr = shared<Socket>();
     // if there is any data to write, do so immediately
-    if (m_outBuffer->m_writePosition > 0)
-        m_socket.async_write_some(boost::asio::buffer(m_outBuffer->m_buffer, m_outBuffer->m_writePosition),
-            make_custom_alloc_handler(m_allocator,
-                [ptr](const boost::system::error_code &error, size_t length) { ptr->OnWriteComplete(error, length);}));
+    if (!m_outQueue.empty())
+        StartAsyncWrite();
     else
         m_writeState = WriteState::Idle;
 }
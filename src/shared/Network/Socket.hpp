@@ -20,24 +20,34 @@
 #define __SOCKET_HPP_
 
 #include "PacketBuffer.hpp"
+#include "NetworkStatistics.hpp"
 
 #include "Platform/Define.h"
+#include "ByteBuffer.h"
 
 #include <boost/asio.hpp>
 
+#include <chrono>
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <string>
 #include <mutex>
 #include <functional>
+#include <vector>
 
 namespace MaNGOS
 {
     class Socket : public std::enable_shared_from_this<Socket>
     {
+        public:
+            // default time, in milliseconds, a write may be held back to be sent together with following writes.
+            // higher values decrease responsiveness ingame but increase bandwidth efficiency by reducing tcp overhead.
+            static const uint32 DefaultWriteDelay = 50;
+
         private:
-            // buffer timeout period, in milliseconds.  higher values decrease responsiveness
-            // ingame but increase bandwidth efficiency by reducing tcp overhead.
-            static const int BufferTimeout = 50;
+            // number of emptied output buffers kept per socket instead of freeing them
+            static const size_t MaxFreeOutBuffers = 2;
 
             enum class WriteState
             {
@@ -55,23 +65,54 @@ namespace MaNGOS
             WriteState m_writeState;
             ReadState m_readState;
 
+            // set while the owner cannot take more incoming data, reading continues after ResumeRead()
+            std::atomic<bool> m_readSuspended;
+
             boost::asio::ip::tcp::socket m_socket;
 
             std::function<void(Socket *)> m_closeHandler;
 
+            // one piece of the output stream: either small writes coalesced into a buffer owned by the socket,
+            // or a shared payload which is handed to asio as is
+            struct OutSegment
+            {
+                std::unique_ptr<PacketBuffer> buffer;
+                std::shared_ptr<const ByteBuffer> payload;
+            };
+
+            // segments are never modified once in flight, new writes always go to m_outQueue
+            std::deque<OutSegment> m_outQueue;
+            std::vector<OutSegment> m_sendingSegments;
+            std::vector<std::unique_ptr<PacketBuffer>> m_freeOutBuffers;
+
             std::unique_ptr<PacketBuffer> m_inBuffer;
-            std::unique_ptr<PacketBuffer> m_outBuffer;
-            std::unique_ptr<PacketBuffer> m_secondaryOutBuffer;
 
             std::mutex m_mutex;
             boost::asio::deadline_timer m_outBufferFlushTimer;
 
+            // start of the last send and the time the running flush timer expires
+            std::chrono::steady_clock::time_point m_lastFlushTime;
+            std::chrono::steady_clock::time_point m_flushDeadline;
+
+            // queue times of the packets waiting in m_outQueue and of those in flight
+            std::vector<std::chrono::steady_clock::time_point> m_queuedTimes;
+            std::vector<std::chrono::steady_clock::time_point> m_sendingQueuedTimes;
+            LatencyHistogram m_sendLatency;
+
+            // counters of the network thread owning this socket, may be null
+            NetworkThreadStatistics* m_statistics;
+
             void StartAsyncRead();
+            void ContinueRead();
             void OnRead(const boost::system::error_code &error, size_t length);
+            void ProcessInBuffer();
 
-            void StartWriteFlushTimer();
+            void OnWriteQueued(uint32 maxDelay);
             void OnWriteComplete(const boost::system::error_code &error, size_t length);
             void FlushOut();
+            void StartAsyncWrite();
+
+            PacketBuffer* GetCoalescingOutBuffer();
 
             void OnError(const boost::system::error_code &error);
 
@@ -87,6 +128,10 @@ namespace MaNGOS
 
             void ForceFlushOut();
 
+            // stop reading after the data already received has been processed. ProcessIncomingData() may also
+            // leave the rest of the received data for later by returning false with errno set to EBADMSG
+            void SuspendRead() { m_readSuspended = true; }
+
         public:
             Socket(boost::asio::io_service &service, std::function<void (Socket *)> closeHandler);
             virtual ~Socket() = default;
@@ -97,14 +142,24 @@ namespace MaNGOS
             bool IsClosed() const { return !m_socket.is_open(); }
             virtual bool Deletable() const { return IsClosed(); }
 
+            bool IsReadSuspended() const { return m_readSuspended; }
+            // may be called from any thread
+            void ResumeRead();
+
             bool Read(char *buffer, int length);
             void ReadSkip(int length) { m_inBuffer->Read(nullptr, length); }
 
-            void Write(const char *buffer, int length);
-            void Write(const char *header, int headerSize, const char* content, int contentSize);
+            // maxDelay is the longest time in milliseconds the data may wait for following writes, 0 sends it right away
+            void Write(const char *buffer, int length, uint32 maxDelay = DefaultWriteDelay);
+            void Write(const char *header, int headerSize, const char* content, int contentSize, uint32 maxDelay = DefaultWriteDelay);
+            // only the header is copied, the payload is referenced until it has been sent
+            void Write(const char *header, int headerSize, std::shared_ptr<const ByteBuffer> const& payload, uint32 maxDelay = DefaultWriteDelay);
 
             boost::asio::ip::tcp::socket &GetAsioSocket() { return m_socket; }
 
+            void SetStatistics(NetworkThreadStatistics* statistics) { m_statistics = statistics; }
+            LatencyHistogram const& GetSendLatency() const { return m_sendLatency; }
+
             const std::string &GetRemoteEndpoint() const { return m_remoteEndpoint; }
             const std::string &GetRemoteAddress() const { return m_address; }
 
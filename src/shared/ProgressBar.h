@@ -30,6 +30,7 @@ class BarGoLink
         void step();
 
         static void SetOutputState(bool on);
+        static bool GetOutputState();
     private:
         void init(int row_count);
 
@@ -0,0 +1,277 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_SIZECLASSPOOL_H
+#define MANGOS_SIZECLASSPOOL_H
+
+#include "Platform/Define.h"
+#include "ThreadCounters.h"
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace MaNGOS
+{
+    /**
+     * Free lists of recycled memory in size classes, used by ByteBufferPool and AuraPool.
+     *
+     * Every thread caches a few items of each class and exchanges them in batches with a shared depot,
+     * so memory allocated by one thread and freed by another is reused instead of returned to the heap.
+     * The pool only keeps items, the user picks the size class and allocates on a miss. Traits describes
+     * the items:
+     *     typedef ... Item;                                    // movable, default constructed without memory,
+     *                                                          // destroying it frees its memory
+     *     static const uint32 ClassCount;
+     *     static const uint32 DefaultThreadCache;
+     *     static const size_t DefaultMaxSharedBytes;
+     *     static size_t GetBytes(Item const& item, uint32 sizeClass);
+     */
+    template <class Traits>
+    class SizeClassPool
+    {
+        public:
+            typedef typename Traits::Item Item;
+            static const uint32 ClassCount = Traits::ClassCount;
+
+            struct ClassTotals
+            {
+                uint64 hits;                                // items taken from the pool
+                uint64 misses;                              // items the user had to allocate
+                uint64 released;                            // items given back
+                uint64 discarded;                           // items freed because the pool was full
+                int64 retained;                             // items currently held by thread caches and depot
+            };
+
+            struct Totals
+            {
+                ClassTotals classes[ClassCount];
+                uint64 unpooled;                            // allocations outside the size classes or with the pool disabled
+            };
+
+            // threadCache items per size class and thread, 0 disables the pool; maxSharedBytes limits the shared depot
+            static void Configure(uint32 threadCache, size_t maxSharedBytes)
+            {
+                s_threadCache = threadCache;
+                s_maxSharedBytes = maxSharedBytes;
+            }
+
+            // moves a pooled item of sizeClass into item (which must be empty), false if the user has to allocate one
+            static bool Take(uint32 sizeClass, Item& item)
+            {
+                if (t_cacheDestroyed)
+                    return false;
+
+                const uint32 threadCache = s_threadCache.load(std::memory_order_relaxed);
+                if (!threadCache)
+                {
+                    AddThreadCounter<uint64>(t_cache.counters.unpooled, 1);
+                    return false;
+                }
+
+                ItemList& cache = t_cache.items[sizeClass];
+                ClassCounters& counters = t_cache.counters.classes[sizeClass];
+
+                if (cache.empty())
+                    Refill(sizeClass, threadCache / 2 + 1);
+
+                if (cache.empty())
+                {
+                    AddThreadCounter<uint64>(counters.misses, 1);
+                    return false;
+                }
+
+                item = std::move(cache.back());
+                cache.pop_back();
+                AddThreadCounter<uint64>(counters.hits, 1);
+                AddThreadCounter<int64>(counters.retained, -1);
+                return true;
+            }
+
+            // keeps item for a later Take of sizeClass, or frees it if the pool is disabled or full; item is left empty
+            static void Give(uint32 sizeClass, Item& item)
+            {
+                const uint32 threadCache = s_threadCache.load(std::memory_order_relaxed);
+                if (!threadCache || t_cacheDestroyed)
+                {
+                    Item discarded(std::move(item));
+                    return;
+                }
+
+                ItemList& cache = t_cache.items[sizeClass];
+                ClassCounters& counters = t_cache.counters.classes[sizeClass];
+
+                if (cache.size() >= threadCache)
+                    Flush(sizeClass, cache.size() / 2 + 1);
+
+                cache.push_back(std::move(item));
+                AddThreadCounter<uint64>(counters.released, 1);
+                AddThreadCounter<int64>(counters.retained, 1);
+            }
+
+            // counts an allocation the user made outside the size classes
+            static void CountUnpooled()
+            {
+                if (!t_cacheDestroyed)
+                    AddThreadCounter<uint64>(t_cache.counters.unpooled, 1);
+            }
+
+            static void GetTotals(Totals& totals)
+            {
+                ThreadCounters<Counters, Totals>::Sum(totals);
+            }
+
+            // bytes held by the shared depot
+            static size_t GetSharedBytes()
+            {
+                return GetShared().depotBytes;
+            }
+
+        private:
+            typedef std::vector<Item> ItemList;
+
+            struct ClassCounters
+            {
+                std::atomic<uint64> hits;
+                std::atomic<uint64> misses;
+                std::atomic<uint64> released;
+                std::atomic<uint64> discarded;
+                std::atomic<int64> retained;                // may go negative for a thread using items another thread released
+
+                ClassCounters() : hits(0), misses(0), released(0), discarded(0), retained(0) {}
+            };
+
+            struct Counters
+            {
+                ClassCounters classes[ClassCount];
+                std::atomic<uint64> unpooled;
+
+                Counters() : unpooled(0) {}
+
+                void AddTo(Totals& totals) const
+                {
+                    for (uint32 i = 0; i < ClassCount; ++i)
+                    {
+                        ClassTotals& total = totals.classes[i];
+                        total.hits += classes[i].hits;
+                        total.misses += classes[i].misses;
+                        total.released += classes[i].released;
+                        total.discarded += classes[i].discarded;
+                        total.retained += classes[i].retained;
+                    }
+                    totals.unpooled += unpooled;
+                }
+            };
+
+            // never destroyed, items can still be given back while static objects are destroyed at exit
+            struct SharedState
+            {
+                std::mutex depotLocks[ClassCount];
+                ItemList depot[ClassCount];
+                std::atomic<size_t> depotBytes;
+
+                SharedState() : depotBytes(0) {}
+            };
+
+            struct ThreadCache
+            {
+                ItemList items[ClassCount];
+                ThreadCounters<Counters, Totals> counters;
+
+                ~ThreadCache()
+                {
+                    t_cacheDestroyed = true;
+
+                    // the cached items are freed with the cache
+                    for (uint32 i = 0; i < ClassCount; ++i)
+                    {
+                        AddThreadCounter<uint64>(counters.classes[i].discarded, items[i].size());
+                        AddThreadCounter<int64>(counters.classes[i].retained, -int64(items[i].size()));
+                    }
+                }
+            };
+
+            static SharedState& GetShared()
+            {
+                static SharedState* state = new SharedState();
+                return *state;
+            }
+
+            static void Refill(uint32 sizeClass, size_t count)
+            {
+                SharedState& shared = GetShared();
+                ItemList& cache = t_cache.items[sizeClass];
+                ItemList& depot = shared.depot[sizeClass];
+
+                std::lock_guard<std::mutex> guard(shared.depotLocks[sizeClass]);
+                for (; count && !depot.empty(); --count)
+                {
+                    shared.depotBytes -= Traits::GetBytes(depot.back(), sizeClass);
+                    cache.push_back(std::move(depot.back()));
+                    depot.pop_back();
+                }
+            }
+
+            static void Flush(uint32 sizeClass, size_t count)
+            {
+                SharedState& shared = GetShared();
+                ItemList& cache = t_cache.items[sizeClass];
+                ItemList& depot = shared.depot[sizeClass];
+                ClassCounters& counters = t_cache.counters.classes[sizeClass];
+                const size_t maxSharedBytes = s_maxSharedBytes.load(std::memory_order_relaxed);
+
+                std::lock_guard<std::mutex> guard(shared.depotLocks[sizeClass]);
+                for (; count && !cache.empty(); --count)
+                {
+                    const size_t bytes = Traits::GetBytes(cache.back(), sizeClass);
+                    if (shared.depotBytes + bytes <= maxSharedBytes)
+                    {
+                        shared.depotBytes += bytes;
+                        depot.push_back(std::move(cache.back()));
+                    }
+                    else
+                    {
+                        AddThreadCounter<uint64>(counters.discarded, 1);
+                        AddThreadCounter<int64>(counters.retained, -1);
+                    }
+                    cache.pop_back();
+                }
+            }
+
+            static std::atomic<uint32> s_threadCache;
+            static std::atomic<size_t> s_maxSharedBytes;
+
+            static thread_local bool t_cacheDestroyed;
+            static thread_local ThreadCache t_cache;
+    };
+
+    template <class Traits>
+    std::atomic<uint32> SizeClassPool<Traits>::s_threadCache(Traits::DefaultThreadCache);
+
+    template <class Traits>
+    std::atomic<size_t> SizeClassPool<Traits>::s_maxSharedBytes(Traits::DefaultMaxSharedBytes);
+
+    template <class Traits>
+    thread_local bool SizeClassPool<Traits>::t_cacheDestroyed = false;
+
+    template <class Traits>
+    thread_local typename SizeClassPool<Traits>::ThreadCache SizeClassPool<Traits>::t_cache;
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_THREADCOUNTERS_H
+#define MANGOS_THREADCOUNTERS_H
+
+#include "Platform/Define.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace MaNGOS
+{
+    // the counters of a thread are only written by the thread itself, so no atomic read-modify-write is needed
+    template <typename T>
+    inline void AddThreadCounter(std::atomic<T>& counter, T value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Statistics counters kept per thread and summed on demand.
+     *
+     * Counters holds the std::atomic counters of one thread, changed with AddThreadCounter, and provides
+     *     void AddTo(Totals& totals) const;
+     * Every ThreadCounters object (usually a thread_local) registers itself on construction and adds its
+     * counts to the totals of ended threads on destruction, so Sum covers every thread that ever ran.
+     */
+    template <class Counters, class Totals>
+    class ThreadCounters : public Counters
+    {
+        public:
+            ThreadCounters()
+            {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> guard(registry.threadsLock);
+                registry.threads.push_back(this);
+            }
+
+            ~ThreadCounters()
+            {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> guard(registry.threadsLock);
+                registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+                this->AddTo(registry.exitedThreads);
+            }
+
+            ThreadCounters(ThreadCounters const&) = delete;
+            ThreadCounters& operator=(ThreadCounters const&) = delete;
+
+            static void Sum(Totals& totals)
+            {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> guard(registry.threadsLock);
+
+                totals = registry.exitedThreads;
+                for (ThreadCounters const* counters : registry.threads)
+                    counters->AddTo(totals);
+            }
+
+        private:
+            // never destroyed, threads can still end while static objects are destroyed at exit
+            struct Registry
+            {
+                std::mutex threadsLock;
+                std::vector<ThreadCounters*> threads;
+                Totals exitedThreads;                       // counters of threads which already ended
+
+                Registry() : exitedThreads() {}
+            };
+
+            static Registry& GetRegistry()
+            {
+                static Registry* registry = new Registry();
+                return *registry;
+            }
+    };
+}
+
+#endif
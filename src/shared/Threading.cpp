@@ -22,6 +22,11 @@
 #include <chrono>
 #include <system_error>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 using namespace MaNGOS;
 
 Thread::Thread() : m_task(nullptr), m_iThreadId(), m_ThreadImp()
@@ -135,3 +140,21 @@ void Thread::Sleep(unsigned long msecs)
 {
     std::this_thread::sleep_for(std::chrono::milliseconds(msecs));
 }
+
+bool Thread::setCurrentAffinity(unsigned int cpu)
+{
+#if defined(_WIN32)
+    if (cpu >= sizeof(DWORD_PTR) * 8)
+        return false;
+
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+    return false;
+#endif
+}
@@ -65,6 +65,8 @@ namespace MaNGOS
 
             static void Sleep(unsigned long msecs);
             static std::thread::id currentId();
+            // pin the calling thread to a single processor, returns false if not supported
+            static bool setCurrentAffinity(unsigned int cpu);
 
         private:
             Thread(const Thread&);
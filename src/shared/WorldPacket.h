@@ -37,11 +37,18 @@ class WorldPacket : public ByteBuffer
         WorldPacket(const WorldPacket& packet)              : ByteBuffer(packet), m_opcode(packet.m_opcode)
         {
         }
+        // move constructor, used to hand a finished packet over to the socket without copying its content
+        WorldPacket(WorldPacket&& packet)                   : ByteBuffer(std::move(packet)), m_opcode(packet.m_opcode)
+        {
+        }
+
+        WorldPacket& operator=(const WorldPacket&) = default;
+        WorldPacket& operator=(WorldPacket&&) = default;
 
         void Initialize(Opcodes opcode, size_t newres = 200)
         {
             clear();
-            _storage.reserve(newres);
+            reserve(newres);
             m_opcode = opcode;
         }
 
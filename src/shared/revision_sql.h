@@ -2,5 +2,5 @@
 #define __REVISION_SQL_H__
  #define REVISION_DB_REALMD "required_s2325_01_realmd"
  #define REVISION_DB_CHARACTERS "required_s2359_01_characters_account_instances_entered"
- #define REVISION_DB_MANGOS "required_s2358_01_mangos_game_event_group"
+ #define REVISION_DB_MANGOS "required_s2371_01_mangos_command"
 #endif // __REVISION_SQL_H__